@@ -1,5 +1,6 @@
 CLOUD_SERVER_SOURCES = \
 	$(SRC)/Tracking/SkyLines/Server.cpp \
+	$(SRC)/Tracking/SkyLines/Sharding.cpp \
 	$(SRC)/Tracking/SkyLines/Assemble.cpp \
 	$(SRC)/Cloud/Serialiser.cpp \
 	$(SRC)/Cloud/Client.cpp \
@@ -9,8 +10,10 @@ CLOUD_SERVER_SOURCES = \
 	$(SRC)/Cloud/OGNTraffic.cpp \
 	$(SRC)/Cloud/OGNClient.cpp \
 	$(SRC)/Cloud/Sender.cpp \
+	$(SRC)/Cloud/Snapshot.cpp \
+	$(SRC)/Cloud/TrafficCache.cpp \
 	$(SRC)/Cloud/Main.cpp
-CLOUD_SERVER_DEPENDS = ASYNC LIBNET IO OS GEO MATH UTIL TIME UNITS
+CLOUD_SERVER_DEPENDS = ASYNC LIBNET IO OS THREAD GEO MATH UTIL TIME UNITS
 $(eval $(call link-program,xcsoar-cloud-server,CLOUD_SERVER))
 
 CLOUD_TO_KML_SOURCES = \
@@ -8,11 +8,14 @@ HOT_SOURCES = \
 	$(JASPER_SOURCES) \
 	$(SRC)/MapWindow/OverlayBitmap.cpp \
 	$(SRC)/Topography/TopographyFileRenderer.cpp \
+	$(SRC)/Terrain/Interpolation.cpp \
 	$(SRC)/Terrain/RasterBuffer.cpp \
 	$(SRC)/Terrain/RasterMap.cpp \
 	$(SRC)/Terrain/HeightMatrix.cpp \
+	$(SRC)/Terrain/SlopeShading.cpp \
 	$(SRC)/Terrain/RasterRenderer.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterTileCache.cpp \
 	$(SRC)/Terrain/ScanLine.cpp \
 	$(SRC)/Terrain/Intersection.cpp \
 	$(SRC)/Projection/Projection.cpp \
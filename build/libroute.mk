@@ -12,6 +12,6 @@ ROUTE_SOURCES = \
 	$(ROUTE_SRC_DIR)/FlatTriangleFanTree.cpp \
 	$(ROUTE_SRC_DIR)/ReachFan.cpp
 
-ROUTE_DEPENDS = GEO GLIDE
+ROUTE_DEPENDS = GEO GLIDE THREAD
 
 $(eval $(call link-library,libroute,ROUTE))
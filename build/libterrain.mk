@@ -1,5 +1,6 @@
 TERRAIN_SOURCES = \
 	$(SRC)/Terrain/AsyncLoader.cpp \
+	$(SRC)/Terrain/Interpolation.cpp \
 	$(SRC)/Terrain/RasterBuffer.cpp \
 	$(SRC)/Terrain/RasterProjection.cpp \
 	$(SRC)/Terrain/RasterMap.cpp \
@@ -13,13 +14,18 @@ TERRAIN_SOURCES = \
 	$(SRC)/Terrain/RasterTerrain.cpp \
 	$(SRC)/Terrain/Thread.cpp \
 	$(SRC)/Terrain/HeightMatrix.cpp \
+	$(SRC)/Terrain/SlopeShading.cpp \
 	$(SRC)/Terrain/RasterRenderer.cpp \
 	$(SRC)/Terrain/TerrainRenderer.cpp \
 	$(SRC)/Terrain/TerrainSettings.cpp
 
+ifeq ($(HAVE_POSIX),y)
+TERRAIN_SOURCES += $(SRC)/Terrain/TileStore.cpp
+endif
+
 TERRAIN_CXXFLAGS_INTERNAL = -Wno-shift-negative-value
 TERRAIN_CPPFLAGS_INTERNAL = $(SCREEN_CPPFLAGS)
 
-TERRAIN_DEPENDS = JASPER ZZIP GEO UTIL
+TERRAIN_DEPENDS = JASPER ZZIP IO THREAD GEO UTIL
 
 $(eval $(call link-library,libterrain,TERRAIN))
@@ -1,6 +1,7 @@
 TOPO_SOURCES = \
 	$(SRC)/Topography/ShapeFile.cpp \
 	$(SRC)/Topography/TopographyFile.cpp \
+	$(SRC)/Topography/TopographyPack.cpp \
 	$(SRC)/Topography/TopographyStore.cpp \
 	$(SRC)/Topography/TopographyFileRenderer.cpp \
 	$(SRC)/Topography/TopographyRenderer.cpp \
@@ -12,6 +13,6 @@ TOPO_SOURCES = \
 
 TOPO_CPPFLAGS_INTERNAL = $(SCREEN_CPPFLAGS)
 
-TOPO_DEPENDS = SHAPELIB
+TOPO_DEPENDS = SHAPELIB IO
 
 $(eval $(call link-library,libtopo,TOPO))
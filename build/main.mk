@@ -29,6 +29,7 @@ DIALOG_SOURCES = \
 	$(SRC)/io/TarBackup.cpp \
 	$(SRC)/Dialogs/DataManagement/FileTransferUtil.cpp \
 	$(SRC)/IGC/IgcMetaCache.cpp \
+	$(SRC)/IGC/IgcMetaIndex.cpp \
 	$(SRC)/Dialogs/Device/PortDataField.cpp \
 	$(SRC)/Dialogs/Device/PortPicker.cpp \
 	$(SRC)/Dialogs/Device/DeviceEditWidget.cpp \
@@ -248,6 +249,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Renderer/RadarRenderer.cpp \
 	\
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
@@ -285,6 +287,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Logger/GlueFlightLogger.cpp \
 	$(SRC)/Replay/Replay.cpp \
 	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCReader.cpp \
 	$(SRC)/Replay/IgcReplay.cpp \
 	$(SRC)/Replay/NmeaReplay.cpp \
 	$(SRC)/Replay/DemoReplay.cpp \
@@ -580,6 +583,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/ApplyVegaSwitches.cpp \
 	$(SRC)/MainWindow.cpp \
 	$(SRC)/Startup.cpp \
+	$(SRC)/StartupJobs.cpp \
 	$(SRC)/Components.cpp \
 	$(SRC)/BackendComponents.cpp \
 	$(SRC)/DataComponents.cpp \
@@ -79,6 +79,10 @@ TEST_NAMES = \
 	test_task \
 	TestInputTransformMode \
 	TestOverwritingRingBuffer \
+	TestThreadPool \
+	TestStartupJobs \
+	TestTerrainInterpolation \
+	TestSlopeShading \
 	TestDateTime TestISO8601 TestRoughTime TestRoughSpeed TestWrapClock \
 	TestPolylineDecoder \
 	TestTransponderCode \
@@ -98,6 +102,7 @@ TEST_NAMES = \
 	TestColorRamp TestXCThermBandQuery TestGeoPoint TestDiffFilter \
 	TestFileUtil TestRepository TestFileType TestPath TestPolars TestCSVLine TestGlidePolar \
 	test_replay_task TestProjection TestFlatPoint TestFlatLine TestFlatGeoPoint \
+	TestPolygonEdges \
 	TestMacCready TestOrderedTask TestAATPoint TestTaskSave \
 	TestTaskFileSeeYouParsing \
 	TestPlanes \
@@ -106,11 +111,15 @@ TEST_NAMES = \
 	TestTeamCode \
 	TestZeroFinder \
 	TestAirspaceWarningManager \
+	TestReachFan \
 	TestAirspaceParser \
 	TestOGNAprsParser \
+	TestCloudClientContainer \
 	TestMETARParser \
 	TestIGCParser \
+	TestIgcMetaIndex \
 	TestTraceBounds \
+	TestTopographyPack \
 	TestStrings TestUnescapeCString TestUTF8 TestWrapText \
 	TestInputConfig \
 	TestCRC16 TestCRC8 \
@@ -122,6 +131,7 @@ TEST_NAMES = \
 	TestFileMetadataFormatter \
 	TestIGCFilenameFormatter \
 	TestNMEAFormatter \
+	TestNMEASentenceTable \
 	TestGDL90 \
 	TestGDL90Driver \
 	TestLXNToIGC \
@@ -222,13 +232,56 @@ TEST_OVERWRITING_RING_BUFFER_SOURCES = \
 TEST_OVERWRITING_RING_BUFFER_DEPENDS = MATH
 $(eval $(call link-program,TestOverwritingRingBuffer,TEST_OVERWRITING_RING_BUFFER))
 
+TEST_THREAD_POOL_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestThreadPool.cpp
+TEST_THREAD_POOL_DEPENDS = THREAD UTIL
+$(eval $(call link-program,TestThreadPool,TEST_THREAD_POOL))
+
+TEST_STARTUP_JOBS_SOURCES = \
+	$(SRC)/StartupJobs.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestStartupJobs.cpp
+TEST_STARTUP_JOBS_DEPENDS = THREAD UTIL
+$(eval $(call link-program,TestStartupJobs,TEST_STARTUP_JOBS))
+
+TEST_TERRAIN_INTERPOLATION_SOURCES = \
+	$(SRC)/Terrain/Interpolation.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTerrainInterpolation.cpp
+$(eval $(call link-program,TestTerrainInterpolation,TEST_TERRAIN_INTERPOLATION))
+
+TEST_SLOPE_SHADING_SOURCES = \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestSlopeShading.cpp
+TEST_SLOPE_SHADING_CPPFLAGS = $(SCREEN_CPPFLAGS)
+TEST_SLOPE_SHADING_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,TestSlopeShading,TEST_SLOPE_SHADING))
+
 TEST_IGC_PARSER_SOURCES = \
 	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCReader.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestIGCParser.cpp
-TEST_IGC_PARSER_DEPENDS = MATH UTIL
+TEST_IGC_PARSER_DEPENDS = IO OS MATH UTIL
 $(eval $(call link-program,TestIGCParser,TEST_IGC_PARSER))
 
+TEST_IGC_META_INDEX_SOURCES = \
+	$(SRC)/IGC/IgcMetaIndex.cpp \
+	$(SRC)/IGC/IgcMetaCache.cpp \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCReader.cpp \
+	$(SRC)/Formatter/TimeFormatter.cpp \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestIgcMetaIndex.cpp
+TEST_IGC_META_INDEX_DEPENDS = CO ASYNC IO OS THREAD TIME MATH UTIL
+$(eval $(call link-program,TestIgcMetaIndex,TEST_IGC_META_INDEX))
+
 TEST_METAR_PARSER_SOURCES = \
 	$(SRC)/Weather/METARParser.cpp \
 	$(SRC)/Atmosphere/Pressure.cpp \
@@ -330,6 +383,7 @@ endif
 
 TEST_AIRSPACE_PARSER_SOURCES = \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Atmosphere/Pressure.cpp \
 	$(SRC)/RadioFrequency.cpp \
 	$(SRC)/TransponderCode.cpp \
@@ -359,6 +413,16 @@ TEST_OGN_APRS_PARSER_SOURCES = \
 TEST_OGN_APRS_PARSER_DEPENDS = GEO MATH UTIL UNITS
 $(eval $(call link-program,TestOGNAprsParser,TEST_OGN_APRS_PARSER))
 
+TEST_CLOUD_CLIENT_CONTAINER_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Cloud/Serialiser.cpp \
+	$(SRC)/Cloud/Client.cpp \
+	$(SRC)/Cloud/TrafficCache.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestCloudClientContainer.cpp
+TEST_CLOUD_CLIENT_CONTAINER_DEPENDS = LIBNET IO GEO MATH UTIL
+$(eval $(call link-program,TestCloudClientContainer,TEST_CLOUD_CLIENT_CONTAINER))
+
 TEST_DATE_TIME_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestDateTime.cpp
@@ -524,6 +588,12 @@ TEST_REACH_SOURCES = \
 TEST_REACH_DEPENDS = TERRAIN OPERATION IO ZZIP OS ROUTE GLIDE GEO MATH UTIL
 $(eval $(call link-program,test_reach,TEST_REACH))
 
+TEST_REACH_FAN_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestReachFan.cpp
+TEST_REACH_FAN_DEPENDS = ROUTE GLIDE GEO MATH UTIL
+$(eval $(call link-program,TestReachFan,TEST_REACH_FAN))
+
 TEST_ROUTE_SOURCES = \
 	$(SRC)/Engine/Navigation/Aircraft.cpp \
 	$(SRC)/Engine/Util/Gradient.cpp \
@@ -608,6 +678,7 @@ $(eval $(call link-program,TestGeoBounds,TEST_GEO_BOUNDS))
 
 TEST_FLARM_NET_SOURCES = \
 	$(SRC)/FLARM/FlarmNetReader.cpp \
+	$(SRC)/FLARM/FlarmNetCache.cpp \
 	$(SRC)/FLARM/Id.cpp \
 	$(SRC)/RadioFrequency.cpp \
 	$(SRC)/FLARM/FlarmNetRecord.cpp \
@@ -750,6 +821,11 @@ TEST_NMEA_FORMATTER_SOURCES = \
 TEST_NMEA_FORMATTER_DEPENDS = LIBNMEA GEO MATH IO UTIL TIME UNITS
 $(eval $(call link-program,TestNMEAFormatter,TEST_NMEA_FORMATTER))
 
+TEST_NMEA_SENTENCE_TABLE_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestNMEASentenceTable.cpp
+$(eval $(call link-program,TestNMEASentenceTable,TEST_NMEA_SENTENCE_TABLE))
+
 TEST_STRINGS_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestStrings.cpp
@@ -931,6 +1007,12 @@ TEST_FLAT_LINE_SOURCES = \
 TEST_FLAT_LINE_DEPENDS = GEO MATH
 $(eval $(call link-program,TestFlatLine,TEST_FLAT_LINE))
 
+TEST_POLYGON_EDGES_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestPolygonEdges.cpp
+TEST_POLYGON_EDGES_DEPENDS = GEO MATH
+$(eval $(call link-program,TestPolygonEdges,TEST_POLYGON_EDGES))
+
 TEST_THERMALBASE_SOURCES = \
 	$(SRC)/Computer/ThermalBase.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -1109,8 +1191,26 @@ TEST_TRACE_BOUNDS_SOURCES = \
 TEST_TRACE_BOUNDS_DEPENDS = GEO MATH UTIL
 $(eval $(call link-program,TestTraceBounds,TEST_TRACE_BOUNDS))
 
+TEST_TOPOGRAPHY_PACK_SOURCES = \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(SRC)/Topography/ShapeFile.cpp \
+	$(SRC)/Topography/XShape.cpp \
+	$(SRC)/Topography/TopographyFile.cpp \
+	$(SRC)/Topography/TopographyPack.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTopographyPack.cpp
+ifeq ($(OPENGL),y)
+TEST_TOPOGRAPHY_PACK_SOURCES += \
+	$(CANVAS_SRC_DIR)/opengl/Triangulate.cpp
+endif
+TEST_TOPOGRAPHY_PACK_DEPENDS = SHAPELIB IO ZZIP GEO MATH OS UTIL
+TEST_TOPOGRAPHY_PACK_CPPFLAGS = $(SCREEN_CPPFLAGS)
+$(eval $(call link-program,TestTopographyPack,TEST_TOPOGRAPHY_PACK))
+
 FLIGHT_TABLE_SOURCES = \
 	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCReader.cpp \
 	$(SRC)/Repository/FileType.cpp \
 	$(TEST_SRC_DIR)/FlightTable.cpp
 FLIGHT_TABLE_DEPENDS = GEO MATH IO OS UTIL
@@ -1135,6 +1235,8 @@ DEBUG_PROGRAM_NAMES = \
 	TestTrace \
 	FlightTable \
 	BenchmarkProjection \
+	BenchmarkSlopeShading \
+	BenchmarkNMEAParser \
 	BenchmarkFAITriangleSector \
 	DumpTextInflate \
 	DumpHexColor \
@@ -1208,7 +1310,9 @@ endif
 ifeq ($(TARGET),UNIX)
 DEBUG_PROGRAM_NAMES += \
 	AnalyseFlight \
-	FeedFlyNetData
+	FeedFlyNetData \
+	RunSkyLinesLoad \
+	BenchmarkCloudClients
 endif
 
 ifeq ($(TARGET),PC)
@@ -1261,6 +1365,7 @@ DEBUG_REPLAY_SOURCES = \
 	$(SRC)/Device/Config.cpp \
 	$(SRC)/RadioFrequency.cpp \
 	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCReader.cpp \
 	$(SRC)/IGC/Generator.cpp \
 	$(SRC)/Formatter/NMEAFormatter.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceWarningConfig.cpp \
@@ -1304,6 +1409,31 @@ BENCHMARK_PROJECTION_DEPENDS = MATH
 BENCHMARK_PROJECTION_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,BenchmarkProjection,BENCHMARK_PROJECTION))
 
+BENCHMARK_SLOPE_SHADING_SOURCES = \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(TEST_SRC_DIR)/BenchmarkSlopeShading.cpp
+BENCHMARK_SLOPE_SHADING_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_SLOPE_SHADING_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,BenchmarkSlopeShading,BENCHMARK_SLOPE_SHADING))
+
+BENCHMARK_NMEA_PARSER_SOURCES = \
+	$(SRC)/Atmosphere/AirDensity.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(SRC)/Device/Parser.cpp \
+	$(SRC)/Device/Driver/FLARM/StaticParser.cpp \
+	$(SRC)/FLARM/Error.cpp \
+	$(SRC)/FLARM/Traffic.cpp \
+	$(SRC)/FLARM/Id.cpp \
+	$(TEST_SRC_DIR)/FakeGeoid.cpp \
+	$(TEST_SRC_DIR)/FakeMessage.cpp \
+	$(TEST_SRC_DIR)/FakeTraffic.cpp \
+	$(TEST_SRC_DIR)/BenchmarkNMEAParser.cpp
+BENCHMARK_NMEA_PARSER_LDADD = $(FAKE_LIBS)
+BENCHMARK_NMEA_PARSER_DEPENDS = LIBNMEA GEO MATH IO OS UTIL TIME UNITS
+$(eval $(call link-program,BenchmarkNMEAParser,BENCHMARK_NMEA_PARSER))
+
 BENCHMARK_FAI_TRIANGLE_SECTOR_SOURCES = \
 	$(ENGINE_SRC_DIR)/Task/Shapes/FAITriangleSettings.cpp \
 	$(ENGINE_SRC_DIR)/Task/Shapes/FAITriangleArea.cpp \
@@ -1418,6 +1548,21 @@ RUN_SL_TRACKING_SOURCES = \
 RUN_SL_TRACKING_DEPENDS = $(DEBUG_REPLAY_DEPENDS)
 $(eval $(call link-program,RunSkyLinesTracking,RUN_SL_TRACKING))
 
+RUN_SKYLINES_LOAD_SOURCES = \
+	$(SRC)/net/SocketError.cxx \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(TEST_SRC_DIR)/RunSkyLinesLoad.cpp
+RUN_SKYLINES_LOAD_DEPENDS = LIBNET IO GEO MATH UTIL
+$(eval $(call link-program,RunSkyLinesLoad,RUN_SKYLINES_LOAD))
+
+BENCHMARK_CLOUD_CLIENTS_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Cloud/Serialiser.cpp \
+	$(SRC)/Cloud/Client.cpp \
+	$(TEST_SRC_DIR)/BenchmarkCloudClients.cpp
+BENCHMARK_CLOUD_CLIENTS_DEPENDS = LIBNET IO GEO MATH UTIL
+$(eval $(call link-program,BenchmarkCloudClients,BENCHMARK_CLOUD_CLIENTS))
+
 RUN_LIVETRACK24_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/net/SocketError.cxx \
@@ -2161,6 +2306,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
 	$(SRC)/Renderer/GeoBitmapRenderer.cpp \
@@ -2666,6 +2812,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
 	$(SRC)/Renderer/AirspaceRendererSettings.cpp \
@@ -2737,6 +2884,7 @@ RUN_AIRSPACE_WARNING_DIALOG_SOURCES = \
 	$(SRC)/Repository/FileType.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/TransponderCode.cpp \
 	$(SRC)/Audio/Sound.cpp \
 	$(MORE_SCREEN_SOURCES) \
@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "AirspaceCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "io/BufferedReader.hxx"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+struct CacheHeader {
+  /**
+   * Increment this whenever the format changes or the parser
+   * produces different airspaces.
+   */
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t version;
+  uint32_t n_airspaces;
+};
+
+/**
+ * The fixed-size part of one airspace.  It is followed by the name,
+ * the station name and (for polygons) the border points.
+ */
+struct CachedAirspace {
+  AbstractAirspace::Shape shape;
+  AirspaceClass asclass, astype;
+  AirspaceActivity days;
+  RadioFrequency radio_frequency;
+  TransponderCode transponder_code;
+
+  uint32_t name_length, station_name_length;
+
+  /**
+   * The number of border points (polygons only).
+   */
+  uint32_t n_points;
+
+  AirspaceAltitude base, top;
+
+  /**
+   * Circles only.
+   */
+  GeoPoint center;
+  double radius;
+};
+
+static_assert(std::is_trivially_copyable_v<CachedAirspace>);
+
+/**
+ * Upper limits which protect against allocating huge amounts of
+ * memory for a corrupt file.
+ */
+static constexpr uint32_t MAX_AIRSPACES = 1024 * 1024;
+static constexpr uint32_t MAX_STRING_LENGTH = 64 * 1024;
+static constexpr uint32_t MAX_POINTS = 1024 * 1024;
+
+} // anonymous namespace
+
+static void
+WriteString(BufferedOutputStream &os, const char *s)
+{
+  os.Write(std::string_view{s});
+}
+
+static void
+SaveAirspace(BufferedOutputStream &os, const AbstractAirspace &airspace)
+{
+  CachedAirspace c;
+
+  /* zero-fill all implicit padding bytes */
+  memset((void *)&c, 0, sizeof(c));
+
+  c.shape = airspace.GetShape();
+  c.asclass = airspace.GetClass();
+  c.astype = airspace.GetType();
+  c.days = airspace.GetDays();
+  c.radio_frequency = airspace.GetRadioFrequency();
+  c.transponder_code = airspace.GetTransponderCode();
+  c.name_length = strlen(airspace.GetName());
+  c.station_name_length = strlen(airspace.GetStationName());
+  c.base = airspace.GetBase();
+  c.top = airspace.GetTop();
+
+  switch (c.shape) {
+  case AbstractAirspace::Shape::CIRCLE: {
+    const auto &circle = (const AirspaceCircle &)airspace;
+    c.center = circle.GetCenter();
+    c.radius = circle.GetRadius();
+    break;
+  }
+
+  case AbstractAirspace::Shape::POLYGON:
+    c.n_points = airspace.GetPoints().size();
+    break;
+  }
+
+  os.WriteT(c);
+  WriteString(os, airspace.GetName());
+  WriteString(os, airspace.GetStationName());
+
+  if (c.shape == AbstractAirspace::Shape::POLYGON)
+    for (const auto &point : airspace.GetPoints())
+      os.WriteT(point.GetLocation());
+}
+
+void
+SaveAirspaceCache(BufferedOutputStream &os, const Airspaces &airspaces,
+                  std::size_t first_pending)
+{
+  const auto &pending = airspaces.GetPending();
+  if (first_pending > pending.size())
+    throw std::invalid_argument("Bad pending airspace index");
+
+  CacheHeader header;
+  memset(&header, 0, sizeof(header));
+  header.version = CacheHeader::VERSION;
+  header.n_airspaces = pending.size() - first_pending;
+  os.WriteT(header);
+
+  for (auto i = std::next(pending.begin(), first_pending);
+       i != pending.end(); ++i)
+    SaveAirspace(os, **i);
+}
+
+static std::string
+ReadString(BufferedReader &r, std::size_t length)
+{
+  std::string s(length, '\0');
+  r.ReadFull(std::as_writable_bytes(std::span{s}));
+
+  if (memchr(s.data(), '\0', s.size()) != nullptr)
+    throw std::runtime_error("Malformed airspace cache string");
+
+  return s;
+}
+
+static bool
+IsValid(const AirspaceAltitude &altitude) noexcept
+{
+  switch (altitude.reference) {
+  case AltitudeReference::AGL:
+  case AltitudeReference::MSL:
+  case AltitudeReference::STD:
+    return true;
+  }
+
+  return false;
+}
+
+static AirspacePtr
+LoadAirspace(BufferedReader &r)
+{
+  const auto c = r.ReadFullT<CachedAirspace>();
+
+  if (c.asclass >= AIRSPACECLASSCOUNT || c.astype >= AIRSPACECLASSCOUNT ||
+      c.name_length > MAX_STRING_LENGTH ||
+      c.station_name_length > MAX_STRING_LENGTH ||
+      !IsValid(c.base) || !IsValid(c.top))
+    throw std::runtime_error("Malformed airspace cache record");
+
+  std::string name = ReadString(r, c.name_length);
+  std::string station_name = ReadString(r, c.station_name_length);
+
+  AirspacePtr airspace;
+
+  switch (c.shape) {
+  case AbstractAirspace::Shape::CIRCLE:
+    if (!c.center.IsValid() || !(c.radius >= 0))
+      throw std::runtime_error("Malformed airspace cache circle");
+
+    airspace = std::make_shared<AirspaceCircle>(c.center, c.radius);
+    break;
+
+  case AbstractAirspace::Shape::POLYGON: {
+    if (c.n_points < 3 || c.n_points > MAX_POINTS)
+      throw std::runtime_error("Malformed airspace cache polygon");
+
+    std::vector<GeoPoint> points(c.n_points);
+    r.ReadFull(std::as_writable_bytes(std::span{points}));
+    airspace = std::make_shared<AirspacePolygon>(points);
+    break;
+  }
+
+  default:
+    throw std::runtime_error("Malformed airspace cache shape");
+  }
+
+  TransponderCode transponder_code = c.transponder_code;
+  airspace->SetProperties(std::move(name), std::move(station_name),
+                          std::move(transponder_code),
+                          c.asclass, c.astype, c.base, c.top);
+  airspace->SetRadioFrequency(c.radio_frequency);
+  airspace->SetDays(c.days);
+  return airspace;
+}
+
+void
+LoadAirspaceCache(BufferedReader &r, Airspaces &airspaces)
+{
+  const auto header = r.ReadFullT<CacheHeader>();
+  if (header.version != CacheHeader::VERSION ||
+      header.n_airspaces > MAX_AIRSPACES)
+    throw std::runtime_error("Malformed airspace cache header");
+
+  /* load everything before adding anything, so a malformed cache
+     does not leave a partial set of airspaces behind */
+  std::vector<AirspacePtr> loaded;
+  loaded.reserve(header.n_airspaces);
+
+  for (uint32_t i = 0; i < header.n_airspaces; ++i)
+    loaded.push_back(LoadAirspace(r));
+
+  for (auto &airspace : loaded)
+    airspaces.Add(std::move(airspace));
+}
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <cstddef>
+
+class Airspaces;
+class BufferedReader;
+class BufferedOutputStream;
+
+/**
+ * Save parsed airspaces in a binary format which can be loaded much
+ * faster than the original OpenAir/TNP file: polygons (including
+ * approximated arcs), circles, altitudes, classes and all other
+ * attributes are stored ready to use.
+ *
+ * Only the airspaces which have not yet been optimised are saved,
+ * starting at the given index in Airspaces::GetPending(); this allows
+ * saving the airspaces of each file separately.
+ *
+ * Throws on I/O error.
+ */
+void
+SaveAirspaceCache(BufferedOutputStream &os, const Airspaces &airspaces,
+                  std::size_t first_pending);
+
+/**
+ * Load airspaces saved by SaveAirspaceCache() and add them to the
+ * given #Airspaces object.  The caller is responsible for calling
+ * Airspaces::Optimise().
+ *
+ * Throws on error (e.g. if the cache was written by an incompatible
+ * version); no airspaces are added in that case.
+ */
+void
+LoadAirspaceCache(BufferedReader &r, Airspaces &airspaces);
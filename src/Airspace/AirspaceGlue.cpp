@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "Airspace/AirspaceGlue.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Airspace/AirspaceParser.hpp"
 #include "Atmosphere/Pressure.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
@@ -11,9 +12,11 @@
 #include "Profile/Keys.hpp"
 #include "Profile/Profile.hpp"
 #include "Repository/FileType.hpp"
+#include "io/BufferedOutputStream.hxx"
 #include "io/BufferedReader.hxx"
+#include "io/FileCache.hpp"
+#include "io/FileOutputStream.hxx"
 #include "io/FileReader.hxx"
-#include "io/MapFile.hpp"
 #include "io/ProgressReader.hpp"
 #include "io/ZipArchive.hpp"
 #include "io/ZipLineReader.hpp"
@@ -21,6 +24,11 @@
 #include "lib/fmt/RuntimeError.hxx"
 #include "system/Path.hpp"
 
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <string>
+
 #include <string.h>
 
 bool
@@ -68,10 +76,114 @@ try {
   return false;
 }
 
+/**
+ * Generate the name of the cache file for the given airspace file.
+ * The path is hashed (64 bit FNV-1a) because the name must not
+ * contain directory separators.
+ */
+[[gnu::pure]]
+static std::string
+MakeCacheName(Path path, const char *suffix) noexcept
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char *p = path.c_str(); *p != 0; ++p) {
+    hash ^= (unsigned char)*p;
+    hash *= 0x100000001b3ULL;
+  }
+
+  return fmt::format("airspace-{:016x}{}.bin", hash, suffix);
+}
+
+static bool
+LoadCache(Airspaces &airspaces, FileCache &cache,
+          const char *name, Path original_path) noexcept
+try {
+  auto r = cache.Load(name, original_path);
+  if (!r)
+    return false;
+
+  BufferedReader br{*r};
+  LoadAirspaceCache(br, airspaces);
+  return true;
+} catch (...) {
+  LogError(std::current_exception(), "Failed to load airspace cache");
+  return false;
+}
+
+static void
+SaveCache(const Airspaces &airspaces, std::size_t first_pending,
+          FileCache &cache, const char *name, Path original_path) noexcept
+try {
+  auto os = cache.Save(name, original_path);
+  BufferedOutputStream bos{*os};
+  SaveAirspaceCache(bos, airspaces, first_pending);
+  bos.Flush();
+  os->Commit();
+} catch (...) {
+  LogError(std::current_exception(), "Failed to save airspace cache");
+}
+
+/**
+ * Load an airspace file from the cache if possible; if not, parse it
+ * and store the result in the cache.
+ */
+static bool
+ReadAirspaceFile(Airspaces &airspaces, Path path, FileCache *cache,
+                 OperationEnvironment &operation) noexcept
+{
+  if (cache == nullptr)
+    return ParseAirspaceFile(airspaces, path, operation);
+
+  const auto name = MakeCacheName(path, "");
+  if (LoadCache(airspaces, *cache, name.c_str(), path))
+    return true;
+
+  const std::size_t first_pending = airspaces.GetPending().size();
+  if (!ParseAirspaceFile(airspaces, path, operation))
+    return false;
+
+  SaveCache(airspaces, first_pending, *cache, name.c_str(), path);
+  return true;
+}
+
+/**
+ * Like ReadAirspaceFile(), but for the "airspace.txt" inside the map
+ * file.  The cache is validated against the map file.
+ */
+static bool
+ReadMapAirspaceFile(Airspaces &airspaces, FileCache *cache,
+                    OperationEnvironment &operation)
+{
+  const auto map_path = Profile::GetPath(ProfileKeys::MapFile);
+  if (map_path == nullptr)
+    return false;
+
+  std::string name;
+  if (cache != nullptr) {
+    name = MakeCacheName(map_path, "-map");
+    if (LoadCache(airspaces, *cache, name.c_str(), map_path))
+      return true;
+  }
+
+  ZipArchive archive{map_path};
+  if (!archive.Exists("airspace.txt"))
+    return false;
+
+  const std::size_t first_pending = airspaces.GetPending().size();
+  if (!ParseAirspaceFile(airspaces, archive.get(), "airspace.txt",
+                         operation))
+    return false;
+
+  if (cache != nullptr)
+    SaveCache(airspaces, first_pending, *cache, name.c_str(), map_path);
+  return true;
+}
+
 void
 ReadAirspace(Airspaces &airspaces,
              AtmosphericPressure press,
-             OperationEnvironment &operation)
+             OperationEnvironment &operation,
+             FileCache *cache)
 {
   LogFormat("Loading airspaces");
   operation.SetText(_("Loading Airspace File..."));
@@ -82,14 +194,11 @@ ReadAirspace(Airspaces &airspaces,
   const auto paths = Profile::GetMultiplePaths(ProfileKeys::AirspaceFileList,
                                                GetFileTypePatterns(FileType::AIRSPACE));
   for (const auto& path : paths) {
-  airspace_ok |= ParseAirspaceFile(airspaces, path, operation);
+  airspace_ok |= ReadAirspaceFile(airspaces, path, cache, operation);
   }
 
   try {
-    if (auto archive = OpenMapFile();
-        archive && archive->Exists("airspace.txt"))
-      airspace_ok |= ParseAirspaceFile(airspaces, archive->get(),
-                                       "airspace.txt", operation);
+    airspace_ok |= ReadMapAirspaceFile(airspaces, cache, operation);
   } catch (...) {
     LogError(std::current_exception(),
              "Failed to load airspaces from map file");
@@ -8,14 +8,20 @@ class AtmosphericPressure;
 class Airspaces;
 class OperationEnvironment;
 class Path;
+class FileCache;
 
 /**
  * Reads the airspace files into the memory
+ *
+ * @param cache if not nullptr, then parsed airspace files are stored
+ * in this cache, and the cached copy is used instead of parsing the
+ * file again if it has not been modified
  */
 void
 ReadAirspace(Airspaces &airspaces,
              AtmosphericPressure press,
-             OperationEnvironment &operation);
+             OperationEnvironment &operation,
+             FileCache *cache=nullptr);
 
 void
 SetAirspaceGroundLevels(Airspaces &airspaces,
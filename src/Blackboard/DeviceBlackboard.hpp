@@ -105,6 +105,16 @@ public:
     return per_device_data[i];
   }
 
+  /**
+   * Like LockGetDeviceDataUpdateClock(), but copy into an existing
+   * object.  This avoids copying the (large) #NMEAInfo twice.
+   */
+  void LockGetDeviceDataUpdateClock(unsigned i, NMEAInfo &dest) noexcept {
+    const std::lock_guard lock{mutex};
+    per_device_data[i].UpdateClock();
+    dest = per_device_data[i];
+  }
+
   /**
    * Overwrites a device's data and schedule the MergeThread.  The
    * method takes care for locking and unlocking the mutex.
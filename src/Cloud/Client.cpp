@@ -11,9 +11,16 @@
 #include "net/Resolver.hxx"
 #include "util/ByteOrder.hxx"
 
-#include <boost/geometry/algorithms/distance.hpp>
-#include <boost/geometry/algorithms/intersection.hpp>
-#include <boost/geometry/strategies/strategies.hpp>
+#include <algorithm>
+
+#include <cassert>
+
+static inline GeoPoint
+NormaliseGridLocation(GeoPoint location) noexcept
+{
+  location.longitude = location.longitude.AsDelta();
+  return location;
+}
 
 CloudClientContainer::CloudClientContainer()
   :key_set(typename KeySet::bucket_traits(key_buckets, N_KEY_BUCKETS)) {}
@@ -49,8 +56,9 @@ CloudClientContainer::Make(SocketAddress address,
   auto result = key_set.insert_check(key, key_set.hash_function(),
                                      key_set.key_eq(), hint);
   if (result.second) {
-    auto client = std::make_shared<CloudClient>(address, key, next_id++,
+    auto client = std::make_shared<CloudClient>(address, key, next_id,
                                                 location, altitude);
+    next_id += id_stride;
     client->track_deg = track_deg;
     client->track_valid = track_valid;
     Insert(*client);
@@ -80,11 +88,13 @@ CloudClientContainer::Refresh(CloudClient &client,
 {
   Refresh(client, address);
 
-  if (location != client.location) {
-    auto ptr = client.shared_from_this();
-    rtree.remove(ptr);
+  if (GetGridCell(location) != client.grid_cell) {
+    GridRemove(client);
     client.location = location;
-    rtree.insert(ptr);
+    GridInsert(client);
+  } else {
+    client.location = location;
+    GetGridEntry(client).location = NormaliseGridLocation(location);
   }
 
   client.altitude = altitude;
@@ -99,16 +109,19 @@ CloudClientContainer::Insert(CloudClient &client)
   list.push_front(client);
   key_set.insert(client);
   id_set.push_back(client);
-  rtree.insert(client.shared_from_this());
+  GridInsert(client);
+  client.container_ref = client.shared_from_this();
 }
 
 void
 CloudClientContainer::Remove(CloudClient &client)
 {
+  const auto ptr = std::move(client.container_ref);
+
   list.erase(list.iterator_to(client));
   key_set.erase(key_set.iterator_to(client));
   id_set.erase(id_set.iterator_to(client));
-  rtree.remove(client.shared_from_this());
+  GridRemove(client);
 }
 
 void
@@ -118,11 +131,158 @@ CloudClientContainer::Expire(std::chrono::steady_clock::time_point before)
     Remove(list.back());
 }
 
+inline unsigned
+CloudClientContainer::GetGridRow(Angle latitude) noexcept
+{
+  const int row = (int)((latitude.Degrees() + 90) * GRID_CELLS_PER_DEGREE);
+  return std::clamp(row, 0, (int)GRID_ROWS - 1);
+}
+
+inline unsigned
+CloudClientContainer::GetGridColumn(Angle longitude) noexcept
+{
+  /* AsDelta() returns a value in the range -180..180, so this
+     cannot be negative; 180 wraps to the first column */
+  const unsigned column = (unsigned)((longitude.AsDelta().Degrees() + 180)
+                                     * GRID_CELLS_PER_DEGREE);
+  return column % GRID_COLUMNS;
+}
+
+unsigned
+CloudClientContainer::GetGridCell(GeoPoint location) noexcept
+{
+  return GetGridRow(location.latitude) * GRID_COLUMNS
+    + GetGridColumn(location.longitude);
+}
+
+inline CloudClientContainer::GridEntry &
+CloudClientContainer::GetGridEntry(const CloudClient &client) noexcept
+{
+  auto i = grid.find(client.grid_cell);
+  assert(i != grid.end());
+  assert(client.grid_index < i->second.size());
+  assert(i->second[client.grid_index].client == &client);
+
+  return i->second[client.grid_index];
+}
+
+GeoBounds
+CloudClientContainer::GetGridCellBounds(unsigned cell) noexcept
+{
+  const unsigned row = cell / GRID_COLUMNS, column = cell % GRID_COLUMNS;
+  const auto size = Angle::Degrees(1. / GRID_CELLS_PER_DEGREE);
+
+  const GeoPoint south_west(Angle::Degrees(-180) + size * column,
+                            Angle::Degrees(-90) + size * row);
+  return GeoBounds(GeoPoint(south_west.longitude,
+                            south_west.latitude + size),
+                   GeoPoint(south_west.longitude + size,
+                            south_west.latitude));
+}
+
+void
+CloudClientContainer::GridInsert(CloudClient &client)
+{
+  client.grid_cell = GetGridCell(client.location);
+
+  auto &cell = grid[client.grid_cell];
+  client.grid_index = cell.size();
+  cell.push_back({NormaliseGridLocation(client.location), &client});
+}
+
+void
+CloudClientContainer::GridRemove(CloudClient &client) noexcept
+{
+  auto i = grid.find(client.grid_cell);
+  assert(i != grid.end());
+
+  /* move the last entry into the gap */
+  auto &cell = i->second;
+  auto &last = cell.back();
+  last.client->grid_index = client.grid_index;
+  cell[client.grid_index] = last;
+  cell.pop_back();
+
+  if (cell.empty())
+    grid.erase(i);
+}
+
+CloudClientContainer::QueryIterator::QueryIterator(const Grid &_grid,
+                                                   GeoPoint _south_west,
+                                                   GeoPoint _north_east) noexcept
+  :grid(&_grid), south_west(_south_west), north_east(_north_east),
+   first_row(GetGridRow(south_west.latitude)),
+   first_column(GetGridColumn(south_west.longitude)),
+   /* the box may cross the antimeridian, i.e. the east column may be
+      smaller than the west column */
+   n_columns((GetGridColumn(north_east.longitude) + GRID_COLUMNS
+              - first_column) % GRID_COLUMNS + 1),
+   next_cell(0),
+   n_cells((GetGridRow(north_east.latitude) - first_row + 1) * n_columns)
+{
+  FindNext();
+}
+
+inline bool
+CloudClientContainer::QueryIterator::IsInside(const GeoPoint &location) const noexcept
+{
+  if (location.latitude < south_west.latitude ||
+      location.latitude > north_east.latitude)
+    return false;
+
+  /* the #GridEntry longitude is normalised already */
+  const Angle longitude = location.longitude;
+  return south_west.longitude <= north_east.longitude
+    ? longitude >= south_west.longitude && longitude <= north_east.longitude
+    /* crosses the antimeridian */
+    : longitude >= south_west.longitude || longitude <= north_east.longitude;
+}
+
+inline bool
+CloudClientContainer::QueryIterator::NextCell() noexcept
+{
+  while (next_cell < n_cells) {
+    const unsigned row = first_row + next_cell / n_columns;
+    const unsigned column = (first_column + next_cell % n_columns)
+      % GRID_COLUMNS;
+    ++next_cell;
+
+    auto c = grid->find(row * GRID_COLUMNS + column);
+    if (c != grid->end()) {
+      i = c->second.data();
+      end = i + c->second.size();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void
+CloudClientContainer::QueryIterator::FindNext() noexcept
+{
+  while (true) {
+    while (i != end) {
+      const auto &entry = *i++;
+      if (IsInside(entry.location)) {
+        current = entry.client;
+        return;
+      }
+    }
+
+    if (!NextCell()) {
+      current = nullptr;
+      return;
+    }
+  }
+}
+
 CloudClientContainer::query_iterator_range
 CloudClientContainer::QueryWithinRange(GeoPoint location, double range) const
 {
-  const auto q = boost::geometry::index::intersects(BoostRangeBox(location, range));
-  return {rtree.qbegin(q), rtree.qend()};
+  const auto box = BoostRangeBox(location, range);
+  return {QueryIterator{grid, box.min_corner(), box.max_corner()},
+          QueryIterator{}};
 }
 
 inline Serialiser &
@@ -206,19 +366,35 @@ CloudClient::Load(Deserialiser &s)
 }
 
 void
-CloudClientContainer::Save(Serialiser &s) const
+CloudClientContainer::SaveBegin(Serialiser &s, unsigned next_id)
 {
   s.Write32(next_id);
+}
 
+void
+CloudClientContainer::SaveClients(Serialiser &s) const
+{
   for (const auto &client : list) {
     s.Write8(1);
     client.Save(s);
   }
+}
 
+void
+CloudClientContainer::SaveEnd(Serialiser &s)
+{
   s.Write8(0);
   s.Write8(0);
 }
 
+void
+CloudClientContainer::Save(Serialiser &s) const
+{
+  SaveBegin(s, next_id);
+  SaveClients(s);
+  SaveEnd(s);
+}
+
 void
 CloudClientContainer::Load(Deserialiser &s)
 {
@@ -226,6 +402,12 @@ CloudClientContainer::Load(Deserialiser &s)
 
   while (s.Read8() != 0) {
     auto client = std::make_shared<CloudClient>(CloudClient::Load(s));
+
+    /* a file merged from several containers may contain ids which
+       were assigned after "next_id" was written */
+    if (client->id >= next_id)
+      next_id = client->id + 1;
+
     Insert(*client);
   }
 
@@ -4,14 +4,18 @@
 #pragma once
 
 #include "Geo/Boost/GeoPoint.hpp"
+#include "Geo/GeoBounds.hpp"
 #include "net/AllocatedSocketAddress.hxx"
 
 #include <boost/intrusive/list.hpp>
 #include <boost/intrusive/set.hpp>
 #include <boost/intrusive/unordered_set.hpp>
-#include <boost/geometry/index/rtree.hpp>
 #include <boost/range/iterator_range_core.hpp>
+#include <iterator>
 #include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <chrono>
 
 class Serialiser;
@@ -58,6 +62,11 @@ struct CloudClient
   std::chrono::steady_clock::time_point last_traffic_push =
     std::chrono::steady_clock::time_point::min();
 
+  /**
+   * Is a traffic snapshot scheduled to be sent to this client?
+   */
+  bool traffic_push_pending = false;
+
   /**
    * The client wishes to receive thermal information until this time
    * stamp.
@@ -85,6 +94,19 @@ struct CloudClient
    */
   unsigned aircraft_type = CLOUD_DEFAULT_AIRCRAFT_TYPE;
 
+  /**
+   * The grid cell which contains #location (see
+   * CloudClientContainer::GetGridCell()), and the position of this
+   * client in the cell's array.
+   */
+  unsigned grid_cell, grid_index;
+
+  /**
+   * The reference which keeps this client alive while it is in a
+   * #CloudClientContainer.
+   */
+  std::shared_ptr<CloudClient> container_ref;
+
   struct KeyHash {
     constexpr std::size_t operator()(uint64_t key) const {
       return key;
@@ -139,21 +161,24 @@ struct CloudClient
 
 using CloudClientPtr = std::shared_ptr<CloudClient>;
 
-/**
- * Helper for boost::geometry::index::rtree.
- */
-struct CloudClientIndexable {
-  typedef GeoPoint result_type;
+class CloudClientContainer {
+  /**
+   * A copy of the client's location next to the pointer, so queries
+   * can scan a cell without touching the clients.  The longitude is
+   * normalised with Angle::AsDelta().
+   */
+  struct GridEntry {
+    GeoPoint location;
+    CloudClient *client;
+  };
 
-  [[gnu::pure]]
-  result_type operator()(const CloudClientPtr &client) const {
-    return client->location;
-  }
-};
+  typedef std::vector<GridEntry> Cell;
 
-class CloudClientContainer {
-  typedef boost::geometry::index::rtree<CloudClientPtr, boost::geometry::index::rstar<16>,
-                                        CloudClientIndexable> Tree;
+  /**
+   * Maps a grid cell number to the clients inside it.  Only
+   * non-empty cells are present.
+   */
+  typedef std::unordered_map<unsigned, Cell> Grid;
 
   typedef boost::intrusive::list<CloudClient,
                                  boost::intrusive::constant_time_size<false>> List;
@@ -168,10 +193,22 @@ class CloudClientContainer {
                                 boost::intrusive::constant_time_size<false>> IdSet;
 
   /**
-   * A geospatial container of all clients, for fast geographic
-   * lookups.
+   * The number of grid cells per degree of latitude and longitude.
+   * A cell is about as large as the traffic range, which keeps the
+   * number of cells visited by QueryWithinRange() small.
    */
-  Tree rtree;
+  static constexpr unsigned GRID_CELLS_PER_DEGREE = 2;
+  static constexpr unsigned GRID_ROWS = 180 * GRID_CELLS_PER_DEGREE;
+  static constexpr unsigned GRID_COLUMNS = 360 * GRID_CELLS_PER_DEGREE;
+
+  /**
+   * A geospatial index of all clients, for fast geographic lookups.
+   * This is a uniform latitude/longitude grid instead of a tree,
+   * because clients move all the time: most location updates stay
+   * inside the cell and only overwrite the #GridEntry, and the others
+   * just move it from one cell to another.
+   */
+  Grid grid;
 
   /**
    * A linked list of clients, sorted by last fix, with fresh items at
@@ -194,6 +231,13 @@ class CloudClientContainer {
    */
   unsigned next_id = 1;
 
+  /**
+   * The difference between two consecutive public ids.  This is
+   * larger than 1 if several containers share the id space (see
+   * SetIdSequence()).
+   */
+  unsigned id_stride = 1;
+
   static constexpr size_t N_KEY_BUCKETS = 65521;
   typename KeySet::bucket_type key_buckets[N_KEY_BUCKETS];
 
@@ -251,12 +295,157 @@ public:
 
   void Expire(std::chrono::steady_clock::time_point before);
 
-  typedef Tree::const_query_iterator query_iterator;
+  /**
+   * Move all clients matching the given predicate to another
+   * container.  Their public ids are preserved.
+   */
+  template<typename P>
+  void MoveIf(CloudClientContainer &dest, P &&p) {
+    for (auto i = list.begin(); i != list.end();) {
+      auto &client = *i++;
+      if (p(std::as_const(client))) {
+        auto ptr = client.shared_from_this();
+        Remove(client);
+        dest.Insert(*ptr);
+      }
+    }
+  }
+
+  unsigned GetNextId() const noexcept {
+    return next_id;
+  }
+
+  /**
+   * Assign the public ids first, first+stride, first+2*stride, ...
+   * to new clients.  This allows several containers to assign ids
+   * without collisions.
+   */
+  void SetIdSequence(unsigned first, unsigned stride) noexcept {
+    next_id = first;
+    id_stride = stride;
+  }
+
+  /**
+   * Iterates over the clients inside a #BoostRangeBox.  This is a
+   * "const" iterator only with respect to the container: the clients
+   * may be modified, but not moved.  Unlike boost::geometry, this
+   * supports boxes which cross the antimeridian.
+   */
+  class QueryIterator {
+    const Grid *grid = nullptr;
+
+    GeoPoint south_west, north_east;
+
+    unsigned first_row = 0, first_column = 0, n_columns = 0;
+
+    /**
+     * The index of the next cell to be visited, counting from the
+     * south-west corner, row by row.
+     */
+    unsigned next_cell = 0, n_cells = 0;
+
+    const GridEntry *i = nullptr, *end = nullptr;
+
+    /**
+     * The current client; nullptr at the end.
+     */
+    CloudClient *current = nullptr;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = CloudClient;
+    using difference_type = std::ptrdiff_t;
+    using pointer = CloudClient *;
+    using reference = CloudClient &;
+
+    /**
+     * Construct the end iterator.
+     */
+    QueryIterator() noexcept = default;
+
+    QueryIterator(const Grid &_grid,
+                  GeoPoint _south_west, GeoPoint _north_east) noexcept;
+
+    reference operator*() const noexcept {
+      return *current;
+    }
+
+    pointer operator->() const noexcept {
+      return current;
+    }
+
+    QueryIterator &operator++() noexcept {
+      FindNext();
+      return *this;
+    }
+
+    QueryIterator operator++(int) noexcept {
+      auto old = *this;
+      FindNext();
+      return old;
+    }
+
+    bool operator==(const QueryIterator &other) const noexcept {
+      return current == other.current;
+    }
+
+    bool operator!=(const QueryIterator &other) const noexcept {
+      return current != other.current;
+    }
+
+  private:
+    [[gnu::pure]]
+    bool IsInside(const GeoPoint &location) const noexcept;
+
+    bool NextCell() noexcept;
+    void FindNext() noexcept;
+  };
+
+  typedef QueryIterator query_iterator;
   typedef boost::iterator_range<query_iterator> query_iterator_range;
 
+  /**
+   * Query clients within the given range.  The result contains
+   * exactly those inside BoostRangeBox(location, range), in
+   * unspecified order.
+   */
   [[gnu::pure]]
   query_iterator_range QueryWithinRange(GeoPoint location, double range) const;
 
+  /**
+   * Determine the grid cell which contains the given location.
+   */
+  [[gnu::const]]
+  static unsigned GetGridCell(GeoPoint location) noexcept;
+
+  /**
+   * Determine the area covered by the given grid cell.
+   */
+  [[gnu::const]]
+  static GeoBounds GetGridCellBounds(unsigned cell) noexcept;
+
   void Save(Serialiser &s) const;
   void Load(Deserialiser &s);
+
+  /**
+   * Save() in three parts, for merging several containers into one
+   * file: SaveBegin() once, SaveClients() for each container, and
+   * SaveEnd() once.
+   */
+  static void SaveBegin(Serialiser &s, unsigned next_id);
+  void SaveClients(Serialiser &s) const;
+  static void SaveEnd(Serialiser &s);
+
+private:
+  [[gnu::const]]
+  static unsigned GetGridRow(Angle latitude) noexcept;
+
+  [[gnu::const]]
+  static unsigned GetGridColumn(Angle longitude) noexcept;
+
+  void GridInsert(CloudClient &client);
+  void GridRemove(CloudClient &client) noexcept;
+
+  [[gnu::pure]]
+  GridEntry &GetGridEntry(const CloudClient &client) noexcept;
 };
@@ -18,6 +18,12 @@ static constexpr uint32_t CLOUD_VERSION = 1;
 
 void
 CloudData::DumpClients()
+{
+  DumpClients(clients);
+}
+
+void
+CloudData::DumpClients(const CloudClientContainer &clients)
 {
   for (const auto &client : clients) {
     cout << ToString(client.address) << '\t'
@@ -31,16 +37,28 @@ CloudData::DumpClients()
 }
 
 void
-CloudData::Save(Serialiser &s) const
+CloudData::SaveBegin(Serialiser &s)
 {
   s.Write32(CLOUD_MAGIC);
   s.Write32(CLOUD_VERSION);
-  clients.Save(s);
+}
+
+void
+CloudData::SaveEnd(Serialiser &s, const CloudThermalContainer &thermals)
+{
   s.Write8(1);
   thermals.Save(s);
   s.Write8(0);
 }
 
+void
+CloudData::Save(Serialiser &s) const
+{
+  SaveBegin(s);
+  clients.Save(s);
+  SaveEnd(s, thermals);
+}
+
 void
 CloudData::Load(Deserialiser &s)
 {
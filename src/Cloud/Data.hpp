@@ -18,7 +18,17 @@ struct CloudData {
   OGNTrafficContainer ogn_traffic;
 
   void DumpClients();
+  static void DumpClients(const CloudClientContainer &clients);
 
   void Save(Serialiser &s) const;
   void Load(Deserialiser &s);
+
+  /**
+   * Save() in parts, for merging the clients of several containers
+   * into one file: SaveBegin(), CloudClientContainer::SaveBegin(),
+   * CloudClientContainer::SaveClients() for each container,
+   * CloudClientContainer::SaveEnd(), and finally SaveEnd().
+   */
+  static void SaveBegin(Serialiser &s);
+  static void SaveEnd(Serialiser &s, const CloudThermalContainer &thermals);
 };
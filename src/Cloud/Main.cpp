@@ -7,16 +7,26 @@
 #include "OGNClient.hpp"
 #include "Sender.hpp"
 #include "Serialiser.hpp"
+#include "Snapshot.hpp"
+#include "TrafficCache.hpp"
 #include "Tracking/SkyLines/Server.hpp"
+#include "Tracking/SkyLines/Sharding.hpp"
 #include "Tracking/SkyLines/Protocol.hpp"
 #include "util/ByteOrder.hxx"
 #include "event/Loop.hxx"
+#include "event/Call.hxx"
 #include "event/CoarseTimerEvent.hxx"
+#include "event/FineTimerEvent.hxx"
+#include "event/InjectEvent.hxx"
 #include "event/SignalMonitor.hxx"
 #include "event/net/cares/Channel.hxx"
+#include "io/async/AsioThread.hpp"
 #include "net/IPv4Address.hxx"
 #include "net/IPv6Address.hxx"
+#include "net/StaticSocketAddress.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
 #include "net/ToString.hxx"
+#include "thread/Mutex.hxx"
 #include "io/FileOutputStream.hxx"
 #include "io/FileReader.hxx"
 #include "util/PrintException.hxx"
@@ -25,7 +35,9 @@
 #include "util/ScopeExit.hxx"
 #include "util/EnvParser.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -33,6 +45,8 @@
 #include <iterator>
 #include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include <signal.h>
 
@@ -58,10 +72,41 @@ static constexpr std::chrono::steady_clock::duration TRAFFIC_PUSH_INTERVAL =
 
 static constexpr unsigned MAX_TRAFFIC_TARGETS_PER_RESPONSE = 64;
 
+/**
+ * Traffic responses triggered by other traffic (see
+ * CloudServer::ScheduleNearTrafficSnapshot()) are delayed by this
+ * duration, so a burst of updates results in only one response to
+ * each client.
+ */
+static constexpr std::chrono::steady_clock::duration TRAFFIC_PUSH_DELAY =
+  std::chrono::milliseconds(250);
+
+/**
+ * How long may a #NearTrafficCache cell be reused?  This is shorter
+ * than #TRAFFIC_PUSH_DELAY, so a delayed response always contains the
+ * update which triggered it.
+ */
+static constexpr std::chrono::steady_clock::duration NEAR_TRAFFIC_CACHE_TTL =
+  std::chrono::milliseconds(100);
+
+static_assert(NEAR_TRAFFIC_CACHE_TTL < TRAFFIC_PUSH_DELAY);
+
+/**
+ * How often does each shard publish a #CloudSnapshot for the other
+ * shards?
+ */
+static constexpr std::chrono::steady_clock::duration SNAPSHOT_INTERVAL =
+  std::chrono::seconds(1);
+
 using std::cout;
 using std::cerr;
 using std::endl;
 
+/**
+ * Keeps log lines of concurrent shards from being interleaved.
+ */
+static Mutex log_mutex;
+
 static uint32_t
 MsUtcMidnight() noexcept
 {
@@ -106,41 +151,262 @@ IsTrafficRelevantToClient(const GeoPoint &client_location,
     separation >= -MAX_TRAFFIC_ALTITUDE_SEPARATION;
 }
 
+class CloudServer;
+
+/**
+ * The part of a shard which is accessed by other threads: messages
+ * from other shards and the most recently published
+ * #CloudSnapshot.  It is created before the shard's #CloudServer and
+ * destroyed after it.
+ */
+class CloudShard {
+public:
+  /**
+   * A datagram which was received by another shard.
+   */
+  struct ForwardedDatagram {
+    StaticSocketAddress address;
+    std::vector<std::byte> data;
+  };
+
+  /**
+   * Another shard has received traffic near this location; nearby
+   * clients of this shard shall receive a traffic snapshot.
+   */
+  struct TrafficNotification {
+    GeoPoint location;
+    int altitude;
+    bool altitude_valid;
+    std::optional<uint64_t> exclude_key;
+    bool force;
+    const char *reason;
+  };
+
+  /**
+   * Another shard has received a new thermal.
+   */
+  struct ThermalNotification {
+    uint64_t client_key;
+    GeoPoint bottom_location;
+    SkyLinesTracking::Thermal thermal;
+  };
+
+  struct Inbox {
+    std::vector<ForwardedDatagram> datagrams;
+    std::vector<TrafficNotification> traffic;
+    std::vector<ThermalNotification> thermals;
+  };
+
+  EventLoop &event_loop;
+
+  const unsigned index;
+
+  /**
+   * The #CloudServer of this shard.  Only accessed from this shard's
+   * thread.
+   */
+  CloudServer *server = nullptr;
+
+private:
+  InjectEvent inject_event;
+
+  Mutex mutex;
+
+  /**
+   * Protected by #mutex.
+   */
+  Inbox inbox;
+
+  /**
+   * Protected by #mutex.
+   */
+  std::shared_ptr<const CloudSnapshot> snapshot;
+
+public:
+  CloudShard(EventLoop &_event_loop, unsigned _index) noexcept
+    :event_loop(_event_loop), index(_index),
+     inject_event(event_loop, BIND_THIS_METHOD(OnInject)) {}
+
+  /**
+   * Add a message to the #Inbox.  Thread-safe.
+   */
+  template<typename F>
+  void Post(F &&f) {
+    {
+      const std::lock_guard lock{mutex};
+      f(inbox);
+    }
+
+    inject_event.Schedule();
+  }
+
+  Inbox TakeInbox() noexcept {
+    const std::lock_guard lock{mutex};
+    return std::exchange(inbox, {});
+  }
+
+  void SetServer(CloudServer *_server) noexcept {
+    server = _server;
+    if (server != nullptr)
+      /* handle messages which have arrived before */
+      inject_event.Schedule();
+  }
+
+  void Publish(std::shared_ptr<const CloudSnapshot> &&_snapshot) noexcept {
+    const std::lock_guard lock{mutex};
+    snapshot = std::move(_snapshot);
+  }
+
+  std::shared_ptr<const CloudSnapshot> GetSnapshot() noexcept {
+    const std::lock_guard lock{mutex};
+    return snapshot;
+  }
+
+private:
+  void OnInject() noexcept;
+};
+
+/**
+ * State shared by all shards.
+ *
+ * Each shard runs a #CloudServer in its own thread with its own
+ * #EventLoop and UDP socket, and owns the clients whose key maps to
+ * it (see SkyLinesTracking::GetShardOfKey()).  Shard 0 runs in the
+ * main thread; it receives OGN traffic and saves the database.
+ */
+struct CloudCluster {
+  const AllocatedPath db_path;
+
+  /**
+   * #CloudData::clients receives the database contents during
+   * startup; each #CloudServer takes its share.
+   * #CloudData::thermals is shared by all shards and protected by
+   * #thermal_mutex.  #CloudData::ogn_traffic is owned by shard 0.
+   */
+  CloudData data;
+
+  Mutex thermal_mutex;
+
+  std::vector<std::unique_ptr<CloudShard>> shards;
+
+  explicit CloudCluster(AllocatedPath &&_db_path) noexcept
+    :db_path(std::move(_db_path)) {}
+
+  unsigned GetShardCount() const noexcept {
+    return shards.size();
+  }
+
+  CloudShard &GetShardOfKey(uint64_t key) const noexcept {
+    return *shards[SkyLinesTracking::GetShardOfKey(key, shards.size())];
+  }
+
+  /**
+   * Invoke the function for the #CloudServer of each shard, inside
+   * the shard's thread.  Must be called from the main thread.
+   */
+  template<typename F>
+  void ForEachServer(F &&f) {
+    for (auto &shard : shards)
+      BlockingCall(shard->event_loop, [&shard, &f](){
+        if (shard->server != nullptr)
+          f(*shard->server);
+      });
+  }
+
+  void Load();
+  void Save();
+
+  void SaveSafely() noexcept {
+    try {
+      Save();
+    } catch (...) {
+      cerr << "Failed to save database: "
+           << GetFullMessage(std::current_exception()) << endl;
+    }
+  }
+
+  void DumpClients();
+};
+
 class CloudServer final
   : public SkyLinesTracking::Server,
-    CloudData,
     public OGNAprsHandler {
-  const AllocatedPath db_path;
+  CloudCluster &cluster;
+  CloudShard &shard;
+
+  /**
+   * The clients owned by this shard.
+   */
+  CloudClientContainer clients;
+
+  /**
+   * The most recent #CloudSnapshot of each other shard (indexed by
+   * #CloudShard::index; nullptr for this one).  Empty if there is
+   * only one shard.
+   */
+  std::vector<std::shared_ptr<const CloudSnapshot>> snapshots;
+
+  NearTrafficCache near_traffic_cache;
+
+  /**
+   * Clients which shall receive a traffic response when
+   * #push_timer fires: the key and the reason (for the log).
+   */
+  std::vector<std::pair<uint64_t, const char *>> pending_pushes;
+
+  FineTimerEvent push_timer;
 
   Cares::Channel cares_channel;
 
   CoarseTimerEvent save_timer, expire_timer;
   CoarseTimerEvent ogn_expire_timer;
+  CoarseTimerEvent snapshot_timer;
 
   std::unique_ptr<OGNClient> ogn_client;
 
 public:
-  CloudServer(AllocatedPath &&_db_path, EventLoop &event_loop,
-              SocketAddress bind_address, bool enable_ogn)
-    :SkyLinesTracking::Server(event_loop, bind_address),
-     db_path(std::move(_db_path)),
-     cares_channel(event_loop),
-     save_timer(event_loop, BIND_THIS_METHOD(OnSaveTimer)),
-     expire_timer(event_loop, BIND_THIS_METHOD(OnExpireTimer)),
-     ogn_expire_timer(event_loop, BIND_THIS_METHOD(OnOgnExpireTimer))
+  CloudServer(CloudCluster &_cluster, CloudShard &_shard,
+              UniqueSocketDescriptor &&socket, bool enable_ogn)
+    :SkyLinesTracking::Server(_shard.event_loop, std::move(socket)),
+     cluster(_cluster), shard(_shard),
+     push_timer(GetEventLoop(), BIND_THIS_METHOD(OnPushTimer)),
+     cares_channel(GetEventLoop()),
+     save_timer(GetEventLoop(), BIND_THIS_METHOD(OnSaveTimer)),
+     expire_timer(GetEventLoop(), BIND_THIS_METHOD(OnExpireTimer)),
+     ogn_expire_timer(GetEventLoop(), BIND_THIS_METHOD(OnOgnExpireTimer)),
+     snapshot_timer(GetEventLoop(), BIND_THIS_METHOD(OnSnapshotTimer))
   {
+    const unsigned n_shards = cluster.GetShardCount();
+
+    /* take over this shard's clients from the database */
+    cluster.data.clients.MoveIf(clients, [this, n_shards](const CloudClient &c){
+      return SkyLinesTracking::GetShardOfKey(c.key, n_shards) == shard.index;
+    });
+    clients.SetIdSequence(cluster.data.clients.GetNextId() + shard.index,
+                          n_shards);
+
+    if (!clients.empty())
+      ScheduleExpire();
+
+    if (n_shards > 1) {
+      snapshots.resize(n_shards);
+      OnSnapshotTimer();
+    }
+
+    if (IsMainShard()) {
 #ifndef _WIN32
-    SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
-    SignalMonitorRegister(SIGTERM, BIND_THIS_METHOD(OnQuitSignal));
-    SignalMonitorRegister(SIGQUIT, BIND_THIS_METHOD(OnQuitSignal));
+      SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
+      SignalMonitorRegister(SIGTERM, BIND_THIS_METHOD(OnQuitSignal));
+      SignalMonitorRegister(SIGQUIT, BIND_THIS_METHOD(OnQuitSignal));
 
-    SignalMonitorRegister(SIGHUP, BIND_THIS_METHOD(OnReloadSignal));
-    SignalMonitorRegister(SIGUSR1, BIND_THIS_METHOD(OnDumpSignal));
+      SignalMonitorRegister(SIGHUP, BIND_THIS_METHOD(OnReloadSignal));
+      SignalMonitorRegister(SIGUSR1, BIND_THIS_METHOD(OnDumpSignal));
 #endif
 
-    ScheduleSave();
+      ScheduleSave();
+    }
 
-    if (enable_ogn) {
+    if (IsMainShard() && enable_ogn) {
       std::string host{GetEnvString("XCS_CLOUD_OGN_HOST", "aprs.glidernet.org")};
       const unsigned port = unsigned(
         GetEnvInt("XCS_CLOUD_OGN_PORT", 10152, 1, 65535));
@@ -154,35 +420,48 @@ public:
            << endl;
 
       ogn_client = std::make_unique<OGNClient>(
-        event_loop, cares_channel, *this,
+        GetEventLoop(), cares_channel, *this,
         std::move(host), port, std::move(user), std::move(pass));
       ogn_client->Start();
       ScheduleOgnExpire();
-    } else
+    } else if (IsMainShard())
       cout << "OGN\tdisabled" << endl;
+
+    shard.SetServer(this);
   }
 
   ~CloudServer() noexcept
   {
+    shard.SetServer(nullptr);
+
     if (ogn_client != nullptr)
       ogn_client->Stop();
   }
 
-  void Load();
-  void Save();
-
-  void SaveSafely() noexcept {
-    try {
-      Save();
-    } catch (...) {
-      cerr << "Failed to save database: "
-           << GetFullMessage(std::current_exception()) << endl;
-    }
+  const CloudClientContainer &GetClients() const noexcept {
+    return clients;
   }
 
+  /**
+   * Handle messages from other shards.
+   */
+  void OnInbox() noexcept;
+
 private:
+  /**
+   * Is this shard 0, which runs in the main thread?
+   */
+  bool IsMainShard() const noexcept {
+    return shard.index == 0;
+  }
+
+  OGNTrafficContainer &GetOgnTraffic() noexcept {
+    assert(IsMainShard());
+    return cluster.data.ogn_traffic;
+  }
+
   void OnSaveTimer() noexcept {
-    SaveSafely();
+    cluster.SaveSafely();
     ScheduleSave();
   }
 
@@ -191,6 +470,7 @@ private:
   }
 
   void OnExpireTimer() noexcept {
+    near_traffic_cache.Expire(std::chrono::steady_clock::now());
     clients.Expire(GetEventLoop().SteadyNow() - std::chrono::minutes(10));
     if (!clients.empty())
       ScheduleExpire();
@@ -201,7 +481,7 @@ private:
   }
 
   void OnOgnExpireTimer() noexcept {
-    ogn_traffic.Expire(GetEventLoop().SteadyNow() - MAX_OGN_TRAFFIC_AGE);
+    GetOgnTraffic().Expire(GetEventLoop().SteadyNow() - MAX_OGN_TRAFFIC_AGE);
     ScheduleOgnExpire();
   }
 
@@ -209,12 +489,26 @@ private:
     ogn_expire_timer.Schedule(std::chrono::minutes(1));
   }
 
-  void PushOgnTraffic(const OGNTrafficEntry &t) noexcept;
+  /**
+   * Publish a new #CloudSnapshot of this shard and obtain the
+   * snapshots of all others.
+   */
+  void OnSnapshotTimer() noexcept;
+
+  void PushOgnTraffic(const OGNTrafficEntry &t);
 
   void SendTrafficCallsign(SocketAddress address, uint64_t key,
                            uint32_t pilot_id,
                            const std::string &callsign) noexcept;
 
+  /**
+   * Obtain the traffic near the given location from
+   * #near_traffic_cache, and fill the cache if necessary.
+   */
+  const NearTrafficCache::Cell &
+  GetNearTraffic(const GeoPoint &location,
+                 std::chrono::steady_clock::time_point now) noexcept;
+
   void SendNearTrafficSnapshot(CloudClient &client,
                                const char *reason) noexcept;
 
@@ -222,31 +516,60 @@ private:
                                     const char *reason,
                                     bool force = false) noexcept;
 
+  /**
+   * Like MaybeSendNearTrafficSnapshot(), but send it after
+   * #TRAFFIC_PUSH_DELAY, together with all other updates until then.
+   */
+  void ScheduleNearTrafficSnapshot(CloudClient &client,
+                                   const char *reason,
+                                   bool force = false) noexcept;
+
+  void OnPushTimer() noexcept;
+
   template<typename F>
   void ForEachClientNearTraffic(
     const GeoPoint &target_location, int target_altitude,
     bool target_altitude_valid,
     std::optional<uint64_t> exclude_key, F &&f) noexcept(
     noexcept(f(std::declval<CloudClient &>()))) {
-    for (const auto &i : clients.QueryWithinRange(target_location,
-                                                  TRAFFIC_RANGE)) {
-      if (exclude_key && i->key == *exclude_key)
+    for (auto &i : clients.QueryWithinRange(target_location,
+                                            TRAFFIC_RANGE)) {
+      if (exclude_key && i.key == *exclude_key)
         continue;
 
-      if (!IsTrafficRelevantToClient(i->location, i->altitude,
+      if (!IsTrafficRelevantToClient(i.location, i.altitude,
                                      target_location, target_altitude,
                                      target_altitude_valid))
         continue;
 
-      f(*i);
+      f(i);
     }
   }
 
+  /**
+   * Notify all other shards which have clients near the given
+   * traffic (according to their most recent #CloudSnapshot).
+   */
+  void NotifyNearTraffic(const GeoPoint &target_location,
+                         int target_altitude, bool target_altitude_valid,
+                         std::optional<uint64_t> exclude_key,
+                         bool force, const char *reason);
+
+  /**
+   * Send a new thermal to all clients of this shard which have
+   * requested thermals recently.
+   */
+  void SendThermal(uint64_t client_key, const GeoPoint &bottom_location,
+                   const SkyLinesTracking::Thermal &thermal) noexcept;
+
   /* OGNAprsHandler */
   void OnAprsLine(std::string_view line) noexcept override;
 
 protected:
   /* virtual methods from class SkyLinesTracking::Server */
+  bool OnDatagramKey(const Client &client,
+                     std::span<const std::byte> datagram) noexcept override;
+
   void OnFix(const Client &client,
              std::chrono::milliseconds time_of_day,
              const ::GeoPoint &location, int altitude,
@@ -277,14 +600,20 @@ protected:
 
   void OnSendError(SocketAddress address,
                    std::exception_ptr e) noexcept override {
+    const std::lock_guard lock{log_mutex};
     cerr << "Failed to send to " << address
          << ": " << GetFullMessage(e)
          << endl;
   }
 
   void OnError(std::exception_ptr e) override {
-    cerr << GetFullMessage(e) << endl;
-    GetEventLoop().Break();
+    {
+      const std::lock_guard lock{log_mutex};
+      cerr << GetFullMessage(e) << endl;
+    }
+
+    /* stop the main thread, which shuts down all shards */
+    cluster.shards.front()->event_loop.InjectBreak();
   }
 
 #ifndef _WIN32
@@ -293,40 +622,124 @@ protected:
   }
 
   void OnReloadSignal() noexcept {
-    SaveSafely();
+    cluster.SaveSafely();
   }
 
   void OnDumpSignal() noexcept {
-    DumpClients();
+    try {
+      cluster.DumpClients();
+    } catch (...) {
+      PrintException(std::current_exception());
+    }
   }
 #endif
 };
 
+void
+CloudShard::OnInject() noexcept
+{
+  /* if there is no server yet, the messages are kept until
+     SetServer() is called */
+  if (server != nullptr)
+    server->OnInbox();
+}
+
+void
+CloudServer::OnInbox() noexcept
+{
+  auto inbox = shard.TakeInbox();
+
+  for (auto &i : inbox.datagrams)
+    HandleDatagram(i.address, i.data);
+
+  for (const auto &i : inbox.traffic)
+    ForEachClientNearTraffic(i.location, i.altitude, i.altitude_valid,
+                             i.exclude_key,
+                             [this, &i](CloudClient &c) {
+                               ScheduleNearTrafficSnapshot(c, i.reason,
+                                                           i.force);
+                             });
+
+  for (const auto &i : inbox.thermals)
+    SendThermal(i.client_key, i.bottom_location, i.thermal);
+}
+
+void
+CloudServer::OnSnapshotTimer() noexcept
+{
+  snapshot_timer.Schedule(SNAPSHOT_INTERVAL);
+
+  try {
+    shard.Publish(std::make_shared<const CloudSnapshot>(clients,
+                                                        IsMainShard()
+                                                        ? &GetOgnTraffic()
+                                                        : nullptr));
+  } catch (...) {
+    const std::lock_guard lock{log_mutex};
+    cerr << "SNAPSHOT\terror\t" << GetFullMessage(std::current_exception())
+         << endl;
+  }
+
+  for (const auto &i : cluster.shards)
+    if (i.get() != &shard)
+      snapshots[i->index] = i->GetSnapshot();
+}
+
+bool
+CloudServer::OnDatagramKey(const Client &client,
+                           std::span<const std::byte> datagram) noexcept
+{
+  auto &owner = cluster.GetShardOfKey(client.key);
+  if (&owner == &shard)
+    return true;
+
+  /* the kernel has delivered the datagram to the wrong socket
+     (e.g. because SteerByKey() is not supported); redirect it to the
+     shard which owns this client */
+  try {
+    owner.Post([&client, datagram](CloudShard::Inbox &inbox){
+      inbox.datagrams.push_back({
+        client.address,
+        {datagram.begin(), datagram.end()},
+      });
+    });
+  } catch (...) {
+    /* out of memory: drop the datagram */
+  }
+
+  return false;
+}
+
 void
 CloudServer::OnAprsLine(std::string_view line) noexcept
 {
   const OGNAprsParseResult p = ParseOGNAprsLine(line);
   if (!p.valid) {
-    if (GetEnvBool("XCS_CLOUD_DEBUG"))
+    if (GetEnvBool("XCS_CLOUD_DEBUG")) {
+      const std::lock_guard lock{log_mutex};
       cerr << "OGN\tignore\t" << line << endl;
+    }
     return;
   }
 
   if (!IsForwardableOgnTraffic(p, line)) {
-    if (GetEnvBool("XCS_CLOUD_DEBUG"))
+    if (GetEnvBool("XCS_CLOUD_DEBUG")) {
+      const std::lock_guard lock{log_mutex};
       cerr << "OGN\tground-station\t" << p.station_id << endl;
+    }
     return;
   }
 
   try {
     OGNTrafficEntry &t =
-      ogn_traffic.Upsert(p.station_id, p.location, p.altitude,
-                         p.altitude_valid,
-                         p.track_deg, p.track_valid,
-                         p.flarm_id, p.flarm_valid,
-                         p.aircraft_type, p.address_type, p.callsign);
+      GetOgnTraffic().Upsert(p.station_id, p.location, p.altitude,
+                             p.altitude_valid,
+                             p.track_deg, p.track_valid,
+                             p.flarm_id, p.flarm_valid,
+                             p.aircraft_type, p.address_type, p.callsign);
 
     if (GetEnvBool("XCS_CLOUD_DEBUG")) {
+      const std::lock_guard lock{log_mutex};
       cout << "OGN\ttraffic\t" << p.station_id << '\t'
            << t.location << '\t' << t.altitude << "m\t"
            << "pilot_id=" << t.pilot_id;
@@ -341,6 +754,7 @@ CloudServer::OnAprsLine(std::string_view line) noexcept
 
     PushOgnTraffic(t);
   } catch (...) {
+    const std::lock_guard lock{log_mutex};
     cerr << "OGN\talloc-error\t" << p.station_id << endl;
   }
 }
@@ -355,13 +769,15 @@ CloudServer::SendTrafficCallsign(SocketAddress address, uint64_t key,
 
   SendUserNameResponse(*this, address, key, pilot_id, callsign);
 
-  if (GetEnvBool("XCS_CLOUD_DEBUG"))
+  if (GetEnvBool("XCS_CLOUD_DEBUG")) {
+    const std::lock_guard lock{log_mutex};
     cerr << "USER_NAME\tpush\tpilot_id=" << pilot_id
          << "\tname=" << callsign << endl;
+  }
 }
 
 void
-CloudServer::PushOgnTraffic(const OGNTrafficEntry &t) noexcept
+CloudServer::PushOgnTraffic(const OGNTrafficEntry &t)
 {
   const auto now = std::chrono::steady_clock::now();
   const auto min_stamp = now - MAX_OGN_TRAFFIC_AGE;
@@ -370,8 +786,47 @@ CloudServer::PushOgnTraffic(const OGNTrafficEntry &t) noexcept
 
   ForEachClientNearTraffic(t.location, t.altitude, t.altitude_valid, {},
                            [&](CloudClient &i) {
-                             MaybeSendNearTrafficSnapshot(i, "TRAFFIC_OGN");
+                             ScheduleNearTrafficSnapshot(i, "TRAFFIC_OGN");
                            });
+
+  NotifyNearTraffic(t.location, t.altitude, t.altitude_valid, {},
+                    false, "TRAFFIC_OGN");
+}
+
+void
+CloudServer::NotifyNearTraffic(const GeoPoint &target_location,
+                               int target_altitude,
+                               bool target_altitude_valid,
+                               std::optional<uint64_t> exclude_key,
+                               bool force, const char *reason)
+{
+  for (std::size_t i = 0; i < snapshots.size(); ++i) {
+    if (snapshots[i] == nullptr)
+      continue;
+
+    bool found = false;
+    for (const auto &[location, c] :
+           snapshots[i]->QueryClientsWithinRange(target_location,
+                                                 TRAFFIC_RANGE)) {
+      if ((!exclude_key || c->key != *exclude_key) &&
+          IsTrafficRelevantToClient(c->location, c->altitude,
+                                    target_location, target_altitude,
+                                    target_altitude_valid)) {
+        found = true;
+        break;
+      }
+    }
+
+    if (!found)
+      continue;
+
+    cluster.shards[i]->Post([&](CloudShard::Inbox &inbox){
+      inbox.traffic.push_back({
+        target_location, target_altitude, target_altitude_valid,
+        exclude_key, force, reason,
+      });
+    });
+  }
 }
 
 void
@@ -388,75 +843,170 @@ CloudServer::MaybeSendNearTrafficSnapshot(CloudClient &client,
 }
 
 void
-CloudServer::SendNearTrafficSnapshot(CloudClient &client,
-                                       const char *reason) noexcept
+CloudServer::ScheduleNearTrafficSnapshot(CloudClient &client,
+                                         const char *reason,
+                                         bool force) noexcept
+{
+  const auto now = std::chrono::steady_clock::now();
+  if (!force && now < client.last_traffic_push + TRAFFIC_PUSH_INTERVAL)
+    return;
+
+  if (client.traffic_push_pending)
+    return;
+
+  client.traffic_push_pending = true;
+  pending_pushes.emplace_back(client.key, reason);
+
+  if (!push_timer.IsPending())
+    push_timer.Schedule(TRAFFIC_PUSH_DELAY);
+}
+
+void
+CloudServer::OnPushTimer() noexcept
 {
   const auto now = std::chrono::steady_clock::now();
+
+  for (const auto &[key, reason] : pending_pushes) {
+    auto *client = clients.Find(key);
+    if (client == nullptr)
+      /* expired meanwhile */
+      continue;
+
+    client->traffic_push_pending = false;
+    client->last_traffic_push = now;
+    SendNearTrafficSnapshot(*client, reason);
+  }
+
+  pending_pushes.clear();
+  near_traffic_cache.Expire(now);
+}
+
+/**
+ * Make a #NearTrafficCache::Item for a #CloudClient (or its
+ * #CloudSnapshot::Client copy).
+ */
+template<typename T>
+static NearTrafficCache::Item
+MakeCloudTrafficItem(const T &traffic) noexcept
+{
+  return {
+    traffic.location, traffic.altitude, traffic.altitude >= 0,
+    false, traffic.key,
+    TrafficResponseSender::MakeTraffic(traffic.id, 0, //TODO: time?
+                                       traffic.location, traffic.altitude,
+                                       TrafficRecordExtensions::FromOgn(traffic.track_deg,
+                                                                        traffic.track_valid,
+                                                                        traffic.aircraft_type,
+                                                                        0, false,
+                                                                        traffic.altitude >= 0)),
+    {},
+  };
+}
+
+const NearTrafficCache::Cell &
+CloudServer::GetNearTraffic(const GeoPoint &location,
+                            std::chrono::steady_clock::time_point now) noexcept
+{
+  const unsigned grid_cell = CloudClientContainer::GetGridCell(location);
+  if (const auto *cell = near_traffic_cache.Get(grid_cell, now))
+    return *cell;
+
+  auto &cell = near_traffic_cache.Make(grid_cell,
+                                       now + NEAR_TRAFFIC_CACHE_TTL);
+  auto &items = cell.items;
+
+  const auto [center, range] =
+    NearTrafficCache::GetCellQuery(grid_cell, TRAFFIC_RANGE);
+
   const auto min_stamp = now - MAX_TRAFFIC_AGE;
   const auto min_ogn_stamp = now - MAX_OGN_TRAFFIC_AGE;
 
+  for (const auto &traffic : clients.QueryWithinRange(center, range))
+    if (traffic.stamp >= min_stamp)
+      items.push_back(MakeCloudTrafficItem(traffic));
+
+  /* clients of other shards */
+  for (const auto &snapshot : snapshots) {
+    if (snapshot == nullptr)
+      continue;
+
+    for (const auto &[location, traffic] :
+           snapshot->QueryClientsWithinRange(center, range))
+      if (traffic->stamp >= min_stamp)
+        items.push_back(MakeCloudTrafficItem(*traffic));
+  }
+
+  const uint32_t time_ms = MsUtcMidnight();
+  auto add_ogn = [&](const OGNTrafficEntry &og){
+    if (og.stamp < min_ogn_stamp)
+      return;
+
+    if (!IsForwardableOgnTraffic(og))
+      return;
+
+    items.push_back({
+      og.location, og.altitude, og.altitude_valid,
+      true, 0,
+      TrafficResponseSender::MakeTraffic(og.pilot_id, time_ms,
+                                         og.location, og.altitude,
+                                         TrafficRecordExtensions::FromOgn(og)),
+      og.callsign,
+    });
+  };
+
+  if (IsMainShard()) {
+    for (const auto &og :
+           GetOgnTraffic().QueryWithinRange(center, range))
+      add_ogn(*og);
+  } else if (snapshots.front() != nullptr) {
+    /* OGN traffic is received by shard 0 */
+    for (const auto &[location, og] :
+           snapshots.front()->QueryOgnTrafficWithinRange(center, range))
+      add_ogn(*og);
+  }
+
+  return cell;
+}
+
+void
+CloudServer::SendNearTrafficSnapshot(CloudClient &client,
+                                       const char *reason) noexcept
+{
+  const auto now = std::chrono::steady_clock::now();
+
   TrafficResponseSender s(*this, client.address, client.key);
 
   unsigned n = 0;
   unsigned n_cloud = 0;
   unsigned n_ogn = 0;
-  for (const auto &traffic : clients.QueryWithinRange(client.location,
-                                                      TRAFFIC_RANGE)) {
-    if (traffic.get() == &client)
-      continue;
+  for (const auto &i : GetNearTraffic(client.location, now).items) {
+    if (n >= MAX_TRAFFIC_TARGETS_PER_RESPONSE)
+      break;
 
-    if (traffic->stamp < min_stamp)
+    if (!i.ogn && i.key == client.key)
       continue;
 
     if (!IsTrafficRelevantToClient(client.location, client.altitude,
-                                   traffic->location, traffic->altitude,
-                                   traffic->altitude >= 0))
+                                   i.location, i.altitude,
+                                   i.altitude_valid))
       continue;
 
-    if (n >= MAX_TRAFFIC_TARGETS_PER_RESPONSE)
-      break;
-
-    s.Add(traffic->id, 0, //TODO: time?
-          traffic->location, traffic->altitude,
-          TrafficRecordExtensions::FromOgn(traffic->track_deg,
-                                           traffic->track_valid,
-                                           traffic->aircraft_type,
-                                           0, false,
-                                           traffic->altitude >= 0));
-    ++n_cloud;
-    ++n;
-  }
-
-  if (n < MAX_TRAFFIC_TARGETS_PER_RESPONSE) {
-    const uint32_t time_ms = MsUtcMidnight();
-    for (const auto &og :
-         ogn_traffic.QueryWithinRange(client.location, TRAFFIC_RANGE)) {
-      if (og->stamp < min_ogn_stamp)
-        continue;
+    s.Add(i.traffic);
 
-      if (!IsForwardableOgnTraffic(*og))
-        continue;
-
-      if (!IsTrafficRelevantToClient(client.location, client.altitude,
-                                     og->location, og->altitude,
-                                     og->altitude_valid))
-        continue;
-
-      if (n >= MAX_TRAFFIC_TARGETS_PER_RESPONSE)
-        break;
-
-      s.Add(og->pilot_id, time_ms, og->location, og->altitude,
-            TrafficRecordExtensions::FromOgn(*og));
+    if (i.ogn) {
       SendTrafficCallsign(client.address, client.key,
-                          og->pilot_id, og->callsign);
+                          FromBE32(i.traffic.pilot_id), i.callsign);
       ++n_ogn;
-      ++n;
-    }
+    } else
+      ++n_cloud;
+
+    ++n;
   }
 
   s.Flush();
 
   if (n > 0 || std::strcmp(reason, "TRAFFIC_FIX") == 0) {
+    const std::lock_guard lock{log_mutex};
     cout << reason << '\t' << client.address << '\t'
          << std::hex << client.key << std::dec << '\t'
          << client.id << '\t' << client.location << '\t'
@@ -481,15 +1031,18 @@ CloudServer::OnFix(const Client &c,
     client = &clients.Make(c.address, c.key, location, altitude,
                            track_deg, track_valid);
 
-    cout << "FIX\t"
-         << client->address << '\t'
-         << std::hex << client->key << std::dec << '\t'
-         << client->id << '\t'
-         << client->location << '\t'
-         << client->altitude << 'm';
-    if (track_valid)
-      cout << "\ttrack=" << track_deg;
-    cout << endl;
+    {
+      const std::lock_guard lock{log_mutex};
+      cout << "FIX\t"
+           << client->address << '\t'
+           << std::hex << client->key << std::dec << '\t'
+           << client->id << '\t'
+           << client->location << '\t'
+           << client->altitude << 'm';
+      if (track_valid)
+        cout << "\ttrack=" << track_deg;
+      cout << endl;
+    }
 
     if (was_empty)
       ScheduleExpire();
@@ -508,22 +1061,28 @@ CloudServer::OnFix(const Client &c,
   /* Push full snapshots to other nearby clients (same as OGN updates). */
   ForEachClientNearTraffic(location, altitude, altitude >= 0, c.key,
                            [&](CloudClient &i) {
-                             MaybeSendNearTrafficSnapshot(i, "TRAFFIC_FIX", true);
+                             ScheduleNearTrafficSnapshot(i, "TRAFFIC_FIX", true);
                            });
+
+  NotifyNearTraffic(location, altitude, altitude >= 0, c.key,
+                    true, "TRAFFIC_FIX");
 }
 
 void
 CloudServer::OnTrafficRequest(const Client &c, bool near)
 {
   if (!near) {
-    if (GetEnvBool("XCS_CLOUD_DEBUG"))
+    if (GetEnvBool("XCS_CLOUD_DEBUG")) {
+      const std::lock_guard lock{log_mutex};
       cerr << "TRAFFIC_REQUEST\tignored\tnot-near\t"
            << std::hex << c.key << std::dec << endl;
+    }
     return;
   }
 
   auto *client = clients.Find(c.key);
   if (client == nullptr) {
+    const std::lock_guard lock{log_mutex};
     cerr << "TRAFFIC_REQUEST\trejected\tunknown-client\t"
          << ToString(c.address) << '\t'
          << std::hex << c.key << std::dec << endl;
@@ -536,7 +1095,11 @@ CloudServer::OnTrafficRequest(const Client &c, bool near)
 void
 CloudServer::OnUserNameRequest(const Client &c, uint32_t user_id)
 {
-  const OGNTrafficEntry *traffic = ogn_traffic.FindByPilotId(user_id);
+  const OGNTrafficEntry *traffic = IsMainShard()
+    ? GetOgnTraffic().FindByPilotId(user_id)
+    : (snapshots.front() != nullptr
+       ? snapshots.front()->FindOgnTrafficByPilotId(user_id)
+       : nullptr);
   if (traffic == nullptr || traffic->callsign.empty())
     return;
 
@@ -557,6 +1120,7 @@ CloudServer::OnWaveSubmit(const Client &c,
        yet */
     return;
 
+  const std::lock_guard lock{log_mutex};
   cout << "WAVE\t"
        << client->address << '\t'
        << std::hex << client->key << std::dec << '\t'
@@ -583,36 +1147,56 @@ CloudServer::OnThermalSubmit(const Client &c,
        yet */
     return;
 
-  cout << "THERMAL\t"
-       << client->address << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << top_location << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
+  {
+    const std::lock_guard lock{log_mutex};
+    cout << "THERMAL\t"
+         << client->address << '\t'
+         << std::hex << client->key << std::dec << '\t'
+         << client->id << '\t'
+         << top_location << '\t'
+         << bottom_altitude << '-' << top_altitude << "m\t"
+         << lift << "m/s"
+         << endl;
+  }
+
+  SkyLinesTracking::Thermal thermal;
 
-  const auto &thermal =
-    thermals.Make(c.key,
-                  AGeoPoint(bottom_location, bottom_altitude),
-                  AGeoPoint(top_location, top_altitude),
-                  lift);
+  {
+    const std::lock_guard lock{cluster.thermal_mutex};
+    thermal = cluster.data.thermals.Make(c.key,
+                                         AGeoPoint(bottom_location, bottom_altitude),
+                                         AGeoPoint(top_location, top_altitude),
+                                         lift).Pack();
+  }
 
   /* send this new thermal to all interested clients immediately */
+  SendThermal(c.key, bottom_location, thermal);
+
+  for (const auto &i : cluster.shards)
+    if (i.get() != &shard)
+      i->Post([&](CloudShard::Inbox &inbox){
+        inbox.thermals.push_back({c.key, bottom_location, thermal});
+      });
+}
+
+void
+CloudServer::SendThermal(uint64_t client_key, const GeoPoint &bottom_location,
+                         const SkyLinesTracking::Thermal &thermal) noexcept
+{
   const auto now = std::chrono::steady_clock::now();
   for (const auto &i : clients.QueryWithinRange(bottom_location,
                                                 THERMAL_RANGE)) {
-    if (i->key == c.key)
+    if (i.key == client_key)
       /* ignore this client's own submissions - he knows them
          already */
       continue;
 
-    if (now > i->wants_thermals)
+    if (now > i.wants_thermals)
       /* not interested (anymore) */
       continue;
 
-    ThermalResponseSender s(*this, i->address, i->key);
-    s.Add(thermal.Pack());
+    ThermalResponseSender s(*this, i.address, i.key);
+    s.Add(thermal);
     s.Flush();
   }
 }
@@ -635,26 +1219,33 @@ CloudServer::OnThermalRequest(const Client &c)
   ThermalResponseSender s(*this, c.address, c.key);
 
   unsigned n = 0;
-  for (const auto &thermal : thermals.QueryWithinRange(client->location,
-                                                       THERMAL_RANGE)) {
-    if (thermal->client_key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
 
-    if (thermal->time < min_time)
-      /* don't send old thermals, they're useless */
-      continue;
+  {
+    const std::lock_guard lock{cluster.thermal_mutex};
+
+    for (const auto &thermal :
+           cluster.data.thermals.QueryWithinRange(client->location,
+                                                  THERMAL_RANGE)) {
+      if (thermal->client_key == c.key)
+        /* ignore this client's own submissions - he knows them
+           already */
+        continue;
 
-    if (n >= 256)
-      break;
+      if (thermal->time < min_time)
+        /* don't send old thermals, they're useless */
+        continue;
 
-    s.Add(thermal->Pack());
-    ++n;
+      if (n >= 256)
+        break;
+
+      s.Add(thermal->Pack());
+      ++n;
+    }
   }
 
   s.Flush();
 
+  const std::lock_guard lock{log_mutex};
   cout << "THERMAL_REQUEST\t" << client->address << '\t'
        << std::hex << client->key << std::dec << '\t'
        << client->id << '\t' << client->location << '\t'
@@ -662,34 +1253,88 @@ CloudServer::OnThermalRequest(const Client &c)
 }
 
 void
-CloudServer::Load()
+CloudCluster::Load()
 {
   FileReader fr(db_path);
   Deserialiser s(fr);
-  CloudData::Load(s);
+  data.Load(s);
 
   cout << "DB\tloaded\tclients="
-       << std::distance(clients.begin(), clients.end())
+       << std::distance(data.clients.begin(), data.clients.end())
        << "\tthermals="
-       << std::distance(thermals.begin(), thermals.end()) << endl;
+       << std::distance(data.thermals.begin(), data.thermals.end()) << endl;
 }
 
 void
-CloudServer::Save()
+CloudCluster::Save()
 {
-  cout << "Saving data to " << db_path.c_str() << endl;
+  {
+    const std::lock_guard lock{log_mutex};
+    cout << "Saving data to " << db_path.c_str() << endl;
+  }
 
   FileOutputStream fos(db_path);
 
   {
     Serialiser s(fos);
-    CloudData::Save(s);
+    CloudData::SaveBegin(s);
+
+    unsigned next_id = 1;
+    ForEachServer([&next_id](CloudServer &server){
+      next_id = std::max(next_id, server.GetClients().GetNextId());
+    });
+
+    CloudClientContainer::SaveBegin(s, next_id);
+    ForEachServer([&s](CloudServer &server){
+      server.GetClients().SaveClients(s);
+    });
+    CloudClientContainer::SaveEnd(s);
+
+    {
+      const std::lock_guard lock{thermal_mutex};
+      CloudData::SaveEnd(s, data.thermals);
+    }
+
     s.Flush();
   }
 
   fos.Commit();
 }
 
+void
+CloudCluster::DumpClients()
+{
+  ForEachServer([](CloudServer &server){
+    const std::lock_guard lock{log_mutex};
+    CloudData::DumpClients(server.GetClients());
+  });
+}
+
+/**
+ * Create the sockets of all shards.  Try IPv6 (dual-stack) first,
+ * and fall back to IPv4.
+ *
+ * Throws on error.
+ */
+static std::vector<UniqueSocketDescriptor>
+CreateSockets(unsigned n_shards, const char *&bind_mode)
+{
+  const unsigned port = CloudServer::GetDefaultPort();
+
+  try {
+    auto sockets =
+      SkyLinesTracking::CreateShardedSockets(IPv6Address(port), n_shards);
+    bind_mode = "ipv6-dual-stack";
+    return sockets;
+  } catch (...) {
+    cerr << "IPv6 bind failed, falling back to IPv4" << endl;
+    auto sockets =
+      SkyLinesTracking::CreateShardedSockets(IPv4Address(port), n_shards);
+    bind_mode = "ipv4";
+    return sockets;
+  }
+}
+
 int
 main(int argc, char **argv)
 try {
@@ -700,6 +1345,9 @@ try {
          << endl;
     cerr << "Optional env: XCS_CLOUD_DEBUG=1 enables verbose debug logging."
          << endl;
+    cerr << "Optional env: XCS_CLOUD_THREADS=N distributes clients over N "
+            "threads (Linux only)."
+         << endl;
     return EXIT_FAILURE;
   }
 
@@ -710,37 +1358,77 @@ try {
   AtScopeExit() { SignalMonitorFinish(); };
 
   const bool enable_ogn = GetEnvBool("XCS_CLOUD_OGN");
+  const unsigned n_shards = GetEnvInt("XCS_CLOUD_THREADS", 1, 1, 64);
 
-  std::unique_ptr<CloudServer> server;
   const char *bind_mode;
-  try {
-    server = std::make_unique<CloudServer>(db_path, event_loop,
-                                           IPv6Address(CloudServer::GetDefaultPort()),
-                                           enable_ogn);
-    bind_mode = "ipv6-dual-stack";
-  } catch (...) {
-    cerr << "IPv6 bind failed, falling back to IPv4" << endl;
-    server = std::make_unique<CloudServer>(db_path, event_loop,
-                                           IPv4Address(CloudServer::GetDefaultPort()),
-                                           enable_ogn);
-    bind_mode = "ipv4";
-  }
+  auto sockets = CreateSockets(n_shards, bind_mode);
+
+  const bool steering = n_shards > 1 &&
+    SkyLinesTracking::SteerByKey(sockets.front(), n_shards);
 
   cout << "START\tport=" << CloudServer::GetDefaultPort()
        << "\tbind=" << bind_mode
        << "\tdb=" << db_path.c_str()
-       << "\tdebug=" << (GetEnvBool("XCS_CLOUD_DEBUG") ? "1" : "0") << endl;
+       << "\tthreads=" << n_shards;
+  if (n_shards > 1)
+    cout << "\tsteering=" << (steering ? "key" : "redirect");
+  cout << "\tdebug=" << (GetEnvBool("XCS_CLOUD_DEBUG") ? "1" : "0") << endl;
+
+  /* declared before the cluster, because the shards refer to their
+     event loops */
+  std::vector<std::unique_ptr<AsioThread>> threads;
+
+  CloudCluster cluster(db_path);
 
   try {
-    server->Load();
+    cluster.Load();
   } catch (const std::runtime_error &e) {
     cerr << "Failed to load database" << endl;
     PrintException(e);
   }
 
+  /* shard 0 runs in this thread, all others in a new thread each */
+  cluster.shards.emplace_back(std::make_unique<CloudShard>(event_loop, 0));
+  for (unsigned i = 1; i < n_shards; ++i) {
+    auto &thread = *threads.emplace_back(std::make_unique<AsioThread>());
+    cluster.shards.emplace_back(std::make_unique<CloudShard>(thread.GetEventLoop(), i));
+  }
+
+  std::vector<std::unique_ptr<CloudServer>> servers(n_shards);
+
+  /* shard 0 first: it blocks the signals handled by SignalMonitor,
+     and the other threads inherit the signal mask */
+  servers.front() = std::make_unique<CloudServer>(cluster,
+                                                  *cluster.shards.front(),
+                                                  std::move(sockets.front()),
+                                                  enable_ogn);
+
+  for (auto &i : threads)
+    i->Start();
+
+  AtScopeExit(&threads) {
+    for (auto &i : threads)
+      i->Stop();
+  };
+
+  AtScopeExit(&cluster, &servers) {
+    /* destroy each CloudServer in its own thread */
+    for (unsigned i = 0; i < servers.size(); ++i)
+      BlockingCall(cluster.shards[i]->event_loop, [&servers, i](){
+        servers[i].reset();
+      });
+  };
+
+  for (unsigned i = 1; i < n_shards; ++i)
+    BlockingCall(cluster.shards[i]->event_loop, [&, i](){
+      servers[i] = std::make_unique<CloudServer>(cluster, *cluster.shards[i],
+                                                 std::move(sockets[i]),
+                                                 false);
+    });
+
   event_loop.Run();
 
-  server->Save();
+  cluster.Save();
 
   return EXIT_SUCCESS;
 } catch (const std::exception &exception) {
@@ -172,6 +172,18 @@ public:
     return list.empty();
   }
 
+  /**
+   * For iteration over all entries in unspecified order.  The
+   * iterators get invalidated by all modifying calls.
+   */
+  List::const_iterator begin() const noexcept {
+    return list.begin();
+  }
+
+  List::const_iterator end() const noexcept {
+    return list.end();
+  }
+
   [[gnu::pure]]
   OGNTrafficEntry *FindByPilotId(uint32_t pilot_id) const noexcept;
 
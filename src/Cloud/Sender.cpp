@@ -34,20 +34,35 @@ TrafficRecordExtensions::FromOgn(const OGNTrafficEntry &t) noexcept
                  t.flarm_id, t.flarm_valid, t.altitude_valid);
 }
 
-void
-TrafficResponseSender::Add(uint32_t pilot_id, uint32_t time,
-                           GeoPoint location, int altitude,
-                           TrafficRecordExtensions ext)
+SkyLinesTracking::TrafficResponsePacket::Traffic
+TrafficResponseSender::MakeTraffic(uint32_t pilot_id, uint32_t time,
+                                   GeoPoint location, int altitude,
+                                   TrafficRecordExtensions ext) noexcept
 {
-  assert(n_traffic < MAX_TRAFFIC);
-
-  auto &traffic = data.traffic[n_traffic++];
+  SkyLinesTracking::TrafficResponsePacket::Traffic traffic;
   traffic.pilot_id = ToBE32(pilot_id);
   traffic.time = ToBE32(time);
   traffic.location = SkyLinesTracking::ExportGeoPoint(location);
   traffic.altitude = ToBE16(altitude);
   traffic.reserved = ToBE16(ext.reserved);
   traffic.reserved2 = ToBE32(ext.reserved2);
+  return traffic;
+}
+
+void
+TrafficResponseSender::Add(uint32_t pilot_id, uint32_t time,
+                           GeoPoint location, int altitude,
+                           TrafficRecordExtensions ext)
+{
+  Add(MakeTraffic(pilot_id, time, location, altitude, ext));
+}
+
+void
+TrafficResponseSender::Add(const SkyLinesTracking::TrafficResponsePacket::Traffic &traffic)
+{
+  assert(n_traffic < MAX_TRAFFIC);
+
+  data.traffic[n_traffic++] = traffic;
 
   if (n_traffic == MAX_TRAFFIC)
     Flush();
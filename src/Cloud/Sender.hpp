@@ -78,9 +78,21 @@ public:
     data.header.reserved3 = 0;
   }
 
+  /**
+   * Encode one traffic record, e.g. for adding it to many responses
+   * with the other Add() overload.
+   */
+  [[gnu::pure]]
+  static SkyLinesTracking::TrafficResponsePacket::Traffic
+  MakeTraffic(uint32_t pilot_id, uint32_t time,
+              GeoPoint location, int altitude,
+              TrafficRecordExtensions ext = {}) noexcept;
+
   void Add(uint32_t pilot_id, uint32_t time,
            GeoPoint location, int altitude,
            TrafficRecordExtensions ext = {});
+
+  void Add(const SkyLinesTracking::TrafficResponsePacket::Traffic &traffic);
   void Flush();
 };
 
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Snapshot.hpp"
+#include "Client.hpp"
+
+/**
+ * Build an rtree with the (fast) packing algorithm.
+ */
+template<typename Tree, typename T>
+static Tree
+PackTree(const std::vector<T> &items)
+{
+  std::vector<typename Tree::value_type> values;
+  values.reserve(items.size());
+  for (const auto &i : items)
+    values.emplace_back(i.location, &i);
+
+  return Tree(values);
+}
+
+CloudSnapshot::CloudSnapshot(const CloudClientContainer &_clients,
+                             const OGNTrafficContainer *_ogn_traffic)
+{
+  for (const auto &i : _clients)
+    clients.push_back({
+      i.key, i.id, i.stamp, i.location, i.altitude,
+      i.track_deg, i.track_valid, i.aircraft_type,
+    });
+
+  client_tree = PackTree<Tree<Client>>(clients);
+
+  if (_ogn_traffic != nullptr) {
+    for (const auto &i : *_ogn_traffic)
+      ogn_traffic.emplace_back(i);
+
+    ogn_tree = PackTree<Tree<OGNTrafficEntry>>(ogn_traffic);
+
+    for (const auto &i : ogn_traffic)
+      ogn_by_pilot_id.emplace(i.pilot_id, &i);
+  }
+}
+
+const OGNTrafficEntry *
+CloudSnapshot::FindOgnTrafficByPilotId(uint32_t pilot_id) const noexcept
+{
+  auto i = ogn_by_pilot_id.find(pilot_id);
+  return i != ogn_by_pilot_id.end()
+    ? i->second
+    : nullptr;
+}
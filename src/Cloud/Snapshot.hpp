@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "OGNTraffic.hpp"
+#include "Geo/Boost/GeoPoint.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/strategies/strategies.hpp>
+#include <boost/range/iterator_range_core.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class CloudClientContainer;
+
+/**
+ * An immutable copy of the clients (and the OGN traffic) of one
+ * shard of a multi-threaded cloud server.  A shard publishes a new
+ * one periodically, and the other shards read it without locking.
+ */
+class CloudSnapshot {
+public:
+  /**
+   * A copy of the #CloudClient attributes needed for traffic
+   * responses.
+   */
+  struct Client {
+    uint64_t key;
+    unsigned id;
+    std::chrono::steady_clock::time_point stamp;
+    GeoPoint location;
+    int altitude;
+    unsigned track_deg;
+    bool track_valid;
+    unsigned aircraft_type;
+  };
+
+private:
+  template<typename T>
+  using Tree = boost::geometry::index::rtree<std::pair<GeoPoint, const T *>,
+                                             boost::geometry::index::rstar<16>>;
+
+  std::vector<Client> clients;
+  std::vector<OGNTrafficEntry> ogn_traffic;
+
+  Tree<Client> client_tree;
+  Tree<OGNTrafficEntry> ogn_tree;
+
+  std::unordered_map<uint32_t, const OGNTrafficEntry *> ogn_by_pilot_id;
+
+public:
+  /**
+   * @param ogn_traffic the OGN traffic to be copied; nullptr if this
+   * shard does not receive OGN traffic
+   */
+  CloudSnapshot(const CloudClientContainer &clients,
+                const OGNTrafficContainer *ogn_traffic);
+
+  CloudSnapshot(const CloudSnapshot &) = delete;
+  CloudSnapshot &operator=(const CloudSnapshot &) = delete;
+
+  template<typename T>
+  using query_iterator_range =
+    boost::iterator_range<typename Tree<T>::const_query_iterator>;
+
+  /**
+   * Query clients within the given range.  The iterator's value is a
+   * std::pair of location and "const Client *".
+   */
+  [[gnu::pure]]
+  query_iterator_range<Client> QueryClientsWithinRange(GeoPoint location,
+                                                       double range) const noexcept {
+    return Query(client_tree, location, range);
+  }
+
+  [[gnu::pure]]
+  query_iterator_range<OGNTrafficEntry> QueryOgnTrafficWithinRange(GeoPoint location,
+                                                                   double range) const noexcept {
+    return Query(ogn_tree, location, range);
+  }
+
+  [[gnu::pure]]
+  const OGNTrafficEntry *FindOgnTrafficByPilotId(uint32_t pilot_id) const noexcept;
+
+private:
+  template<typename T>
+  static query_iterator_range<T> Query(const Tree<T> &tree,
+                                       GeoPoint location,
+                                       double range) noexcept {
+    const auto q =
+      boost::geometry::index::intersects(BoostRangeBox(location, range));
+    return {tree.qbegin(q), tree.qend()};
+  }
+};
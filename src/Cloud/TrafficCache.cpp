@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "TrafficCache.hpp"
+#include "Client.hpp"
+#include "Geo/GeoBounds.hpp"
+
+#include <algorithm>
+
+NearTrafficCache::CellQuery
+NearTrafficCache::GetCellQuery(unsigned cell, double range) noexcept
+{
+  /* by the triangle inequality, everything within the range of any
+     location inside the grid cell is within this range of the cell's
+     center */
+  const auto bounds = CloudClientContainer::GetGridCellBounds(cell);
+  const auto center = bounds.GetCenter();
+  return {
+    center,
+    range + std::max(center.Distance(bounds.GetNorthWest()),
+                     center.Distance(bounds.GetSouthWest())),
+  };
+}
+
+const NearTrafficCache::Cell *
+NearTrafficCache::Get(unsigned cell,
+                      std::chrono::steady_clock::time_point now) const noexcept
+{
+  auto i = cells.find(cell);
+  return i != cells.end() && now < i->second.expires
+    ? &i->second
+    : nullptr;
+}
+
+NearTrafficCache::Cell &
+NearTrafficCache::Make(unsigned cell,
+                       std::chrono::steady_clock::time_point expires)
+{
+  auto &c = cells[cell];
+  c.expires = expires;
+
+  /* keep the allocated memory for the new items */
+  c.items.clear();
+  return c;
+}
+
+void
+NearTrafficCache::Expire(std::chrono::steady_clock::time_point now) noexcept
+{
+  std::erase_if(cells, [now](const auto &i){
+    return now >= i.second.expires;
+  });
+}
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Geo/GeoPoint.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Caches the traffic near each #CloudClientContainer grid cell,
+ * already encoded for #SkyLinesTracking::TrafficResponsePacket.  In
+ * dense areas, many clients of the same cell receive traffic
+ * responses within a short time; they share one query and one
+ * encoding, and only the filter and the packet header are done per
+ * recipient.
+ */
+class NearTrafficCache {
+public:
+  struct Item {
+    /**
+     * Location and altitude of the traffic, for the per-recipient
+     * filter.
+     */
+    GeoPoint location;
+    int altitude;
+    bool altitude_valid;
+
+    /**
+     * Is this OGN traffic?  If not, it is a cloud client.
+     */
+    bool ogn;
+
+    /**
+     * The secret key of the cloud client, to skip the recipient
+     * itself.  Not used for OGN traffic.
+     */
+    uint64_t key;
+
+    SkyLinesTracking::TrafficResponsePacket::Traffic traffic;
+
+    /**
+     * The callsign of OGN traffic, which is sent along with it.
+     */
+    std::string callsign;
+  };
+
+  /**
+   * A circle which contains everything within a given range of any
+   * location inside a #CloudClientContainer grid cell.
+   */
+  struct CellQuery {
+    GeoPoint center;
+    double range;
+  };
+
+  struct Cell {
+    std::chrono::steady_clock::time_point expires;
+
+    /**
+     * All traffic which may be relevant to a client in this cell, in
+     * order of priority.
+     */
+    std::vector<Item> items;
+  };
+
+private:
+  std::unordered_map<unsigned, Cell> cells;
+
+public:
+  /**
+   * Determine the query for filling a cell: the given range plus the
+   * distance from the cell's center to its farthest corner.
+   */
+  [[gnu::const]]
+  static CellQuery GetCellQuery(unsigned cell, double range) noexcept;
+
+  /**
+   * Look up a cell.
+   *
+   * @return nullptr if the cell is not cached or has expired
+   */
+  [[gnu::pure]]
+  const Cell *Get(unsigned cell,
+                  std::chrono::steady_clock::time_point now) const noexcept;
+
+  /**
+   * Clear the given cell, to be filled by the caller.
+   */
+  Cell &Make(unsigned cell, std::chrono::steady_clock::time_point expires);
+
+  /**
+   * Remove all expired cells.
+   */
+  void Expire(std::chrono::steady_clock::time_point now) noexcept;
+};
@@ -3,15 +3,45 @@
 
 #include "ContestComputer.hpp"
 #include "Engine/Contest/Settings.hpp"
+#include "thread/ThreadPool.hpp"
+#include "LogFile.hpp"
+
+#include <algorithm>
+
+/**
+ * The maximum number of solvers which ContestManager runs in
+ * parallel.
+ */
+static constexpr unsigned MAX_PARALLEL_SOLVERS = 3;
+
+static std::unique_ptr<ThreadPool>
+CreateSolverPool() noexcept
+try {
+  const unsigned n_cpus = ThreadPool::GetHardwareConcurrency();
+  if (n_cpus < 2)
+    return nullptr;
+
+  /* the calculation thread is the remaining solver thread */
+  return std::make_unique<ThreadPool>("ContestSolver",
+                                      std::min(n_cpus,
+                                               MAX_PARALLEL_SOLVERS) - 1);
+} catch (...) {
+  LogError(std::current_exception(), "Failed to start contest solvers");
+  return nullptr;
+}
 
 ContestComputer::ContestComputer(const Trace &trace_full,
                                  const Trace &trace_triangle,
                                  const Trace &trace_sprint)
-  :contest_manager(Contest::OLC_SPRINT, trace_full, trace_triangle, trace_sprint, true)
+  :pool(CreateSolverPool()),
+   contest_manager(Contest::OLC_SPRINT, trace_full, trace_triangle, trace_sprint, true)
 {
   contest_manager.SetIncremental(true);
+  contest_manager.SetThreadPool(pool.get());
 }
 
+ContestComputer::~ContestComputer() noexcept = default;
+
 void
 ContestComputer::Solve(const ContestSettings &settings,
                        ContestStatistics &contest_stats)
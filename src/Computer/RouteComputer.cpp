@@ -7,14 +7,35 @@
 #include "NMEA/Derived.hpp"
 #include "NMEA/Aircraft.hpp"
 #include "Navigation/Aircraft.hpp"
+#include "thread/ThreadPool.hpp"
+#include "LogFile.hpp"
 
 #include <algorithm>
 
+static std::unique_ptr<ThreadPool>
+CreateReachPool() noexcept
+try {
+  const unsigned n_cpus = ThreadPool::GetHardwareConcurrency();
+  if (n_cpus < 2)
+    return nullptr;
+
+  /* the calculation thread helps while waiting */
+  return std::make_unique<ThreadPool>("ReachSolver", n_cpus - 1);
+} catch (...) {
+  LogError(std::current_exception(), "Failed to start reach solvers");
+  return nullptr;
+}
+
 RouteComputer::RouteComputer(const Airspaces &airspace_database,
                              const ProtectedAirspaceWarningManager *warnings)
-  :protected_route_planner(route_planner, airspace_database, warnings),
+  :pool(CreateReachPool()),
+   protected_route_planner(route_planner, airspace_database, warnings),
    terrain(NULL)
-{}
+{
+  route_planner.SetThreadPool(pool.get());
+}
+
+RouteComputer::~RouteComputer() noexcept = default;
 
 void
 RouteComputer::ResetFlight()
@@ -123,7 +144,7 @@ RouteComputer::Reach(const MoreData &basic, DerivedInfo &calculated,
   const int h_ceiling(std::max((int)basic.nav_altitude + 500,
                                (int)calculated.common_stats.height_max_working));
 
-  if (reach_clock.CheckAdvance(basic.time, PERIOD)) {
+  if (reach_clock.CheckAdvance(basic.time, REACH_PERIOD)) {
     protected_route_planner.SolveReach(start, config, h_ceiling, do_solve);
 
     if (do_solve) {
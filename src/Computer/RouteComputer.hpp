@@ -8,6 +8,8 @@
 #include "Engine/Route/RoutePlanner.hpp"
 #include "time/GPSClock.hpp"
 
+#include <memory>
+
 struct MoreData;
 struct DerivedInfo;
 struct GlideSettings;
@@ -15,10 +17,23 @@ struct RoutePlannerConfig;
 class ProtectedAirspaceWarningManager;
 class RasterTerrain;
 class GlidePolar;
+class ThreadPool;
 
 class RouteComputer {
   static constexpr std::chrono::steady_clock::duration PERIOD = std::chrono::seconds(5);
 
+  /**
+   * The reach is updated more often than the route, because
+   * ReachFan::Solve() reuses most of the previous solution.
+   */
+  static constexpr std::chrono::steady_clock::duration REACH_PERIOD = std::chrono::seconds(1);
+
+  /**
+   * Worker threads for the reach calculation; nullptr on
+   * single-core machines.
+   */
+  std::unique_ptr<ThreadPool> pool;
+
   RoutePlannerGlue route_planner;
   ProtectedRoutePlanner protected_route_planner;
 
@@ -33,6 +48,7 @@ class RouteComputer {
 public:
   RouteComputer(const Airspaces &airspace_database,
                 const ProtectedAirspaceWarningManager *warnings);
+  ~RouteComputer() noexcept;
 
   const ProtectedRoutePlanner &GetProtectedRoutePlanner() const {
     return protected_route_planner;
@@ -1777,10 +1777,28 @@ DeviceDescriptor::LineReceived(const char *line) noexcept
   if (dispatcher != nullptr)
     dispatcher->LineReceived(line);
 
-  const auto e = BeginEdit();
-  e->UpdateClock();
-  ParseNMEA(line, *e);
-  e.Commit();
+  if (!line_batch_pending) {
+    /* the first line of this chunk: parse into a copy of the
+       device's data, to avoid holding the DeviceBlackboard mutex
+       while parsing */
+    if (!line_batch)
+      line_batch = std::make_unique<NMEAInfo>();
+
+    blackboard.LockGetDeviceDataUpdateClock(index, *line_batch);
+    line_batch_pending = true;
+  }
+
+  ParseNMEA(line, *line_batch);
 
   return true;
 }
+
+void
+DeviceDescriptor::EndOfLines() noexcept
+{
+  if (!line_batch_pending)
+    return;
+
+  line_batch_pending = false;
+  blackboard.LockSetDeviceDataScheduleMerge(index, *line_batch);
+}
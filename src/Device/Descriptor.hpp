@@ -133,6 +133,19 @@ class DeviceDescriptor final
    */
   PortLineHandler *dispatcher = nullptr;
 
+  /**
+   * A copy of the device's data which NMEA lines are parsed into.
+   * All lines from one port read are collected here and then
+   * published with one DeviceBlackboard lock and one MergeThread
+   * wakeup, see EndOfLines().  Allocated on demand.
+   */
+  std::unique_ptr<NMEAInfo> line_batch;
+
+  /**
+   * Does #line_batch contain data which has not yet been published?
+   */
+  bool line_batch_pending = false;
+
   /**
    * The device driver used to handle data to/from the device.
    */
@@ -635,6 +648,9 @@ private:
   /* virtual methods from PortLineHandler */
   bool LineReceived(const char *line) noexcept override;
 
+  /* virtual methods from PortLineSplitter */
+  void EndOfLines() noexcept override;
+
   void OnReopenTimer() noexcept;
 
 #ifdef HAVE_INTERNAL_GPS
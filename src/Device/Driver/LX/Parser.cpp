@@ -5,6 +5,7 @@
 #include "Parsers.hpp"
 #include "NMEA/Checksum.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/SentenceTable.hpp"
 #include "NMEA/Info.hpp"
 #include "Geo/SpeedVector.hpp"
 #include "RadioFrequency.hpp"
@@ -751,6 +752,32 @@ LXDevice::UpdateDeviceFlags(const DeviceInfo &device_info,
   }
 }
 
+/**
+ * All sentences understood by LXDevice::ParseNMEA().
+ */
+enum class LXSentence : uint8_t {
+  UNKNOWN,
+  LXWP0,
+  LXWP1,
+  LXWP2,
+  LXWP3,
+  PLXV0,
+  PLXVC,
+  PLXVF,
+  PLXVS,
+};
+
+static constexpr auto lx_sentences = MakeNMEASentenceTable<LXSentence>({
+  {"$LXWP0"sv, LXSentence::LXWP0},
+  {"$LXWP1"sv, LXSentence::LXWP1},
+  {"$LXWP2"sv, LXSentence::LXWP2},
+  {"$LXWP3"sv, LXSentence::LXWP3},
+  {"$PLXV0"sv, LXSentence::PLXV0},
+  {"$PLXVC"sv, LXSentence::PLXVC},
+  {"$PLXVF"sv, LXSentence::PLXVF},
+  {"$PLXVS"sv, LXSentence::PLXVS},
+});
+
 bool
 LXDevice::ParseNMEA(const char *String, NMEAInfo &info)
 {
@@ -759,12 +786,15 @@ LXDevice::ParseNMEA(const char *String, NMEAInfo &info)
 
   NMEAInputLine line(String);
 
-  const auto type = line.ReadView();
-  if (type == "$LXWP0"sv)
+  switch (lx_sentences.Get(line.ReadView(), LXSentence::UNKNOWN)) {
+  case LXSentence::UNKNOWN:
+    break;
+
+  case LXSentence::LXWP0:
     return LX::LXWP0(line, info,
                       !(plxvf_received || IsLXNAVVario()));
 
-  if (type == "$LXWP1"sv) {
+  case LXSentence::LXWP1: {
     DeviceInfo &device_info = mode == Mode::PASS_THROUGH
       ? info.secondary_device
       : info.device;
@@ -773,18 +803,17 @@ LXDevice::ParseNMEA(const char *String, NMEAInfo &info)
     return true;
   }
 
-  if (type == "$LXWP2"sv)
+  case LXSentence::LXWP2:
     return LX::LXWP2(line, info);
 
-  if (type == "$LXWP3"sv)
+  case LXSentence::LXWP3:
     return LX::LXWP3(line, info);
 
-  if (type == "$PLXV0"sv) {
+  case LXSentence::PLXV0:
     is_colibri = false;
     return PLXV0(line, lxnav_vario_settings, info);
-  }
 
-  if (type == "$PLXVC"sv) {
+  case LXSentence::PLXVC:
     is_colibri = false;
     PLXVC(line, info, nano_settings, device_declaration, mutex);
 
@@ -798,15 +827,13 @@ LXDevice::ParseNMEA(const char *String, NMEAInfo &info)
         vario_just_detected = true;
     }
     return true;
-  }
 
-  if (type == "$PLXVF"sv) {
+  case LXSentence::PLXVF:
     is_colibri = false;
     plxvf_received = true;
     return PLXVF(line, info);
-  }
 
-  if (type == "$PLXVS"sv) {
+  case LXSentence::PLXVS:
     is_colibri = false;
     return PLXVS(line, info);
   }
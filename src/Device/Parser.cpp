@@ -8,6 +8,7 @@
 #include "NMEA/Info.hpp"
 #include "NMEA/Checksum.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/SentenceTable.hpp"
 #include "Units/System.hpp"
 #include "Driver/FLARM/StaticParser.hpp"
 #include "util/CharUtil.hxx"
@@ -29,6 +30,75 @@ NMEAParser::Reset()
   last_time = {};
 }
 
+/**
+ * All sentences understood by NMEAParser::ParseLine().
+ */
+enum class Sentence : uint8_t {
+  UNKNOWN,
+
+  /* standard sentences, with a two-letter talker id */
+  GSA,
+  GLL,
+  RMC,
+  GGA,
+  HDM,
+  MWV,
+
+  /* proprietary sentences */
+  LK8EX1,
+  PTAS1,
+  PFLAE,
+  PFLAV,
+  PFLAA,
+  PFLAU,
+  PFLAJ,
+  PFLAQ,
+  PFLAM,
+  PGRMZ,
+};
+
+/**
+ * Standard sentence types without the "$" and the talker id.
+ */
+static constexpr auto standard_sentences = MakeNMEASentenceTable<Sentence>({
+  {"GSA"sv, Sentence::GSA},
+  {"GLL"sv, Sentence::GLL},
+  {"RMC"sv, Sentence::RMC},
+  {"GGA"sv, Sentence::GGA},
+  {"HDM"sv, Sentence::HDM},
+  {"MWV"sv, Sentence::MWV},
+});
+
+/**
+ * Proprietary sentence types without the "$".
+ */
+static constexpr auto proprietary_sentences = MakeNMEASentenceTable<Sentence>({
+  {"LK8EX1"sv, Sentence::LK8EX1},
+  {"PTAS1"sv, Sentence::PTAS1},
+  {"PFLAE"sv, Sentence::PFLAE},
+  {"PFLAV"sv, Sentence::PFLAV},
+  {"PFLAA"sv, Sentence::PFLAA},
+  {"PFLAU"sv, Sentence::PFLAU},
+  {"PFLAJ"sv, Sentence::PFLAJ},
+  {"PFLAQ"sv, Sentence::PFLAQ},
+  {"PFLAM"sv, Sentence::PFLAM},
+  {"PGRMZ"sv, Sentence::PGRMZ},
+});
+
+[[gnu::pure]]
+static Sentence
+IdentifySentence(std::string_view type) noexcept
+{
+  if (type.size() < 6)
+    return Sentence::UNKNOWN;
+
+  if (type.size() == 6 && IsAlphaASCII(type[1]) && IsAlphaASCII(type[2]))
+    if (const auto *s = standard_sentences.Find(type.substr(3)))
+      return *s;
+
+  return proprietary_sentences.Get(type.substr(1), Sentence::UNKNOWN);
+}
+
 bool
 NMEAParser::ParseLine(const char *string, NMEAInfo &info)
 {
@@ -42,87 +112,71 @@ NMEAParser::ParseLine(const char *string, NMEAInfo &info)
 
   NMEAInputLine line(string);
 
-  const auto type = line.ReadView();
-  if (type.size() < 6)
-    return false;
-
-  if (type == "$LK8EX1"sv)
-    return LK8EX1(line, info);
-
-  if (IsAlphaASCII(type[1]) && IsAlphaASCII(type[2])) {
-    const auto type2 = type.substr(3);
-
-    if (type2 == "GSA"sv)
-      return GSA(line, info);
+  switch (IdentifySentence(line.ReadView())) {
+  case Sentence::UNKNOWN:
+    break;
 
-    if (type2 == "GLL"sv)
-      return GLL(line, info);
+  case Sentence::GSA:
+    return GSA(line, info);
 
-    if (type2 == "RMC"sv)
-      return RMC(line, info);
+  case Sentence::GLL:
+    return GLL(line, info);
 
-    if (type2 == "GGA"sv)
-      return GGA(line, info);
+  case Sentence::RMC:
+    return RMC(line, info);
 
-    if (type2 == "HDM"sv)
-      return HDM(line, info);
+  case Sentence::GGA:
+    return GGA(line, info);
 
-    if (type2 == "MWV"sv)
-      return MWV(line, info);
-  }
+  case Sentence::HDM:
+    return HDM(line, info);
 
-  // if (proprietary sentence) ...
-  if (type[1] == 'P') {
-    const auto type2 = type.substr(1);
+  case Sentence::MWV:
+    return MWV(line, info);
 
-    // Airspeed and vario sentence
-    if (type2 == "PTAS1"sv)
-      return PTAS1(line, info);
+  case Sentence::LK8EX1:
+    return LK8EX1(line, info);
 
-    // FLARM sentences
-    if (type2 == "PFLAE"sv) {
-      ParsePFLAE(line, info.flarm.error, info.clock);
-      return true;
-    }
+  // Airspeed and vario sentence
+  case Sentence::PTAS1:
+    return PTAS1(line, info);
 
-    if (type2 == "PFLAV"sv) {
-      ParsePFLAV(line, info.flarm.version, info.clock);
-      return true;
-    }
+  // FLARM sentences
+  case Sentence::PFLAE:
+    ParsePFLAE(line, info.flarm.error, info.clock);
+    return true;
 
-    if (type2 == "PFLAA"sv) {
-      RangeFilter range;
-      range.horizontal=0;
-      range.vertical=0;
-      ParsePFLAA(line, info.flarm.traffic, info.clock, range);
-      return true;
-    }
+  case Sentence::PFLAV:
+    ParsePFLAV(line, info.flarm.version, info.clock);
+    return true;
 
-    if (type2 == "PFLAU"sv) {
-      ParsePFLAU(line, info.flarm.status, info.clock);
-      return true;
-    }
+  case Sentence::PFLAA: {
+    RangeFilter range;
+    range.horizontal=0;
+    range.vertical=0;
+    ParsePFLAA(line, info.flarm.traffic, info.clock, range);
+    return true;
+  }
 
-    if (type2 == "PFLAJ"sv) {
-      ParsePFLAJ(line, info.flarm.state, info.clock);
-      return true;
-    }
+  case Sentence::PFLAU:
+    ParsePFLAU(line, info.flarm.status, info.clock);
+    return true;
 
-    if (type2 == "PFLAQ"sv) {
-      ParsePFLAQ(line, info.flarm.progress, info.clock);
-      return true;
-    }
+  case Sentence::PFLAJ:
+    ParsePFLAJ(line, info.flarm.state, info.clock);
+    return true;
 
-    if (type2 == "PFLAM"sv) {
-      ParsePFLAM(line);
-      return true;
-    }
+  case Sentence::PFLAQ:
+    ParsePFLAQ(line, info.flarm.progress, info.clock);
+    return true;
 
-    // Garmin altitude sentence
-    if (type2 == "PGRMZ"sv)
-      return RMZ(line, info);
+  case Sentence::PFLAM:
+    ParsePFLAM(line);
+    return true;
 
-    return false;
+  // Garmin altitude sentence
+  case Sentence::PGRMZ:
+    return RMZ(line, info);
   }
 
   return false;
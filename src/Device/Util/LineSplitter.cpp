@@ -68,10 +68,13 @@ PortLineSplitter::DataReceived(std::span<const std::byte> s) noexcept
       while ((nul = memchr(line, 0, end - line)) != nullptr)
         line = (char *)nul + 1;
 
-      if (!LineReceived(line))
+      if (!LineReceived(line)) {
+        EndOfLines();
         return false;
+      }
     }
   } while (data < end);
 
+  EndOfLines();
   return true;
 }
@@ -12,6 +12,15 @@ class PortLineSplitter : public DataHandler, protected PortLineHandler {
 
   Buffer buffer;
 
+protected:
+  /**
+   * Called after all complete lines from one DataReceived() call
+   * have been passed to LineReceived().  This allows implementations
+   * to collect the results of all those lines and publish them at
+   * once.
+   */
+  virtual void EndOfLines() noexcept {}
+
 public:
   /* virtual methods from class DataHandler */
   bool DataReceived(std::span<const std::byte> s) noexcept override;
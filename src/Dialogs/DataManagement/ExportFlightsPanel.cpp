@@ -37,6 +37,7 @@
 #include <cstring>
 
 static constexpr char EXPORT_FLIGHTS_SUBFOLDER[] = "xcsoar_flights";
+static constexpr char IGC_META_INDEX_FILE[] = "igc-meta.idx";
 
 static IgcMetaCache igc_cache;
 
@@ -294,6 +295,9 @@ struct FlightContainer : public PropertyWidgetContainer {
   void Prepare(ContainerWindow &parent, const PixelRect &rc) noexcept override {
     PropertyWidgetContainer::Prepare(parent, rc);
 
+    igc_cache.LoadIndex(AllocatedPath::Build(GetCachePath(),
+                                             IGC_META_INDEX_FILE));
+
     const DialogLook &look = UIGlobals::GetDialogLook();
     if (!nmea_checkbox)
       nmea_checkbox = std::make_unique<CheckBoxControl>();
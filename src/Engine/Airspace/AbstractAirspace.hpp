@@ -246,6 +246,10 @@ public:
     days_of_operation = mask;
   }
 
+  AirspaceActivity GetDays() const noexcept {
+    return days_of_operation;
+  }
+
   /**
    * Get asclass of airspace
    *
@@ -413,7 +417,7 @@ public:
 
 protected:
   /** Project border */
-  void Project(const FlatProjection &tp) noexcept;
+  virtual void Project(const FlatProjection &tp) noexcept;
 
 private:
   /**
@@ -55,7 +55,11 @@ AirspacePolygon::GetCenter() const noexcept
 bool
 AirspacePolygon::Inside(const GeoPoint &loc) const noexcept
 {
-  return m_border.IsInside(loc);
+  if (edges.empty())
+    /* not projected yet */
+    return m_border.IsInside(loc);
+
+  return edges.IsInside(loc);
 }
 
 AirspaceIntersectionVector
@@ -67,17 +71,20 @@ AirspacePolygon::Intersects(const GeoPoint &start, const GeoPoint &end,
 
   AirspaceIntersectSort sorter(start, *this);
 
-  for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it) {
-
-    const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
-    auto t = ray.DistinctIntersection(r_seg);
-    if (t >= 0)
-      sorter.add(t, projection.Unproject(ray.Parametric(t)));
-  }
+  edges.VisitIntersections(ray, [&](double t){
+    sorter.add(t, projection.Unproject(ray.Parametric(t)));
+  });
 
   return sorter.all();
 }
 
+void
+AirspacePolygon::Project(const FlatProjection &projection) noexcept
+{
+  AbstractAirspace::Project(projection);
+  edges.Update(m_border);
+}
+
 GeoPoint
 AirspacePolygon::ClosestPoint(const GeoPoint &loc,
                               const FlatProjection &projection) const noexcept
@@ -4,6 +4,8 @@
 #pragma once
 
 #include "AbstractAirspace.hpp"
+#include "Geo/PolygonEdges.hpp"
+
 #include <vector>
 
 #ifdef DO_PRINT
@@ -12,6 +14,12 @@
 
 /** General polygon form airspace */
 class AirspacePolygon final : public AbstractAirspace {
+  /**
+   * A copy of #m_border for the fast inside and intersection tests,
+   * updated each time the border is projected.
+   */
+  PolygonEdges edges;
+
 public:
   /**
    * Constructor.  For testing, pts vector is a cloud of points,
@@ -29,6 +37,8 @@ public:
   void MakeConvex() noexcept {
     m_border.PruneInterior();
     is_convex = TriState::TRUE;
+    /* rebuilt by the next Project() call */
+    edges.Clear();
   }
 
   /* virtual methods from class AbstractAirspace */
@@ -41,6 +51,9 @@ public:
   GeoPoint ClosestPoint(const GeoPoint &loc,
                         const FlatProjection &projection) const noexcept override;
 
+protected:
+  void Project(const FlatProjection &projection) noexcept override;
+
 public:
 #ifdef DO_PRINT
   friend std::ostream &operator<<(std::ostream &f,
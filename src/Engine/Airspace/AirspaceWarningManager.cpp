@@ -11,6 +11,10 @@
 #include "util/PrintException.hxx"
 #include "LogFileDecl.hpp"
 
+#include <boost/geometry/algorithms/intersects.hpp>
+#include <boost/geometry/geometries/segment.hpp>
+#include <boost/geometry/strategies/strategies.hpp>
+
 static constexpr double CRUISE_FILTER_FACT = 0.5;
 
 /**
@@ -170,10 +174,11 @@ AirspaceWarningManager::Update(const AircraftState& state,
     w.SaveState();
 
   // check from strongest to weakest alerts
-  UpdateInside(state, glide_polar);
-  UpdateGlide(state, glide_polar);
-  UpdateFilter(state, circling);
-  UpdateTask(state, glide_polar, task_stats);
+  PredictionList predictions;
+  PredictGlide(state, glide_polar, predictions);
+  PredictFilter(state, circling, predictions);
+  PredictTask(state, glide_polar, task_stats, predictions);
+  Sweep(state, glide_polar, predictions);
 
   // action changes
   for (auto it = warnings.begin(), end = warnings.end(); it != end;) {
@@ -203,12 +208,11 @@ AirspaceWarningManager::Update(const AircraftState& state,
 class AirspaceIntersectionWarningVisitor final
   : public AirspaceIntersectionVisitor
 {
-  const AircraftState state;
+  const AircraftState &state;
   const AirspaceAircraftPerformance &perf;
   AirspaceWarningManager &warning_manager;
   const AirspaceWarning::State warning_state;
   const FloatDuration max_time;
-  bool found = false;
   const double max_alt;
   bool mode_inside = false;
 
@@ -276,7 +280,6 @@ public:
           warning = warning_manager.GetNewWarningPtr(std::move(airspace_ptr));
 
         warning->UpdateSolution(warning_state, solution);
-        found = true;
       }
     } catch (const std::exception &e) {
       LogFormat("Airspace intersection failed: %s", e.what());
@@ -297,15 +300,6 @@ public:
     Intersection(as);
   }
 
-  /**
-   * Determine whether intersections for this type were found (new or modified)
-   *
-   * @return True if intersections were found
-   */
-  bool Found() const {
-    return found;
-  }
-
   void SetMode(bool m) {
     mode_inside = m;
   }
@@ -320,68 +314,25 @@ private:
 };
 
 
-bool 
-AirspaceWarningManager::UpdatePredicted(const AircraftState& state, 
-                                        const GeoPoint &location_predicted,
-                                        const AirspaceAircraftPerformance &perf,
-                                        const AirspaceWarning::State warning_state,
-                                        const FloatDuration max_time) noexcept
-{
-  // this is the time limit of intrusions, beyond which we are not interested.
-  // it can be the minimum of the user set warning time, or the time of the 
-  // task segment
-
-  const auto max_time_limit = std::min(FloatDuration{config.warning_time},
-                                       max_time);
-
-  // the ceiling is the max height for predicted intrusions, given
-  // that you may be climbing.  the ceiling is nominally set at 1000m
-  // above the current altitude, but the 1000m margin should be at
-  // least as big as config.AltWarningMargin since if the airspace is
-  // visible according to that display mode, it should have warnings
-  // collected for it.  It is very unlikely users will have more than 1000m
-  // in AltWarningMargin anyway.
-
-  const auto ceiling = state.altitude
-    + std::max((unsigned)1000, config.altitude_warning_margin);
-
-  AirspaceIntersectionWarningVisitor visitor(state, perf, 
-                                             *this, 
-                                             warning_state, max_time_limit,
-                                             ceiling);
-
-  airspaces.VisitIntersecting(state.location, location_predicted, visitor);
-
-  visitor.SetMode(true);
-
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    visitor.Visit(i.GetAirspacePtr());
-  }
-
-  return visitor.Found();
-}
-
-
-bool 
-AirspaceWarningManager::UpdateTask(const AircraftState &state,
-                                   const GlidePolar &glide_polar,
-                                   const TaskStats &task_stats)
+void
+AirspaceWarningManager::PredictTask(const AircraftState &state,
+                                    const GlidePolar &glide_polar,
+                                    const TaskStats &task_stats,
+                                    PredictionList &predictions) const noexcept
 {
   if (!glide_polar.IsValid())
-    return false;
+    return;
 
   const ElementStat &current_leg = task_stats.current_leg;
 
   if (!task_stats.task_valid || !current_leg.location_remaining.IsValid())
-    return false;
+    return;
 
   const GlideResult &solution = current_leg.solution_remaining;
   if (!solution.IsOk() || !solution.IsAchievable())
     /* glide solver failed, cannot continue */
-    return false;
+    return;
 
-  const AirspaceAircraftPerformance perf_task(glide_polar,
-                                              current_leg.solution_remaining);
   GeoPoint location_tp = current_leg.location_remaining;
   const auto time_remaining = solution.time_elapsed;
 
@@ -392,86 +343,153 @@ AirspaceWarningManager::UpdateTask(const AircraftState &state,
        the configured warning time */
     location_tp = state.location.IntermediatePoint(location_tp, max_distance);
 
-  return UpdatePredicted(state, location_tp, perf_task,
-                          AirspaceWarning::WARNING_TASK, time_remaining);
+  predictions.push_back({
+    location_tp,
+    AirspaceAircraftPerformance(glide_polar, solution),
+    AirspaceWarning::WARNING_TASK,
+    std::min(FloatDuration{config.warning_time}, time_remaining),
+  });
 }
 
-
-bool 
-AirspaceWarningManager::UpdateFilter(const AircraftState& state, const bool circling)
+void
+AirspaceWarningManager::PredictFilter(const AircraftState &state,
+                                      const bool circling,
+                                      PredictionList &predictions) noexcept
 {
   // update both filters even though we are using only one
   cruise_filter.Update(state);
   circling_filter.Update(state);
 
-  const GeoPoint location_predicted = circling?
-    circling_filter.GetPredictedState(prediction_time_filter).location:
-    cruise_filter.GetPredictedState(prediction_time_filter).location;
-
-  if (circling) 
-    return UpdatePredicted(state, location_predicted,
-                           AirspaceAircraftPerformance(circling_filter),
-                            AirspaceWarning::WARNING_FILTER, prediction_time_filter);
-  else
-    return UpdatePredicted(state, location_predicted,
-                           AirspaceAircraftPerformance(cruise_filter),
-                            AirspaceWarning::WARNING_FILTER, prediction_time_filter);
-}
+  const AircraftStateFilter &filter = circling
+    ? circling_filter
+    : cruise_filter;
 
+  predictions.push_back({
+    filter.GetPredictedState(prediction_time_filter).location,
+    AirspaceAircraftPerformance(filter),
+    AirspaceWarning::WARNING_FILTER,
+    std::min(FloatDuration{config.warning_time}, prediction_time_filter),
+  });
+}
 
-bool 
-AirspaceWarningManager::UpdateGlide(const AircraftState &state,
-                                    const GlidePolar &glide_polar)
+void
+AirspaceWarningManager::PredictGlide(const AircraftState &state,
+                                     const GlidePolar &glide_polar,
+                                     PredictionList &predictions) const noexcept
 {
   if (!glide_polar.IsValid())
-    return false;
-
-  const GeoPoint location_predicted = 
-    state.GetPredictedState(prediction_time_glide).location;
-
-  const AirspaceAircraftPerformance perf_glide(glide_polar);
-  return UpdatePredicted(state, location_predicted,
-                          perf_glide,
-                          AirspaceWarning::WARNING_GLIDE, prediction_time_glide);
+    return;
+
+  predictions.push_back({
+    state.GetPredictedState(prediction_time_glide).location,
+    AirspaceAircraftPerformance(glide_polar),
+    AirspaceWarning::WARNING_GLIDE,
+    std::min(FloatDuration{config.warning_time}, prediction_time_glide),
+  });
 }
 
-bool
-AirspaceWarningManager::UpdateInside(const AircraftState& state,
-                                     const GlidePolar &glide_polar)
+void
+AirspaceWarningManager::Sweep(const AircraftState &state,
+                              const GlidePolar &glide_polar,
+                              const PredictionList &predictions)
 {
-  if (!glide_polar.IsValid())
-    return false;
+  const FlatProjection &projection = GetProjection();
+  const auto flat_location = projection.ProjectInteger(state.location);
+
+  /* query the R-tree only once with the bounding box of all
+     predicted paths; the bounding box of each candidate is then
+     checked against the paths, just like
+     Airspaces::QueryIntersecting() would do */
+  FlatBoundingBox box(flat_location, flat_location);
+  StaticArray<boost::geometry::model::segment<FlatGeoPoint>, 3> segments;
+  for (const auto &prediction : predictions) {
+    const auto flat_end = projection.ProjectInteger(prediction.location);
+    box.Expand(flat_end);
+    segments.emplace_back(flat_location, flat_end);
+  }
 
-  bool found = false;
+  // the ceiling is the max height for predicted intrusions, given
+  // that you may be climbing.  the ceiling is nominally set at 1000m
+  // above the current altitude, but the 1000m margin should be at
+  // least as big as config.AltWarningMargin since if the airspace is
+  // visible according to that display mode, it should have warnings
+  // collected for it.  It is very unlikely users will have more than 1000m
+  // in AltWarningMargin anyway.
+
+  const auto ceiling = state.altitude
+    + std::max((unsigned)1000, config.altitude_warning_margin);
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    const auto airspace = i.GetAirspacePtr();
+  for (const auto &i : airspaces.QueryIntersecting(box)) {
+    const AbstractAirspace &airspace = i.GetAirspace();
 
-    const AltitudeState &altitude = state;
     if (// ignore inactive airspaces
-        !airspace->IsActive() ||
-        !(config.IsClassEnabled(airspace->GetClassOrType()) || config.IsClassEnabled(airspace->GetTypeOrClass())) ||
-        !airspace->Inside(altitude))
+        !airspace.IsActive() ||
+        !(config.IsClassEnabled(airspace.GetClassOrType()) ||
+          config.IsClassEnabled(airspace.GetTypeOrClass())))
       continue;
 
-    AirspaceWarning *warning = GetWarningPtr(*airspace);
-
-    if (warning == nullptr ||
-        warning->IsStateAccepted(AirspaceWarning::WARNING_INSIDE)) {
-      GeoPoint c = airspace->ClosestPoint(state.location, GetProjection());
-      const AirspaceAircraftPerformance perf_glide(glide_polar);
-      const AirspaceInterceptSolution solution =
-        airspace->Intercept(state, c, GetProjection(), perf_glide);
-
-      if (warning == nullptr)
-        warning = GetNewWarningPtr(airspace);
+    /* prune by altitude before doing any geometry: the predictions
+       ignore airspaces whose base is above the ceiling, and the
+       aircraft cannot be inside them (unless the base is the
+       terrain, which is always "below" the aircraft) */
+    if (ceiling > 0 && airspace.GetBaseAltitude(state) > ceiling &&
+        !airspace.GetBase().IsTerrain())
+      continue;
 
-      warning->UpdateSolution(AirspaceWarning::WARNING_INSIDE, solution);
-      found = true;
+    /* the same lateral check as Airspaces::QueryInside() (envelope
+       first, then the outline, which was projected when the airspace
+       was inserted into the R-tree); it is shared by all
+       predictions */
+    const bool inside =
+      ((const FlatBoundingBox &)i).IsInside(flat_location) &&
+      i.IsInside(state.location);
+
+    if (inside && glide_polar.IsValid() &&
+        airspace.Inside((const AltitudeState &)state))
+      UpdateInside(state, glide_polar, i.GetAirspacePtr());
+
+    for (std::size_t j = 0; j < predictions.size(); ++j) {
+      const auto &prediction = predictions[j];
+      AirspaceIntersectionWarningVisitor visitor(state, prediction.perf,
+                                                 *this,
+                                                 prediction.warning_state,
+                                                 prediction.max_time,
+                                                 ceiling);
+
+      if (boost::geometry::intersects(segments[j],
+                                      (const FlatBoundingBox &)i) &&
+          visitor.SetIntersections(i.Intersects(state.location,
+                                                prediction.location,
+                                                projection)))
+        visitor.Visit(i.GetAirspacePtr());
+
+      if (inside) {
+        visitor.SetMode(true);
+        visitor.Visit(i.GetAirspacePtr());
+      }
     }
   }
+}
+
+void
+AirspaceWarningManager::UpdateInside(const AircraftState &state,
+                                     const GlidePolar &glide_polar,
+                                     const ConstAirspacePtr &airspace)
+{
+  AirspaceWarning *warning = GetWarningPtr(*airspace);
 
-  return found;
+  if (warning == nullptr ||
+      warning->IsStateAccepted(AirspaceWarning::WARNING_INSIDE)) {
+    GeoPoint c = airspace->ClosestPoint(state.location, GetProjection());
+    const AirspaceAircraftPerformance perf_glide(glide_polar);
+    const AirspaceInterceptSolution solution =
+      airspace->Intercept(state, c, GetProjection(), perf_glide);
+
+    if (warning == nullptr)
+      warning = GetNewWarningPtr(airspace);
+
+    warning->UpdateSolution(AirspaceWarning::WARNING_INSIDE, solution);
+  }
 }
 
 void
@@ -5,9 +5,11 @@
 
 #include "AirspaceWarning.hpp"
 #include "AirspaceWarningConfig.hpp"
+#include "AirspaceAircraftPerformance.hpp"
 #include "Util/AircraftStateFilter.hpp"
 #include "time/FloatDuration.hxx"
 #include "util/Serial.hpp"
+#include "util/StaticArray.hxx"
 
 #include <list>
 #include <string>
@@ -18,7 +20,6 @@ class TaskStats;
 class GlidePolar;
 class Airspaces;
 class FlatProjection;
-class AirspaceAircraftPerformance;
 
 /**
  * Class to detect and track airspace warnings
@@ -76,6 +77,8 @@ class AirspaceWarningManager {
    */
   Serial serial;
 
+  friend class AirspaceWarningManagerTest;
+
 public:
   using const_iterator = AirspaceWarningList::const_iterator;
 
@@ -278,15 +281,42 @@ private:
   const AirspaceWarning *
   FindWarningByNotamDayAckKey(std::string_view key) const noexcept;
 
-  bool UpdateTask(const AircraftState &state, const GlidePolar &glide_polar,
-                  const TaskStats &task_stats);
-  bool UpdateFilter(const AircraftState& state, const bool circling);
-  bool UpdateGlide(const AircraftState& state, const GlidePolar &glide_polar);
-  bool UpdateInside(const AircraftState& state, const GlidePolar &glide_polar);
-
-  bool UpdatePredicted(const AircraftState& state, 
-                       const GeoPoint &location_predicted,
-                       const AirspaceAircraftPerformance &perf,
-                       const AirspaceWarning::State warning_state,
-                       FloatDuration max_time) noexcept;
+  /**
+   * A predicted flight path starting at the current location which is
+   * checked for airspace intrusions.
+   */
+  struct Prediction {
+    GeoPoint location;
+
+    AirspaceAircraftPerformance perf{AirspaceAircraftPerformance::Simple{}};
+
+    AirspaceWarning::State warning_state;
+
+    /**
+     * The time limit of intrusions, beyond which we are not
+     * interested.  It is the minimum of the user set warning time and
+     * the prediction time (e.g. the time of the task segment).
+     */
+    FloatDuration max_time;
+  };
+
+  using PredictionList = StaticArray<Prediction, 3>;
+
+  void PredictTask(const AircraftState &state, const GlidePolar &glide_polar,
+                   const TaskStats &task_stats,
+                   PredictionList &predictions) const noexcept;
+  void PredictFilter(const AircraftState &state, bool circling,
+                     PredictionList &predictions) noexcept;
+  void PredictGlide(const AircraftState &state, const GlidePolar &glide_polar,
+                    PredictionList &predictions) const noexcept;
+
+  /**
+   * Check all airspaces near the aircraft and the given predicted
+   * flight paths with one R-tree query.
+   */
+  void Sweep(const AircraftState &state, const GlidePolar &glide_polar,
+             const PredictionList &predictions);
+
+  void UpdateInside(const AircraftState &state, const GlidePolar &glide_polar,
+                    const ConstAirspacePtr &airspace);
 };
@@ -58,6 +58,16 @@ Airspaces::QueryIntersecting(const GeoPoint &a, const GeoPoint &b) const noexcep
   return {airspace_tree.qbegin(bgi::intersects(line)), airspace_tree.qend()};
 }
 
+Airspaces::const_iterator_range
+Airspaces::QueryIntersecting(const FlatBoundingBox &box) const noexcept
+{
+  if (IsEmpty())
+    // nothing to do
+    return {airspace_tree.qend(), airspace_tree.qend()};
+
+  return {airspace_tree.qbegin(bgi::intersects(box)), airspace_tree.qend()};
+}
+
 void
 Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
                              bool include_inside,
@@ -64,6 +64,14 @@ public:
    */
   void Add(AirspacePtr airspace) noexcept;
 
+  /**
+   * Returns the airspaces which were added since the last
+   * Optimise() call.
+   */
+  const std::deque<AirspacePtr> &GetPending() const noexcept {
+    return tmp_as;
+  }
+
   /**
    * Re-organise the internal airspace tree after inserting/deleting.
    * Should be called after inserting/deleting airspaces prior to performing
@@ -141,6 +149,13 @@ public:
   const_iterator_range QueryIntersecting(const GeoPoint &a,
                                          const GeoPoint &b) const noexcept;
 
+  /**
+   * Query airspaces whose bounding box intersects the given
+   * (projected) box.  The result is in no specific order.
+   */
+  [[gnu::pure]]
+  const_iterator_range QueryIntersecting(const FlatBoundingBox &box) const noexcept;
+
   /**
    * Call visitor class on airspaces intersected by vector.
    * Note that the visitor is not instantiated separately for each match
@@ -2,6 +2,10 @@
 // Copyright The XCSoar Project
 
 #include "ContestManager.hpp"
+#include "thread/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cassert>
 
 ContestManager::ContestManager(const Contest _contest,
                                const Trace &trace_full,
@@ -158,6 +162,29 @@ RunContest(AbstractContest &_contest,
   return true;
 }
 
+bool
+ContestManager::RunContests(std::initializer_list<AbstractContest *> solvers,
+                            bool exhaustive) noexcept
+{
+  assert(solvers.size() <= ContestStatistics::N);
+
+  bool found[ContestStatistics::N]{};
+
+  if (pool != nullptr && solvers.size() > 1) {
+    pool->ForEach(solvers.size(), [&](unsigned i){
+      found[i] = RunContest(*solvers.begin()[i], stats.result[i],
+                            stats.solution[i], exhaustive);
+    });
+  } else {
+    for (unsigned i = 0; i < solvers.size(); ++i)
+      found[i] = RunContest(*solvers.begin()[i], stats.result[i],
+                            stats.solution[i], exhaustive);
+  }
+
+  return std::find(found, found + solvers.size(), true) !=
+    found + solvers.size();
+}
+
 bool
 ContestManager::UpdateIdle(bool exhaustive) noexcept
 {
@@ -193,11 +220,7 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
     break;
 
   case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests({&olc_classic, &olc_fai}, exhaustive);
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
@@ -210,14 +233,8 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
     break;
 
   case Contest::DMST:
-    retval = RunContest(dmst_quad, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(dmst_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
-
-    retval |= RunContest(dmst_or, stats.result[2],
-                         stats.solution[2], exhaustive);
+    retval = RunContests({&dmst_quad, &dmst_triangle, &dmst_or},
+                         exhaustive);
 
     if (retval) {
       dmst_free.Feed(stats.result[0], stats.solution[0],
@@ -230,17 +247,11 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
     break;
 
   case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests({&xcontest_free, &xcontest_triangle}, exhaustive);
     break;
 
   case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests({&dhv_xc_free, &dhv_xc_triangle}, exhaustive);
     break;
 
   case Contest::SIS_AT:
@@ -254,14 +265,8 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
     break;
 
   case Contest::WEGLIDE_FREE:
-    retval = RunContest(weglide_distance, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(weglide_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
-
-    retval |= RunContest(weglide_or, stats.result[2],
-                         stats.solution[2], exhaustive);
+    retval = RunContests({&weglide_distance, &weglide_fai, &weglide_or},
+                         exhaustive);
 
     if (retval) {
       weglide_free.Feed(stats.result[0], stats.solution[0],
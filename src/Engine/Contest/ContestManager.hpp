@@ -24,7 +24,10 @@
 #include "Solvers/Charron.hpp"
 #include "ContestStatistics.hpp"
 
+#include <initializer_list>
+
 class Trace;
+class ThreadPool;
 
 /**
  * Special task holder for Online Contest calculations
@@ -35,6 +38,12 @@ class ContestManager
 
   Contest contest;
 
+  /**
+   * If set, then independent solvers (e.g. the DMSt quadrilateral,
+   * triangle and out-and-return) run in parallel on this pool.
+   */
+  ThreadPool *pool = nullptr;
+
   ContestStatistics stats;
 
   OLCSprint olc_sprint;
@@ -93,6 +102,18 @@ public:
 
   void SetHandicap(unsigned handicap) noexcept;
 
+  /**
+   * Use the given #ThreadPool to run independent solvers in
+   * parallel.  The solvers only read the #Trace objects, which must
+   * not be modified while UpdateIdle() runs.
+   *
+   * @param _pool the pool or nullptr to run all solvers in the
+   * calling thread
+   */
+  void SetThreadPool(ThreadPool *_pool) noexcept {
+    pool = _pool;
+  }
+
   /**
    * Update internal states (non-essential) for housework,
    * or where functions are slow and would cause loss to real-time performance.
@@ -132,4 +153,16 @@ public:
   const ContestStatistics &GetStats() const noexcept {
     return stats;
   }
+
+private:
+  /**
+   * Run independent solvers, in parallel if a #ThreadPool was set.
+   * The solver with index i stores its result in stats.result[i]
+   * and stats.solution[i].
+   *
+   * @return true if at least one solver has found an improved
+   * solution
+   */
+  bool RunContests(std::initializer_list<AbstractContest *> solvers,
+                   bool exhaustive) noexcept;
 };
@@ -5,6 +5,7 @@
 #include "../ContestResult.hpp"
 #include "Trace/Trace.hpp"
 #include "Cast.hpp"
+#include "util/Compiler.h"
 
 #include <algorithm>
 #include <cassert>
@@ -35,7 +36,11 @@ ContestDijkstra::UpdateTrace(bool force) noexcept
   if (IsMasterAppended()) return; /* unmodified */
 
   if (IsMasterUpdated(continuous)) {
-    UpdateTraceFull();
+    if (finished) {
+      if (RemapTrace())
+        return;
+    } else
+      UpdateTraceFull();
 
     trace_dirty = true;
     finished = false;
@@ -309,6 +314,67 @@ ContestDijkstra::AddIncrementalEdges(unsigned first_point) noexcept
   AddStartEdges();
 }
 
+bool
+ContestDijkstra::RemapTrace() noexcept
+{
+  assert(continuous);
+  assert(incremental);
+  assert(finished);
+
+  if (UpdateTraceRemap(remap) < num_stages) {
+    dijkstra.Clear();
+    return false;
+  }
+
+  /* the first point which has a node whose chain went through a
+     removed point; these nodes need to be derived again */
+  unsigned first_orphan_point = n_points;
+
+  const std::size_t n_nodes = dijkstra.GetEdgeMap().size();
+  const std::size_t n_removed = dijkstra.RemapNodes([this](ScanTaskPoint &node){
+    const unsigned i = node.GetPointIndex();
+    if (i == predicted_index)
+      return true;
+
+    if (i >= remap.size() || remap[i] == REMOVED_POINT)
+      return false;
+
+    node.SetPointIndex(remap[i]);
+    return true;
+  }, [this, &first_orphan_point](ScanTaskPoint node){
+    /* the predicted point is linked by every AddEdges() call into
+       the final stage, which the last point guarantees */
+    const unsigned i = node.GetPointIndex() == predicted_index
+      ? n_points - 1
+      : node.GetPointIndex();
+    first_orphan_point = std::min(first_orphan_point, i);
+  });
+
+  if (n_removed * 4 > n_nodes) {
+    /* too much of the graph is gone; a new search will find better
+       solutions */
+    dijkstra.Clear();
+    return false;
+  }
+
+  /* all surviving points come before the new ones */
+  const auto last_survivor =
+    std::find_if(remap.rbegin(), remap.rend(), [](unsigned i){
+      return i != REMOVED_POINT;
+    });
+  assert(last_survivor != remap.rend());
+
+  /* linking all surviving nodes to the new points and to the
+     orphans' points re-derives the orphans (and everything that
+     follows them) like new points */
+  const unsigned first_point = std::min(*last_survivor + 1,
+                                        first_orphan_point);
+  if (first_point < n_points)
+    AddIncrementalEdges(first_point);
+
+  return true;
+}
+
 const ContestTraceVector &
 ContestDijkstra::GetCurrentPath() const noexcept
 {
@@ -8,6 +8,7 @@
 #include "TraceManager.hpp"
 
 #include <cassert>
+#include <vector>
 
 class Trace;
 
@@ -45,6 +46,12 @@ class ContestDijkstra : public AbstractContest, protected NavDijkstra<>, public
    */
   ContestTraceVector solution;
 
+  /**
+   * A buffer for UpdateTraceRemap(), kept here to avoid repeated
+   * allocations.
+   */
+  std::vector<unsigned> remap;
+
   /**
    * The required minimum leg distance.
    */
@@ -146,6 +153,19 @@ private:
 
   bool SaveSolution() noexcept;
 
+  /**
+   * The master #Trace was modified (e.g. thinned) after the search
+   * had finished.  Instead of starting a new search, renumber the
+   * Dijkstra nodes of all surviving points, drop the ones which
+   * depended on removed points and continue with the new points,
+   * like AddIncrementalEdges() does.  Surviving points whose nodes
+   * were dropped are treated like new points, so their nodes are
+   * derived again.
+   *
+   * @return false if a new search is necessary
+   */
+  bool RemapTrace() noexcept;
+
 protected:
   /**
    * Update working trace from master.
@@ -5,6 +5,7 @@
 #include "Trace/Trace.hpp"
 
 #include <cassert>
+#include <iterator>
 
 TraceManager::TraceManager(const Trace &_trace) noexcept
   :trace_master(_trace),
@@ -77,6 +78,7 @@ TraceManager::ClearTrace() noexcept
   append_serial = modify_serial = Serial();
   trace_dirty = true;
   trace.clear();
+  point_keys.clear();
   n_points = 0;
   predicted = TracePoint::Invalid();
 }
@@ -88,6 +90,11 @@ TraceManager::UpdateTraceFull() noexcept
   trace_master.GetPoints(trace);
   n_points = trace.size();
 
+  point_keys.clear();
+  point_keys.reserve(trace.capacity());
+  for (const TracePoint *p : trace)
+    point_keys.emplace_back(*p);
+
   if (n_points > 0 && predicted.IsDefined())
     predicted.Project(trace_master.GetProjection());
 
@@ -95,6 +102,35 @@ TraceManager::UpdateTraceFull() noexcept
   modify_serial = trace_master.GetModifySerial();
 }
 
+unsigned
+TraceManager::UpdateTraceRemap(std::vector<unsigned> &remap) noexcept
+{
+  const std::vector<PointKey> old_keys = std::move(point_keys);
+  point_keys = {};
+
+  UpdateTraceFull();
+
+  /* both lists are sorted by time; walk them in parallel */
+  remap.clear();
+  remap.reserve(old_keys.size());
+
+  unsigned n_survivors = 0;
+  auto i = point_keys.begin();
+  for (const auto &key : old_keys) {
+    while (i != point_keys.end() && i->time < key.time)
+      ++i;
+
+    if (i != point_keys.end() && *i == key) {
+      remap.push_back(std::distance(point_keys.begin(), i));
+      ++n_survivors;
+      ++i;
+    } else
+      remap.push_back(REMOVED_POINT);
+  }
+
+  return n_survivors;
+}
+
 bool
 TraceManager::UpdateTraceTail() noexcept
 {
@@ -108,6 +144,9 @@ TraceManager::UpdateTraceTail() noexcept
     /* no new points */
     return false;
 
+  for (unsigned i = n_points; i < trace.size(); ++i)
+    point_keys.emplace_back(*trace[i]);
+
   n_points = trace.size();
 
   if (n_points > 0 && predicted.IsDefined())
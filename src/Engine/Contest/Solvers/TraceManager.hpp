@@ -8,6 +8,8 @@
 #include "Trace/Vector.hpp"
 #include "Trace/Point.hpp"
 
+#include <vector>
+
 class TraceManager {
 protected:
   const Trace &trace_master;
@@ -38,6 +40,35 @@ protected:
   /** Number of points in current trace set */
   unsigned n_points;
 
+  /**
+   * Returned by UpdateTraceRemap() for points which were removed.
+   */
+  static constexpr unsigned REMOVED_POINT = ~0u;
+
+private:
+  /**
+   * Identifies a point of #trace.  Unlike the pointers in #trace, it
+   * remains usable after the master #Trace has been thinned, see
+   * UpdateTraceRemap().
+   */
+  struct PointKey {
+    TracePoint::Time time;
+    FlatGeoPoint location;
+
+    explicit PointKey(const TracePoint &p) noexcept
+      :time(p.GetTime()), location(p.GetFlatLocation()) {}
+
+    bool operator==(const PointKey &other) const noexcept {
+      return time == other.time && location == other.location;
+    }
+  };
+
+  /**
+   * The #PointKey of each point in #trace.
+   */
+  std::vector<PointKey> point_keys;
+
+protected:
   TracePoint predicted;
 
   static constexpr unsigned predicted_index = 0xffff;
@@ -70,6 +101,18 @@ protected:
    */
   void UpdateTraceFull() noexcept;
 
+  /**
+   * Obtain a new #Trace copy after the master #Trace was modified
+   * (e.g. thinned), and determine the new index of each point of the
+   * previous copy.  Surviving points keep their order; new points
+   * are appended after the last of them.
+   *
+   * @param remap receives the new index of each old point, or
+   * #REMOVED_POINT
+   * @return the number of points which have survived
+   */
+  unsigned UpdateTraceRemap(std::vector<unsigned> &remap) noexcept;
+
   /**
    * Copy points that were added to the end of the master Trace.
    *
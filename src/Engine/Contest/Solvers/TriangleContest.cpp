@@ -4,6 +4,7 @@
 #include "TriangleContest.hpp"
 #include "Cast.hpp"
 #include "Trace/Trace.hpp"
+#include "util/Compiler.h"
 #include "util/QuadTree.hxx"
 
 /*
@@ -5,6 +5,8 @@
 
 #include "util/ReservablePriorityQueue.hpp"
 
+#include <cstddef>
+
 #define DIJKSTRA_MINMAX_OFFSET 134217727
 
 /**
@@ -202,6 +204,59 @@ public:
       q.emplace(i.second.value, i);
   }
 
+  /**
+   * Rebuild the edge map after the nodes have been renumbered,
+   * e.g. because some of the underlying points were deleted.  The
+   * search queue is cleared, therefore this may only be used after
+   * the search has finished.
+   *
+   * @param f a function which translates an old node (passed by
+   * reference) to the new one; it returns false if the node does not
+   * exist anymore.  Nodes whose chain of predecessors includes such
+   * a node are removed as well.
+   * @param orphan a function which is called with the new node of
+   * each node which still exists, but was removed because its chain
+   * was broken; the caller must link it again to re-derive it
+   * @return the number of nodes which were removed
+   */
+  template<typename F, typename O>
+  std::size_t RemapNodes(F &&f, O &&orphan) noexcept {
+    q.clear();
+
+    const EdgeMap old_edges = edges;
+    edges.clear();
+
+    const auto is_chain_valid = [&old_edges, &f](Node node){
+      while (true) {
+        Node copy = node;
+        if (!f(copy))
+          return false;
+
+        const auto i = old_edges.find(node);
+        if (i == old_edges.end() || i->second.parent == node)
+          /* this is a start node */
+          return true;
+
+        node = i->second.parent;
+      }
+    };
+
+    std::size_t n_removed = 0;
+    for (const auto &[node, edge] : old_edges) {
+      Node new_node = node, new_parent = edge.parent;
+      if (!f(new_node)) {
+        ++n_removed;
+      } else if (f(new_parent) && is_chain_valid(edge.parent)) {
+        edges.try_emplace(new_node, new_parent, edge.value);
+      } else {
+        ++n_removed;
+        orphan(new_node);
+      }
+    }
+
+    return n_removed;
+  }
+
 private:
   /**
    * Add node to search queue
@@ -15,8 +15,8 @@ class FlatTriangleFan {
   using VertexVector = std::vector<FlatGeoPoint>;
 
   VertexVector vs;
-  FlatBoundingBox bounding_box;
-  int height;
+  FlatBoundingBox bounding_box{};
+  int height = 0;
 
 public:
   friend class PrintHelper;
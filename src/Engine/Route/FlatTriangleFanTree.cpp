@@ -8,6 +8,11 @@
 #include "ReachFanParms.hpp"
 #include "util/GlobalSliceAllocator.hxx"
 #include "Geo/Flat/FlatProjection.hpp"
+#include "thread/ThreadPool.hpp"
+
+#include <array>
+#include <optional>
+#include <vector>
 
 #define REACH_SWEEP (ROUTEPOLAR_Q1-BUFFER)
 
@@ -27,6 +32,102 @@ TooClose(const FlatGeoPoint p1, const FlatGeoPoint p2) noexcept
   return dmax < FlatTriangleFanTree::MIN_STEP;
 }
 
+/**
+ * A child fan which fills a gap: either a sub-tree of the previous
+ * solution (not yet moved out of it) or a newly solved fan.
+ */
+struct FlatTriangleFanTree::GapChild {
+  FlatTriangleFanTree *reuse = nullptr;
+  FlatTriangleFanTree child;
+
+  explicit GapChild(unsigned _depth) noexcept
+    :child(_depth) {}
+};
+
+/**
+ * A gap between two edges of a fan, which may need a child fan.
+ */
+struct FlatTriangleFanTree::Gap {
+  FlatTriangleFanTree *parent;
+  RouteLink e_1, e_2;
+
+  /**
+   * The child found by a worker thread.
+   */
+  std::optional<GapChild> result;
+
+  Gap(FlatTriangleFanTree &_parent,
+      const RouteLink &_e_1, const RouteLink &_e_2) noexcept
+    :parent(&_parent), e_1(_e_1), e_2(_e_2) {}
+};
+
+/**
+ * Call the function for all indices from 0 to n-1 on the pool.  A few
+ * batches per thread keep the queue overhead small, while idle
+ * threads can still pick up the remaining batches.
+ */
+template<typename F>
+static void
+ParallelFor(ThreadPool &pool, const std::size_t n, F &&f) noexcept
+{
+  const std::size_t n_batches =
+    std::min<std::size_t>(n, pool.GetConcurrency() * 4);
+
+  pool.ForEach(n_batches, [n, n_batches, &f](unsigned i){
+    const std::size_t begin = n * i / n_batches;
+    const std::size_t end = n * (i + 1) / n_batches;
+    for (std::size_t j = begin; j < end; ++j)
+      f(j);
+  });
+}
+
+bool
+FlatTriangleFanTree::IsReusableOrigin(const AFlatGeoPoint &old_origin,
+                                      const AFlatGeoPoint &new_origin) noexcept
+{
+  const FlatGeoPoint k = FlatGeoPoint(old_origin) - FlatGeoPoint(new_origin);
+  const unsigned dmax = std::max<unsigned>(std::abs(k.x), std::abs(k.y));
+  return dmax <= REUSE_DISTANCE &&
+    old_origin.altitude <= new_origin.altitude &&
+    new_origin.altitude - old_origin.altitude <= REUSE_HEIGHT;
+}
+
+FlatTriangleFanTree *
+FlatTriangleFanTree::FindReusable(const unsigned _depth,
+                                  const AFlatGeoPoint &origin,
+                                  const int _index_low,
+                                  const int _index_high) noexcept
+{
+  if (IsEmpty())
+    /* already taken */
+    return nullptr;
+
+  if (depth == _depth)
+    return index_low == _index_low && index_high == _index_high &&
+      IsReusableOrigin(fan.GetOrigin(), origin)
+      ? this
+      : nullptr;
+
+  for (auto &child : children)
+    if (child.depth <= _depth)
+      if (auto *found = child.FindReusable(_depth, origin,
+                                           _index_low, _index_high))
+        return found;
+
+  return nullptr;
+}
+
+void
+FlatTriangleFanTree::CountFans(unsigned &fans,
+                               unsigned &vertices) const noexcept
+{
+  ++fans;
+  vertices += fan.GetVertices().size();
+
+  for (const auto &child : children)
+    child.CountFans(fans, vertices);
+}
+
 const FlatBoundingBox &
 FlatTriangleFanTree::CalcBoundingBox() noexcept
 {
@@ -48,7 +149,9 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin,
 
   for (parms.set_depth = 0; parms.set_depth < MAX_DEPTH;
       ++parms.set_depth)
-    if (!FillDepth(origin, parms))
+    if (!(parms.pool != nullptr
+          ? FillDepthParallel(origin, parms)
+          : FillDepth(origin, parms)))
       // stop searching
       break;
 
@@ -88,13 +191,97 @@ FlatTriangleFanTree::FillDepth(const AFlatGeoPoint &origin,
   return true;
 }
 
+void
+FlatTriangleFanTree::CollectDepth(const unsigned set_depth,
+                                  std::vector<FlatTriangleFanTree *> &nodes) noexcept
+{
+  if (depth == set_depth) {
+    if (!gaps_filled)
+      nodes.push_back(this);
+  } else if (depth < set_depth) {
+    for (auto &child : children)
+      child.CollectDepth(set_depth, nodes);
+  }
+}
+
+bool
+FlatTriangleFanTree::FillDepthParallel(const AFlatGeoPoint &origin,
+                                       ReachFanParms &parms) noexcept
+{
+  assert(IsRoot());
+  assert(parms.pool != nullptr);
+
+  std::vector<FlatTriangleFanTree *> nodes;
+  CollectDepth(parms.set_depth, nodes);
+
+  /* the gaps of all fans at this depth are independent of each
+     other; solve them in parallel */
+  std::vector<Gap> gaps;
+  std::vector<std::size_t> first_gap;
+  first_gap.reserve(nodes.size() + 1);
+  for (auto *node : nodes) {
+    first_gap.push_back(gaps.size());
+    node->CollectGaps(origin, parms, gaps);
+  }
+  first_gap.push_back(gaps.size());
+
+  ParallelFor(*parms.pool, gaps.size(), [&origin, &parms, &gaps](std::size_t i){
+    Gap &gap = gaps[i];
+    gap.result = gap.parent->FindGapChild(origin, gap.e_1, gap.e_2, parms);
+  });
+
+  /* merge the results in the same order as FillDepth() would have
+     solved them, so the tree does not depend on thread timing */
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    FlatTriangleFanTree &node = *nodes[i];
+    node.gaps_filled = true;
+
+    if (parms.vertex_counter > MAX_VERTICES)
+      return false;
+    if (parms.fan_counter > MAX_FANS)
+      return false;
+
+    for (std::size_t j = first_gap[i]; j < first_gap[i + 1]; ++j) {
+      Gap &gap = gaps[j];
+      if (!gap.result)
+        continue;
+
+      if (gap.result->reuse != nullptr && gap.result->reuse->IsEmpty())
+        /* this sub-tree of the previous solution has already been
+           taken by another gap; look again */
+        node.CheckGap(origin, gap.e_1, gap.e_2, parms);
+      else
+        node.AddChild(std::move(*gap.result), parms);
+    }
+  }
+
+  return true;
+}
+
+static FlatGeoPoint
+ReachPoint(int index, const AFlatGeoPoint &origin, const GeoPoint &geo_origin,
+           const ReachFanParms &parms) noexcept
+{
+  FlatGeoPoint x = parms.ReachIntercept(index, origin, geo_origin);
+  /* if ReachIntercept() did not find anything reasonable it returns
+     a FlatGeoPoint that is almost the same as origin, but differs
+     +/- 1 due to conversion errors. The resulting polygon can have
+     overlapping edges causing triangulation failures. */
+  if (AlmostTheSame(origin, x))
+    x = origin;
+
+  return x;
+}
+
 bool
-FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
-                               const int index_high,
+FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin,
+                               const int _index_low, const int _index_high,
                                const ReachFanParms &parms) noexcept
 {
   const GeoPoint geo_origin = parms.projection.Unproject(origin);
   fan.SetHeight(origin.altitude);
+  index_low = _index_low;
+  index_high = _index_high;
 
   // fill vector
   if (!IsRoot()) {
@@ -106,24 +293,33 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
   }
 
   fan.AddOrigin(origin, index_high - index_low);
-  for (int index = index_low; index < index_high; ++index) {
-    FlatGeoPoint x = parms.ReachIntercept(index, origin, geo_origin);
-    /* if ReachIntercept() did not find anything reasonable it returns
-       a FlatGeoPoint that is almost the same as origin, but differs
-       +/- 1 due to conversion errors. The resulting polygon can have
-       overlapping edges causing triangulation failures. */
-    if (AlmostTheSame(origin, x))
-      x = origin;
-
-    fan.AddPoint(x);
+
+  if (IsRoot() && parms.pool != nullptr) {
+    /* the root fan scans the terrain in all directions; child fans
+       are already solved in parallel by FillDepthParallel() */
+    std::array<FlatGeoPoint, ROUTEPOLAR_POINTS> points;
+    assert(index_high - index_low <= (int)points.size());
+
+    ParallelFor(*parms.pool, index_high - index_low,
+                [this, &origin, &geo_origin, &parms, &points](std::size_t i){
+                  points[i] = ReachPoint(index_low + i, origin,
+                                         geo_origin, parms);
+                });
+
+    for (int i = 0; i < index_high - index_low; ++i)
+      fan.AddPoint(points[i]);
+  } else {
+    for (int index = index_low; index < index_high; ++index)
+      fan.AddPoint(ReachPoint(index, origin, geo_origin, parms));
   }
 
   return fan.CommitPoints(IsRoot());
 }
 
 void
-FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin,
-                              ReachFanParms &parms) noexcept
+FlatTriangleFanTree::CollectGaps(const AFlatGeoPoint &origin,
+                                 const ReachFanParms &parms,
+                                 std::vector<Gap> &gaps) noexcept
 {
   // worth checking for gaps?
   if (const auto vertices = fan.GetVertices();
@@ -138,14 +334,25 @@ FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin,
         continue;
 
       const RouteLink e(RoutePoint(*x, 0), origin, parms.projection);
-      // check if children need to be added
-      CheckGap(origin, e_last, e, parms);
+      gaps.emplace_back(*this, e_last, e);
 
       e_last = e;
     }
   }
 }
 
+void
+FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin,
+                              ReachFanParms &parms) noexcept
+{
+  std::vector<Gap> gaps;
+  CollectGaps(origin, parms, gaps);
+
+  // check if children need to be added
+  for (const auto &gap : gaps)
+    CheckGap(origin, gap.e_1, gap.e_2, parms);
+}
+
 void
 FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint o,
                                        ReachFanParms &parms) noexcept
@@ -173,16 +380,16 @@ FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint o,
     parms.terrain_base /= parms.terrain_counter;
 }
 
-bool
-FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
-                              const RouteLink &e_2,
-                              ReachFanParms &parms) noexcept
+std::optional<FlatTriangleFanTree::GapChild>
+FlatTriangleFanTree::FindGapChild(const AFlatGeoPoint &n,
+                                  const RouteLink &e_1, const RouteLink &e_2,
+                                  const ReachFanParms &parms) const noexcept
 {
   const bool side = (e_1.d > e_2.d);
   const RouteLink &e_long = (side ? e_1 : e_2);
   const RouteLink &e_short = (side ? e_2 : e_1);
   if (e_short.d >= e_long.d)
-    return false;
+    return std::nullopt;
 
   const FlatGeoPoint &p_long = e_long.first;
 
@@ -214,18 +421,57 @@ FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
     // altitude calculated from pure glide from n to x
     const AFlatGeoPoint x(px, h);
 
-    FlatTriangleFanTree child(depth + 1);
-    if (child.FillReach(x, index_left, index_right, parms)) {
-      parms.vertex_counter += child.fan.GetVertices().size();
-      parms.fan_counter++;
-      children.emplace_front(std::move(child));
-      return true;
+    if (parms.previous != nullptr) {
+      /* a sub-fan of the previous solution which was solved from
+         (almost) this corner does not need a new terrain scan */
+      auto *old = parms.previous->FindReusable(depth + 1, x,
+                                               index_left, index_right);
+      if (old != nullptr) {
+        GapChild result(depth + 1);
+        result.reuse = old;
+        return result;
+      }
     }
+
+    GapChild result(depth + 1);
+    if (result.child.FillReach(x, index_left, index_right, parms))
+      return result;
+  }
+
+  return std::nullopt;
+}
+
+void
+FlatTriangleFanTree::AddChild(GapChild &&c, ReachFanParms &parms) noexcept
+{
+  if (c.reuse != nullptr) {
+    children.emplace_front(std::move(*c.reuse));
+    c.reuse->Clear();
+
+    const unsigned fan_counter = parms.fan_counter;
+    children.front().CountFans(parms.fan_counter, parms.vertex_counter);
+    parms.reused_fans += parms.fan_counter - fan_counter;
+  } else {
+    parms.vertex_counter += c.child.fan.GetVertices().size();
+    parms.fan_counter++;
+    children.emplace_front(std::move(c.child));
   }
+}
 
-  return false;
+bool
+FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
+                              const RouteLink &e_2,
+                              ReachFanParms &parms) noexcept
+{
+  auto c = FindGapChild(n, e_1, e_2, parms);
+  if (!c)
+    return false;
+
+  AddChild(std::move(*c), parms);
+  return true;
 }
 
+
 int
 FlatTriangleFanTree::DirectArrival(FlatGeoPoint dest,
                                    const ReachFanParms &parms) const noexcept
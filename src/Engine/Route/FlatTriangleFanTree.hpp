@@ -9,6 +9,8 @@
 
 #include <cstdint>
 #include <forward_list>
+#include <optional>
+#include <vector>
 
 class FlatProjection;
 struct GeoPoint;
@@ -28,15 +30,34 @@ public:
   static constexpr unsigned MIN_STEP = 25;
   static constexpr unsigned MAX_FANS = 300;
 
+  /**
+   * A fan solved from an origin which differs from the requested one
+   * by no more than this (in flat coordinates) and which is lower by
+   * no more than this (in meters) is considered good enough to be
+   * reused.  A fan solved from a higher origin is never reused,
+   * because its reach would be optimistic.
+   */
+  static constexpr unsigned REUSE_DISTANCE = 1;
+  static constexpr int REUSE_HEIGHT = 10;
+
 private:
+  struct GapChild;
+  struct Gap;
+
   FlatTriangleFan fan;
 
   using LeafVector =
     std::forward_list<FlatTriangleFanTree,
                       GlobalSliceAllocator<FlatTriangleFanTree, 128u>>;
 
-  FlatBoundingBox bb_children;
+  FlatBoundingBox bb_children{};
   LeafVector children;
+
+  /**
+   * The range of #RoutePolar directions which were solved.
+   */
+  int_least16_t index_low = 0, index_high = 0;
+
   uint_least8_t depth;
   bool gaps_filled = false;
 
@@ -64,6 +85,15 @@ public:
   void FillReach(const AFlatGeoPoint &origin, ReachFanParms &parms) noexcept;
   void DummyReach(const AFlatGeoPoint &origin) noexcept;
 
+  /**
+   * Can this (root) tree be used as-is for a reach solution from the
+   * specified origin?
+   */
+  [[gnu::pure]]
+  bool CanReuse(const AFlatGeoPoint &origin) const noexcept {
+    return !IsEmpty() && IsReusableOrigin(fan.GetOrigin(), origin);
+  }
+
   /**
    * Basic check for a state created by DummyReach().  If this method
    * returns true, then calls to FindPositiveArrival() are supposed to
@@ -92,11 +122,35 @@ public:
   int DirectArrival(FlatGeoPoint dest,
                     const ReachFanParms &parms) const noexcept;
 
+  /**
+   * Add the fans and vertices of this sub-tree to the counters.
+   */
+  void CountFans(unsigned &fans, unsigned &vertices) const noexcept;
+
 private:
   bool IsRoot() const noexcept {
     return depth == 0;
   }
 
+  /**
+   * Can a fan solved from #old_origin be used for #new_origin?  See
+   * #REUSE_DISTANCE and #REUSE_HEIGHT.
+   */
+  [[gnu::pure]]
+  static bool IsReusableOrigin(const AFlatGeoPoint &old_origin,
+                               const AFlatGeoPoint &new_origin) noexcept;
+
+  /**
+   * Find a sub-tree which was solved for the specified depth and
+   * direction range from an origin near the given one.  Sub-trees
+   * which have already been taken are skipped.
+   */
+  [[gnu::pure]]
+  FlatTriangleFanTree *FindReusable(unsigned _depth,
+                                    const AFlatGeoPoint &origin,
+                                    int _index_low,
+                                    int _index_high) noexcept;
+
   const FlatBoundingBox &CalcBoundingBox() noexcept;
 
   /**
@@ -108,8 +162,38 @@ private:
                  const ReachFanParms &parms) noexcept;
 
   bool FillDepth(const AFlatGeoPoint &origin, ReachFanParms &parms) noexcept;
+
+  /**
+   * Collect the fans at depth #ReachFanParms::set_depth in the order
+   * in which FillDepth() visits them.
+   */
+  void CollectDepth(unsigned set_depth,
+                    std::vector<FlatTriangleFanTree *> &nodes) noexcept;
+
+  /**
+   * Like FillDepth() (to be called on the root), but solve the gaps
+   * of all fans on #ReachFanParms::pool.  The results are merged in
+   * the order of FillDepth().
+   */
+  bool FillDepthParallel(const AFlatGeoPoint &origin,
+                         ReachFanParms &parms) noexcept;
+
+  void CollectGaps(const AFlatGeoPoint &origin, const ReachFanParms &parms,
+                   std::vector<Gap> &gaps) noexcept;
   void FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms) noexcept;
 
+  /**
+   * Find a child fan for the gap between the two edges.  This
+   * method does not modify the tree and may be called from any
+   * thread.
+   */
+  std::optional<GapChild> FindGapChild(const AFlatGeoPoint &n,
+                                       const RouteLink &e_1,
+                                       const RouteLink &e_2,
+                                       const ReachFanParms &parms) const noexcept;
+
+  void AddChild(GapChild &&c, ReachFanParms &parms) noexcept;
+
   bool CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
                 const RouteLink &e_2, ReachFanParms &parms) noexcept;
 };
@@ -13,16 +13,35 @@ ReachFan::Reset() noexcept
 {
   root.Clear();
   terrain_base = 0;
+  reusable = false;
+}
+
+bool
+ReachFan::IsReusable(const GeoPoint &origin, const RoutePolars &rpolars,
+                     const RasterMap *terrain) const noexcept
+{
+  return reusable && terrain == reuse_terrain &&
+    (terrain == nullptr || terrain->GetSerial() == reuse_terrain_serial) &&
+    rpolars.IsReachCompatible(reuse_rpolars, REUSE_GRADIENT_TOLERANCE) &&
+    projection.GetCenter().DistanceS(origin) <= REUSE_RADIUS;
 }
 
 bool
 ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-                const RasterMap* terrain, const bool do_solve) noexcept
+                const RasterMap* terrain, const bool do_solve,
+                ThreadPool *pool) noexcept
 {
-  Reset();
+  reused_fans = 0;
+
+  /* keep the projection (and the flat coordinates of the previous
+     solution) if parts of the previous solution may be reused */
+  const bool reuse = do_solve && IsReusable(origin, rpolars, terrain);
+  if (!reuse) {
+    Reset();
 
-  // initialise projection
-  projection = FlatProjection(origin);
+    // initialise projection
+    projection = FlatProjection(origin);
+  }
 
   const auto h = terrain
     ? terrain->GetHeight(origin)
@@ -37,14 +56,39 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
   if ((!h.IsInvalid() &&
       (origin.altitude <= h2 + rpolars.GetSafetyHeight()))
       || (origin.altitude < MIN_FLOOR_CLEARANCE + rpolars.GetFloor() + rpolars.GetSafetyHeight())) {
+    Reset();
     terrain_base = h2;
     root.DummyReach(ao);
     return false;
   }
 
-  if (do_solve)
+  if (reuse && root.CanReuse(ao)) {
+    /* the aircraft has barely moved; the previous solution
+       (including the terrain base) is still good */
+    unsigned vertices = 0;
+    root.CountFans(reused_fans, vertices);
+    return true;
+  }
+
+  if (do_solve) {
+    FlatTriangleFanTree previous = std::move(root);
+    root.Clear();
+
+    if (reuse)
+      parms.previous = &previous;
+    parms.pool = pool;
+
     root.FillReach(ao, parms);
-  else
+    reused_fans = parms.reused_fans;
+
+    if (!reuse) {
+      reusable = true;
+      reuse_terrain = terrain;
+      if (terrain != nullptr)
+        reuse_terrain_serial = terrain->GetSerial();
+      reuse_rpolars = rpolars;
+    }
+  } else
     root.DummyReach(ao);
 
   if (!h.IsInvalid()) {
@@ -5,20 +5,59 @@
 
 #include "Geo/Flat/FlatProjection.hpp"
 #include "FlatTriangleFanTree.hpp"
+#include "RoutePolars.hpp"
+#include "util/Serial.hpp"
 
 #include <optional>
 
-class RoutePolars;
 class RasterMap;
 class GeoBounds;
+class ThreadPool;
 struct ReachResult;
 
+/**
+ * The reach footprint from one origin.
+ *
+ * Solve() reuses the previous solution where possible: while the
+ * aircraft stays near the projection center, the terrain did not
+ * change and the glide performance (wind, MacCready, polar) did not
+ * get worse or better beyond a small tolerance, sub-fans whose
+ * origin moved by no more than FlatTriangleFanTree::REUSE_DISTANCE
+ * and climbed by no more than FlatTriangleFanTree::REUSE_HEIGHT are
+ * taken over instead of scanning the terrain again.  The reach is
+ * therefore never optimistic.
+ */
 class ReachFan
 {
+  /**
+   * The maximum distance [m] from the projection center for
+   * reusing the previous solution.
+   */
+  static constexpr double REUSE_RADIUS = 5000;
+
+  /**
+   * The maximum relative glide slope improvement for reusing the
+   * previous solution.
+   */
+  static constexpr double REUSE_GRADIENT_TOLERANCE = 0.01;
+
   FlatProjection projection;
   FlatTriangleFanTree root;
   int terrain_base = 0;
 
+  /**
+   * Can #root be reused by the next Solve() call?  If yes, the
+   * following attributes describe the parameters it was
+   * (initially) solved with.
+   */
+  bool reusable = false;
+
+  const RasterMap *reuse_terrain;
+  Serial reuse_terrain_serial;
+  RoutePolars reuse_rpolars;
+
+  unsigned reused_fans = 0;
+
 public:
   friend class PrintHelper;
 
@@ -32,8 +71,22 @@ public:
 
   void Reset() noexcept;
 
+  /**
+   * Returns the number of fans which the last Solve() call took over
+   * from the previous solution.
+   */
+  unsigned GetReusedFans() const noexcept {
+    return reused_fans;
+  }
+
+  /**
+   * @param pool if not nullptr, then the terrain scans are
+   * distributed over the threads of this pool; the result is the
+   * same as without a pool
+   */
   bool Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-             const RasterMap *terrain, const bool do_solve = true) noexcept;
+             const RasterMap *terrain, const bool do_solve = true,
+             ThreadPool *pool = nullptr) noexcept;
 
   /**
    * Find arrival height at destination.
@@ -57,4 +110,9 @@ public:
   int GetTerrainBase() const noexcept {
     return terrain_base;
   }
+
+private:
+  [[gnu::pure]]
+  bool IsReusable(const GeoPoint &origin, const RoutePolars &rpolars,
+                  const RasterMap *terrain) const noexcept;
 };
@@ -7,6 +7,8 @@
 
 class FlatProjection;
 class RasterMap;
+class FlatTriangleFanTree;
+class ThreadPool;
 
 struct ReachFanParms {
   const RoutePolars &rpolars;
@@ -18,6 +20,20 @@ struct ReachFanParms {
   unsigned vertex_counter = 0;
   unsigned char set_depth = 0;
 
+  /**
+   * The previous solution, whose sub-fans may be moved into the new
+   * tree instead of being solved again (see
+   * FlatTriangleFanTree::FindReusable()).  May be nullptr.
+   */
+  FlatTriangleFanTree *previous = nullptr;
+  unsigned reused_fans = 0;
+
+  /**
+   * If not nullptr, then the terrain scans are distributed over
+   * this pool.
+   */
+  ThreadPool *pool = nullptr;
+
   ReachFanParms(const RoutePolars& _rpolars,
                 const FlatProjection &_projection,
                 const short _terrain_base,
@@ -8,6 +8,8 @@
 #include "Geo/Flat/FlatGeoPoint.hpp"
 #include "util/Macros.hpp"
 
+#include <cmath>
+
 GlideResult
 RoutePolar::SolveTask(const GlideSettings &settings,
                       const GlidePolar& glide_polar,
@@ -39,6 +41,23 @@ RoutePolar::Initialise(const GlideSettings &settings, const GlidePolar& polar,
   }
 }
 
+bool
+RoutePolar::IsGradientCloseBelow(const RoutePolar &other,
+                                 const double tolerance) const noexcept
+{
+  for (unsigned i = 0; i < ROUTEPOLAR_POINTS; ++i) {
+    const RoutePolarPoint &a = points[i], &b = other.points[i];
+    if (a.valid != b.valid)
+      return false;
+
+    if (a.valid && (a.gradient > b.gradient ||
+                    b.gradient - a.gradient > tolerance * b.gradient))
+      return false;
+  }
+
+  return true;
+}
+
 static constexpr FlatGeoPoint index_to_point[] = {
   {128, 0},
   {126, 16},
@@ -76,6 +76,15 @@ public:
     return points[index];
   }
 
+  /**
+   * Check whether the glide slopes in all directions are not worse
+   * than the ones of the other table, and better by no more than the
+   * specified fraction.
+   */
+  [[gnu::pure]]
+  bool IsGradientCloseBelow(const RoutePolar &other,
+                            double tolerance) const noexcept;
+
   /**
    * Calculate distances normalised to 128 corresponding to direction index
    *
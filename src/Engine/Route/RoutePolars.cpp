@@ -212,6 +212,16 @@ RoutePolars::Intersection(const AGeoPoint &origin,
                                  height_min_working);
 }
 
+bool
+RoutePolars::IsReachCompatible(const RoutePolars &other,
+                               const double tolerance) const noexcept
+{
+  return height_min_working == other.height_min_working &&
+    config.safety_height_terrain == other.config.safety_height_terrain &&
+    config.reach_calc_mode == other.config.reach_calc_mode &&
+    polar_glide.IsGradientCloseBelow(other.polar_glide, tolerance);
+}
+
 int
 RoutePolars::CalcGlideArrival(const AFlatGeoPoint &origin,
                               const FlatGeoPoint &dest,
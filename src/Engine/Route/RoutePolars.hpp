@@ -227,6 +227,18 @@ public:
                        const FlatGeoPoint &dest,
                        const FlatProjection &proj) const noexcept;
 
+  /**
+   * Check whether a reach footprint calculated with the other
+   * performance model can still be used with this one: the glide
+   * slopes are not worse than the other ones (so the old footprint
+   * is not optimistic) and better by no more than the specified
+   * fraction, and all other reach parameters are equal.  The cruise altitude and the
+   * climb ceiling are ignored, because reach is a pure glide.
+   */
+  [[gnu::pure]]
+  bool IsReachCompatible(const RoutePolars &other,
+                         double tolerance) const noexcept;
+
   int GetSafetyHeight() const noexcept {
     return config.safety_height_terrain;
   }
@@ -3,9 +3,16 @@
 
 #include "TerrainRoute.hpp"
 #include "ReachResult.hpp"
-#include "ReachFan.hpp"
 #include "Terrain/RasterMap.hpp"
 
+void
+TerrainRoute::Reset() noexcept
+{
+  RoutePlanner::Reset();
+  reach_terrain.Reset();
+  reach_working.Reset();
+}
+
 void
 TerrainRoute::UpdatePolar(const GlideSettings &settings,
                           const RoutePlannerConfig &config,
@@ -42,8 +49,8 @@ TerrainRoute::SolveReach(const AGeoPoint &origin,
   auto &rpolars = working ? rpolars_reach_working : rpolars_reach;
   rpolars.SetConfig(config, origin.altitude, h_ceiling);
 
-  ReachFan reach;
-  reach.Solve(origin, rpolars, terrain, do_solve);
+  auto &reach = working ? reach_working : reach_terrain;
+  reach.Solve(origin, rpolars, terrain, do_solve, pool);
   return reach;
 }
 
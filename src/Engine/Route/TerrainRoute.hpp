@@ -4,8 +4,9 @@
 #pragma once
 
 #include "RoutePlanner.hpp"
+#include "ReachFan.hpp"
 
-class ReachFan;
+class ThreadPool;
 
 /**
  * Specialization of #RoutePlanner which implements terrain avoidance.
@@ -20,11 +21,21 @@ class TerrainRoute: public RoutePlanner
   /** Terrain raster */
   const RasterMap *terrain = nullptr;
 
+  /** Worker threads for the reach calculation (optional) */
+  ThreadPool *pool = nullptr;
+
   /** Aircraft performance model for reach to terrain */
   RoutePolars rpolars_reach;
   /** Aircraft performance model for reach to working floor */
   RoutePolars rpolars_reach_working;
 
+  /**
+   * The previous reach solutions, which are partially reused by the
+   * next SolveReach() call.
+   */
+  ReachFan reach_terrain;
+  ReachFan reach_working;
+
   mutable RoutePoint m_inx_terrain;
 
 public:
@@ -38,6 +49,14 @@ public:
     terrain = _terrain;
   }
 
+  /**
+   * Distribute the terrain scans of SolveReach() over the threads
+   * of this pool.
+   */
+  void SetThreadPool(ThreadPool *_pool) noexcept {
+    pool = _pool;
+  }
+
   const auto &GetReachPolar() const noexcept {
     return rpolars_reach;
   }
@@ -50,12 +69,13 @@ public:
                    int height_min_working=0) noexcept;
 
   /**
-   * Solve reach footprint to terrain or working height.
+   * Solve reach footprint to terrain or working height.  Parts of
+   * the previous solution are reused if the origin, altitude and
+   * performance model did not change much (see #ReachFan).
    *
    * @param origin The start of the search (current aircraft location)
    * @param do_solve actually solve or just perform minimal calculations
    */
-  [[gnu::pure]]
   ReachFan SolveReach(const AGeoPoint &origin,
                       const RoutePlannerConfig &config,
                       int h_ceiling, bool do_solve,
@@ -76,6 +96,9 @@ public:
   GeoPoint Intersection(const AGeoPoint &origin,
                         const AGeoPoint &destination) const noexcept;
 
+  /* virtual methods from class RoutePlanner */
+  void Reset() noexcept override;
+
 protected:
   bool IsClear(const RouteLink &e) const noexcept override;
   void AddNearby(const RouteLink &e) noexcept override;
@@ -6,20 +6,21 @@
 #include "Geo/GeoBounds.hpp"
 #include "Geo/Flat/FlatBoundingBox.hpp"
 #include "Geo/Flat/FlatRay.hpp"
-#include "util/GlobalSliceAllocator.hxx"
 
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
 #include <vector>
 
+#include <stdlib.h>
+
 Trace::Trace(const Time _no_thin_time, const Time max_time,
              const unsigned max_size) noexcept
-  :cached_size(0),
-   max_time(max_time),
+  :max_time(max_time),
    no_thin_time(_no_thin_time),
    max_size(max_size),
-   opt_size((3 * max_size) / 4)
+   opt_size((3 * max_size) / 4),
+   average_delta_time({}), average_delta_distance(0)
 {
   assert(max_size >= 4);
 }
@@ -27,18 +28,10 @@ Trace::Trace(const Time _no_thin_time, const Time max_time,
 void
 Trace::clear() noexcept
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
   average_delta_distance = 0;
   average_delta_time = {};
 
-  delta_list.clear();
-  chronological_list.clear_and_dispose(MakeDisposer());
-  cached_size = 0;
-
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  points.clear();
 
   ++modify_serial;
   ++append_serial;
@@ -57,102 +50,219 @@ Trace::GetRecentTime(const Time t) const noexcept
   return {};
 }
 
-void
-Trace::UpdateDelta(TraceDelta &td) noexcept
+Trace::PointList::const_iterator
+Trace::LowerBound(const Time min_time) const noexcept
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
-  if (&td == &chronological_list.front() ||
-      &td == &chronological_list.back())
-    return;
-
-  const auto ci = chronological_list.iterator_to(td);
-  const TraceDelta &previous = *std::prev(ci);
-  const TraceDelta &next = *std::next(ci);
+  return std::partition_point(points.begin(), points.end(),
+                              [min_time](const TracePoint &p){
+                                return p.GetTime() < min_time;
+                              });
+}
 
-  delta_list.erase(delta_list.iterator_to(td));
-  td.Update(previous.point, next.point);
-  delta_list.insert(td);
+/**
+ * Calculate error distance, between last through this to next, if
+ * this node is removed.  This metric provides for Douglas-Peuker
+ * thinning.
+ *
+ * @param last Point previous in time to this node
+ * @param node This node
+ * @param next Point succeeding this node
+ *
+ * @return Distance error if this node is thinned
+ */
+[[gnu::pure]]
+static unsigned
+DistanceMetric(const TracePoint &last, const TracePoint &node,
+               const TracePoint &next) noexcept
+{
+  const int d_this = last.FlatDistanceTo(node) + node.FlatDistanceTo(next);
+  const int d_rem = last.FlatDistanceTo(next);
+  return abs(d_this - d_rem);
 }
 
-void
-Trace::EraseInside(DeltaList::iterator it) noexcept
+/**
+ * Calculate error time, between last through this to next, if this
+ * node is removed.  This metric provides for fair thinning (tendency
+ * to to result in equal time steps)
+ *
+ * @param last Point previous in time to this node
+ * @param node This node
+ * @param next Point succeeding this node
+ *
+ * @return Time delta if this node is thinned
+ */
+static constexpr TracePoint::Time
+TimeMetric(const TracePoint &last, const TracePoint &node,
+           const TracePoint &next) noexcept
 {
-  assert(cached_size > 0);
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-  assert(it != delta_list.end());
-
-  const TraceDelta &td = *it;
-  assert(!td.IsEdge());
-
-  const auto ci = chronological_list.iterator_to(td);
-  TraceDelta &previous = const_cast<TraceDelta &>(*std::prev(ci));
-  TraceDelta &next = const_cast<TraceDelta &>(*std::next(ci));
-
-  // now delete the item
-  chronological_list.erase(chronological_list.iterator_to(td));
-  delta_list.erase_and_dispose(it, MakeDisposer());
-  --cached_size;
-
-  // and update the deltas
-  UpdateDelta(previous);
-  UpdateDelta(next);
+  return next.DeltaTime(last)
+    - std::min(next.DeltaTime(node), node.DeltaTime(last));
 }
 
+namespace {
+
+/**
+ * A point which may be removed by Trace::EraseDelta(), with the loss
+ * of precision caused by removing it.
+ */
+struct ThinCandidate {
+  unsigned elim_distance;
+  TracePoint::Time elim_time;
+
+  TracePoint::Time time;
+
+  /**
+   * The index in Trace::points.
+   */
+  unsigned index;
+
+  /**
+   * Ranking is primarily by distance delta; for equal distances,
+   * rank by time delta.  This is like a modified Douglas-Peuker
+   * algorithm.
+   */
+  [[gnu::pure]]
+  static constexpr bool RanksBefore(const ThinCandidate &x,
+                                    const ThinCandidate &y) noexcept {
+    // distance is king
+    if (x.elim_distance != y.elim_distance)
+      return x.elim_distance < y.elim_distance;
+
+    // distance is equal, so go by time error
+    if (x.elim_time != y.elim_time)
+      return x.elim_time < y.elim_time;
+
+    // all else fails, go by age
+    return x.time < y.time;
+  }
+
+  /**
+   * Comparison for the std::push_heap() family, which puts the best
+   * candidate on top.
+   */
+  static constexpr bool HeapCompare(const ThinCandidate &x,
+                                    const ThinCandidate &y) noexcept {
+    return RanksBefore(y, x);
+  }
+};
+
+/**
+ * The neighbours and the current ranking of one point while
+ * Trace::EraseDelta() runs.
+ */
+struct ThinNode {
+  static constexpr unsigned NONE = ~0u;
+
+  /**
+   * The indices of the neighbours which have not been removed (yet);
+   * #NONE for the first and the last point, which are never removed.
+   */
+  unsigned previous, next;
+
+  unsigned elim_distance;
+  TracePoint::Time elim_time;
+
+  bool removed;
+
+  constexpr bool IsEdge() const noexcept {
+    return previous == NONE || next == NONE;
+  }
+};
+
+} // anonymous namespace
+
 bool
 Trace::EraseDelta(const unsigned target_size, const Time recent) noexcept
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
-  if (size() <= 2)
+  const unsigned n = size();
+  if (n <= 2 || n <= target_size)
     return false;
 
-  bool modified = false;
-
   const Time recent_time = GetRecentTime(recent);
 
-  auto candidate = delta_list.begin();
-  while (size() > target_size) {
-    const TraceDelta &td = *candidate;
-    if (!td.IsEdge() && td.point.GetTime() < recent_time) {
-      EraseInside(candidate);
-      candidate = delta_list.begin(); // find new top
-      modified = true;
-    } else {
-      ++candidate;
-      // suppressed removal, skip it.
-    }
+  std::vector<ThinNode> nodes(n);
+  std::vector<ThinCandidate> heap;
+  heap.reserve(n);
+
+  /* calculates the ranking of a point from its current neighbours
+     and adds it to the heap unless it is too recent */
+  const auto update = [&](unsigned i){
+    ThinNode &node = nodes[i];
+    const TracePoint &point = points[i];
+    node.elim_distance = DistanceMetric(points[node.previous], point,
+                                        points[node.next]);
+    node.elim_time = TimeMetric(points[node.previous], point,
+                                points[node.next]);
+
+    if (point.GetTime() < recent_time) {
+      heap.push_back({node.elim_distance, node.elim_time,
+                      point.GetTime(), i});
+      return true;
+    } else
+      return false;
+  };
+
+  for (unsigned i = 0; i < n; ++i) {
+    ThinNode &node = nodes[i];
+    node.previous = i > 0 ? i - 1 : ThinNode::NONE;
+    node.next = i + 1 < n ? i + 1 : ThinNode::NONE;
+    node.removed = false;
+
+    if (!node.IsEdge())
+      update(i);
+  }
+
+  std::make_heap(heap.begin(), heap.end(), ThinCandidate::HeapCompare);
+
+  unsigned remaining = n;
+  while (remaining > target_size && !heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), ThinCandidate::HeapCompare);
+    const ThinCandidate candidate = heap.back();
+    heap.pop_back();
+
+    ThinNode &node = nodes[candidate.index];
+    if (node.removed || node.elim_distance != candidate.elim_distance ||
+        node.elim_time != candidate.elim_time)
+      /* obsolete entry; the point was removed or re-ranked since */
+      continue;
+
+    node.removed = true;
+    --remaining;
+
+    ThinNode &previous = nodes[node.previous];
+    ThinNode &next = nodes[node.next];
+    previous.next = node.next;
+    next.previous = node.previous;
+
+    // and update the deltas
+    if (!previous.IsEdge() && update(node.previous))
+      std::push_heap(heap.begin(), heap.end(), ThinCandidate::HeapCompare);
+    if (!next.IsEdge() && update(node.next))
+      std::push_heap(heap.begin(), heap.end(), ThinCandidate::HeapCompare);
   }
 
-  return modified;
+  if (remaining == n)
+    return false;
+
+  /* compact the array */
+  unsigned dest = 0;
+  for (unsigned i = 0; i < n; ++i)
+    if (!nodes[i].removed)
+      points[dest++] = points[i];
+
+  assert(dest == remaining);
+  points.resize(remaining);
+  return true;
 }
 
 bool
 Trace::EraseEarlierThan(const Time p_time) noexcept
 {
-  if (p_time == Time{} || empty() || GetFront().point.GetTime() >= p_time)
+  if (p_time == Time{} || empty() || front().GetTime() >= p_time)
     // there will be nothing to remove
     return false;
 
-  do {
-    auto ci = chronological_list.begin();
-    TraceDelta &td = *ci;
-    chronological_list.erase(ci);
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase_and_dispose(i, MakeDisposer());
-
-    --cached_size;
-  } while (!empty() && GetFront().point.GetTime() < p_time);
-
-  // need to set deltas for first point, only one of these
-  // will occur (have to search for this point)
-  if (!empty())
-    EraseStart(GetFront());
+  points.erase(points.begin(), LowerBound(p_time));
 
   ++modify_serial;
   ++append_serial;
@@ -165,50 +275,26 @@ Trace::EraseLaterThan(const Time min_time) noexcept
   assert(min_time.count() > 0);
   assert(!empty());
 
-  while (!empty() && GetBack().point.GetTime() > min_time) {
-    TraceDelta &td = GetBack();
-
-    chronological_list.erase(chronological_list.iterator_to(td));
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase_and_dispose(i, MakeDisposer());
-
-    --cached_size;
-  }
-
-  /* need to set deltas for first point, only one of these will occur
-     (have to search for this point) */
-  if (!empty())
-    EraseStart(GetBack());
-}
-
-/**
- * Update start node (and neighbour) after min time pruning
- */
-void
-Trace::EraseStart(TraceDelta &td) noexcept
-{
-  delta_list.erase(delta_list.iterator_to(td));
-
-  td.elim_distance = null_delta;
-  td.elim_time = null_time;
-
-  delta_list.insert(td);
+  points.erase(std::partition_point(points.begin(), points.end(),
+                                    [min_time](const TracePoint &p){
+                                      return p.GetTime() <= min_time;
+                                    }),
+               points.end());
 }
 
 void
 Trace::push_back(const TracePoint &point) noexcept
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
   const Time min_delta = std::chrono::seconds{2};
 
   if (empty()) {
     // first point determines origin for flat projection
     task_projection.Reset(point.GetLocation());
     task_projection.Update();
+
+    /* allocate the whole array now, to keep pointers valid while
+       points get appended */
+    points.reserve(max_size);
   } else if (point.GetTime() < back().GetTime()) {
     // gone back in time
 
@@ -235,17 +321,8 @@ Trace::push_back(const TracePoint &point) noexcept
 
   assert(size() < max_size);
 
-  TraceDelta *td = allocator.allocate(1);
-  std::allocator_traits<Allocator>::construct(allocator, td, point);
-  td->point.Project(task_projection);
-
-  delta_list.insert(*td);
-  chronological_list.push_back(*td);
-
-  ++cached_size;
-
-  if (td != &chronological_list.front())
-    UpdateDelta(*std::prev(chronological_list.iterator_to(*td)));
+  points.push_back(point);
+  points.back().Project(task_projection);
 
   ++append_serial;
 }
@@ -253,42 +330,30 @@ Trace::push_back(const TracePoint &point) noexcept
 unsigned
 Trace::CalcAverageDeltaDistance(const Time no_thin) const noexcept
 {
-  const Time r = GetRecentTime(no_thin);
-  unsigned acc = 0;
-  unsigned counter = 0;
-
-  const auto end = chronological_list.end();
-  for (auto it = chronological_list.begin();
-       it != end && it->point.GetTime() < r; ++it, ++counter)
-    acc += it->delta_distance;
+  const auto end = LowerBound(GetRecentTime(no_thin));
+  if (end == points.begin())
+    return 0;
 
-  if (counter)
-    return acc / counter;
+  /* the first point has no predecessor and counts as zero */
+  unsigned acc = 0;
+  for (auto it = std::next(points.begin()); it != end; ++it)
+    acc += it->FlatDistanceTo(*std::prev(it));
 
-  return 0;
+  return acc / std::distance(points.begin(), end);
 }
 
 Trace::Time
 Trace::CalcAverageDeltaTime(const Time no_thin) const noexcept
 {
-  const Time r = GetRecentTime(no_thin);
-  unsigned counter = 0;
-
   /* find the last item before the "r" timestamp */
-  const auto end = chronological_list.end();
-  ChronologicalList::const_iterator it;
-  for (it = chronological_list.begin(); it != end && it->point.GetTime() < r; ++it)
-    ++counter;
-
+  const auto end = LowerBound(GetRecentTime(no_thin));
+  const unsigned counter = std::distance(points.begin(), end);
   if (counter < 2)
     return {};
 
-  --it;
-  --counter;
-
   Time start_time = front().GetTime();
-  Time end_time = it->point.GetTime();
-  return (end_time - start_time) / counter;
+  Time end_time = std::prev(end)->GetTime();
+  return (end_time - start_time) / (counter - 1);
 }
 
 void
@@ -328,8 +393,6 @@ Trace::Thin2() noexcept
 void
 Trace::Thin() noexcept
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
   assert(size() == max_size);
 
   Thin2();
@@ -346,56 +409,16 @@ Trace::Thin() noexcept
 void
 Trace::GetPoints(TracePointVector& iov) const noexcept
 {
-  iov.clear();
-  iov.reserve(size());
-  std::copy(begin(), end(), std::back_inserter(iov));
+  iov.assign(points.begin(), points.end());
 }
 
-template<typename I>
-class PointerIterator {
-  I i;
-
-public:
-  typedef typename I::iterator_category iterator_category;
-  typedef typename I::pointer value_type;
-  typedef typename I::pointer *pointer;
-  typedef value_type &reference;
-  typedef typename I::difference_type difference_type;
-
-  PointerIterator() = default;
-  explicit PointerIterator(I _i) noexcept:i(_i) {}
-
-  PointerIterator<I> &operator--() noexcept {
-    --i;
-    return *this;
-  }
-
-  PointerIterator<I> &operator++() noexcept {
-    ++i;
-    return *this;
-  }
-
-  typename I::pointer operator*() noexcept {
-    return &*i;
-  }
-
-  bool operator==(const PointerIterator<I> &other) const noexcept {
-    return i == other.i;
-  }
-
-  bool operator!=(const PointerIterator<I> &other) const noexcept {
-    return i != other.i;
-  }
-};
-
 void
 Trace::GetPoints(TracePointerVector &v) const noexcept
 {
   v.clear();
   v.reserve(size());
-  std::copy(PointerIterator<decltype(begin())>(begin()),
-            PointerIterator<decltype(end())>(end()),
-            std::back_inserter(v));
+  for (const TracePoint &point : points)
+    v.push_back(&point);
 }
 
 bool
@@ -408,10 +431,9 @@ Trace::SyncPoints(TracePointerVector &v) const noexcept
     return false;
 
   v.reserve(size());
+  for (auto i = std::next(points.begin(), v.size()); i != points.end(); ++i)
+    v.push_back(&*i);
 
-  PointerIterator<decltype(end())> e(end());
-  std::copy(std::prev(e, size() - v.size()), e,
-            std::back_inserter(v));
   assert(v.size() == size());
   return true;
 }
@@ -422,30 +444,24 @@ Trace::GetPoints(TracePointVector &v, const Time min_time,
                  double min_distance) const
 {
   /* skip the trace points that are before min_time */
-  Trace::const_iterator i = begin(), end = this->end();
-  unsigned skipped = 0;
-  while (true) {
-    if (i == end)
-      /* nothing left */
-      return;
-
-    if (i->GetTime() >= min_time)
-      /* found the first point that is within range */
-      break;
-
-    ++i;
-    ++skipped;
-  }
-
-  assert(skipped < size());
+  auto i = LowerBound(min_time);
+  const auto end = points.end();
+  if (i == end)
+    /* nothing left */
+    return;
 
-  v.reserve(size() - skipped);
+  v.reserve(v.size() + std::distance(i, end));
   const unsigned range = ProjectRange(location, min_distance);
   const unsigned sq_range = range * range;
-  do {
-    v.push_back(*i);
-    i.NextSquareRange(sq_range, end);
-  } while (i != end);
+
+  const TracePoint *previous = &*i;
+  v.push_back(*previous);
+  for (++i; i != end; ++i) {
+    if (i->FlatSquareDistanceTo(*previous) >= sq_range) {
+      previous = &*i;
+      v.push_back(*previous);
+    }
+  }
 }
 
 /**
@@ -588,29 +604,17 @@ Trace::MakeSpatialFilter(const GeoBounds &bounds,
 void
 Trace::GetPointsFrom(Time min_time, TracePointVector &v) const noexcept
 {
-  v.clear();
-
-  Trace::const_iterator i = begin(), end = this->end();
-  while (i != end && i->GetTime() < min_time)
-    ++i;
-
-  if (i == end)
-    return;
-
-  v.reserve(size());
-  for (; i != end; ++i)
-    v.push_back(*i);
+  v.assign(LowerBound(min_time), points.end());
 }
 
 void
 Trace::AppendPointsAfter(Time after, TracePointVector &v) const noexcept
 {
-  Trace::const_iterator i = begin(), end = this->end();
-  while (i != end && i->GetTime() <= after)
-    ++i;
-
-  for (; i != end; ++i)
-    v.push_back(*i);
+  const auto i = std::partition_point(points.begin(), points.end(),
+                                      [after](const TracePoint &p){
+                                        return p.GetTime() <= after;
+                                      });
+  v.insert(v.end(), i, points.end());
 }
 
 void
@@ -630,9 +634,8 @@ Trace::GetPoints(TracePointVector &v, const Time min_time,
     return;
 
   /* Skip points before min_time. */
-  Trace::const_iterator i = begin(), end = this->end();
-  while (i != end && i->GetTime() < min_time)
-    ++i;
+  auto i = LowerBound(min_time);
+  const auto end = points.end();
 
   if (i == end)
     return;
@@ -5,19 +5,13 @@
 
 #include "Point.hpp"
 #include "util/NonCopyable.hpp"
-#include "util/Sanitizer.hxx"
-#include "util/SliceAllocator.hxx"
 #include "util/Serial.hpp"
 #include "Geo/Flat/FlatBoundingBox.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "time/Stamp.hpp"
 
-#include <boost/intrusive/list.hpp>
-#include <boost/intrusive/set.hpp>
-#include <algorithm>
 #include <cassert>
-#include <type_traits>
-#include <stdlib.h>
+#include <vector>
 
 class TracePointVector;
 class TracePointerVector;
@@ -58,153 +52,25 @@ void FilterTraceByBounds(const TracePointVector &in,
  * the candidate point removed.  In this version, time differences is also a
  * secondary factor, such that thinning attempts to remove points such that,
  * for equal distance ranking, smaller time step details are removed first.
+ *
+ * The points are stored in one contiguous array in chronological
+ * order, so readers can scan them linearly and look up time ranges
+ * with a binary search.  The ranking metadata needed for thinning is
+ * only built (in separate arrays) while thinning a batch of points.
  */
 class Trace : private NonCopyable
 {
   using Time = TracePoint::Time;
 
-  struct TraceDelta
-    : boost::intrusive::set_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>,
-      boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>> {
-
-    /**
-     * Function used to points for sorting by deltas.
-     * Ranking is primarily by distance delta; for equal distances, rank by
-     * time delta.
-     * This is like a modified Douglas-Peuker algorithm
-     */
-    [[gnu::pure]]
-    static constexpr bool DeltaRank(const TraceDelta &x,
-                                    const TraceDelta &y) noexcept {
-      // distance is king
-      if (x.elim_distance < y.elim_distance)
-        return true;
-
-      if (x.elim_distance > y.elim_distance)
-        return false;
-
-      // distance is equal, so go by time error
-      if (x.elim_time < y.elim_time)
-        return true;
-
-      if (x.elim_time > y.elim_time)
-        return false;
-
-      // all else fails, go by age
-      if (x.point.IsOlderThan(y.point))
-        return true;
-
-      if (x.point.IsNewerThan(y.point))
-        return false;
-
-      return false;
-    }
-
-    struct DeltaRankOp {
-      constexpr bool operator()(const TraceDelta &s1,
-                                const TraceDelta &s2) const noexcept {
-        return DeltaRank(s1, s2);
-      }
-    };
-
-    TracePoint point;
-
-    Time elim_time;
-    unsigned elim_distance;
-    unsigned delta_distance;
-
-    explicit TraceDelta(const TracePoint &p) noexcept
-      :point(p),
-       elim_time(null_time), elim_distance(null_delta),
-       delta_distance(0) {}
-
-    TraceDelta(const TracePoint &p_last, const TracePoint &p,
-               const TracePoint &p_next) noexcept
-      :point(p),
-       elim_time(TimeMetric(p_last, p, p_next)),
-       elim_distance(DistanceMetric(p_last, p, p_next)),
-       delta_distance(p.FlatDistanceTo(p_last))
-    {
-      assert(elim_distance != null_delta);
-    }
-
-    /**
-     * Is this the first or the last point?
-     */
-    constexpr bool IsEdge() const noexcept {
-      return elim_time == null_time;
-    }
-
-    void Update(const TracePoint &p_last, const TracePoint &p_next) noexcept {
-      elim_time = TimeMetric(p_last, point, p_next);
-      elim_distance = DistanceMetric(p_last, point, p_next);
-      delta_distance = point.FlatDistanceTo(p_last);
-    }
-
-    /**
-     * Calculate error distance, between last through this to next,
-     * if this node is removed.  This metric provides for Douglas-Peuker
-     * thinning.
-     *
-     * @param last Point previous in time to this node
-     * @param node This node
-     * @param next Point succeeding this node
-     *
-     * @return Distance error if this node is thinned
-     */
-    [[gnu::pure]]
-    static unsigned DistanceMetric(const TracePoint &last,
-                                   const TracePoint &node,
-                                   const TracePoint &next) noexcept {
-      const int d_this = last.FlatDistanceTo(node) + node.FlatDistanceTo(next);
-      const int d_rem = last.FlatDistanceTo(next);
-      return abs(d_this - d_rem);
-    }
-
-    /**
-     * Calculate error time, between last through this to next,
-     * if this node is removed.  This metric provides for fair thinning
-     * (tendency to to result in equal time steps)
-     *
-     * @param last Point previous in time to this node
-     * @param node This node
-     * @param next Point succeeding this node
-     *
-     * @return Time delta if this node is thinned
-     */
-    static constexpr Time TimeMetric(const TracePoint &last,
-                                     const TracePoint &node,
-                                     const TracePoint &next) noexcept {
-      return next.DeltaTime(last)
-        - std::min(next.DeltaTime(node), node.DeltaTime(last));
-    }
-  };
-
-  /* using multiset, not because we need multiple values (we don't),
-     but to avoid set's overhead for duplicate elimination */
-  typedef boost::intrusive::multiset<TraceDelta,
-                                     boost::intrusive::compare<TraceDelta::DeltaRankOp>,
-                                     boost::intrusive::constant_time_size<false>> DeltaList;
-
-  typedef boost::intrusive::list<TraceDelta,
-                                 boost::intrusive::constant_time_size<false>> ChronologicalList;
+  using PointList = std::vector<TracePoint>;
 
   /**
-   * Use a SliceAllocator for allocating TraceDelta instances.  This
-   * reduces a lot of allocation overhead (both CPU and memory),
-   * because there will be lots of these objects.  Fall back to
-   * std::allocator when compiled with AddressSanitizer, because that
-   * avoids hiding memory errors.
+   * All points in chronological order.  Its capacity is reserved
+   * with the first point and it never grows beyond #max_size, so
+   * pointers obtained by GetPoints(TracePointerVector &) remain valid
+   * until the next modification (see GetModifySerial()).
    */
-  using Allocator = std::conditional_t<HaveAddressSanitizer(),
-                                       std::allocator<TraceDelta>,
-                                       SliceAllocator<TraceDelta, 128u>>;
-
-  Allocator allocator;
-
-  DeltaList delta_list;
-  ChronologicalList chronological_list;
-  unsigned cached_size;
+  PointList points;
 
   TaskProjection task_projection;
 
@@ -218,25 +84,6 @@ class Trace : private NonCopyable
 
   Serial append_serial, modify_serial;
 
-  template<typename Alloc>
-  struct Disposer {
-    Alloc &alloc;
-
-    void operator()(typename std::allocator_traits<Alloc>::pointer td) {
-      std::allocator_traits<Alloc>::destroy(alloc, td);
-      alloc.deallocate(td, 1);
-    }
-  };
-
-  template<typename Alloc>
-  static Disposer<Alloc> MakeDisposer(Alloc &alloc) {
-    return {alloc};
-  }
-
-  Disposer<decltype(allocator)> MakeDisposer() {
-    return MakeDisposer(allocator);
-  }
-
 public:
   /**
    * Constructor.  Task projection is updated after first call to append().
@@ -250,10 +97,6 @@ public:
                  const Time max_time = null_time,
                  const unsigned max_size = 1000) noexcept;
 
-  ~Trace() noexcept {
-    clear();
-  }
-
 protected:
   /**
    * Find recent time after which points should not be culled
@@ -266,27 +109,6 @@ protected:
   [[gnu::pure]]
   Time GetRecentTime(Time t) const noexcept;
 
-  /**
-   * Update delta values for specified item in the delta list and the
-   * tree.  This repositions the item after into its sorted position.
-   *
-   * @param it Item to update
-   * @param tree Tree containing leaf
-   *
-   * @return Iterator to updated item
-   */
-  void UpdateDelta(TraceDelta &td) noexcept;
-
-  /**
-   * Erase a non-edge item from delta list and tree, updating
-   * deltas in the process.  This Invalidates the calling iterator.
-   *
-   * @param it Item to erase
-   * @param tree Tree to remove from
-   *
-   */
-  void EraseInside(DeltaList::iterator it) noexcept;
-
   /**
    * Erase elements based on delta metric until the size is
    * equal to the target size.  Wont remove elements more recent than
@@ -296,7 +118,6 @@ protected:
    * fail to set the target size.
    *
    * @param target_size Size of desired list.
-   * @param tree Tree to remove from
    * @param recent Time window for which to not remove points
    *
    * @return True if items were erased
@@ -305,11 +126,9 @@ protected:
                   Time recent = {}) noexcept;
 
   /**
-   * Erase elements older than specified time from delta and tree,
-   * and update earliest item to become the new start
+   * Erase elements older than specified time.
    *
    * @param p_time Time to remove
-   * @param tree Tree to remove from
    *
    * @return True if items were erased
    */
@@ -321,11 +140,6 @@ protected:
    */
   void EraseLaterThan(Time min_time) noexcept;
 
-  /**
-   * Update start node (and neighbour) after min time pruning
-   */
-  void EraseStart(TraceDelta &td_start) noexcept;
-
 public:
   /**
    * Add trace to internal store.  Call optimise() periodically
@@ -353,13 +167,10 @@ public:
   }
 
   /**
-   * Size of traces (in tree, not in temporary store) ---
-   * must call optimise() before this for it to be accurate.
-   *
-   * @return Number of traces in tree
+   * @return Number of points in the store
    */
   unsigned size() const noexcept {
-    return cached_size;
+    return points.size();
   }
 
   /**
@@ -368,7 +179,7 @@ public:
    * @return True if no traces stored
    */
   bool empty() const noexcept {
-    return cached_size == 0;
+    return points.empty();
   }
 
   /**
@@ -458,13 +269,13 @@ public:
   const TracePoint &front() const noexcept {
     assert(!empty());
 
-    return chronological_list.front().point;
+    return points.front();
   }
 
   const TracePoint &back() const noexcept {
     assert(!empty());
 
-    return chronological_list.back().point;
+    return points.back();
   }
 
 private:
@@ -491,17 +302,12 @@ private:
    */
   void Thin() noexcept;
 
-  TraceDelta &GetFront() noexcept {
-    assert(!empty());
-
-    return chronological_list.front();
-  }
-
-  TraceDelta &GetBack() noexcept {
-    assert(!empty());
-
-    return chronological_list.back();
-  }
+  /**
+   * Returns an iterator to the first point not before the given
+   * time.
+   */
+  [[gnu::pure]]
+  PointList::const_iterator LowerBound(Time min_time) const noexcept;
 
   [[gnu::pure]]
   unsigned CalcAverageDeltaDistance(Time no_thin) const noexcept;
@@ -509,8 +315,6 @@ private:
   [[gnu::pure]]
   Time CalcAverageDeltaTime(Time no_thin) const noexcept;
 
-  static constexpr unsigned null_delta = 0 - 1;
-
 public:
   static constexpr auto null_time = TracePoint::INVALID_TIME;
 
@@ -523,53 +327,14 @@ public:
   }
 
 public:
-  class const_iterator : public ChronologicalList::const_iterator {
-    friend class Trace;
-
-    const_iterator(ChronologicalList::const_iterator &&_iterator) noexcept
-      :ChronologicalList::const_iterator(std::move(_iterator)) {}
-
-  public:
-    using ChronologicalList::const_iterator::iterator_category;
-    using ChronologicalList::const_iterator::difference_type;
-    typedef const TracePoint value_type;
-    typedef const TracePoint *pointer;
-    typedef const TracePoint &reference;
-
-    const_iterator() = default;
-
-    const TracePoint &operator*() const noexcept {
-      const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-      return td.point;
-    }
-
-    const TracePoint *operator->() const noexcept {
-      const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-      return &td.point;
-    }
-
-    const_iterator &NextSquareRange(unsigned sq_resolution,
-                                    const const_iterator &end) noexcept {
-      const TracePoint &previous = **this;
-      while (true) {
-        ++*this;
-
-        if (*this == end)
-          return *this;
-
-        const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-        if (td.point.FlatSquareDistanceTo(previous) >= sq_resolution)
-          return *this;
-      }
-    }
-  };
+  using const_iterator = PointList::const_iterator;
 
   const_iterator begin() const noexcept {
-    return chronological_list.begin();
+    return points.begin();
   }
 
   const_iterator end() const noexcept {
-    return chronological_list.end();
+    return points.end();
   }
 
   const TaskProjection &GetProjection() const noexcept {
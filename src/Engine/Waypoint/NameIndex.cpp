@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "NameIndex.hpp"
+#include "NameSearch.hpp"
+#include "Waypoint.hpp"
+#include "util/StringAPI.hxx"
+#include "util/StringUtil.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+static constexpr uint_least32_t
+MakeTrigram(const char *p) noexcept
+{
+  return (uint_least32_t(uint8_t(p[0])) << 16) |
+    (uint_least32_t(uint8_t(p[1])) << 8) |
+    uint_least32_t(uint8_t(p[2]));
+}
+
+void
+WaypointNameIndex::Clear() noexcept
+{
+  valid = false;
+  entries.clear();
+  names.clear();
+  trigrams.clear();
+  offsets.clear();
+  postings.clear();
+}
+
+unsigned
+WaypointNameIndex::AddName(std::string_view name) noexcept
+{
+  if (name.empty() || name.size() >= NAME_SEARCH_BUFFER_SIZE)
+    /* WaypointMatchesNormalisedSubstring() ignores overlong names */
+    return NO_NAME;
+
+  const unsigned offset = names.size();
+  names.resize(offset + name.size() + 1);
+  NormalizeSearchString(names.data() + offset, name);
+  names.resize(offset + strlen(names.data() + offset) + 1);
+  return offset;
+}
+
+void
+WaypointNameIndex::Add(const WaypointPtr &wp) noexcept
+{
+  const unsigned name = AddName(wp->name);
+  const unsigned shortname = AddName(wp->shortname);
+  entries.push_back({wp, name, shortname});
+}
+
+void
+WaypointNameIndex::Commit() noexcept
+{
+  /* collect (trigram, entry) pairs, sort them and convert them to
+     posting lists */
+
+  std::vector<uint_least64_t> pairs;
+
+  for (unsigned i = 0; i < entries.size(); ++i) {
+    for (const unsigned offset : {entries[i].name, entries[i].shortname}) {
+      if (offset == NO_NAME)
+        continue;
+
+      const char *name = names.data() + offset;
+      const std::size_t length = strlen(name);
+      for (std::size_t j = 0; j + 3 <= length; ++j)
+        pairs.push_back((uint_least64_t(MakeTrigram(name + j)) << 32) | i);
+    }
+  }
+
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  postings.reserve(pairs.size());
+  for (const auto pair : pairs) {
+    const uint_least32_t trigram = pair >> 32;
+    if (trigrams.empty() || trigrams.back() != trigram) {
+      trigrams.push_back(trigram);
+      offsets.push_back(postings.size());
+    }
+
+    postings.push_back(unsigned(pair));
+  }
+
+  offsets.push_back(postings.size());
+
+  valid = true;
+}
+
+inline bool
+WaypointNameIndex::Matches(const Entry &entry,
+                           const char *needle) const noexcept
+{
+  return (entry.name != NO_NAME &&
+          StringFind(names.data() + entry.name, needle) != nullptr) ||
+    (entry.shortname != NO_NAME &&
+     StringFind(names.data() + entry.shortname, needle) != nullptr);
+}
+
+inline std::pair<const unsigned *, const unsigned *>
+WaypointNameIndex::FindPostings(uint_least32_t trigram) const noexcept
+{
+  const auto i = std::lower_bound(trigrams.begin(), trigrams.end(), trigram);
+  if (i == trigrams.end() || *i != trigram)
+    return {nullptr, nullptr};
+
+  const std::size_t n = std::distance(trigrams.begin(), i);
+  return {postings.data() + offsets[n], postings.data() + offsets[n + 1]};
+}
+
+void
+WaypointNameIndex::VisitNormalisedSubstring(const char *needle,
+                                            const std::function<void(const WaypointPtr &)> &visitor) const
+{
+  assert(valid);
+
+  const std::size_t length = strlen(needle);
+
+  if (length == 0) {
+    for (const auto &entry : entries)
+      visitor(entry.waypoint);
+    return;
+  }
+
+  if (length < 3) {
+    /* too short for the trigram index; scan the pre-normalised
+       names */
+    for (const auto &entry : entries)
+      if (Matches(entry, needle))
+        visitor(entry.waypoint);
+    return;
+  }
+
+  /* every match contains all trigrams of the needle; check only the
+     waypoints listed for the rarest one */
+
+  std::pair<const unsigned *, const unsigned *> best{nullptr, nullptr};
+  for (std::size_t i = 0; i + 3 <= length; ++i) {
+    const auto p = FindPostings(MakeTrigram(needle + i));
+    if (p.first == p.second)
+      /* this trigram does not occur anywhere */
+      return;
+
+    if (best.first == nullptr ||
+        p.second - p.first < best.second - best.first)
+      best = p;
+  }
+
+  for (const unsigned *i = best.first; i != best.second; ++i) {
+    const Entry &entry = entries[*i];
+    if (Matches(entry, needle))
+      visitor(entry.waypoint);
+  }
+}
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Ptr.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * An index of all trigrams (sequences of three characters) in the
+ * normalised names and shortnames of a set of waypoints.  It finds
+ * substring matches by checking only the waypoints which contain the
+ * rarest trigram of the needle, instead of normalising and scanning
+ * every name.
+ *
+ * The index is a snapshot; it must be rebuilt after the waypoint set
+ * has been modified.
+ */
+class WaypointNameIndex {
+  static constexpr unsigned NO_NAME = ~0u;
+
+  struct Entry {
+    WaypointPtr waypoint;
+
+    /**
+     * Offsets of the NUL-terminated normalised name and shortname in
+     * #names; #NO_NAME if there is none.
+     */
+    unsigned name, shortname;
+  };
+
+  std::vector<Entry> entries;
+
+  std::string names;
+
+  /**
+   * The sorted list of distinct trigrams.
+   */
+  std::vector<uint_least32_t> trigrams;
+
+  /**
+   * The postings of trigrams[i] are postings[offsets[i]] to
+   * postings[offsets[i+1]-1]; each is an index into #entries, in
+   * ascending order.
+   */
+  std::vector<unsigned> offsets, postings;
+
+  bool valid = false;
+
+public:
+  bool IsValid() const noexcept {
+    return valid;
+  }
+
+  /**
+   * Discard the index (and the references to all waypoints).
+   */
+  void Clear() noexcept;
+
+  /**
+   * Build the index from a range of #WaypointPtr.  Waypoints are
+   * visited in this order by VisitNormalisedSubstring().
+   */
+  template<typename R>
+  void Build(const R &waypoints) noexcept {
+    Clear();
+
+    for (const auto &wp : waypoints)
+      Add(wp);
+
+    Commit();
+  }
+
+  /**
+   * Call the visitor on each waypoint whose normalised name or
+   * shortname contains the given (already normalised, see
+   * NormalizeSearchString()) needle.  An empty needle matches all
+   * waypoints.
+   *
+   * The index must be valid.
+   */
+  void VisitNormalisedSubstring(const char *needle,
+                                const std::function<void(const WaypointPtr &)> &visitor) const;
+
+private:
+  unsigned AddName(std::string_view name) noexcept;
+  void Add(const WaypointPtr &wp) noexcept;
+  void Commit() noexcept;
+
+  [[gnu::pure]]
+  bool Matches(const Entry &entry, const char *needle) const noexcept;
+
+  /**
+   * Returns the postings of the specified trigram (an empty range if
+   * it does not occur anywhere).
+   */
+  [[gnu::pure]]
+  std::pair<const unsigned *, const unsigned *>
+  FindPostings(uint_least32_t trigram) const noexcept;
+};
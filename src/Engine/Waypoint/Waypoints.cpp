@@ -80,19 +80,21 @@ Waypoints::Waypoints() noexcept = default;
 void
 Waypoints::Optimise() noexcept
 {
-  if (waypoint_tree.IsEmpty() || waypoint_tree.HaveBounds())
-    /* empty or already optimised */
-    return;
-
-  task_projection.Update();
+  /* not empty and not already optimised? */
+  if (!waypoint_tree.IsEmpty() && !waypoint_tree.HaveBounds()) {
+    task_projection.Update();
+
+    for (auto &i : waypoint_tree) {
+      // TODO: eliminate this const_cast hack
+      Waypoint &w = const_cast<Waypoint &>(*i);
+      w.Project(task_projection);
+    }
 
-  for (auto &i : waypoint_tree) {
-    // TODO: eliminate this const_cast hack
-    Waypoint &w = const_cast<Waypoint &>(*i);
-    w.Project(task_projection);
+    waypoint_tree.Optimise();
   }
 
-  waypoint_tree.Optimise();
+  if (!name_index.IsValid())
+    name_index.Build(waypoint_tree);
 }
 
 void
@@ -115,6 +117,7 @@ Waypoints::Append(WaypointPtr wp) noexcept
 
   waypoint_tree.Add(wp);
   name_tree.Add(wp);
+  name_index.Clear();
 
   ++serial;
 }
@@ -360,6 +363,11 @@ Waypoints::VisitNameSubstring(std::string_view substring,
   char needle[NAME_SEARCH_BUFFER_SIZE];
   NormalizeSearchString(needle, substring);
 
+  if (name_index.IsValid()) {
+    name_index.VisitNormalisedSubstring(needle, visitor);
+    return;
+  }
+
   for (const auto &wp : waypoint_tree)
     if (WaypointMatchesNormalisedSubstring(*wp, needle))
       visitor(wp);
@@ -371,6 +379,7 @@ Waypoints::Clear() noexcept
   ++serial;
   home = nullptr;
   name_tree.Clear();
+  name_index.Clear();
   waypoint_tree.clear();
   next_id = 1;
 }
@@ -388,6 +397,7 @@ Waypoints::Erase(WaypointPtr &&wp) noexcept
   assert(f.first != waypoint_tree.end());
 
   name_tree.Remove(std::move(wp));
+  name_index.Clear();
   waypoint_tree.erase(f.first);
   ++serial;
 }
@@ -402,6 +412,7 @@ Waypoints::EraseUserMarkers() noexcept
           home = nullptr;
 
         name_tree.Remove(wp);
+        name_index.Clear();
         ++serial;
         return true;
       } else
@@ -415,6 +426,7 @@ Waypoints::Replace(const WaypointPtr &orig, Waypoint &&replacement) noexcept
   assert(!waypoint_tree.IsEmpty());
 
   name_tree.Remove(orig);
+  name_index.Clear();
 
   replacement.id = orig->id;
 
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "Ptr.hpp"
+#include "NameIndex.hpp"
 #include "Waypoint.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "util/RadixTree.hpp"
@@ -62,6 +63,13 @@ class Waypoints {
 
   WaypointTree waypoint_tree;
   WaypointNameTree name_tree;
+
+  /**
+   * Speeds up VisitNameSubstring().  It is built by Optimise() and
+   * cleared by all modifications.
+   */
+  WaypointNameIndex name_index;
+
   TaskProjection task_projection;
 
   WaypointPtr home;
@@ -142,7 +150,8 @@ public:
 
   /**
    * Optimise the internal search tree after adding/removing elements.
-   * Also performs projection to flat earth for new elements.
+   * Also performs projection to flat earth for new elements and
+   * rebuilds the name index used by VisitNameSubstring().
    * This updates the task_projection.
    *
    * Note: currently this code doesn't check for task projections
@@ -296,9 +305,12 @@ public:
    * shortname) contains the specified substring.  An empty
    * substring matches every waypoint.
    *
-   * This is a linear scan over all waypoints; cost is
-   * O(N * avg_name_length).  Each waypoint is visited at most
-   * once even if it matches via both name and shortname.
+   * After Optimise(), this looks up candidates in a trigram index
+   * and checks only those; needles shorter than three characters
+   * scan all (pre-normalised) names.  If the waypoints were modified
+   * since the last Optimise() call, this falls back to a linear
+   * scan.  Each waypoint is visited at most once even if it matches
+   * via both name and shortname.
    */
   void VisitNameSubstring(std::string_view substring,
                           WaypointVisitor visitor) const;
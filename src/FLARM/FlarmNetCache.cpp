@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "FlarmNetCache.hpp"
+#include "FlarmNetDatabase.hpp"
+#include "io/FileMapping.hpp"
+#include "io/FileOutputStream.hxx"
+#include "system/FileUtil.hpp"
+#include "system/Path.hpp"
+#include "util/SpanCast.hxx"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<FlarmNetRecord>,
+              "FlarmNetRecord cannot be mapped from a file");
+
+namespace {
+
+struct Header {
+  static constexpr uint32_t MAGIC = 0x464e6574;
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic, version;
+
+  /**
+   * sizeof(FlarmNetRecord); detects changes of the record layout.
+   */
+  uint32_t record_size;
+
+  uint32_t n_records;
+
+  /**
+   * The size and modification time of the FlarmNet.org file.
+   */
+  uint64_t file_size;
+  int64_t file_mtime;
+};
+
+static_assert(sizeof(Header) % alignof(FlarmNetRecord) == 0);
+static_assert(sizeof(FlarmNetRecord) % alignof(uint32_t) == 0);
+
+} // anonymous namespace
+
+static Header
+MakeHeader(Path original_path, std::size_t n_records) noexcept
+{
+  Header header{};
+  header.magic = Header::MAGIC;
+  header.version = Header::VERSION;
+  header.record_size = sizeof(FlarmNetRecord);
+  header.n_records = n_records;
+  header.file_size = File::GetSize(original_path);
+  header.file_mtime = File::GetLastModification(original_path)
+    .time_since_epoch().count();
+  return header;
+}
+
+bool
+FlarmNetCache::Load(Path path, Path original_path,
+                    FlarmNetDatabase &database)
+{
+  if (!File::Exists(path))
+    return false;
+
+  auto mapping = std::make_unique<FileMapping>(path);
+  const std::span<const std::byte> data = *mapping;
+
+  Header header;
+  if (data.size() < sizeof(header))
+    return false;
+
+  memcpy(&header, data.data(), sizeof(header));
+
+  const Header expected = MakeHeader(original_path, header.n_records);
+  if (memcmp(&header, &expected, sizeof(header)) != 0)
+    return false;
+
+  const std::size_t n = header.n_records;
+  const std::size_t records_size = n * sizeof(FlarmNetRecord);
+  if (data.size() != sizeof(header) + records_size + n * sizeof(uint32_t))
+    return false;
+
+  const auto records = FromBytesStrict<const FlarmNetRecord>
+    (data.subspan(sizeof(header), records_size));
+  const auto callsign_index = FromBytesStrict<const uint32_t>
+    (data.subspan(sizeof(header) + records_size));
+
+  /* check the index, because it is used without bounds checks */
+  for (const uint32_t i : callsign_index)
+    if (i >= n)
+      return false;
+
+  database.Attach(std::move(mapping), records, callsign_index);
+  return true;
+}
+
+void
+FlarmNetCache::Save(Path path, Path original_path,
+                    const FlarmNetDatabase &database)
+{
+  const auto records = database.GetRecords();
+  const auto callsign_index = database.GetCallSignIndex();
+  const Header header = MakeHeader(original_path, records.size());
+
+  FileOutputStream file(path);
+  file.Write(ReferenceAsBytes(header));
+  file.Write(std::as_bytes(records));
+  file.Write(std::as_bytes(callsign_index));
+  file.Commit();
+}
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+class Path;
+class FlarmNetDatabase;
+
+/**
+ * A binary copy of a parsed FlarmNet.org file which can be
+ * memory-mapped instead of parsing the text file again.
+ *
+ * The file consists of a header, the #FlarmNetRecord array sorted by
+ * id and the callsign index (see FlarmNetDatabase).  The header
+ * contains the size and modification time of the text file; if these
+ * do not match, the cache is ignored.  The format depends on the
+ * memory layout of #FlarmNetRecord, therefore the cache can only be
+ * used on the machine which created it.
+ */
+namespace FlarmNetCache {
+
+/**
+ * Map the cache file into the database.
+ *
+ * Throws on I/O error.
+ *
+ * @param path the path of the cache file
+ * @param original_path the path of the FlarmNet.org file
+ * @return false if the cache file is stale or malformed
+ */
+bool
+Load(Path path, Path original_path, FlarmNetDatabase &database);
+
+/**
+ * Write the (committed) database to a cache file.
+ *
+ * Throws on I/O error.
+ *
+ * @param path the path of the cache file
+ * @param original_path the path of the FlarmNet.org file which was
+ * loaded into the database
+ */
+void
+Save(Path path, Path original_path, const FlarmNetDatabase &database);
+
+} // namespace FlarmNetCache
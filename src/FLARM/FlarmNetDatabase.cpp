@@ -2,10 +2,25 @@
 // Copyright The XCSoar Project
 
 #include "FlarmNetDatabase.hpp"
+#include "io/FileMapping.hpp"
 #include "util/StringAPI.hxx"
 
+#include <algorithm>
 #include <cassert>
 
+FlarmNetDatabase::FlarmNetDatabase() noexcept = default;
+FlarmNetDatabase::~FlarmNetDatabase() noexcept = default;
+
+void
+FlarmNetDatabase::Clear() noexcept
+{
+  owned_records = {};
+  owned_callsign_index = {};
+  mapping.reset();
+  records = {};
+  callsign_index = {};
+}
+
 void
 FlarmNetDatabase::Insert(const FlarmNetRecord &record) noexcept
 {
@@ -13,34 +28,107 @@ FlarmNetDatabase::Insert(const FlarmNetRecord &record) noexcept
     /* ignore malformed records */
     return;
 
-  map.insert(std::make_pair(record.id, record));
+  assert(mapping == nullptr);
+
+  owned_records.push_back(record);
+}
+
+void
+FlarmNetDatabase::Commit() noexcept
+{
+  assert(mapping == nullptr);
+
+  /* the stable sort keeps the first of several records with the
+     same id in front, which is the one std::unique() keeps */
+  std::stable_sort(owned_records.begin(), owned_records.end(),
+                   [](const FlarmNetRecord &a, const FlarmNetRecord &b){
+                     return a.id < b.id;
+                   });
+  owned_records.erase(std::unique(owned_records.begin(), owned_records.end(),
+                                  [](const FlarmNetRecord &a,
+                                     const FlarmNetRecord &b){
+                                    return a.id == b.id;
+                                  }),
+                      owned_records.end());
+  owned_records.shrink_to_fit();
+
+  owned_callsign_index.resize(owned_records.size());
+  for (std::size_t i = 0; i < owned_callsign_index.size(); ++i)
+    owned_callsign_index[i] = i;
+
+  std::stable_sort(owned_callsign_index.begin(), owned_callsign_index.end(),
+                   [this](uint32_t a, uint32_t b){
+                     return StringCompare(owned_records[a].callsign,
+                                          owned_records[b].callsign) < 0;
+                   });
+
+  records = owned_records;
+  callsign_index = owned_callsign_index;
+}
+
+void
+FlarmNetDatabase::Attach(std::unique_ptr<FileMapping> &&_mapping,
+                         std::span<const FlarmNetRecord> _records,
+                         std::span<const uint32_t> _callsign_index) noexcept
+{
+  assert(_records.size() == _callsign_index.size());
+
+  Clear();
+
+  mapping = std::move(_mapping);
+  records = _records;
+  callsign_index = _callsign_index;
 }
 
 const FlarmNetRecord *
-FlarmNetDatabase::FindFirstRecordByCallSign(const char *cn) const noexcept
+FlarmNetDatabase::FindRecordById(FlarmId id) const noexcept
 {
-  for (const auto &[id, record] : map) {
-    assert(id.IsDefined());
+  auto i = std::lower_bound(records.begin(), records.end(), id,
+                            [](const FlarmNetRecord &record, FlarmId id){
+                              return record.id < id;
+                            });
+  return i != records.end() && i->id == id
+    ? &*i
+    : NULL;
+}
 
-    if (StringIsEqual(record.callsign, cn))
-      return &record;
-  }
+inline std::span<const uint32_t>
+FlarmNetDatabase::FindCallSign(const char *cn) const noexcept
+{
+  const auto begin =
+    std::lower_bound(callsign_index.begin(), callsign_index.end(), cn,
+                     [this](uint32_t i, const char *cn){
+                       return StringCompare(records[i].callsign, cn) < 0;
+                     });
+  const auto end =
+    std::upper_bound(begin, callsign_index.end(), cn,
+                     [this](const char *cn, uint32_t i){
+                       return StringCompare(cn, records[i].callsign) < 0;
+                     });
+  return {begin, end};
+}
 
-  return NULL;
+const FlarmNetRecord *
+FlarmNetDatabase::FindFirstRecordByCallSign(const char *cn) const noexcept
+{
+  const auto r = FindCallSign(cn);
+  return r.empty()
+    ? NULL
+    : &records[r.front()];
 }
 
 unsigned
 FlarmNetDatabase::FindRecordsByCallSign(const char *cn,
                                         const FlarmNetRecord *array[],
-                                        [[maybe_unused]] unsigned size) const noexcept
+                                        unsigned size) const noexcept
 {
   unsigned count = 0;
 
-  for (const auto &[id, record] : map) {
-    assert(id.IsDefined());
+  for (const uint32_t i : FindCallSign(cn)) {
+    if (count >= size)
+      break;
 
-    if (StringIsEqual(record.callsign, cn))
-      array[count++] = &record;
+    array[count++] = &records[i];
   }
 
   return count;
@@ -48,15 +136,16 @@ FlarmNetDatabase::FindRecordsByCallSign(const char *cn,
 
 unsigned
 FlarmNetDatabase::FindIdsByCallSign(const char *cn, FlarmId array[],
-                                    [[maybe_unused]] unsigned size) const noexcept
+                                    unsigned size) const noexcept
 {
   unsigned count = 0;
 
-  for (const auto &[id, record] : map) {
-    assert(id.IsDefined());
+  for (const uint32_t i : FindCallSign(cn)) {
+    if (count >= size)
+      break;
 
-    if (StringIsEqual(record.callsign, cn))
-      array[count++] = id;
+    assert(records[i].id.IsDefined());
+    array[count++] = records[i].id;
   }
 
   return count;
@@ -6,37 +6,103 @@
 #include "Id.hpp"
 #include "FlarmNetRecord.hpp"
 
-#include <map>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+class FileMapping;
+
 /**
  * An in-memory representation of the FlarmNet.org database.
+ *
+ * The records are kept in an array sorted by FLARM id, and a second
+ * array with record indices sorted by callsign speeds up the callsign
+ * lookups.  Both arrays are either owned by this object (filled with
+ * Insert() and Commit()) or memory-mapped from a cache file (see
+ * FlarmNetCache).
  */
 class FlarmNetDatabase {
-  typedef std::map<FlarmId, FlarmNetRecord> RecordMap;
-  RecordMap map;
+  /**
+   * Records owned by this object; unsorted between Insert() and
+   * Commit().
+   */
+  std::vector<FlarmNetRecord> owned_records;
+  std::vector<uint32_t> owned_callsign_index;
+
+  /**
+   * The mapped cache file; nullptr if the arrays are owned.
+   */
+  std::unique_ptr<FileMapping> mapping;
+
+  std::span<const FlarmNetRecord> records;
+
+  /**
+   * Indices into #records sorted by callsign and (for equal
+   * callsigns) by FLARM id.
+   */
+  std::span<const uint32_t> callsign_index;
 
 public:
+  FlarmNetDatabase() noexcept;
+  ~FlarmNetDatabase() noexcept;
+
+  FlarmNetDatabase(const FlarmNetDatabase &) = delete;
+  FlarmNetDatabase &operator=(const FlarmNetDatabase &) = delete;
+
   bool IsEmpty() const noexcept {
-    return map.empty();
+    return records.empty();
   }
 
-  void Clear() noexcept {
-    map.clear();
+  std::size_t size() const noexcept {
+    return records.size();
   }
 
+  void Clear() noexcept;
+
+  /**
+   * Add a record.  It cannot be found until Commit() is called.  If
+   * there are several records with the same id, the first one wins.
+   */
   void Insert(const FlarmNetRecord &record) noexcept;
 
+  /**
+   * Sort the records inserted with Insert() and build the callsign
+   * index.
+   */
+  void Commit() noexcept;
+
+  /**
+   * Replace the contents with arrays inside a mapped file.  The
+   * arrays must be sorted as described for #records and
+   * #callsign_index (i.e. they were obtained from GetRecords() and
+   * GetCallSignIndex() of a committed database).
+   */
+  void Attach(std::unique_ptr<FileMapping> &&_mapping,
+              std::span<const FlarmNetRecord> _records,
+              std::span<const uint32_t> _callsign_index) noexcept;
+
+  /**
+   * Returns all records sorted by FLARM id.
+   */
+  std::span<const FlarmNetRecord> GetRecords() const noexcept {
+    return records;
+  }
+
+  /**
+   * Returns the indices of all records sorted by callsign.
+   */
+  std::span<const uint32_t> GetCallSignIndex() const noexcept {
+    return callsign_index;
+  }
+
   /**
    * Finds a FLARMNetRecord object based on the given FLARM id
    * @param id FLARM id
    * @return FLARMNetRecord object
    */
   [[gnu::pure]]
-  const FlarmNetRecord *FindRecordById(FlarmId id) const noexcept {
-    auto i = map.find(id);
-    return i != map.end()
-      ? &i->second
-      : NULL;
-  }
+  const FlarmNetRecord *FindRecordById(FlarmId id) const noexcept;
 
   /**
    * Finds a FLARMNetRecord object based on the given Callsign
@@ -54,11 +120,19 @@ public:
 
   [[gnu::pure]]
   auto begin() const noexcept {
-    return map.begin();
+    return records.begin();
   }
 
   [[gnu::pure]]
   auto end() const noexcept {
-    return map.end();
+    return records.end();
   }
+
+private:
+  /**
+   * Returns the range of #callsign_index entries with the given
+   * callsign.
+   */
+  [[gnu::pure]]
+  std::span<const uint32_t> FindCallSign(const char *cn) const noexcept;
 };
@@ -6,6 +6,7 @@
 #include "Global.hpp"
 #include "TrafficDatabases.hpp"
 #include "FlarmNetReader.hpp"
+#include "FlarmNetCache.hpp"
 #include "NameFile.hpp"
 #include "MessagingFile.hpp"
 #include "Components.hpp"
@@ -13,6 +14,7 @@
 #include "MergeThread.hpp"
 #include "Repository/FileType.hpp"
 #include "io/DataFile.hpp"
+#include "io/FileCache.hpp"
 #include "io/Reader.hxx"
 #include "io/BufferedReader.hxx"
 #include "io/LineReader.hpp"
@@ -25,8 +27,12 @@
 #include "Profile/Keys.hpp"
 #include "time/PeriodClock.hpp"
 
+static constexpr char flarmnet_cache_name[] = "flarmnet.bin";
+
 /**
- * Loads the FLARMnet file
+ * Loads the FLARMnet file.  The parsed database is saved to the file
+ * cache, and subsequent calls map the cache instead of parsing the
+ * text file again.
  */
 static void
 LoadFLARMnet(FlarmNetDatabase &db) noexcept
@@ -36,9 +42,32 @@ try {
     return;
   }
 
+  AllocatedPath cache_path;
+  if (file_cache != nullptr) {
+    cache_path = file_cache->CreatePath(flarmnet_cache_name);
+
+    try {
+      if (FlarmNetCache::Load(cache_path, path, db)) {
+        LogFormat("FLARMnet IDs found in cache: %u", unsigned(db.size()));
+        return;
+      }
+    } catch (...) {
+      LogError(std::current_exception(), "Failed to load FLARMnet cache");
+    }
+  }
+
   unsigned num_records = FlarmNetReader::LoadFile(path, db);
-  if (num_records > 0)
+  if (num_records > 0) {
     LogFormat("FLARMnet IDs found: %u", num_records);
+
+    if (cache_path != nullptr) {
+      try {
+        FlarmNetCache::Save(cache_path, path, db);
+      } catch (...) {
+        LogError(std::current_exception(), "Failed to save FLARMnet cache");
+      }
+    }
+  }
 } catch (...) {
   LogError(std::current_exception());
 }
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "PolygonEdges.hpp"
+#include "SearchPointVector.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+void
+PolygonEdges::Update(const SearchPointVector &border) noexcept
+{
+  if (border.size() < 2) {
+    Clear();
+    return;
+  }
+
+  n = border.size() - 1;
+  geo.resize(2 * (n + 1));
+  flat.resize(2 * (n + 1) + 4 * n);
+
+  double *const lon = geo.data(), *const lat = lon + n + 1;
+  int *const x = flat.data(), *const y = x + n + 1;
+  int *const min_x = y + n + 1, *const max_x = min_x + n;
+  int *const min_y = max_x + n, *const max_y = min_y + n;
+
+  for (std::size_t i = 0; i <= n; ++i) {
+    const auto &location = border[i].GetLocation();
+    lon[i] = location.longitude.Native();
+    lat[i] = location.latitude.Native();
+
+    const auto &flat_location = border[i].GetFlatLocation();
+    x[i] = flat_location.x;
+    y[i] = flat_location.y;
+  }
+
+  for (std::size_t i = 0; i < n; ++i) {
+    min_x[i] = std::min(x[i], x[i + 1]);
+    max_x[i] = std::max(x[i], x[i + 1]);
+    min_y[i] = std::min(y[i], y[i + 1]);
+    max_y[i] = std::max(y[i], y[i + 1]);
+  }
+}
+
+bool
+PolygonEdges::IsInside(const GeoPoint &p) const noexcept
+{
+  /* this is the winding number test of PolygonInterior(), written
+     without branches */
+
+  if (n < 2)
+    return false;
+
+  const double *const lon = geo.data(), *const lat = lon + n + 1;
+  const double px = p.longitude.Native(), py = p.latitude.Native();
+
+  int wn = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const double is_left = (lon[i + 1] - lon[i]) * (py - lat[i]) -
+      (lat[i + 1] - lat[i]) * (px - lon[i]);
+
+    const bool up = (lat[i] <= py) & (lat[i + 1] > py) & (is_left > 0);
+    const bool down = (lat[i] > py) & (lat[i + 1] <= py) & (is_left < 0);
+    wn += int(up) - int(down);
+  }
+
+  return wn != 0;
+}
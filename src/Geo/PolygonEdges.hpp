@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Flat/FlatRay.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct GeoPoint;
+class SearchPointVector;
+
+/**
+ * A copy of a closed polygon's outline in a "structure of arrays"
+ * layout: all longitudes, all latitudes, all flat coordinates and the
+ * flat bounding box of each edge are stored in separate contiguous
+ * arrays.  This allows point-in-polygon and ray intersection tests to
+ * run as tight loops which the compiler can vectorise, instead of
+ * walking over #SearchPoint objects.
+ *
+ * The flat coordinates are a snapshot; Update() must be called again
+ * after the #SearchPointVector has been projected.
+ */
+class PolygonEdges {
+  /**
+   * The number of edges.  There is one more vertex, because the
+   * last vertex closes the polygon.
+   */
+  std::size_t n = 0;
+
+  /**
+   * Longitudes and latitudes (native angle units) of all vertices:
+   * n+1 longitudes followed by n+1 latitudes.
+   */
+  std::vector<double> geo;
+
+  /**
+   * Flat coordinates of all vertices (n+1 x followed by n+1 y),
+   * followed by the flat bounding box of each edge (n min_x, n max_x,
+   * n min_y, n max_y).
+   */
+  std::vector<int> flat;
+
+public:
+  bool empty() const noexcept {
+    return n == 0;
+  }
+
+  void Clear() noexcept {
+    n = 0;
+    geo.clear();
+    flat.clear();
+  }
+
+  /**
+   * Copy the outline.  The last point must be equal to the first
+   * one, and the #SearchPointVector must have been projected.
+   */
+  void Update(const SearchPointVector &border) noexcept;
+
+  /**
+   * Is the given location inside the polygon?  Same result as
+   * SearchPointVector::IsInside(const GeoPoint &).
+   */
+  [[gnu::pure]]
+  bool IsInside(const GeoPoint &p) const noexcept;
+
+  /**
+   * Invoke the given function for each edge which is crossed by the
+   * given ray away from the nodes, in the order of the edges.  The
+   * parameter is the ray parameter of the intersection (see
+   * FlatRay::DistinctIntersection()).
+   */
+  template<typename F>
+  void VisitIntersections(const FlatRay &ray, F &&f) const noexcept {
+    const int end_x = ray.point.x + ray.vector.x;
+    const int end_y = ray.point.y + ray.vector.y;
+    const int ray_min_x = std::min(ray.point.x, end_x);
+    const int ray_max_x = std::max(ray.point.x, end_x);
+    const int ray_min_y = std::min(ray.point.y, end_y);
+    const int ray_max_y = std::max(ray.point.y, end_y);
+
+    const int *const x = flat.data(), *const y = x + n + 1;
+    const int *const min_x = y + n + 1, *const max_x = min_x + n;
+    const int *const min_y = max_x + n, *const max_y = min_y + n;
+
+    /* check the bounding boxes of 64 edges at a time without
+       branching, and run the exact test only for those which
+       overlap with the ray's bounding box */
+    for (std::size_t base = 0; base < n; base += 64) {
+      const std::size_t count = std::min<std::size_t>(n - base, 64);
+
+      uint_least64_t mask = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t j = base + i;
+        const bool overlap = (min_x[j] <= ray_max_x) & (max_x[j] >= ray_min_x) &
+          (min_y[j] <= ray_max_y) & (max_y[j] >= ray_min_y);
+        mask |= uint_least64_t(overlap) << i;
+      }
+
+      while (mask != 0) {
+        const std::size_t j = base + std::countr_zero(mask);
+        mask &= mask - 1;
+
+        const FlatRay edge({x[j], y[j]}, {x[j + 1], y[j + 1]});
+        const double t = ray.DistinctIntersection(edge);
+        if (t >= 0)
+          f(t);
+      }
+    }
+  }
+};
@@ -11,6 +11,26 @@ struct IGCExtension {
   uint16_t start, finish;
 
   char code[4];
+
+  /**
+   * The #IGCFix attribute which receives the value of this
+   * extension.  It is looked up by IGCParseExtensions(), so the "B"
+   * record parser does not need to compare the #code of each
+   * extension in each fix.
+   */
+  enum class Type : uint8_t {
+    UNKNOWN,
+    ENL,
+    RPM,
+    HDM,
+    HDT,
+    TRM,
+    TRT,
+    GSP,
+    IAS,
+    TAS,
+    SIU,
+  } type;
 };
 
 struct IGCExtensions : public TrivialArray<IGCExtension, 16> {
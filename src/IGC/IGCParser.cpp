@@ -97,13 +97,51 @@ IGCParseDateRecord(const char *line, BrokenDate &date)
   return date.IsPlausible();
 }
 
-static int
-ParseTwoDigits(const char *p)
+/**
+ * Parse an unsigned integer from the given string range
+ * (null-termination is not necessary).  Parsing stops at the first
+ * non-digit, therefore a null-terminated string shorter than the
+ * range is safe, too.
+ *
+ * @param p the string
+ * @param end the end of the string
+ * @return the result, or -1 on error
+ */
+static constexpr int
+ParseUnsigned(const char *p, const char *end) noexcept
+{
+  unsigned value = 0;
+
+  for (; p < end; ++p) {
+    if (!IsDigitASCII(*p))
+      return -1;
+
+    value = value * 10 + (*p - '0');
+  }
+
+  return value;
+}
+
+static constexpr int
+ParseTwoDigits(const char *p) noexcept
 {
-  if (!IsDigitASCII(p[0]) || !IsDigitASCII(p[1]))
-    return -1;
+  return ParseUnsigned(p, p + 2);
+}
+
+/**
+ * Parse a 5 character altitude ("%05d"); the first character may be
+ * a minus sign.
+ */
+static constexpr bool
+ParseAltitude(const char *p, int &value_r) noexcept
+{
+  const bool negative = *p == '-';
+  const int value = ParseUnsigned(p + negative, p + 5);
+  if (value < 0)
+    return false;
 
-  return (p[0] - '0') * 10 + (p[1] - '0');
+  value_r = negative ? -value : value;
+  return true;
 }
 
 static bool
@@ -113,34 +151,63 @@ CheckThreeAlphaNumeric(const char *src)
     IsAlphaNumericASCII(src[2]);
 }
 
+[[gnu::pure]]
+static IGCExtension::Type
+ParseExtensionType(const char *code) noexcept
+{
+  using Type = IGCExtension::Type;
+
+  static constexpr struct {
+    char code[4];
+    Type type;
+  } types[] = {
+    { "ENL", Type::ENL },
+    { "RPM", Type::RPM },
+    { "HDM", Type::HDM },
+    { "HDT", Type::HDT },
+    { "TRM", Type::TRM },
+    { "TRT", Type::TRT },
+    { "GSP", Type::GSP },
+    { "IAS", Type::IAS },
+    { "TAS", Type::TAS },
+    { "SIU", Type::SIU },
+  };
+
+  for (const auto &i : types)
+    if (StringIsEqual(code, i.code))
+      return i.type;
+
+  return Type::UNKNOWN;
+}
+
 bool
-IGCParseExtensions(const char *buffer, IGCExtensions &extensions)
+IGCParseExtensions(std::string_view line, IGCExtensions &extensions) noexcept
 {
-  if (*buffer++ != 'I')
+  /* "I" NN (SS FF CCC)* */
+  if (line.size() < 3 || line.front() != 'I')
     return false;
 
-  int count = ParseTwoDigits(buffer);
+  int count = ParseTwoDigits(line.data() + 1);
   if (count < 0)
     return false;
 
-  buffer += 2;
-
   extensions.clear();
 
-  while (count-- > 0) {
+  for (std::size_t i = 3; count-- > 0; i += 7) {
+    if (line.size() < i + 7)
+      return false;
+
+    const char *buffer = line.data() + i;
+
     const int start = ParseTwoDigits(buffer);
     if (start < 8)
       return false;
 
-    buffer += 2;
-
-    const int finish = ParseTwoDigits(buffer);
+    const int finish = ParseTwoDigits(buffer + 2);
     if (finish < start)
       return false;
 
-    buffer += 2;
-
-    if (!CheckThreeAlphaNumeric(buffer))
+    if (!CheckThreeAlphaNumeric(buffer + 4))
       return false;
 
     if (extensions.full())
@@ -149,36 +216,18 @@ IGCParseExtensions(const char *buffer, IGCExtensions &extensions)
     IGCExtension &x = extensions.append();
     x.start = start;
     x.finish = finish;
-    memcpy(x.code, buffer, 3);
+    memcpy(x.code, buffer + 4, 3);
     x.code[3] = 0;
-
-    buffer += 3;
+    x.type = ParseExtensionType(x.code);
   }
 
   return true;
 }
 
-/**
- * Parse an unsigned integer from the given string range
- * (null-termination is not necessary).
- *
- * @param p the string
- * @param end the end of the string
- * @return the result, or -1 on error
- */
-static int
-ParseUnsigned(const char *p, const char *end)
+bool
+IGCParseExtensions(const char *buffer, IGCExtensions &extensions)
 {
-  unsigned value = 0;
-
-  for (; p < end; ++p) {
-    if (!IsDigitASCII(*p))
-      return -1;
-
-    value = value * 10 + (*p - '0');
-  }
-
-  return value;
+  return IGCParseExtensions(std::string_view{buffer}, extensions);
 }
 
 static void
@@ -199,7 +248,7 @@ static void
 ParseExtensionValueN(const char *p, const char *end, size_t n,
                      int16_t &value_r)
 {
-  if (n > (size_t)(p - end))
+  if (n > (size_t)(end - p))
     /* string is too short */
     return;
 
@@ -208,23 +257,73 @@ ParseExtensionValueN(const char *p, const char *end, size_t n,
     value_r = value;
 }
 
+static void
+ParseExtension(const IGCExtension &extension, const char *start,
+               const char *finish, IGCFix &fix) noexcept
+{
+  using Type = IGCExtension::Type;
+
+  switch (extension.type) {
+  case Type::UNKNOWN:
+    break;
+
+  case Type::ENL:
+    ParseExtensionValue(start, finish, fix.enl);
+    break;
+
+  case Type::RPM:
+    ParseExtensionValue(start, finish, fix.rpm);
+    break;
+
+  case Type::HDM:
+    ParseExtensionValue(start, finish, fix.hdm);
+    break;
+
+  case Type::HDT:
+    ParseExtensionValue(start, finish, fix.hdt);
+    break;
+
+  case Type::TRM:
+    ParseExtensionValue(start, finish, fix.trm);
+    break;
+
+  case Type::TRT:
+    ParseExtensionValue(start, finish, fix.trt);
+    break;
+
+  case Type::GSP:
+    ParseExtensionValueN(start, finish, 3, fix.gsp);
+    break;
+
+  case Type::IAS:
+    ParseExtensionValueN(start, finish, 3, fix.ias);
+    break;
+
+  case Type::TAS:
+    ParseExtensionValueN(start, finish, 3, fix.tas);
+    break;
+
+  case Type::SIU:
+    ParseExtensionValue(start, finish, fix.siu);
+    break;
+  }
+}
+
 bool
-IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
+IGCParseFix(std::string_view line, const IGCExtensions &extensions,
+            IGCFix &fix) noexcept
 {
-  if (*buffer != 'B')
+  /* "B" HHMMSS DDMMmmm[NS] DDDMMmmm[EW] [AV] PPPPP GGGGG */
+  if (line.size() < 35 || line.front() != 'B')
     return false;
 
+  const char *buffer = line.data();
+
   BrokenTime time;
   if (!IGCParseTime(buffer + 1, time))
     return false;
 
-  char valid_char;
-  int gps_altitude, pressure_altitude;
-
-  if (sscanf(buffer + 24, "%c%05d%05d",
-             &valid_char, &pressure_altitude, &gps_altitude) != 3)
-    return false;
-
+  const char valid_char = buffer[24];
   if (valid_char == 'A')
     fix.gps_valid = true;
   else if (valid_char == 'V')
@@ -232,8 +331,9 @@ IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
   else
     return false;
 
-  fix.gps_altitude = gps_altitude;
-  fix.pressure_altitude = pressure_altitude;
+  if (!ParseAltitude(buffer + 25, fix.pressure_altitude) ||
+      !ParseAltitude(buffer + 30, fix.gps_altitude))
+    return false;
 
   if (!IGCParseLocation(buffer + 7, fix.location))
     return false;
@@ -242,61 +342,73 @@ IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
 
   fix.ClearExtensions();
 
-  const size_t line_length = strlen(buffer);
-  for (auto i = extensions.begin(), end = extensions.end(); i != end; ++i) {
-    const IGCExtension &extension = *i;
+  for (const IGCExtension &extension : extensions) {
     assert(extension.start > 0);
     assert(extension.finish >= extension.start);
 
-    if (extension.finish > line_length)
+    if (extension.finish > line.size())
       /* exceeds the input line length */
       continue;
 
-    const char *start = buffer + extension.start - 1;
-    const char *finish = buffer + extension.finish;
-
-    if (StringIsEqual(extension.code, "ENL"))
-      ParseExtensionValue(start, finish, fix.enl);
-    else if (StringIsEqual(extension.code, "RPM"))
-      ParseExtensionValue(start, finish, fix.rpm);
-    else if (StringIsEqual(extension.code, "HDM"))
-      ParseExtensionValue(start, finish, fix.hdm);
-    else if (StringIsEqual(extension.code, "HDT"))
-      ParseExtensionValue(start, finish, fix.hdt);
-    else if (StringIsEqual(extension.code, "TRM"))
-      ParseExtensionValue(start, finish, fix.trm);
-    else if (StringIsEqual(extension.code, "TRT"))
-      ParseExtensionValue(start, finish, fix.trt);
-    else if (StringIsEqual(extension.code, "GSP"))
-      ParseExtensionValueN(start, finish, 3, fix.gsp);
-    else if (StringIsEqual(extension.code, "IAS"))
-      ParseExtensionValueN(start, finish, 3, fix.ias);
-    else if (StringIsEqual(extension.code, "TAS"))
-      ParseExtensionValueN(start, finish, 3, fix.tas);
-    else if (StringIsEqual(extension.code, "SIU"))
-      ParseExtensionValue(start, finish, fix.siu);
+    ParseExtension(extension, buffer + extension.start - 1,
+                   buffer + extension.finish, fix);
   }
 
   return true;
 }
 
+bool
+IGCParseFixTime(std::string_view line, BrokenTime &time,
+                bool &gps_valid) noexcept
+{
+  /* "B" HHMMSS DDMMmmm[NS] DDDMMmmm[EW] [AV] */
+  if (line.size() < 25 || line.front() != 'B')
+    return false;
+
+  const char valid_char = line[24];
+  if (valid_char == 'A')
+    gps_valid = true;
+  else if (valid_char == 'V')
+    gps_valid = false;
+  else
+    return false;
+
+  return IGCParseTime(line.data() + 1, time);
+}
+
+bool
+IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
+{
+  return IGCParseFix(std::string_view{buffer}, extensions, fix);
+}
+
 bool
 IGCParseLocation(const char *buffer, GeoPoint &location)
 {
-  unsigned lat_degrees, lat_minutes, lon_degrees, lon_minutes;
-  char lat_char, lon_char;
+  /* DDMMmmm[NS]DDDMMmmm[EW]; each field is checked before the next
+     one is accessed, so a short null-terminated string is safe */
+  const int lat_degrees = ParseUnsigned(buffer, buffer + 2);
+  if (lat_degrees < 0 || lat_degrees >= 90)
+    return false;
+
+  const int lat_minutes = ParseUnsigned(buffer + 2, buffer + 7);
+  if (lat_minutes < 0 || lat_minutes >= 60000)
+    return false;
+
+  const char lat_char = buffer[7];
+  if (lat_char != 'N' && lat_char != 'S')
+    return false;
 
-  if (sscanf(buffer, "%02u%05u%c%03u%05u%c",
-             &lat_degrees, &lat_minutes, &lat_char,
-             &lon_degrees, &lon_minutes, &lon_char) != 6)
+  const int lon_degrees = ParseUnsigned(buffer + 8, buffer + 11);
+  if (lon_degrees < 0 || lon_degrees >= 180)
     return false;
 
-  if (lat_degrees >= 90 || lat_minutes >= 60000 ||
-      (lat_char != 'N' && lat_char != 'S'))
+  const int lon_minutes = ParseUnsigned(buffer + 11, buffer + 16);
+  if (lon_minutes < 0 || lon_minutes >= 60000)
     return false;
 
-  if (lon_degrees >= 180 || lon_minutes >= 60000 ||
-      (lon_char != 'E' && lon_char != 'W'))
+  const char lon_char = buffer[16];
+  if (lon_char != 'E' && lon_char != 'W')
     return false;
 
   location.latitude = Angle::Degrees(lat_degrees +
@@ -315,9 +427,16 @@ IGCParseLocation(const char *buffer, GeoPoint &location)
 bool
 IGCParseTime(const char *buffer, BrokenTime &time)
 {
-  unsigned hour, minute, second;
+  const int hour = ParseTwoDigits(buffer);
+  if (hour < 0)
+    return false;
+
+  const int minute = ParseTwoDigits(buffer + 2);
+  if (minute < 0)
+    return false;
 
-  if (sscanf(buffer, "%02u%02u%02u", &hour, &minute, &second) != 3)
+  const int second = ParseTwoDigits(buffer + 4);
+  if (second < 0)
     return false;
 
   time = BrokenTime(hour, minute, second);
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <string_view>
+
 struct IGCFix;
 struct IGCHeader;
 struct IGCExtensions;
@@ -36,6 +38,14 @@ IGCParseDateRecord(const char *line, BrokenDate &date);
 bool
 IGCParseExtensions(const char *buffer, IGCExtensions &extensions);
 
+/**
+ * Parse an IGC "I" record which is not null-terminated.
+ *
+ * @return true on success, false if the line was not recognized
+ */
+bool
+IGCParseExtensions(std::string_view line, IGCExtensions &extensions) noexcept;
+
 /**
  * Parse a location in IGC file format. (DDMMmmm[N/S]DDDMMmmm[E/W])
  *
@@ -52,6 +62,29 @@ IGCParseLocation(const char *buffer, GeoPoint &location);
 bool
 IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix);
 
+/**
+ * Parse an IGC "B" record which is not null-terminated, e.g. a line
+ * returned by #IGCReader.  All fields are at fixed offsets, and the
+ * extension columns were looked up by IGCParseExtensions().
+ *
+ * @return true on success, false if the line was not recognized
+ */
+bool
+IGCParseFix(std::string_view line, const IGCExtensions &extensions,
+            IGCFix &fix) noexcept;
+
+/**
+ * Parse only the time and the GPS validity flag of an IGC "B"
+ * record, which are at fixed offsets (1..6 and 24).  Unlike
+ * IGCParseFix(), the location, the altitudes and the extensions are
+ * neither parsed nor required.
+ *
+ * @return true on success, false if the line was not recognized
+ */
+bool
+IGCParseFixTime(std::string_view line, BrokenTime &time,
+                bool &gps_valid) noexcept;
+
 /**
  * Parse a time in IGC file format (HHMMSS).
  *
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "IGCReader.hpp"
+#include "io/FileMapping.hpp"
+#include "system/FileUtil.hpp"
+#include "system/Path.hpp"
+#include "util/SpanCast.hxx"
+
+IGCReader::IGCReader(Path path)
+{
+  /* FileMapping refuses to map empty files, but an empty IGC file is
+     not an error */
+  if (File::GetSize(path) == 0 && File::Exists(path))
+    return;
+
+  mapping = std::make_unique<FileMapping>(path);
+  data = remaining = ToStringView(std::span<const std::byte>{*mapping});
+}
+
+IGCReader::IGCReader(std::string_view _data) noexcept
+  :data(_data), remaining(_data) {}
+
+IGCReader::~IGCReader() noexcept = default;
+
+std::optional<std::string_view>
+IGCReader::ReadLine() noexcept
+{
+  if (remaining.empty())
+    return std::nullopt;
+
+  std::string_view line;
+  if (const auto i = remaining.find('\n'); i != remaining.npos) {
+    line = remaining.substr(0, i);
+    remaining.remove_prefix(i + 1);
+  } else {
+    line = remaining;
+    remaining = {};
+  }
+
+  if (!line.empty() && line.back() == '\r')
+    line.remove_suffix(1);
+
+  return line;
+}
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string_view>
+
+class Path;
+class FileMapping;
+
+/**
+ * Reads the records of an IGC file without copying them.  The file
+ * is mapped into memory, and each line is returned as a
+ * std::string_view pointing into the mapping.  IGC files are plain
+ * ASCII, so there is no charset conversion.
+ *
+ * The returned lines are not null-terminated; they can be passed to
+ * the std::string_view overloads of IGCParseFix() and
+ * IGCParseExtensions().
+ */
+class IGCReader {
+  std::unique_ptr<FileMapping> mapping;
+
+  /**
+   * The whole file.
+   */
+  std::string_view data;
+
+  /**
+   * The portion of #data which has not been read yet.
+   */
+  std::string_view remaining;
+
+public:
+  /**
+   * Map the specified file.
+   *
+   * Throws on error.
+   */
+  explicit IGCReader(Path path);
+
+  /**
+   * Read from a buffer owned by the caller.
+   */
+  explicit IGCReader(std::string_view _data) noexcept;
+
+  ~IGCReader() noexcept;
+
+  IGCReader(const IGCReader &) = delete;
+  IGCReader &operator=(const IGCReader &) = delete;
+
+  /**
+   * Returns the next line (without the line terminator), or
+   * std::nullopt at the end of the file.  The line remains valid
+   * until this object is destroyed.
+   */
+  std::optional<std::string_view> ReadLine() noexcept;
+
+  /**
+   * Go back to the beginning of the file.
+   */
+  void Rewind() noexcept {
+    remaining = data;
+  }
+};
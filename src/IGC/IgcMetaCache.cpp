@@ -4,8 +4,10 @@
 #include "IgcMetaCache.hpp"
 
 #include "IGC/IGCParser.hpp"
+#include "IGC/IGCReader.hpp"
 #include "Formatter/TimeFormatter.hpp"
-#include "io/FileLineReader.hpp"
+#include "system/FileUtil.hpp"
+#include "LogFile.hpp"
 #include "ui/event/Notify.hpp"
 #include "co/InvokeTask.hxx"
 #include "io/async/AsioThread.hpp"
@@ -15,33 +17,33 @@
 #include <chrono>
 #include <utility>
 
-/**
- * Lightweight B-record parser that extracts only the time and GPS
- * validity flag, skipping the expensive location, altitude, and
- * extension parsing that IGCParseFix() performs.
- */
-static bool
-ParseBRecordTime(const char *line, BrokenTime &time,
-                 bool &gps_valid) noexcept
+static StaticString<64>
+FormatMeta(const IgcFileMeta &meta) noexcept
 {
-  if (line[0] != 'B')
-    return false;
+  StaticString<64> text;
+  text = "";
 
-  /* time is at offset 1..6, validity char at offset 24 */
-  if (std::strlen(line) < 25)
-    return false;
-
-  if (!IGCParseTime(line + 1, time))
-    return false;
-
-  if (line[24] == 'A')
-    gps_valid = true;
-  else if (line[24] == 'V')
-    gps_valid = false;
-  else
-    return false;
+  if (meta.has_start && meta.has_end) {
+    StaticString<32> lbuf;
+    lbuf.Format("%02u:%02u - %02u:%02u",
+                (unsigned)meta.start.hour,
+                (unsigned)meta.start.minute,
+                (unsigned)meta.end.hour,
+                (unsigned)meta.end.minute);
+    text = lbuf.c_str();
+
+    int64_t s = (int64_t)meta.start.GetSecondOfDay();
+    int64_t e = (int64_t)meta.end.GetSecondOfDay();
+    int64_t diff = e - s;
+    if (diff < 0)
+      diff += 24 * 3600;
+    auto dur = FormatTimespanSmart(std::chrono::seconds(diff), 2);
+    text.append(" (");
+    text.append(dur.c_str());
+    text.append(")");
+  }
 
-  return true;
+  return text;
 }
 
 IgcMetaCache::~IgcMetaCache() noexcept
@@ -54,14 +56,20 @@ IgcMetaCache::ParseEntry(Path path) noexcept
 {
   CacheEntry entry;
   entry.path = path;
+  entry.verified = true;
+
+  /* before reading, so a modification while reading is detected
+     next time */
+  IgcMetaIndex::GetFileKey(path, entry.file_size, entry.file_mtime);
 
   try {
-    FileLineReaderA reader(path);
-    char *line;
-    while ((line = reader.ReadLine()) != nullptr) {
+    IGCReader reader(path);
+    while (const auto line = reader.ReadLine()) {
+      /* only the time is needed; records with a short or bad
+         location still count */
       BrokenTime time;
       bool gps_valid;
-      if (ParseBRecordTime(line, time, gps_valid) && gps_valid) {
+      if (IGCParseFixTime(*line, time, gps_valid) && gps_valid) {
         if (!entry.meta.has_start) {
           entry.meta.start = time;
           entry.meta.has_start = true;
@@ -74,29 +82,23 @@ IgcMetaCache::ParseEntry(Path path) noexcept
     // ignore parse errors
   }
 
-  entry.text = "";
+  entry.text = FormatMeta(entry.meta);
+  return entry;
+}
 
-  if (entry.meta.has_start && entry.meta.has_end) {
-    StaticString<32> lbuf;
-    lbuf.Format("%02u:%02u - %02u:%02u",
-                (unsigned)entry.meta.start.hour,
-                (unsigned)entry.meta.start.minute,
-                (unsigned)entry.meta.end.hour,
-                (unsigned)entry.meta.end.minute);
-    entry.text = lbuf.c_str();
-
-    int64_t s = (int64_t)entry.meta.start.GetSecondOfDay();
-    int64_t e = (int64_t)entry.meta.end.GetSecondOfDay();
-    int64_t diff = e - s;
-    if (diff < 0)
-      diff += 24 * 3600;
-    auto dur = FormatTimespanSmart(std::chrono::seconds(diff), 2);
-    entry.text.append(" (");
-    entry.text.append(dur.c_str());
-    entry.text.append(")");
-  }
+IgcMetaCache::CacheEntry *
+IgcMetaCache::Find(Path path) noexcept
+{
+  auto i = by_path.find(path.c_str());
+  return i != by_path.end() ? i->second : nullptr;
+}
 
-  return entry;
+IgcMetaCache::CacheEntry &
+IgcMetaCache::Add(CacheEntry &&entry) noexcept
+{
+  CacheEntry &e = cache.emplace_back(std::move(entry));
+  by_path.emplace(e.path.c_str(), &e);
+  return e;
 }
 
 IgcMetaCache::CacheEntry *
@@ -104,22 +106,98 @@ IgcMetaCache::FindOrParse(Path path) noexcept
 {
   {
     const std::lock_guard lock{cache_mutex};
-    for (auto &e : cache) {
-      if (e.path == path)
-        return &e;
+    if (auto *e = Find(path)) {
+      if (e->verified)
+        return e;
+
+      /* loaded from the index file: use it if the file is
+         unmodified */
+      uint64_t size;
+      int64_t mtime;
+      IgcMetaIndex::GetFileKey(path, size, mtime);
+      if (size == e->file_size && mtime == e->file_mtime) {
+        e->verified = true;
+        return e;
+      }
     }
   }
 
   CacheEntry entry = ParseEntry(path);
 
   const std::lock_guard lock{cache_mutex};
-  for (auto &e : cache) {
-    if (e.path == path)
-      return &e;
+  dirty = true;
+
+  if (auto *e = Find(path)) {
+    /* no pointer to an unverified entry has been handed out, so it
+       may be replaced */
+    if (!e->verified)
+      *e = std::move(entry);
+    return e;
   }
 
-  cache.push_back(std::move(entry));
-  return &cache.back();
+  return &Add(std::move(entry));
+}
+
+void
+IgcMetaCache::LoadIndex(AllocatedPath path) noexcept
+{
+  const std::lock_guard lock{cache_mutex};
+  if (index_path != nullptr)
+    return;
+
+  index_path = std::move(path);
+  if (!File::Exists(index_path))
+    return;
+
+  try {
+    for (auto &r : IgcMetaIndex::Load(index_path)) {
+      if (by_path.contains(r.path))
+        continue;
+
+      CacheEntry entry;
+      entry.path = Path(r.path.c_str());
+      entry.meta = r.meta;
+      entry.text = FormatMeta(r.meta);
+      entry.file_size = r.file_size;
+      entry.file_mtime = r.file_mtime;
+      entry.verified = false;
+      Add(std::move(entry));
+    }
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to load IGC index");
+  }
+}
+
+void
+IgcMetaCache::SaveIndex() noexcept
+{
+  std::vector<IgcMetaIndex::Record> records;
+  AllocatedPath path;
+
+  {
+    const std::lock_guard lock{cache_mutex};
+    if (!dirty || index_path == nullptr)
+      return;
+
+    dirty = false;
+    path = Path(index_path);
+
+    records.reserve(cache.size());
+    for (const auto &e : cache) {
+      if (!e.verified && !File::Exists(e.path))
+        /* deleted */
+        continue;
+
+      records.push_back({e.path.c_str(), e.file_size, e.file_mtime, e.meta});
+    }
+  }
+
+  try {
+    Directory::CreateRecursive(path.GetParent());
+    IgcMetaIndex::Save(path, records);
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to save IGC index");
+  }
 }
 
 std::string
@@ -149,6 +227,8 @@ IgcMetaCache::FillCacheCoro(std::vector<AllocatedPath> paths) noexcept
 void
 IgcMetaCache::OnFillComplete([[maybe_unused]] std::exception_ptr error) noexcept
 {
+  SaveIndex();
+
   // Notify UI that fill is complete (ignore any errors)
   if (auto *notify = current_notify.exchange(nullptr))
     notify->SendNotification();
@@ -186,6 +266,7 @@ IgcMetaCache::Shutdown() noexcept
 {
   CancelBackgroundFill();
   inject_task.reset();
+  SaveIndex();
 }
 
 void
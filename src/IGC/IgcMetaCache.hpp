@@ -3,47 +3,96 @@
 
 #pragma once
 
+#include "IgcMetaIndex.hpp"
 #include "system/Path.hpp"
 #include "util/StaticString.hxx"
-#include "time/BrokenTime.hpp"
 #include "co/InjectTask.hxx"
 #include "thread/Mutex.hxx"
 
 #include <atomic>
+#include <cstdint>
 #include <deque>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
 namespace UI { class Notify; }
 
 class IgcMetaCache {
-  struct Meta {
-    bool has_start{false};
-    bool has_end{false};
-    BrokenTime start;
-    BrokenTime end;
-  };
+  using Meta = IgcFileMeta;
 
   struct CacheEntry {
     AllocatedPath path;
     Meta meta;
     StaticString<64> text;
+
+    /**
+     * The size and modification time of the file when it was parsed.
+     */
+    uint64_t file_size;
+    int64_t file_mtime;
+
+    /**
+     * False if this entry was loaded from the index file and has not
+     * yet been compared with the file.  Pointers to #text are only
+     * handed out for verified entries.
+     */
+    bool verified;
   };
 
   mutable Mutex cache_mutex;
   std::deque<CacheEntry> cache;
+
+  /**
+   * Maps the path to its #cache element.
+   */
+  std::unordered_map<std::string, CacheEntry *> by_path;
+
+  /**
+   * The index file passed to LoadIndex().  Protected by
+   * #cache_mutex.
+   */
+  AllocatedPath index_path;
+
+  /**
+   * Have entries been parsed since the index file was written?
+   * Protected by #cache_mutex.
+   */
+  bool dirty = false;
+
   std::unique_ptr<Co::InjectTask> inject_task;
   std::atomic<UI::Notify *> current_notify{nullptr};
 
-  CacheEntry ParseEntry(Path path) noexcept;
+  static CacheEntry ParseEntry(Path path) noexcept;
   Co::InvokeTask FillCacheCoro(std::vector<AllocatedPath> paths) noexcept;
   void OnFillComplete(std::exception_ptr error) noexcept;
+  CacheEntry *Find(Path path) noexcept;
+  CacheEntry &Add(CacheEntry &&entry) noexcept;
   CacheEntry *FindOrParse(Path path) noexcept;
 
 public:
   ~IgcMetaCache() noexcept;
 
+  /**
+   * Load the entries of an index file written by SaveIndex() during
+   * a previous run.  Each entry is compared with the size and
+   * modification time of its IGC file before it is used, so only new
+   * or modified files are parsed again.
+   *
+   * The path is remembered for SaveIndex(); calling this method
+   * again has no effect.
+   */
+  void LoadIndex(AllocatedPath path) noexcept;
+
+  /**
+   * Write all entries to the index file passed to LoadIndex(), unless
+   * nothing has changed.  Entries of files which have been deleted
+   * are omitted.  This is called automatically after a background
+   * fill and by Shutdown().
+   */
+  void SaveIndex() noexcept;
+
   /**
    * Get compact metadata for an IGC file: "HH:MM - HH:MM (duration)".
    *
@@ -64,9 +113,9 @@ public:
   void CancelBackgroundFill() noexcept;
 
   /**
-   * Releases resources which reference the Asio event loop.  This must be
-   * called before that event loop is destroyed when the cache has static
-   * storage duration.
+   * Releases resources which reference the Asio event loop and saves
+   * the index file.  This must be called before that event loop is
+   * destroyed when the cache has static storage duration.
    */
   void Shutdown() noexcept;
 
@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "IgcMetaIndex.hpp"
+#include "io/FileMapping.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/BufferedOutputStream.hxx"
+#include "system/FileUtil.hpp"
+#include "system/Path.hpp"
+#include "util/SpanCast.hxx"
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace IgcMetaIndex {
+
+namespace {
+
+struct Header {
+  static constexpr uint32_t MAGIC = 0x49474d69;
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic, version;
+
+  uint32_t n_records;
+
+  uint32_t reserved;
+};
+
+/**
+ * The fixed-size part of a record; the path follows (without null
+ * terminator).
+ */
+struct RecordHeader {
+  uint64_t file_size;
+  int64_t file_mtime;
+
+  uint16_t path_length;
+
+  enum Flags : uint8_t {
+    HAS_START = 0x1,
+    HAS_END = 0x2,
+  };
+
+  uint8_t flags;
+
+  /**
+   * Hour, minute, second.
+   */
+  uint8_t start[3], end[3];
+
+  uint8_t reserved[7];
+};
+
+static_assert(std::is_trivially_copyable_v<RecordHeader>);
+static_assert(sizeof(RecordHeader) == 32);
+
+} // anonymous namespace
+
+static void
+ExportTime(uint8_t dest[3], const BrokenTime &src) noexcept
+{
+  dest[0] = src.hour;
+  dest[1] = src.minute;
+  dest[2] = src.second;
+}
+
+static bool
+ImportTime(BrokenTime &dest, const uint8_t src[3]) noexcept
+{
+  dest = BrokenTime(src[0], src[1], src[2]);
+  return dest.IsPlausible();
+}
+
+void
+GetFileKey(Path path, uint64_t &size_r, int64_t &mtime_r) noexcept
+{
+  size_r = File::GetSize(path);
+  mtime_r = File::GetLastModification(path).time_since_epoch().count();
+}
+
+std::vector<Record>
+Load(Path path)
+{
+  const FileMapping mapping(path);
+  std::span<const std::byte> data = mapping;
+
+  Header header;
+  if (data.size() < sizeof(header))
+    return {};
+
+  memcpy(&header, data.data(), sizeof(header));
+  data = data.subspan(sizeof(header));
+
+  if (header.magic != Header::MAGIC || header.version != Header::VERSION ||
+      header.n_records > data.size() / sizeof(RecordHeader))
+    return {};
+
+  std::vector<Record> records;
+  records.reserve(header.n_records);
+
+  for (unsigned i = 0; i < header.n_records; ++i) {
+    RecordHeader rh;
+    if (data.size() < sizeof(rh))
+      return {};
+
+    memcpy(&rh, data.data(), sizeof(rh));
+    data = data.subspan(sizeof(rh));
+
+    if (rh.path_length == 0 || data.size() < rh.path_length)
+      return {};
+
+    Record &r = records.emplace_back();
+    r.path = ToStringView(data.first(rh.path_length));
+    data = data.subspan(rh.path_length);
+
+    r.file_size = rh.file_size;
+    r.file_mtime = rh.file_mtime;
+
+    r.meta.has_start = rh.flags & RecordHeader::HAS_START;
+    r.meta.has_end = rh.flags & RecordHeader::HAS_END;
+
+    if ((r.meta.has_start && !ImportTime(r.meta.start, rh.start)) ||
+        (r.meta.has_end && !ImportTime(r.meta.end, rh.end)))
+      return {};
+  }
+
+  if (!data.empty())
+    return {};
+
+  return records;
+}
+
+void
+Save(Path path, std::span<const Record> records)
+{
+  Header header{};
+  header.magic = Header::MAGIC;
+  header.version = Header::VERSION;
+  header.n_records = records.size();
+
+  FileOutputStream file(path);
+  BufferedOutputStream bos(file);
+  bos.Write(ReferenceAsBytes(header));
+
+  for (const auto &r : records) {
+    if (r.path.empty() || r.path.size() > UINT16_MAX)
+      throw std::invalid_argument("Bad IGC index path");
+
+    RecordHeader rh{};
+    rh.file_size = r.file_size;
+    rh.file_mtime = r.file_mtime;
+    rh.path_length = r.path.size();
+
+    if (r.meta.has_start) {
+      rh.flags |= RecordHeader::HAS_START;
+      ExportTime(rh.start, r.meta.start);
+    }
+
+    if (r.meta.has_end) {
+      rh.flags |= RecordHeader::HAS_END;
+      ExportTime(rh.end, r.meta.end);
+    }
+
+    bos.Write(ReferenceAsBytes(rh));
+    bos.Write(std::string_view{r.path});
+  }
+
+  bos.Flush();
+  file.Commit();
+}
+
+} // namespace IgcMetaIndex
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "time/BrokenTime.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+class Path;
+
+/**
+ * The start and end time of the valid fixes in an IGC file.
+ */
+struct IgcFileMeta {
+  bool has_start{false};
+  bool has_end{false};
+  BrokenTime start;
+  BrokenTime end;
+};
+
+/**
+ * A compact binary file which stores the #IgcFileMeta of many IGC
+ * files, so they do not need to be parsed again after a restart.
+ *
+ * Each record is keyed by the path of the IGC file; its size and
+ * modification time are stored, too, so a changed file can be
+ * detected.
+ */
+namespace IgcMetaIndex {
+
+struct Record {
+  std::string path;
+
+  uint64_t file_size;
+  int64_t file_mtime;
+
+  IgcFileMeta meta;
+};
+
+/**
+ * Determine the size and modification time of a file, to be compared
+ * with Record::file_size and Record::file_mtime.
+ */
+void
+GetFileKey(Path path, uint64_t &size_r, int64_t &mtime_r) noexcept;
+
+/**
+ * Load all records from the index file.
+ *
+ * Throws on I/O error.
+ *
+ * @return the records, or an empty vector if the file is malformed
+ * or was written by an incompatible version
+ */
+std::vector<Record>
+Load(Path path);
+
+/**
+ * Write an index file.
+ *
+ * Throws on I/O error.
+ */
+void
+Save(Path path, std::span<const Record> records);
+
+} // namespace IgcMetaIndex
@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+/**
+ * The maximum length of a NMEA sentence type which can be looked up
+ * in a #NMEASentenceTable.
+ */
+static constexpr std::size_t MAX_NMEA_SENTENCE_TYPE = 8;
+
+/**
+ * Pack a NMEA sentence type (e.g. "$GPRMC" or "PFLAU", up to
+ * #MAX_NMEA_SENTENCE_TYPE characters) into an integer, which allows
+ * comparing it with one instruction.  Returns 0 if the string is
+ * empty or too long.
+ */
+constexpr uint_least64_t
+PackNMEASentenceType(std::string_view type) noexcept
+{
+  if (type.empty() || type.size() > MAX_NMEA_SENTENCE_TYPE)
+    return 0;
+
+  uint_least64_t result = 0;
+  for (std::size_t i = 0; i < type.size(); ++i)
+    result |= uint_least64_t(uint8_t(type[i])) << (i * 8);
+  return result;
+}
+
+template<typename T>
+struct NMEASentenceTableEntry {
+  std::string_view type;
+  T value;
+};
+
+/**
+ * A lookup table which maps NMEA sentence types to a value (e.g. an
+ * enum which is then dispatched with a switch).  It is built at
+ * compile time using a perfect hash function, so each lookup costs
+ * one multiplication and one comparison, no matter how many entries
+ * there are and whether the sentence type is known or not.
+ *
+ * Construct instances with MakeNMEASentenceTable().
+ */
+template<typename T, std::size_t N>
+class NMEASentenceTable {
+  /**
+   * The number of slots is a power of two with at least four times
+   * as many slots as entries, which makes finding a collision-free
+   * multiplier quick.
+   */
+  static constexpr unsigned BITS = [](){
+    unsigned bits = 2;
+    while ((std::size_t(1) << bits) < N * 4)
+      ++bits;
+    return bits;
+  }();
+
+  static constexpr std::size_t SIZE = std::size_t(1) << BITS;
+
+  struct Slot {
+    /**
+     * The packed sentence type; 0 means the slot is empty.
+     */
+    uint_least64_t key = 0;
+
+    T value{};
+  };
+
+  std::array<Slot, SIZE> slots{};
+
+  uint_least64_t multiplier = 0;
+
+  static constexpr std::size_t Hash(uint_least64_t key,
+                                    uint_least64_t multiplier) noexcept {
+    return static_cast<std::size_t>((key * multiplier) >> (64 - BITS));
+  }
+
+public:
+  consteval explicit NMEASentenceTable(const NMEASentenceTableEntry<T> (&entries)[N]) {
+    /* try pseudo-random odd multipliers until one maps all keys to
+       distinct slots */
+    uint_least64_t state = 0x9e3779b97f4a7c15;
+
+    for (unsigned attempt = 0; attempt < 10000; ++attempt) {
+      /* splitmix64 */
+      state += 0x9e3779b97f4a7c15;
+      uint_least64_t m = state;
+      m = (m ^ (m >> 30)) * 0xbf58476d1ce4e5b9;
+      m = (m ^ (m >> 27)) * 0x94d049bb133111eb;
+      m = (m ^ (m >> 31)) | 1;
+
+      if (TryMultiplier(entries, m))
+        return;
+    }
+
+    /* this aborts compilation */
+    throw std::logic_error("No perfect hash found");
+  }
+
+  /**
+   * Look up a sentence type.
+   *
+   * @return a pointer to the value or nullptr if the type is unknown
+   */
+  constexpr const T *Find(std::string_view type) const noexcept {
+    const uint_least64_t key = PackNMEASentenceType(type);
+    const Slot &slot = slots[Hash(key, multiplier)];
+    return key != 0 && slot.key == key
+      ? &slot.value
+      : nullptr;
+  }
+
+  /**
+   * Like Find(), but return the given default value if the type is
+   * unknown.
+   */
+  constexpr T Get(std::string_view type, T default_value) const noexcept {
+    const T *value = Find(type);
+    return value != nullptr ? *value : default_value;
+  }
+
+private:
+  constexpr bool TryMultiplier(const NMEASentenceTableEntry<T> (&entries)[N],
+                               uint_least64_t m) {
+    slots = {};
+
+    for (const auto &entry : entries) {
+      const uint_least64_t key = PackNMEASentenceType(entry.type);
+      if (key == 0)
+        throw std::logic_error("Malformed sentence type");
+
+      Slot &slot = slots[Hash(key, m)];
+      if (slot.key == key)
+        throw std::logic_error("Duplicate sentence type");
+
+      if (slot.key != 0)
+        return false;
+
+      slot.key = key;
+      slot.value = entry.value;
+    }
+
+    multiplier = m;
+    return true;
+  }
+};
+
+/**
+ * Build a #NMEASentenceTable at compile time.  Example:
+ *
+ *   static constexpr auto table = MakeNMEASentenceTable<Sentence>({
+ *     {"$PFLAU", Sentence::PFLAU},
+ *     {"$PFLAA", Sentence::PFLAA},
+ *   });
+ */
+template<typename T, std::size_t N>
+consteval auto
+MakeNMEASentenceTable(const NMEASentenceTableEntry<T> (&entries)[N])
+{
+  return NMEASentenceTable<T, N>{entries};
+}
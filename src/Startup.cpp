@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "Startup.hpp"
+#include "StartupJobs.hpp"
 #include "Interface.hpp"
 #include "Components.hpp"
 #include "NetComponents.hpp"
@@ -93,7 +94,7 @@
 #include "Engine/Task/Ordered/OrderedTask.hpp"
 #include "Operation/VerboseOperationEnvironment.hpp"
 #include "Operation/PluggableOperationEnvironment.hpp"
-#include "Operation/SubOperationEnvironment.hpp"
+#include "thread/ThreadPool.hpp"
 #include "Widget/ProgressWidget.hpp"
 #include "PageActions.hpp"
 #include "Weather/Features.hpp"
@@ -567,32 +568,59 @@ Startup(UI::Display &display)
                          CommonInterface::SetComputerSettings(), gp);
   task_manager->SetGlidePolar(gp);
 
-  // Read the topography file(s)
   data_components->topography = std::make_unique<TopographyStore>();
-  {
-    LogFormat("Loading topography");
-    operation.SetText(_("Loading Topography File..."));
-    LoadConfiguredTopography(*data_components->topography);
-    operation.SetProgressPosition(256);
-  }
 
-  // Read the waypoint files
-  LogFormat("Loading waypoints");
+  /* the data files are independent of each other (except for the
+     airfield details, which are attached to the waypoints), so load
+     them in parallel; the terrain is loaded asynchronously by
+     MainWindow::LoadTerrain(), and MainWindow::OnTerrainLoaded()
+     applies it to the airspaces */
+  std::shared_ptr<RaspStore> rasp;
   {
-    SubOperationEnvironment sub_env(operation, 256, 512);
-    sub_env.SetText(_("Loading Waypoints..."));
-    WaypointGlue::LoadWaypoints(*data_components->waypoints,
-                                data_components->terrain.get(),
-                                sub_env);
-  }
+    StartupJobs jobs;
 
-  // Read and parse the airfield info file
-  try {
-    SubOperationEnvironment sub_env(operation, 512, 768);
-    sub_env.SetText(_("Loading Airfield Details File..."));
-    WaypointDetails::ReadFileFromProfile(*data_components->waypoints, sub_env);
-  } catch (...) {
-    LogError(std::current_exception());
+    // Read the topography file(s)
+    jobs.Add(1, [](OperationEnvironment &env){
+      LogFormat("Loading topography");
+      env.SetText(_("Loading Topography File..."));
+      LoadConfiguredTopography(*data_components->topography);
+    });
+
+    // Read the waypoint files
+    const unsigned waypoints_job = jobs.Add(1, [](OperationEnvironment &env){
+      LogFormat("Loading waypoints");
+      env.SetText(_("Loading Waypoints..."));
+      WaypointGlue::LoadWaypoints(*data_components->waypoints,
+                                  data_components->terrain.get(),
+                                  env);
+    });
+
+    // Read and parse the airfield info file
+    jobs.Add(1, [](OperationEnvironment &env){
+      try {
+        env.SetText(_("Loading Airfield Details File..."));
+        WaypointDetails::ReadFileFromProfile(*data_components->waypoints, env);
+      } catch (...) {
+        LogError(std::current_exception());
+      }
+    }, {waypoints_job});
+
+    // Scan for weather forecast
+    jobs.Add(0, [&rasp](OperationEnvironment &){
+      LogString("RASP load");
+      rasp = LoadConfiguredRasp();
+    });
+
+    // Reads the airspace files
+    jobs.Add(1, [&computer_settings](OperationEnvironment &env){
+      ReadAirspace(*data_components->airspaces,
+                   computer_settings.pressure,
+                   env, file_cache);
+    });
+
+    ThreadPool pool{"StartupLoader",
+                    std::max(ThreadPool::GetHardwareConcurrency(), 2U) - 1};
+    jobs.Run(pool, operation);
   }
 
   // Set the home waypoint
@@ -607,23 +635,11 @@ Startup(UI::Display &display)
   backend_components->device_blackboard->Merge();
   CommonInterface::ReadBlackboardBasic(backend_components->device_blackboard->Basic());
 
-  // Scan for weather forecast
-  LogString("RASP load");
-  auto rasp = LoadConfiguredRasp();
-
 #ifdef HAVE_HTTP
   auto skysight = std::make_shared<SkySightClient>(*Net::curl);
   DataGlobals::SetSkySight(skysight);
 #endif
 
-  // Reads the airspace files
-  {
-    SubOperationEnvironment sub_env(operation, 768, 1024);
-    ReadAirspace(*data_components->airspaces,
-                 computer_settings.pressure,
-                 sub_env);
-  }
-
   if (data_components->terrain)
     SetAirspaceGroundLevels(*data_components->airspaces,
                             *data_components->terrain);
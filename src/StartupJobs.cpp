@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "StartupJobs.hpp"
+#include "Operation/Operation.hpp"
+#include "thread/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+/**
+ * The #OperationEnvironment passed to a job.  It may be used by any
+ * thread; it only records the calls, which are forwarded by
+ * StartupJobs::Run().
+ */
+class StartupJobs::Environment final : public OperationEnvironment {
+  Mutex &mutex;
+  Job &job;
+
+public:
+  Environment(Mutex &_mutex, Job &_job) noexcept
+    :mutex(_mutex), job(_job) {}
+
+  /* virtual methods from class OperationEnvironment */
+  bool IsCancelled() const noexcept override {
+    return false;
+  }
+
+  void SetCancelHandler(std::function<void()>) noexcept override {
+  }
+
+  void Sleep(std::chrono::steady_clock::duration duration) noexcept override {
+    std::this_thread::sleep_for(duration);
+  }
+
+  void SetErrorMessage(const char *text) noexcept override {
+    const std::lock_guard lock{mutex};
+    job.errors.emplace_back(text);
+  }
+
+  void SetText(const char *text) noexcept override {
+    const std::lock_guard lock{mutex};
+    job.text = text;
+  }
+
+  void SetProgressRange(unsigned range) noexcept override {
+    const std::lock_guard lock{mutex};
+    job.progress_range = range;
+  }
+
+  void SetProgressPosition(unsigned position) noexcept override {
+    const std::lock_guard lock{mutex};
+    job.progress_position = position;
+  }
+};
+
+StartupJobs::StartupJobs() noexcept = default;
+StartupJobs::~StartupJobs() noexcept = default;
+
+unsigned
+StartupJobs::Add(unsigned weight, Function &&function,
+                 std::initializer_list<unsigned> depends) noexcept
+{
+  auto &job = jobs.emplace_back();
+  job.function = std::move(function);
+  job.depends = depends;
+  job.weight = weight;
+
+  assert(std::all_of(job.depends.begin(), job.depends.end(),
+                     [n = jobs.size() - 1](unsigned i){ return i < n; }));
+
+  return jobs.size() - 1;
+}
+
+inline bool
+StartupJobs::IsReady(const Job &job) const noexcept
+{
+  return job.state == Job::State::WAITING &&
+    std::all_of(job.depends.begin(), job.depends.end(), [this](unsigned i){
+      return jobs[i].state == Job::State::DONE;
+    });
+}
+
+inline void
+StartupJobs::Execute(Job &job) noexcept
+{
+  std::exception_ptr exception;
+
+  try {
+    Environment env{mutex, job};
+    job.function(env);
+  } catch (...) {
+    exception = std::current_exception();
+  }
+
+  /* release the captures outside of the lock */
+  job.function = {};
+
+  const std::lock_guard lock{mutex};
+  job.exception = std::move(exception);
+  job.state = Job::State::DONE;
+  cond.notify_one();
+}
+
+void
+StartupJobs::Run(ThreadPool &pool, OperationEnvironment &env) noexcept
+{
+  assert(pool.GetConcurrency() > 1);
+
+  /* progress is reported in units of 1/256 of a job's weight */
+  unsigned total_weight = 0;
+  for (const auto &job : jobs)
+    total_weight += job.weight;
+
+  env.SetProgressRange(std::max(total_weight, 1U) * 256);
+
+  ThreadPool::Group group;
+  std::string last_text;
+
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    bool all_done = true;
+    for (auto &job : jobs) {
+      if (IsReady(job)) {
+        job.state = Job::State::RUNNING;
+
+        try {
+          pool.Submit(group, [this, &job]{ Execute(job); });
+        } catch (...) {
+          /* out of memory; its dependencies are done, so it can
+             run in this thread */
+          const ScopeUnlock unlock{mutex};
+          Execute(job);
+        }
+      }
+
+      if (job.state != Job::State::DONE)
+        all_done = false;
+    }
+
+    /* collect the status of all jobs and forward it outside of the
+       lock */
+
+    unsigned progress = 0;
+    const char *text = nullptr;
+    std::vector<std::string> errors;
+    std::vector<std::exception_ptr> exceptions;
+
+    for (auto &job : jobs) {
+      switch (job.state) {
+      case Job::State::WAITING:
+        break;
+
+      case Job::State::RUNNING:
+        if (job.progress_range > 0)
+          progress += job.weight *
+            std::min(job.progress_position, job.progress_range) * 256 /
+            job.progress_range;
+
+        if (text == nullptr && !job.text.empty())
+          text = job.text.c_str();
+        break;
+
+      case Job::State::DONE:
+        progress += job.weight * 256;
+
+        if (job.exception)
+          exceptions.push_back(std::exchange(job.exception, {}));
+        break;
+      }
+
+      std::move(job.errors.begin(), job.errors.end(),
+                std::back_inserter(errors));
+      job.errors.clear();
+    }
+
+    /* the text is owned by the job; copy it before unlocking */
+    const bool new_text = text != nullptr && last_text != text;
+    if (new_text)
+      last_text = text;
+
+    lock.unlock();
+
+    if (new_text)
+      env.SetText(last_text.c_str());
+
+    env.SetProgressPosition(progress);
+
+    for (const auto &error : errors)
+      env.SetErrorMessage(error.c_str());
+
+    for (const auto &exception : exceptions)
+      env.SetError(exception);
+
+    lock.lock();
+
+    if (all_done)
+      break;
+
+    /* wake up periodically to update the progress */
+    cond.wait_for(lock, std::chrono::milliseconds(100));
+  }
+
+  lock.unlock();
+
+  /* all jobs are done; this only synchronises with the pool */
+  pool.Wait(group);
+}
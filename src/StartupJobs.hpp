@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+class OperationEnvironment;
+
+/**
+ * A set of data loaders which run concurrently on a #ThreadPool.  A
+ * job may depend on other jobs; it is started only after all of them
+ * have finished.
+ *
+ * Each job gets its own #OperationEnvironment.  Its progress, text
+ * and errors are collected and forwarded to the main
+ * #OperationEnvironment by the thread which calls Run(), because
+ * that one usually updates the UI and must not be used by other
+ * threads.
+ */
+class StartupJobs {
+public:
+  using Function = std::function<void(OperationEnvironment &env)>;
+
+private:
+  class Environment;
+
+  struct Job {
+    Function function;
+
+    /**
+     * Indices of the jobs which must finish before this one starts.
+     */
+    std::vector<unsigned> depends;
+
+    /**
+     * This job's share of the total progress.
+     */
+    unsigned weight;
+
+    /**
+     * The following attributes are protected by #mutex.
+     */
+    enum class State {
+      WAITING,
+      RUNNING,
+      DONE,
+    } state = State::WAITING;
+
+    std::string text;
+    unsigned progress_range = 0, progress_position = 0;
+
+    /**
+     * Error messages which have not yet been forwarded.
+     */
+    std::vector<std::string> errors;
+    std::exception_ptr exception;
+  };
+
+  std::vector<Job> jobs;
+
+  Mutex mutex;
+
+  /**
+   * Signalled when a job has finished.
+   */
+  Cond cond;
+
+public:
+  StartupJobs() noexcept;
+  ~StartupJobs() noexcept;
+
+  StartupJobs(const StartupJobs &) = delete;
+  StartupJobs &operator=(const StartupJobs &) = delete;
+
+  /**
+   * Add a job.  Must not be called while Run() is in progress.
+   *
+   * @param weight the share of this job in the total progress
+   * @param depends the return values of Add() for jobs which must
+   * finish before this one starts
+   * @return an identifier for the "depends" parameter
+   */
+  unsigned Add(unsigned weight, Function &&function,
+               std::initializer_list<unsigned> depends = {}) noexcept;
+
+  /**
+   * Run all jobs and wait for completion.  The pool must have at
+   * least one worker thread, because this thread only forwards
+   * progress.
+   *
+   * Exceptions thrown by a job are passed to
+   * OperationEnvironment::SetError(); the jobs depending on it run
+   * nonetheless.
+   */
+  void Run(ThreadPool &pool, OperationEnvironment &env) noexcept;
+
+private:
+  bool IsReady(const Job &job) const noexcept;
+  void Execute(Job &job) noexcept;
+};
@@ -8,6 +8,7 @@
 struct GlideSettings;
 class RasterTerrain;
 class ProtectedAirspaceWarningManager;
+class ThreadPool;
 
 class RoutePlannerGlue {
   const RasterTerrain *terrain = nullptr;
@@ -35,6 +36,10 @@ public:
     planner.Reset();
   }
 
+  void SetThreadPool(ThreadPool *pool) noexcept {
+    planner.SetThreadPool(pool);
+  }
+
   bool Solve(const AGeoPoint &origin, const AGeoPoint &destination,
              const RoutePlannerConfig &config,
              int h_ceiling);
@@ -43,7 +48,6 @@ public:
     return planner.GetSolution();
   }
 
-  [[gnu::pure]]
   ReachFan SolveReach(const AGeoPoint &origin, const RoutePlannerConfig &config,
                       int h_ceiling, bool do_solve, bool working) noexcept;
 
@@ -8,15 +8,25 @@
 #include "Geo/GeoBounds.hpp"
 #else
 #include "Projection/WindowProjection.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Math/Util.hpp"
 #endif
 
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <string.h>
 
 void
 HeightMatrix::FillGradient(UnsignedPoint2D _size,
                            int16_t min_h, int16_t max_h,
                            bool vertical) noexcept
 {
+#ifndef ENABLE_OPENGL
+  Invalidate();
+#endif
+
   SetSize(_size);
 
   auto *p = data.data();
@@ -85,6 +95,161 @@ HeightMatrix::Fill(const RasterMap &map, const GeoBounds &bounds,
 
 #else
 
+void
+HeightMatrix::FillRows(const RasterMap &map,
+                       const WindowProjection &projection,
+                       PixelPoint origin, unsigned quantisation_pixels,
+                       unsigned begin, unsigned end,
+                       bool interpolate) noexcept
+{
+  assert(begin <= end);
+  assert(end <= size.y);
+
+  const int width = (size.x - 1) * quantisation_pixels;
+
+  auto p = data.data() + begin * size.x;
+  for (unsigned row = begin; row < end; ++row, p += size.x) {
+    const int y = origin.y + int(row * quantisation_pixels);
+    map.ScanLine(projection.ScreenToGeo({origin.x, y}),
+                 projection.ScreenToGeo({origin.x + width, y}),
+                 p, size.x, interpolate);
+  }
+}
+
+void
+HeightMatrix::FillColumns(const RasterMap &map,
+                          const WindowProjection &projection,
+                          PixelPoint origin, unsigned quantisation_pixels,
+                          unsigned begin, unsigned end,
+                          unsigned row_begin, unsigned row_end,
+                          bool interpolate) noexcept
+{
+  assert(begin <= end);
+  assert(end <= size.x);
+  assert(row_begin + 2 <= row_end);
+  assert(row_end <= size.y);
+
+  const unsigned n = row_end - row_begin;
+  const auto column = std::make_unique<TerrainHeight[]>(n);
+
+  const int top = origin.y + int(row_begin * quantisation_pixels);
+  const int bottom = origin.y + int((row_end - 1) * quantisation_pixels);
+
+  for (unsigned col = begin; col < end; ++col) {
+    const int x = origin.x + int(col * quantisation_pixels);
+    map.ScanLine(projection.ScreenToGeo({x, top}),
+                 projection.ScreenToGeo({x, bottom}),
+                 column.get(), n, interpolate);
+
+    auto p = data.data() + row_begin * size.x + col;
+    for (unsigned i = 0; i < n; ++i, p += size.x)
+      *p = column[i];
+  }
+}
+
+void
+HeightMatrix::Shift(IntPoint2D delta) noexcept
+{
+  assert(unsigned(std::abs(delta.x)) < size.x);
+  assert(unsigned(std::abs(delta.y)) < size.y);
+
+  const unsigned n_columns = size.x - std::abs(delta.x);
+  const unsigned dest_column = std::max(delta.x, 0);
+  const unsigned src_column = std::max(-delta.x, 0);
+
+  const unsigned n_rows = size.y - std::abs(delta.y);
+
+  auto move_row = [&](unsigned dest_row){
+    const unsigned src_row = dest_row - delta.y;
+    memmove(data.data() + dest_row * size.x + dest_column,
+            data.data() + src_row * size.x + src_column,
+            n_columns * sizeof(TerrainHeight));
+  };
+
+  /* move the rows in an order which doesn't overwrite rows which
+     are still needed */
+  if (delta.y > 0) {
+    for (unsigned i = n_rows; i-- > 0;)
+      move_row(delta.y + i);
+  } else {
+    for (unsigned i = 0; i < n_rows; ++i)
+      move_row(i);
+  }
+}
+
+bool
+HeightMatrix::FillIncremental(const RasterMap &map,
+                              const WindowProjection &projection,
+                              unsigned quantisation_pixels,
+                              bool interpolate) noexcept
+{
+  if (last_fill.map != &map ||
+      last_fill.serial != map.GetSerial() ||
+      last_fill.scale != projection.GetScale() ||
+      last_fill.angle != projection.GetScreenAngle() ||
+      last_fill.screen_size != projection.GetScreenSize() ||
+      last_fill.quantisation_pixels != quantisation_pixels ||
+      last_fill.interpolate != interpolate)
+    return false;
+
+  /* where is the first sample of the previous call on the new
+     screen? */
+
+  const GeoVector v(projection.ScreenToGeo({0, 0}), last_fill.origin);
+  const double distance = v.distance * projection.GetScale();
+  const auto [sin_bearing, cos_bearing] =
+    (v.bearing - projection.GetScreenAngle()).SinCos();
+  const double sx = distance * sin_bearing, sy = -distance * cos_bearing;
+
+  /* round to whole cells; the remainder (at most half a cell) is
+     the offset of the sample grid on the new screen */
+  const IntPoint2D delta(iround(sx / quantisation_pixels),
+                         iround(sy / quantisation_pixels));
+  if (delta.x == 0 && delta.y == 0)
+    return true;
+
+  /* at least two rows must remain for FillColumns() */
+  if (unsigned(std::abs(delta.x)) >= size.x ||
+      unsigned(std::abs(delta.y)) + 2 > size.y)
+    return false;
+
+  const PixelPoint origin(iround(sx - delta.x * double(quantisation_pixels)),
+                          iround(sy - delta.y * double(quantisation_pixels)));
+
+  Shift(delta);
+
+  /* sample the rows and columns which were shifted in */
+
+  const unsigned row_begin = std::max(delta.y, 0);
+  const unsigned row_end = size.y + std::min(delta.y, 0);
+
+  FillRows(map, projection, origin, quantisation_pixels,
+           0, row_begin, interpolate);
+  FillRows(map, projection, origin, quantisation_pixels,
+           row_end, size.y, interpolate);
+
+  const unsigned column_begin = std::max(delta.x, 0);
+  const unsigned column_end = size.x + std::min(delta.x, 0);
+
+  FillColumns(map, projection, origin, quantisation_pixels,
+              0, column_begin, row_begin, row_end, interpolate);
+  FillColumns(map, projection, origin, quantisation_pixels,
+              column_end, size.x, row_begin, row_end, interpolate);
+
+  /* the new first sample is the old one moved by the shift; it is
+     calculated from the old one (and not from the new screen) so
+     the rounding error does not accumulate */
+
+  const double dx = -delta.x * double(quantisation_pixels);
+  const double dy = -delta.y * double(quantisation_pixels);
+  const GeoVector shift(std::hypot(dx, dy) / projection.GetScale(),
+                        Angle::Radians(std::atan2(dx, -dy)) +
+                        projection.GetScreenAngle());
+  last_fill.origin = shift.EndPoint(last_fill.origin);
+
+  return true;
+}
+
 void
 HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
                    unsigned quantisation_pixels, bool interpolate) noexcept
@@ -96,15 +261,22 @@ HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
   if (screen_size.width == 0 || screen_size.height == 0)
     return;
 
+  if (FillIncremental(map, projection, quantisation_pixels, interpolate))
+    return;
+
   SetSize((UnsignedPoint2D)screen_size, quantisation_pixels);
 
-  auto p = data.data();
-  for (unsigned y = 0; y < screen_size.height;
-       y += quantisation_pixels, p += size.x) {
-    map.ScanLine(projection.ScreenToGeo({0, (int)y}),
-                 projection.ScreenToGeo({(int)screen_size.width, (int)y}),
-                 p, size.x, interpolate);
-  }
+  FillRows(map, projection, {0, 0}, quantisation_pixels,
+           0, size.y, interpolate);
+
+  last_fill.map = &map;
+  last_fill.serial = map.GetSerial();
+  last_fill.origin = projection.ScreenToGeo({0, 0});
+  last_fill.scale = projection.GetScale();
+  last_fill.angle = projection.GetScreenAngle();
+  last_fill.screen_size = screen_size;
+  last_fill.quantisation_pixels = quantisation_pixels;
+  last_fill.interpolate = interpolate;
 }
 
 #endif
@@ -7,6 +7,13 @@
 #include "Math/Point2D.hpp"
 #include "util/AllocatedArray.hxx"
 
+#ifndef ENABLE_OPENGL
+#include "Geo/GeoPoint.hpp"
+#include "ui/dim/Point.hpp"
+#include "ui/dim/Size.hpp"
+#include "util/Serial.hpp"
+#endif
+
 class RasterMap;
 
 #ifdef ENABLE_OPENGL
@@ -19,6 +26,30 @@ class HeightMatrix {
   AllocatedArray<TerrainHeight> data;
   UnsignedPoint2D size;
 
+#ifndef ENABLE_OPENGL
+  /**
+   * The parameters of the last Fill() call.  They are used to decide
+   * whether the next call may shift the existing contents instead of
+   * sampling the whole matrix again.
+   */
+  struct FillState {
+    const RasterMap *map = nullptr;
+    Serial serial;
+
+    /**
+     * The location of the first sample.  All other samples are on a
+     * grid with #quantisation_pixels spacing relative to it.
+     */
+    GeoPoint origin;
+
+    double scale;
+    Angle angle;
+    PixelSize screen_size;
+    unsigned quantisation_pixels;
+    bool interpolate;
+  } last_fill;
+#endif
+
 public:
   HeightMatrix() noexcept = default;
 
@@ -40,10 +71,51 @@ public:
             UnsignedPoint2D _size, bool interpolate) noexcept;
 #else
   /**
+   * If the projection has only been translated since the last call
+   * (same map, scale, rotation and size), the existing contents are
+   * shifted and only the newly exposed rows and columns are sampled.
+   *
    * @param interpolate true enables interpolation of sub-pixel values
    */
   void Fill(const RasterMap &map, const WindowProjection &map_projection,
             unsigned quantisation_pixels, bool interpolate) noexcept;
+
+  /**
+   * Force the next Fill() call to sample the whole matrix.
+   */
+  void Invalidate() noexcept {
+    last_fill.map = nullptr;
+  }
+
+private:
+  void FillRows(const RasterMap &map, const WindowProjection &projection,
+                PixelPoint origin, unsigned quantisation_pixels,
+                unsigned begin, unsigned end, bool interpolate) noexcept;
+
+  void FillColumns(const RasterMap &map,
+                   const WindowProjection &projection,
+                   PixelPoint origin, unsigned quantisation_pixels,
+                   unsigned begin, unsigned end,
+                   unsigned row_begin, unsigned row_end,
+                   bool interpolate) noexcept;
+
+  /**
+   * Move the contents by the given number of cells; cells which are
+   * shifted in are left undefined.
+   */
+  void Shift(IntPoint2D delta) noexcept;
+
+  /**
+   * Attempt to update the matrix incrementally.
+   *
+   * @return false if the whole matrix needs to be sampled
+   */
+  bool FillIncremental(const RasterMap &map,
+                       const WindowProjection &projection,
+                       unsigned quantisation_pixels,
+                       bool interpolate) noexcept;
+
+public:
 #endif
 
   /**
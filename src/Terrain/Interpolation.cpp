@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Interpolation.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+
+/**
+ * The number of samples processed by one SIMD iteration.
+ */
+static constexpr unsigned SIMD_WIDTH = 8;
+
+/**
+ * All values up to (and including) this one are "special", see
+ * TerrainHeight::IsSpecial().
+ */
+static constexpr int16_t SPECIAL_MAX = -30000;
+
+static_assert(TerrainHeight{SPECIAL_MAX}.IsSpecial());
+static_assert(!TerrainHeight{SPECIAL_MAX + 1}.IsSpecial());
+
+#endif
+
+#ifdef __SSE2__
+
+/**
+ * Interpolate 8 samples using SSE2.  SSE2 lacks a 32 bit multiply,
+ * therefore this uses PMADDWD (16x16+16x16 -> 32 bit) in two passes:
+ * first horizontally, then vertically with the horizontal result
+ * split into its upper and lower bits.  The result is bit-exact with
+ * InterpolateBilinear().
+ */
+[[gnu::always_inline]]
+static inline void
+Interpolate8(const int16_t *a, const int16_t *b,
+             const int16_t *c, const int16_t *d,
+             const uint16_t *ix, const uint16_t *iy,
+             TerrainHeight *dest) noexcept
+{
+  const __m128i va = _mm_load_si128((const __m128i *)a);
+  const __m128i vb = _mm_load_si128((const __m128i *)b);
+  const __m128i vc = _mm_load_si128((const __m128i *)c);
+  const __m128i vd = _mm_load_si128((const __m128i *)d);
+  const __m128i vix = _mm_load_si128((const __m128i *)ix);
+  const __m128i viy = _mm_load_si128((const __m128i *)iy);
+
+  const __m128i one = _mm_set1_epi16(0x100);
+  const __m128i vkx = _mm_sub_epi16(one, vix);
+  const __m128i vky = _mm_sub_epi16(one, viy);
+
+  /* horizontal: a*kx + b*ix and c*kx + d*ix */
+
+  const __m128i wx_lo = _mm_unpacklo_epi16(vkx, vix);
+  const __m128i wx_hi = _mm_unpackhi_epi16(vkx, vix);
+
+  const __m128i top_lo = _mm_madd_epi16(_mm_unpacklo_epi16(va, vb), wx_lo);
+  const __m128i top_hi = _mm_madd_epi16(_mm_unpackhi_epi16(va, vb), wx_hi);
+  const __m128i bottom_lo = _mm_madd_epi16(_mm_unpacklo_epi16(vc, vd), wx_lo);
+  const __m128i bottom_hi = _mm_madd_epi16(_mm_unpackhi_epi16(vc, vd), wx_hi);
+
+  /* vertical: the horizontal results have 24 bits; split them into
+     a signed upper and an unsigned lower part which both fit into 16
+     bits */
+
+  const __m128i low_mask = _mm_set1_epi32(0xff);
+
+  const __m128i top_h = _mm_packs_epi32(_mm_srai_epi32(top_lo, 8),
+                                        _mm_srai_epi32(top_hi, 8));
+  const __m128i top_l = _mm_packs_epi32(_mm_and_si128(top_lo, low_mask),
+                                        _mm_and_si128(top_hi, low_mask));
+  const __m128i bottom_h = _mm_packs_epi32(_mm_srai_epi32(bottom_lo, 8),
+                                           _mm_srai_epi32(bottom_hi, 8));
+  const __m128i bottom_l = _mm_packs_epi32(_mm_and_si128(bottom_lo, low_mask),
+                                           _mm_and_si128(bottom_hi, low_mask));
+
+  const __m128i wy_lo = _mm_unpacklo_epi16(vky, viy);
+  const __m128i wy_hi = _mm_unpackhi_epi16(vky, viy);
+
+  const __m128i h_lo = _mm_madd_epi16(_mm_unpacklo_epi16(top_h, bottom_h), wy_lo);
+  const __m128i h_hi = _mm_madd_epi16(_mm_unpackhi_epi16(top_h, bottom_h), wy_hi);
+  const __m128i l_lo = _mm_madd_epi16(_mm_unpacklo_epi16(top_l, bottom_l), wy_lo);
+  const __m128i l_hi = _mm_madd_epi16(_mm_unpackhi_epi16(top_l, bottom_l), wy_hi);
+
+  const __m128i r_lo = _mm_srai_epi32(_mm_add_epi32(_mm_slli_epi32(h_lo, 8), l_lo), 16);
+  const __m128i r_hi = _mm_srai_epi32(_mm_add_epi32(_mm_slli_epi32(h_hi, 8), l_hi), 16);
+  const __m128i r = _mm_packs_epi32(r_lo, r_hi);
+
+  /* if one of the four pixels is special, use the top left one */
+
+  const __m128i min = _mm_min_epi16(_mm_min_epi16(va, vb),
+                                    _mm_min_epi16(vc, vd));
+  const __m128i special =
+    _mm_cmplt_epi16(min, _mm_set1_epi16(SPECIAL_MAX + 1));
+
+  const __m128i result = _mm_or_si128(_mm_and_si128(special, va),
+                                      _mm_andnot_si128(special, r));
+  _mm_storeu_si128((__m128i *)dest, result);
+}
+
+#elif defined(__ARM_NEON__)
+
+/**
+ * Interpolate 8 samples using ARM NEON.  The result is bit-exact
+ * with InterpolateBilinear().
+ */
+[[gnu::always_inline]]
+static inline int32x4_t
+Interpolate4(int16x4_t a, int16x4_t b, int16x4_t c, int16x4_t d,
+             int32x4_t ix, int32x4_t iy) noexcept
+{
+  const int32x4_t one = vdupq_n_s32(0x100);
+  const int32x4_t kx = vsubq_s32(one, ix);
+  const int32x4_t ky = vsubq_s32(one, iy);
+
+  const int32x4_t top = vmlaq_s32(vmulq_s32(vmovl_s16(a), kx),
+                                  vmovl_s16(b), ix);
+  const int32x4_t bottom = vmlaq_s32(vmulq_s32(vmovl_s16(c), kx),
+                                     vmovl_s16(d), ix);
+
+  return vshrq_n_s32(vmlaq_s32(vmulq_s32(top, ky), bottom, iy), 16);
+}
+
+[[gnu::always_inline]]
+static inline void
+Interpolate8(const int16_t *a, const int16_t *b,
+             const int16_t *c, const int16_t *d,
+             const uint16_t *ix, const uint16_t *iy,
+             TerrainHeight *dest) noexcept
+{
+  const int16x8_t va = vld1q_s16(a);
+  const int16x8_t vb = vld1q_s16(b);
+  const int16x8_t vc = vld1q_s16(c);
+  const int16x8_t vd = vld1q_s16(d);
+  const uint16x8_t vix = vld1q_u16(ix);
+  const uint16x8_t viy = vld1q_u16(iy);
+
+  const int32x4_t r_lo =
+    Interpolate4(vget_low_s16(va), vget_low_s16(vb),
+                 vget_low_s16(vc), vget_low_s16(vd),
+                 vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(vix))),
+                 vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(viy))));
+  const int32x4_t r_hi =
+    Interpolate4(vget_high_s16(va), vget_high_s16(vb),
+                 vget_high_s16(vc), vget_high_s16(vd),
+                 vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(vix))),
+                 vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(viy))));
+  const int16x8_t r = vcombine_s16(vmovn_s32(r_lo), vmovn_s32(r_hi));
+
+  /* if one of the four pixels is special, use the top left one */
+
+  const int16x8_t min = vminq_s16(vminq_s16(va, vb), vminq_s16(vc, vd));
+  const uint16x8_t special =
+    vcleq_s16(min, vdupq_n_s16(SPECIAL_MAX));
+
+  vst1q_s16((int16_t *)dest, vbslq_s16(special, va, r));
+}
+
+#endif
+
+TerrainHeight *
+InterpolationBatch::Flush(TerrainHeight *dest) noexcept
+{
+  unsigned i = 0;
+
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+  for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH, dest += SIMD_WIDTH)
+    Interpolate8(a + i, b + i, c + i, d + i, ix + i, iy + i, dest);
+#endif
+
+  /* the odd remainder (or everything, without SIMD) */
+  for (; i < n; ++i)
+    *dest++ = InterpolateBilinear(TerrainHeight{a[i]}, TerrainHeight{b[i]},
+                                  TerrainHeight{c[i]}, TerrainHeight{d[i]},
+                                  ix[i], iy[i]);
+
+  n = 0;
+  return dest;
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Height.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+/**
+ * Bilinear interpolation between four neighbouring pixels.  If one
+ * of them is "special", the top left value is returned.
+ *
+ * @param a the top left pixel
+ * @param b the top right pixel
+ * @param c the bottom left pixel
+ * @param d the bottom right pixel
+ * @param ix the horizontal sub-pixel position (0..255)
+ * @param iy the vertical sub-pixel position (0..255)
+ */
+constexpr TerrainHeight
+InterpolateBilinear(TerrainHeight a, TerrainHeight b,
+                    TerrainHeight c, TerrainHeight d,
+                    unsigned ix, unsigned iy) noexcept
+{
+  if (a.IsSpecial() || b.IsSpecial() || c.IsSpecial() || d.IsSpecial())
+    return a;
+
+  const unsigned kx = 0x100 - ix;
+  const unsigned ky = 0x100 - iy;
+
+  return TerrainHeight((a.GetValue() * kx * ky
+                        + b.GetValue() * ix * ky
+                        + c.GetValue() * kx * iy
+                        + d.GetValue() * ix * iy) >> 16);
+}
+
+/**
+ * Collects the inputs of many bilinear interpolations (see
+ * InterpolateBilinear()) and calculates them all at once, using SIMD
+ * instructions if available.  The inputs are stored as a "structure
+ * of arrays", so the arithmetic can operate on several samples per
+ * instruction; only the (scattered) pixel loads remain scalar.
+ */
+class InterpolationBatch {
+public:
+  static constexpr unsigned CAPACITY = 64;
+
+private:
+  unsigned n = 0;
+
+  alignas(16) int16_t a[CAPACITY], b[CAPACITY], c[CAPACITY], d[CAPACITY];
+  alignas(16) uint16_t ix[CAPACITY], iy[CAPACITY];
+
+public:
+  bool IsFull() const noexcept {
+    return n == CAPACITY;
+  }
+
+  /**
+   * Add an interpolation between the pixel at #tm, its right
+   * neighbour at tm[dx], its bottom neighbour at tm[dy] and the
+   * bottom right neighbour at tm[dx + dy].
+   */
+  void Append(const TerrainHeight *tm, unsigned dx, unsigned dy,
+              unsigned _ix, unsigned _iy) noexcept {
+    assert(!IsFull());
+    assert(_ix < 0x100);
+    assert(_iy < 0x100);
+
+    a[n] = tm->GetValue();
+    b[n] = tm[dx].GetValue();
+    c[n] = tm[dy].GetValue();
+    d[n] = tm[dx + dy].GetValue();
+    ix[n] = _ix;
+    iy[n] = _iy;
+    ++n;
+  }
+
+  /**
+   * Add a sample which does not need interpolation; its value is
+   * passed through unmodified.
+   */
+  void Append(TerrainHeight h) noexcept {
+    assert(!IsFull());
+
+    a[n] = b[n] = c[n] = d[n] = h.GetValue();
+    ix[n] = iy[n] = 0;
+    ++n;
+  }
+
+  /**
+   * Calculate all samples, write them to the given buffer and clear
+   * the batch.
+   *
+   * @return the end of the samples written to #dest
+   */
+  TerrainHeight *Flush(TerrainHeight *dest) noexcept;
+};
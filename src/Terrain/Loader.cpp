@@ -7,18 +7,35 @@
 #include "ZzipStream.hpp"
 #include "WorldFile.hpp"
 #include "Operation/Operation.hpp"
+#include "io/ZipArchive.hpp"
 #include "system/ConvertPathName.hpp"
+#include "thread/ThreadPool.hpp"
 #include "util/ScopeExit.hxx"
 #include "LogFile.hpp"
 
+#ifdef HAVE_POSIX
+#include "TileStore.hpp"
+#endif
+
 extern "C" {
 #include "jasper/jp2/jp2_cod.h"
 #include "jasper/jpc/jpc_dec.h"
 #include "jasper/jpc/jpc_t1cod.h"
 }
 
+#include <algorithm>
+#include <vector>
+
 #include <string.h>
 
+inline bool
+TerrainLoader::IsTileWanted(unsigned index) const noexcept
+{
+  return raster_tile_cache.tiles.GetLinear(index).IsRequested() &&
+    (tile_subset.empty() ||
+     std::binary_search(tile_subset.begin(), tile_subset.end(), index));
+}
+
 long
 TerrainLoader::SkipMarkerSegment(long file_offset) const
 {
@@ -41,8 +58,7 @@ TerrainLoader::SkipMarkerSegment(long file_offset) const
     return 0;
 
   long skip_to = segment->file_offset;
-  while (segment->IsTileSegment() &&
-         !raster_tile_cache.tiles.GetLinear(segment->tile).IsRequested()) {
+  while (segment->IsTileSegment() && !IsTileWanted(segment->tile)) {
     ++segment;
     if (segment >= raster_tile_cache.segments.end())
       /* last segment is hidden; shouldn't happen either, because we
@@ -168,18 +184,40 @@ TerrainLoader::PutTileData(unsigned index,
   if (scan_overview)
     raster_tile_cache.PutOverviewTile(index, start, end, m);
 
-  if (scan_tiles) {
+  if (!scan_tiles)
+    return;
+
+  if (scan_overview) {
     const std::lock_guard lock{mutex};
 
-    if (scan_overview)
-      /* When loading all data at once (e.g. small RASP files),
-         PutOverviewTile() already called Set() on the tile. So:
-         copy tile data directly, with no IsRequested() check
-         which would discard the tile immediately */
-      raster_tile_cache.tiles.GetLinear(index).CopyFrom(m);
-    else
-      raster_tile_cache.PutTileData(index, m);
+    /* When loading all data at once (e.g. small RASP files),
+       PutOverviewTile() already called Set() on the tile. So:
+       copy tile data directly, with no IsRequested() check
+       which would discard the tile immediately */
+    raster_tile_cache.tiles.GetLinear(index).CopyFrom(m);
+    return;
+  }
+
+  if (!IsTileWanted(index))
+    return;
+
+  auto &tile = raster_tile_cache.tiles.GetLinear(index);
+
+  {
+    /* convert the matrix before obtaining the write lock, to keep
+       GetHeight() readers blocked as briefly as possible */
+    auto buffer = tile.ConvertMatrix(m);
+
+    const std::lock_guard lock{mutex};
+    raster_tile_cache.PutTileData(index, std::move(buffer));
   }
+
+#ifdef HAVE_POSIX
+  if (options.store != nullptr && tile.IsLoaded())
+    /* no lock needed: the tile buffer is only modified by this
+       thread */
+    options.store->Save(index, tile);
+#endif
 }
 
 /**
@@ -229,8 +267,6 @@ LoadJPG2000(jas_stream_t *in, void *loader)
   /* allow really large maps, but specify a reasonable limit */
   opts.max_samples = size_t(1) << 31;
 
-  jpc_initluts();
-
   const auto dec = jpc_dec_create(&opts, in);
   if (dec == nullptr)
     throw std::runtime_error("jpc_dec_create() failed");
@@ -243,8 +279,8 @@ LoadJPG2000(jas_stream_t *in, void *loader)
     throw std::runtime_error("jpc_dec_decode() failed");
 }
 
-inline void
-TerrainLoader::LoadJPG2000(struct zzip_dir *dir, const char *path)
+void
+TerrainLoader::DecodeJPG2000(struct zzip_dir *dir, const char *path)
 {
   const auto in = OpenJasperZzipStream(dir, path);
   AtScopeExit(in) { jas_stream_close(in); };
@@ -252,6 +288,13 @@ TerrainLoader::LoadJPG2000(struct zzip_dir *dir, const char *path)
   ::LoadJPG2000(in, this);
 }
 
+inline void
+TerrainLoader::LoadJPG2000(struct zzip_dir *dir, const char *path)
+{
+  jpc_initluts();
+  DecodeJPG2000(dir, path);
+}
+
 static bool
 LoadWorldFile(RasterTileCache &tile_cache,
               struct zzip_dir *dir, const char *path)
@@ -305,6 +348,75 @@ LoadTerrainOverview(struct zzip_dir *dir,
   loader.LoadOverview(dir, path, world_file);
 }
 
+#ifdef HAVE_POSIX
+
+inline bool
+TerrainLoader::LoadStoredTiles() noexcept
+{
+  assert(options.store != nullptr);
+
+  bool missing = false;
+  for (const unsigned i : raster_tile_cache.request_tiles) {
+    auto &tile = raster_tile_cache.tiles.GetLinear(i);
+    if (!tile.IsRequested())
+      continue;
+
+    if (options.store->Load(i, tile))
+      tile.ClearRequest();
+    else
+      missing = true;
+  }
+
+  return missing;
+}
+
+#endif
+
+inline void
+TerrainLoader::DecodeParallel(struct zzip_dir *dir, const char *path)
+{
+  ThreadPool &pool = *options.pool;
+
+  /* collect the tiles which still need to be decoded */
+  std::vector<uint16_t> pending;
+  for (const unsigned i : raster_tile_cache.request_tiles)
+    if (raster_tile_cache.tiles.GetLinear(i).IsRequested())
+      pending.push_back(i);
+
+  const unsigned n_groups = std::min<std::size_t>(pool.GetConcurrency(),
+                                                  pending.size());
+  if (n_groups < 2) {
+    LoadJPG2000(dir, path);
+    return;
+  }
+
+  /* distribute the tiles round-robin, so each group gets tiles
+     from all over the requested area; this keeps the groups sorted,
+     as required by IsTileWanted() */
+  std::sort(pending.begin(), pending.end());
+  std::vector<std::vector<uint16_t>> groups(n_groups);
+  for (std::size_t i = 0; i < pending.size(); ++i)
+    groups[i % n_groups].push_back(pending[i]);
+
+  /* these lookup tables are global; initialise them before
+     starting the decoders */
+  jpc_initluts();
+
+  TerrainTileOptions group_options = options;
+  group_options.pool = nullptr;
+
+  pool.ForEach(n_groups, [&](unsigned i){
+    /* each decoder needs its own zzip_dir, because its file
+       position is shared by all files opened from it */
+    ZipArchive archive{options.archive_path};
+
+    TerrainLoader loader(mutex, raster_tile_cache, false, true, env,
+                         group_options);
+    loader.tile_subset = groups[i];
+    loader.DecodeJPG2000(archive.get(), path);
+  });
+}
+
 inline void
 TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
                            SignedRasterLocation p, unsigned radius)
@@ -322,19 +434,35 @@ TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
   }
 
   AtScopeExit(this) { raster_tile_cache.FinishTileUpdate(); };
-  LoadJPG2000(dir, path);
+
+#ifdef HAVE_POSIX
+  if (options.store != nullptr) {
+    /* page in tiles which have been decoded before */
+    const std::lock_guard lock{mutex};
+    if (!LoadStoredTiles())
+      /* all requested tiles were found, no need to decode */
+      return;
+  }
+#endif
+
+  if (options.pool != nullptr && options.archive_path != nullptr)
+    DecodeParallel(dir, path);
+  else
+    LoadJPG2000(dir, path);
 }
 
 void
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
-                   SignedRasterLocation p, unsigned radius)
+                   SignedRasterLocation p, unsigned radius,
+                   const TerrainTileOptions &options)
 {
   if (!raster_tile_cache.IsValid())
     return;
 
   NullOperationEnvironment env;
-  TerrainLoader loader(mutex, raster_tile_cache, false, true, env);
+  TerrainLoader loader(mutex, raster_tile_cache, false, true, env,
+                       options);
   loader.UpdateTiles(dir, path, p, radius);
 }
 
@@ -342,11 +470,13 @@ void
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
-                   const GeoPoint &location, double radius)
+                   const GeoPoint &location, double radius,
+                   const TerrainTileOptions &options)
 {
   const auto raster_location = projection.ProjectCoarse(location);
 
   UpdateTerrainTiles(dir, path, raster_tile_cache, mutex,
                      raster_location,
-                     projection.DistancePixelsCoarse(radius));
+                     projection.DistancePixelsCoarse(radius),
+                     options);
 }
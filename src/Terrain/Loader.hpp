@@ -5,15 +5,43 @@
 
 #include "RasterLocation.hpp"
 #include "thread/SharedMutex.hpp"
+#include "system/Path.hpp"
 
 #include <cstdint>
+#include <span>
 
 struct zzip_dir;
 struct GeoPoint;
 class RasterTileCache;
 class RasterProjection;
+class TerrainTileStore;
+class ThreadPool;
 class OperationEnvironment;
 
+/**
+ * Optional features for UpdateTerrainTiles().
+ */
+struct TerrainTileOptions {
+  /**
+   * Load requested tiles from this store if possible, and add newly
+   * decoded tiles to it.
+   */
+  TerrainTileStore *store = nullptr;
+
+  /**
+   * If set, the requested tiles are split into groups which are
+   * decoded in parallel on this pool.
+   */
+  ThreadPool *pool = nullptr;
+
+  /**
+   * The path of the map file.  This is required for #pool, because
+   * a zzip_dir cannot be shared among threads; each task opens its
+   * own instance.
+   */
+  Path archive_path = nullptr;
+};
+
 class TerrainLoader {
   SharedMutex &mutex;
 
@@ -23,6 +51,15 @@ class TerrainLoader {
 
   OperationEnvironment &env;
 
+  const TerrainTileOptions options;
+
+  /**
+   * If not empty, then this loader decodes only these tiles (a
+   * sorted subset of the requested tiles); this is used to split
+   * the work among several threads.
+   */
+  std::span<const uint16_t> tile_subset;
+
   /**
    * The number of remaining segments after the current one.
    */
@@ -31,11 +68,12 @@ class TerrainLoader {
 public:
   TerrainLoader(SharedMutex &_mutex, RasterTileCache &_rtc,
                 bool _scan_overview, bool _scan_all,
-                OperationEnvironment &_env)
+                OperationEnvironment &_env,
+                const TerrainTileOptions &_options={})
     :mutex(_mutex), raster_tile_cache(_rtc),
      scan_overview(_scan_overview),
      scan_tiles(!_scan_overview || _scan_all),
-     env(_env) {}
+     env(_env), options(_options) {}
 
   /**
    * Throws on error.
@@ -67,11 +105,44 @@ public:
                    const struct jas_matrix &m);
 
 private:
+#ifdef HAVE_POSIX
+  /**
+   * Load all requested tiles from the #TerrainTileStore.  The caller
+   * must hold the write lock.
+   *
+   * @return true if there are requested tiles which were not found
+   * in the store and need to be decoded
+   */
+  bool LoadStoredTiles() noexcept;
+#endif
+
+  /**
+   * Shall the specified tile be decoded by this loader?
+   */
+  [[gnu::pure]]
+  bool IsTileWanted(unsigned index) const noexcept;
+
   /**
    * Throws on error.
    */
   void LoadJPG2000(struct zzip_dir *dir, const char *path);
 
+  /**
+   * Like LoadJPG2000(), but assumes that jpc_initluts() has already
+   * been called.  This may be called from several threads at the
+   * same time, each with its own zzip_dir.
+   *
+   * Throws on error.
+   */
+  void DecodeJPG2000(struct zzip_dir *dir, const char *path);
+
+  /**
+   * Decode the requested tiles on #TerrainTileOptions::pool.
+   *
+   * Throws on error.
+   */
+  void DecodeParallel(struct zzip_dir *dir, const char *path);
+
   void ParseBounds(const char *data);
 };
 
@@ -104,7 +175,8 @@ LoadTerrainOverview(struct zzip_dir *dir,
 void
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
-                   SignedRasterLocation p, unsigned radius);
+                   SignedRasterLocation p, unsigned radius,
+                   const TerrainTileOptions &options={});
 
 static inline void
 UpdateTerrainTiles(struct zzip_dir *dir,
@@ -118,14 +190,16 @@ void
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
-                   const GeoPoint &location, double radius);
+                   const GeoPoint &location, double radius,
+                   const TerrainTileOptions &options={});
 
 static inline void
 UpdateTerrainTiles(struct zzip_dir *dir,
                    RasterTileCache &tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
-                   const GeoPoint &location, double radius)
+                   const GeoPoint &location, double radius,
+                   const TerrainTileOptions &options={})
 {
   UpdateTerrainTiles(dir, "terrain.jp2", tile_cache, mutex,
-                     projection, location, radius);
+                     projection, location, radius, options);
 }
@@ -31,17 +31,7 @@ RasterBuffer::GetInterpolated(unsigned lx, unsigned ly,
   const unsigned int dy = (ly == GetSize().y - 1) ? 0 : GetSize().x;
   const TerrainHeight *tm = GetDataAt({lx, ly});
 
-  if (tm->IsSpecial() || tm[dx].IsSpecial() ||
-      tm[dy].IsSpecial() || tm[dx + dy].IsSpecial())
-    return *tm;
-
-  unsigned kx = 0x100 - ix;
-  unsigned ky = 0x100 - iy;
-
-  return TerrainHeight((tm->GetValue() * kx * ky
-                        + tm[dx].GetValue() * ix * ky
-                        + tm[dy].GetValue() * kx * iy
-                        + tm[dx + dy].GetValue() * ix * iy) >> 16);
+  return InterpolateBilinear(tm[0], tm[dx], tm[dy], tm[dx + dy], ix, iy);
 }
 
 TerrainHeight
@@ -60,6 +50,18 @@ RasterBuffer::GetInterpolated(RasterLocation p) const noexcept
   return GetInterpolated(px, py, ix, iy);
 }
 
+void
+RasterBuffer::AppendInterpolated(InterpolationBatch &batch,
+                                 RasterLocation p) const noexcept
+{
+  const auto [px, ix] = RasterTraits::CalcSubpixel(p.x);
+  const auto [py, iy] = RasterTraits::CalcSubpixel(p.y);
+  if (px >= GetSize().x || py >= GetSize().y)
+    batch.Append(TerrainHeight::Invalid());
+  else
+    AppendInterpolated(batch, px, py, ix, iy);
+}
+
 /**
  * This class implements an algorithm to traverse pixels quickly with
  * only integer addition, no multiplication and division.
@@ -129,13 +131,20 @@ RasterBuffer::ScanHorizontalLine(unsigned ax, unsigned bx, unsigned y,
 
     const auto [cy, iy] = RasterTraits::CalcSubpixel(y);
 
+    InterpolationBatch batch;
+
     --size;
     for (int i = 0; (unsigned)i <= size; ++i) {
+      if (batch.IsFull())
+        buffer = batch.Flush(buffer);
+
       const auto [cx, ix] =
         RasterTraits::CalcSubpixel(ax + (i * dx) / (int)size);
 
-      *buffer++ = GetInterpolated(cx, cy, ix, iy);
+      AppendInterpolated(batch, cx, cy, ix, iy);
     }
+
+    batch.Flush(buffer);
   } else if (dx > 0) [[likely]] {
     /* no interpolation needed, forward scan */
 
@@ -199,14 +208,21 @@ RasterBuffer::ScanLine(RasterLocation a, RasterLocation b,
       (unsigned)(abs(d.x) + abs(d.y)) < (2 * size << RasterTraits::SUBPIXEL_BITS)) {
     /* interpolate */
 
+    InterpolationBatch batch;
+
     for (int i = 0; (unsigned)i <= size; ++i) {
+      if (batch.IsFull())
+        buffer = batch.Flush(buffer);
+
       const auto [cx, ix] =
         RasterTraits::CalcSubpixel(a.x + (i * d.x) / (int)size);
       const auto [cy, iy] =
         RasterTraits::CalcSubpixel(a.y + (i * d.y) / (int)size);
 
-      *buffer++ = GetInterpolated(cx, cy, ix, iy);
+      AppendInterpolated(batch, cx, cy, ix, iy);
     }
+
+    batch.Flush(buffer);
   } else {
     /* no interpolation needed */
 
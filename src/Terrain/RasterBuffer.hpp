@@ -6,9 +6,12 @@
 #include "RasterTraits.hpp"
 #include "RasterLocation.hpp"
 #include "Height.hpp"
+#include "Interpolation.hpp"
 #include "util/AllocatedGrid.hxx"
 #include "util/Compiler.h"
 
+#include <cassert>
+
 class RasterBuffer {
   AllocatedGrid<TerrainHeight> data;
 
@@ -17,8 +20,8 @@ public:
   RasterBuffer(unsigned _width, unsigned _height) noexcept
     :data(_width, _height) {}
 
-  RasterBuffer(const RasterBuffer &) = delete;
-  RasterBuffer &operator=(const RasterBuffer &) = delete;
+  RasterBuffer(RasterBuffer &&) noexcept = default;
+  RasterBuffer &operator=(RasterBuffer &&) noexcept = default;
 
   bool IsDefined() const noexcept {
     return data.IsDefined();
@@ -57,6 +60,29 @@ public:
   [[gnu::pure]]
   TerrainHeight GetInterpolated(RasterLocation p) const noexcept;
 
+  /**
+   * Like GetInterpolated(), but append the sample to the batch
+   * instead of calculating it right away.
+   */
+  void AppendInterpolated(InterpolationBatch &batch,
+                          unsigned lx, unsigned ly,
+                          unsigned ix, unsigned iy) const noexcept {
+    assert(IsDefined());
+    assert(lx < GetSize().x);
+    assert(ly < GetSize().y);
+
+    const unsigned dx = (lx == GetSize().x - 1) ? 0 : 1;
+    const unsigned dy = (ly == GetSize().y - 1) ? 0 : GetSize().x;
+    batch.Append(GetDataAt({lx, ly}), dx, dy, ix, iy);
+  }
+
+  /**
+   * Like GetInterpolated(), but append the sample to the batch
+   * instead of calculating it right away.
+   */
+  void AppendInterpolated(InterpolationBatch &batch,
+                          RasterLocation p) const noexcept;
+
   [[gnu::pure]]
   TerrainHeight Get(RasterLocation p) const noexcept {
     return *GetDataAt(p);
@@ -35,6 +35,51 @@ RasterMap::GetInterpolatedHeight(const GeoPoint &location) const noexcept
   return raster_tile_cache.GetInterpolatedHeight(pt);
 }
 
+/**
+ * The number of locations projected at a time by the batch lookups.
+ */
+static constexpr std::size_t PROJECT_CHUNK = 256;
+
+void
+RasterMap::GetHeights(std::span<const GeoPoint> src,
+                      TerrainHeight *dest) const noexcept
+{
+  RasterLocation buffer[PROJECT_CHUNK];
+
+  while (!src.empty()) {
+    const auto chunk = src.first(std::min(src.size(), PROJECT_CHUNK));
+    src = src.subspan(chunk.size());
+
+    std::transform(chunk.begin(), chunk.end(), buffer,
+                   [this](const GeoPoint &location){
+                     return projection.ProjectCoarse(location);
+                   });
+
+    raster_tile_cache.GetHeights({buffer, chunk.size()}, dest);
+    dest += chunk.size();
+  }
+}
+
+void
+RasterMap::GetInterpolatedHeights(std::span<const GeoPoint> src,
+                                  TerrainHeight *dest) const noexcept
+{
+  RasterLocation buffer[PROJECT_CHUNK];
+
+  while (!src.empty()) {
+    const auto chunk = src.first(std::min(src.size(), PROJECT_CHUNK));
+    src = src.subspan(chunk.size());
+
+    std::transform(chunk.begin(), chunk.end(), buffer,
+                   [this](const GeoPoint &location){
+                     return projection.ProjectFine(location);
+                   });
+
+    raster_tile_cache.GetInterpolatedHeights({buffer, chunk.size()}, dest);
+    dest += chunk.size();
+  }
+}
+
 void
 RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
                     TerrainHeight *buffer, unsigned size,
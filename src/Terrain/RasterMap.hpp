@@ -7,6 +7,8 @@
 #include "RasterTileCache.hpp"
 #include "Geo/GeoPoint.hpp"
 
+#include <span>
+
 class OperationEnvironment;
 
 class RasterMap {
@@ -95,6 +97,24 @@ public:
   [[gnu::pure]]
   TerrainHeight GetInterpolatedHeight(const GeoPoint &location) const noexcept;
 
+  /**
+   * Batch version of GetHeight(): determine the non-interpolated
+   * heights at all specified locations.
+   *
+   * @param dest a buffer of the same size as #src
+   */
+  void GetHeights(std::span<const GeoPoint> src,
+                  TerrainHeight *dest) const noexcept;
+
+  /**
+   * Batch version of GetInterpolatedHeight(): determine the
+   * interpolated heights at all specified locations.
+   *
+   * @param dest a buffer of the same size as #src
+   */
+  void GetInterpolatedHeights(std::span<const GeoPoint> src,
+                              TerrainHeight *dest) const noexcept;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
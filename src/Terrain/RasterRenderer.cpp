@@ -3,6 +3,7 @@
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/SlopeShading.hpp"
 #include "Math/Constants.hpp"
 #include "Screen/Layout.hpp"
 #include "ui/canvas/Ramp.hpp"
@@ -189,6 +190,7 @@ RasterRenderer::~RasterRenderer() noexcept
   delete image;
   delete[] contour_column_base;
   delete[] contour_pending;
+  delete[] illumination;
 }
 
 #ifdef ENABLE_OPENGL
@@ -361,6 +363,9 @@ RasterRenderer::GenerateImage(bool do_shading,
     delete[] contour_pending;
     contour_pending =
       new ColumnContourPending[height_matrix.GetSize().x];
+
+    delete[] illumination;
+    illumination = new int8_t[height_matrix.GetSize().x];
   }
 
   // At extreme zoom out, terrain features are too small to be meaningful;
@@ -482,24 +487,6 @@ RasterRenderer::GenerateUnshadedImage(const unsigned height_scale,
   }
 }
 
-/**
- * Clip the difference between two adjacent terrain height values to
- * sane bounds.  This works around integer overflows in the
- * GenerateSlopeImage() formula when the map file is broken, avoiding
- * the sqrt() call with a negative argument.
- */
-static constexpr int
-ClipHeightDelta(int d) noexcept
-{
-  return std::clamp(d, -512, 512);
-}
-
-static constexpr int
-ClipHeightDelta(TerrainHeight a, TerrainHeight b) noexcept
-{
-  return ClipHeightDelta(a.GetValue() - b.GetValue());
-}
-
 void
 RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                                    int contrast,
@@ -521,6 +508,10 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                   its square will not overflow */
                max_height_slope_factor);
 
+  const SlopeShadingParameters shading{
+    sx, sy, sz, contrast, height_slope_factor,
+  };
+
   const auto *src = height_matrix.GetData();
   const RawColor *oColorBuf = color_table + 64 * 256;
 
@@ -540,7 +531,11 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
       SafeMinusStep(y, quantisation_effective);
     const unsigned row_minus_offset = matrix_size.x * row_minus_index;
 
-    const unsigned p31 = row_plus_index + row_minus_index;
+    /* calculate the illumination of the whole row in one pass, which
+       can be vectorised */
+    ShadeSlopeRow(shading, src, matrix_size.x,
+                  row_minus_index, row_plus_index,
+                  quantisation_effective, illumination);
 
     RawColor *p = dest;
     dest = image->GetNextRow(dest);
@@ -615,31 +610,7 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
           continue;
         }
 
-        const int p32 = ClipHeightDelta(h_above, h_below);
-        const int p22 = ClipHeightDelta(h_right, h_left);
-
-        const unsigned p20 = column_plus_index + column_minus_index;
-
-        const int dd0 = p22 * int(p31);
-        const int dd1 = int(p20) * p32;
-        const double dd2 = double(p20) * double(p31) *
-          double(height_slope_factor);
-        const double num =
-          dd2 * double(sz) + double(dd0) * double(sx) +
-          double(dd1) * double(sy);
-        const double square_mag =
-          double(dd0) * double(dd0) +
-          double(dd1) * double(dd1) +
-          dd2 * dd2;
-        const double mag = sqrt(square_mag);
-        /* this is a workaround for a SIGFPE (division by zero)
-           observed by our users on some Android devices (e.g. Nexus
-           7), even though we did our best to make sure that the
-           integer arithmetics above can't overflow */
-        /* TODO: debug this problem and replace this workaround */
-        const int sval = int(num / std::max(mag, 1.0));
-        const int sindex = (sval - sz) * contrast / 128;
-        *p++ = oColorBuf[int(h) + 256 * std::clamp(sindex, -63, 63)];
+        *p++ = oColorBuf[int(h) + 256 * illumination[x]];
       } else if (e.IsWater()) {
         // we're in the water, so look up the color for water
         *p++ = oColorBuf[255];
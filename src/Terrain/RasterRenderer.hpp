@@ -9,6 +9,8 @@
 #include "Geo/GeoBounds.hpp"
 #endif
 
+#include <cstdint>
+
 static constexpr unsigned NUM_COLOR_RAMP_LEVELS = 13;
 
 class Angle;
@@ -80,6 +82,12 @@ class RasterRenderer {
    */
   ColumnContourPending *contour_pending = nullptr;
 
+  /**
+   * The slope shading illumination of the current row, see
+   * ShadeSlopeRow().
+   */
+  int8_t *illumination = nullptr;
+
   double pixel_size = 0;
 
   RawColor *color_table = nullptr;
@@ -127,11 +135,20 @@ public:
     return quantisation_effective > 0;
   }
 
-#ifdef ENABLE_OPENGL
+  /**
+   * Discard the previous contents, so the next ScanMap() call
+   * samples the whole area.
+   */
   void Invalidate() noexcept {
+#ifdef ENABLE_OPENGL
     bounds.SetInvalid();
+#else
+    height_matrix.Invalidate();
+#endif
   }
 
+#ifdef ENABLE_OPENGL
+
   /**
    * Force a specific quantisation value.  Useful for preview
    * windows that should always render at full resolution
@@ -187,7 +204,9 @@ public:
                               unsigned height_scale, int interp_levels) noexcept;
 
   /**
-   * Scan the map and fill the height matrix.
+   * Scan the map and fill the height matrix.  Without OpenGL, the
+   * previous height matrix is shifted if the projection has only
+   * been translated, and only the newly exposed area is scanned.
    */
   void ScanMap(const RasterMap &map,
                const WindowProjection &projection) noexcept;
@@ -3,6 +3,7 @@
 
 #include "RasterTerrain.hpp"
 #include "Loader.hpp"
+#include "TileStore.hpp"
 #include "Profile/Profile.hpp"
 #include "io/ZipArchive.hpp"
 #include "io/FileCache.hpp"
@@ -11,11 +12,22 @@
 #include "io/Reader.hxx"
 #include "io/BufferedReader.hxx"
 #include "system/ConvertPathName.hpp"
+#include "system/FileUtil.hpp"
 #include "Operation/Operation.hpp"
+#include "thread/ThreadPool.hpp"
 #include "LogFile.hpp"
 
 static const char *const terrain_cache_name = "terrain";
 
+#ifdef HAVE_POSIX
+static const char *const terrain_tile_store_name = "terrain-tiles";
+#endif
+
+RasterTerrain::RasterTerrain(Path _path, ZipArchive &&_archive) noexcept
+  :Guard<RasterMap>(map), path(_path), archive(std::move(_archive)) {}
+
+RasterTerrain::~RasterTerrain() noexcept = default;
+
 inline bool
 RasterTerrain::LoadCache(FileCache &cache, Path path)
 {
@@ -68,12 +80,58 @@ RasterTerrain::Load(Path path, FileCache *cache,
   }
 }
 
+inline void
+RasterTerrain::StartDecoderPool() noexcept
+try {
+  const unsigned n_cpus = ThreadPool::GetHardwareConcurrency();
+  if (n_cpus < 2)
+    return;
+
+  /* the thread calling UpdateTiles() is the remaining decoder */
+  decoder_pool = std::make_unique<ThreadPool>("TerrainDecoder",
+                                              n_cpus - 1, true);
+} catch (...) {
+  LogError(std::current_exception(), "Failed to start terrain decoders");
+}
+
+#ifdef HAVE_POSIX
+
+inline void
+RasterTerrain::OpenTileStore(FileCache &cache, Path path) noexcept
+try {
+  const auto &tile_cache = map.GetTileCache();
+  if (!tile_cache.IsValid())
+    return;
+
+  const TerrainTileStore::Key key{
+    File::GetSize(path),
+    File::GetLastModification(path),
+    tile_cache.GetSize(),
+    tile_cache.GetTileGridSize(),
+  };
+
+  tile_store = std::make_unique<TerrainTileStore>(cache.CreatePath(terrain_tile_store_name),
+                                                  key,
+                                                  key.n_tiles.x * key.n_tiles.y);
+} catch (...) {
+  LogError(std::current_exception(), "Failed to open terrain tile store");
+}
+
+#endif
+
 std::unique_ptr<RasterTerrain>
 RasterTerrain::OpenTerrain(FileCache *cache, Path path,
                            OperationEnvironment &operation)
 {
-  auto rt = std::make_unique<RasterTerrain>(ZipArchive{path});
+  auto rt = std::make_unique<RasterTerrain>(path, ZipArchive{path});
   rt->Load(path, cache, operation);
+  rt->StartDecoderPool();
+
+#ifdef HAVE_POSIX
+  if (cache != nullptr)
+    rt->OpenTileStore(*cache, path);
+#endif
+
   return rt;
 }
 
@@ -98,8 +156,15 @@ RasterTerrain::UpdateTiles(const GeoPoint &location, double radius) noexcept
     return false;
 
   try {
+    TerrainTileOptions options;
+#ifdef HAVE_POSIX
+    options.store = tile_store.get();
+#endif
+    options.pool = decoder_pool.get();
+    options.archive_path = path;
+
     UpdateTerrainTiles(archive.get(), tile_cache, mutex,
-                       map.GetProjection(), location, radius);
+                       map.GetProjection(), location, radius, options);
   } catch (...) {
     LogError(std::current_exception(), "Failed to update terrain tiles");
   }
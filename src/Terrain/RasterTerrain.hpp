@@ -7,11 +7,14 @@
 #include "Geo/GeoPoint.hpp"
 #include "thread/Guard.hpp"
 #include "io/ZipArchive.hpp"
+#include "system/Path.hpp"
 
 #include <memory>
 
 class Path;
 class FileCache;
+class TerrainTileStore;
+class ThreadPool;
 class OperationEnvironment;
 
 /**
@@ -25,16 +28,32 @@ public:
   friend class WaypointVisitorMap; // for intersection rendering
 
 private:
+  const AllocatedPath path;
+
   ZipArchive archive;
 
   RasterMap map;
 
+  /**
+   * Worker threads for decoding tiles in parallel; nullptr on
+   * single-core machines.
+   */
+  std::unique_ptr<ThreadPool> decoder_pool;
+
+#ifdef HAVE_POSIX
+  /**
+   * The persistent store of decoded tiles; nullptr if there is no
+   * #FileCache or if the store could not be opened.
+   */
+  std::unique_ptr<TerrainTileStore> tile_store;
+#endif
+
 public:
   /**
    * Constructor.  Returns uninitialised object.
    */
-  explicit RasterTerrain(ZipArchive &&_archive) noexcept
-    :Guard<RasterMap>(map), archive(std::move(_archive)) {}
+  RasterTerrain(Path _path, ZipArchive &&_archive) noexcept;
+  ~RasterTerrain() noexcept;
 
   const Serial &GetSerial() const noexcept {
     return map.GetSerial();
@@ -89,4 +108,18 @@ private:
    */
   void Load(Path path, FileCache *cache,
             OperationEnvironment &operation);
+
+  /**
+   * Create the #decoder_pool if this machine has more than one
+   * processor.  Errors are logged.
+   */
+  void StartDecoderPool() noexcept;
+
+#ifdef HAVE_POSIX
+  /**
+   * Open the #TerrainTileStore for the loaded map.  Errors are
+   * logged.
+   */
+  void OpenTileStore(FileCache &cache, Path path) noexcept;
+#endif
 };
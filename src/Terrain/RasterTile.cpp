@@ -28,14 +28,9 @@ RasterTile::LoadCache(BufferedReader &r)
   Set(data.start, data.end);
 }
 
-void
-RasterTile::CopyFrom(const struct jas_matrix &m) noexcept
+static void
+CopyMatrix(RasterBuffer &buffer, const struct jas_matrix &m) noexcept
 {
-  if (!IsDefined())
-    return;
-
-  buffer.Resize(size);
-
   auto *gcc_restrict dest = buffer.GetData();
   assert(dest != nullptr);
 
@@ -49,6 +44,27 @@ RasterTile::CopyFrom(const struct jas_matrix &m) noexcept
   }
 }
 
+void
+RasterTile::CopyFrom(const struct jas_matrix &m) noexcept
+{
+  if (!IsDefined())
+    return;
+
+  buffer.Resize(size);
+  CopyMatrix(buffer, m);
+}
+
+RasterBuffer
+RasterTile::ConvertMatrix(const struct jas_matrix &m) const noexcept
+{
+  assert(IsDefined());
+
+  RasterBuffer result;
+  result.Resize(size);
+  CopyMatrix(result, m);
+  return result;
+}
+
 TerrainHeight
 RasterTile::GetHeight(RasterLocation p) const noexcept
 {
@@ -82,6 +98,19 @@ RasterTile::GetInterpolatedHeight(unsigned lx, unsigned ly,
   return buffer.GetInterpolated(lx, ly, ix, iy);
 }
 
+void
+RasterTile::AppendInterpolatedHeight(InterpolationBatch &batch,
+                                     unsigned lx, unsigned ly,
+                                     unsigned ix, unsigned iy) const noexcept
+{
+  assert(IsLoaded());
+
+  if ((lx -= start.x) >= size.x || (ly -= start.y) >= size.y)
+    batch.Append(TerrainHeight::Invalid());
+  else
+    buffer.AppendInterpolated(batch, lx, ly, ix, iy);
+}
+
 inline unsigned
 RasterTile::CalcDistanceTo(IntPoint2D p) const noexcept
 {
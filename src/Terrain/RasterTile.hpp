@@ -7,6 +7,8 @@
 #include "RasterLocation.hpp"
 #include "RasterBuffer.hpp"
 
+#include <utility>
+
 struct jas_matrix;
 class BufferedOutputStream;
 class BufferedReader;
@@ -87,6 +89,20 @@ public:
 
   void CopyFrom(const struct jas_matrix &m) noexcept;
 
+  /**
+   * Convert a decoded JPEG2000 matrix to a new buffer with the size
+   * of this tile.  This does not modify the tile, therefore the
+   * caller does not need to hold the write lock.
+   */
+  RasterBuffer ConvertMatrix(const struct jas_matrix &m) const noexcept;
+
+  /**
+   * Install a buffer obtained from ConvertMatrix().
+   */
+  void SetBuffer(RasterBuffer &&_buffer) noexcept {
+    buffer = std::move(_buffer);
+  }
+
   /**
    * Determine the non-interpolated height at the specified pixel
    * location.
@@ -110,6 +126,14 @@ public:
   TerrainHeight GetInterpolatedHeight(unsigned x, unsigned y,
                                       unsigned ix, unsigned iy) const noexcept;
 
+  /**
+   * Like GetInterpolatedHeight(), but append the sample to the batch
+   * instead of calculating it right away.
+   */
+  void AppendInterpolatedHeight(InterpolationBatch &batch,
+                                unsigned x, unsigned y,
+                                unsigned ix, unsigned iy) const noexcept;
+
   bool VisibilityChanged(IntPoint2D view, unsigned view_radius) noexcept;
 
   void ScanLine(RasterLocation a, RasterLocation b,
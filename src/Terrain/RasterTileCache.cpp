@@ -58,14 +58,13 @@ RasterTileCache::PutOverviewTile(unsigned index,
 }
 
 void
-RasterTileCache::PutTileData(unsigned index,
-                             const struct jas_matrix &m) noexcept
+RasterTileCache::PutTileData(unsigned index, RasterBuffer &&buffer) noexcept
 {
   auto &tile = tiles.GetLinear(index);
   if (!tile.IsRequested())
     return;
 
-  tile.CopyFrom(m);
+  tile.SetBuffer(std::move(buffer));
 }
 
 struct RTDistanceSort {
@@ -177,6 +176,97 @@ RasterTileCache::GetInterpolatedHeight(RasterLocation l) const noexcept
   return overview.GetInterpolated({RasterTraits::ToOverview(l.x), RasterTraits::ToOverview(l.y)});
 }
 
+/**
+ * Remembers the tile of the previous lookup, so consecutive
+ * locations within the same tile do not need to look it up again.
+ */
+class RasterTileCache::TileCursor {
+  const RasterTileCache &cache;
+
+  const RasterTile *tile = nullptr;
+
+  /**
+   * The pixel position of the current tile's top left corner.
+   */
+  RasterLocation origin;
+
+public:
+  explicit TileCursor(const RasterTileCache &_cache) noexcept
+    :cache(_cache) {}
+
+  const RasterTile &Find(unsigned px, unsigned py) noexcept {
+    if (tile == nullptr ||
+        px - origin.x >= cache.tile_size.x ||
+        py - origin.y >= cache.tile_size.y) {
+      const unsigned tx = px / cache.tile_size.x;
+      const unsigned ty = py / cache.tile_size.y;
+      origin = {tx * cache.tile_size.x, ty * cache.tile_size.y};
+      tile = &cache.tiles.Get(tx, ty);
+    }
+
+    return *tile;
+  }
+};
+
+void
+RasterTileCache::GetHeights(std::span<const RasterLocation> src,
+                            TerrainHeight *dest) const noexcept
+{
+  TileCursor cursor{*this};
+  InterpolationBatch batch;
+
+  for (const RasterLocation p : src) {
+    if (batch.IsFull())
+      dest = batch.Flush(dest);
+
+    if (p.x >= size.x || p.y >= size.y) {
+      // outside overall bounds
+      batch.Append(TerrainHeight::Invalid());
+      continue;
+    }
+
+    const RasterTile &tile = cursor.Find(p.x, p.y);
+    if (tile.IsLoaded())
+      batch.Append(tile.GetHeight(p));
+    else
+      // still not found, so go to overview
+      overview.AppendInterpolated(batch, p << (RasterTraits::SUBPIXEL_BITS - RasterTraits::OVERVIEW_BITS));
+  }
+
+  batch.Flush(dest);
+}
+
+void
+RasterTileCache::GetInterpolatedHeights(std::span<const RasterLocation> src,
+                                        TerrainHeight *dest) const noexcept
+{
+  TileCursor cursor{*this};
+  InterpolationBatch batch;
+
+  for (const RasterLocation l : src) {
+    if (batch.IsFull())
+      dest = batch.Flush(dest);
+
+    if (l.x >= overview_size_fine.x || l.y >= overview_size_fine.y) {
+      // outside overall bounds
+      batch.Append(TerrainHeight::Invalid());
+      continue;
+    }
+
+    const auto [px, ix] = RasterTraits::CalcSubpixel(l.x);
+    const auto [py, iy] = RasterTraits::CalcSubpixel(l.y);
+
+    const RasterTile &tile = cursor.Find(px, py);
+    if (tile.IsLoaded())
+      tile.AppendInterpolatedHeight(batch, px, py, ix, iy);
+    else
+      // still not found, so go to overview
+      overview.AppendInterpolated(batch, {RasterTraits::ToOverview(l.x), RasterTraits::ToOverview(l.y)});
+  }
+
+  batch.Flush(dest);
+}
+
 void
 RasterTileCache::SetSize(UnsignedPoint2D _size,
                          Point2D<uint_least16_t> _tile_size,
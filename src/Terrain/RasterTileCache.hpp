@@ -13,6 +13,7 @@
 #include <cassert>
 #include <cstdint>
 #include <optional>
+#include <span>
 
 static constexpr unsigned  RASTER_SLOPE_FACT = 12;
 
@@ -22,6 +23,8 @@ class BufferedOutputStream;
 class BufferedReader;
 
 class RasterTileCache {
+  class TileCursor;
+
   static constexpr unsigned MAX_RTC_TILES = 4096;
 
   /**
@@ -150,6 +153,29 @@ public:
   [[gnu::pure]]
   TerrainHeight GetInterpolatedHeight(RasterLocation p) const noexcept;
 
+  /**
+   * Batch version of GetHeight().  Consecutive locations within the
+   * same tile share one tile lookup.
+   *
+   * @param src the pixel positions within the map; may be out of
+   * range
+   * @param dest a buffer of the same size as #src
+   */
+  void GetHeights(std::span<const RasterLocation> src,
+                  TerrainHeight *dest) const noexcept;
+
+  /**
+   * Batch version of GetInterpolatedHeight().  Consecutive locations
+   * within the same tile share one tile lookup, and the
+   * interpolation is vectorised (see #InterpolationBatch).
+   *
+   * @param src the sub-pixel positions within the map; may be out
+   * of range
+   * @param dest a buffer of the same size as #src
+   */
+  void GetInterpolatedHeights(std::span<const RasterLocation> src,
+                              TerrainHeight *dest) const noexcept;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
@@ -260,7 +286,12 @@ public:
 
   bool PollTiles(SignedRasterLocation p, unsigned radius) noexcept;
 
-  void PutTileData(unsigned index, const struct jas_matrix &m) noexcept;
+  /**
+   * Install a buffer obtained from RasterTile::ConvertMatrix() in
+   * the specified tile, unless the tile is no longer requested.  The
+   * caller must hold the write lock.
+   */
+  void PutTileData(unsigned index, RasterBuffer &&buffer) noexcept;
 
   void FinishTileUpdate() noexcept;
 
@@ -284,6 +315,13 @@ public:
     return size << RasterTraits::SUBPIXEL_BITS;
   }
 
+  /**
+   * Returns the number of tile columns and rows.
+   */
+  RasterLocation GetTileGridSize() const noexcept {
+    return {tiles.GetWidth(), tiles.GetHeight()};
+  }
+
 private:
   RasterLocation GetFineTileSize() const noexcept {
     return {
@@ -0,0 +1,311 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "SlopeShading.hpp"
+#include "util/Compiler.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+/**
+ * Clip the difference between two adjacent terrain height values to
+ * sane bounds.  This works around integer overflows in the shading
+ * formula when the map file is broken, avoiding the sqrt() call with
+ * a negative argument.
+ */
+static constexpr int MAX_HEIGHT_DELTA = 512;
+
+static constexpr int MAX_ILLUMINATION = 63;
+
+static constexpr int
+ClipHeightDelta(TerrainHeight a, TerrainHeight b) noexcept
+{
+  return std::clamp(a.GetValue() - b.GetValue(),
+                    -MAX_HEIGHT_DELTA, MAX_HEIGHT_DELTA);
+}
+
+namespace {
+
+/**
+ * The shading formula with all values which are constant within
+ * one row (and one horizontal step size) precalculated.
+ *
+ * The surface normal of a cell is (dd0, dd1, dd2) with:
+ *
+ * - dd0 = horizontal height delta * vertical distance
+ * - dd1 = horizontal distance * vertical height delta
+ * - dd2 = horizontal distance * vertical distance * cell size
+ *
+ * The illumination is the dot product of the normalised surface
+ * normal and the light vector, relative to a flat surface.
+ */
+class SlopeShader {
+  float p20, p31;
+
+  /**
+   * The coefficients of the dot product: a*p22 + b*p32 + c.
+   */
+  float a, b, c;
+
+  float dd2_square;
+
+  int sz;
+
+  /**
+   * contrast/128; multiplying with this factor and truncating the
+   * result is the same as integer division, because both operands
+   * are small integers.
+   */
+  float contrast_factor;
+
+public:
+  SlopeShader(const SlopeShadingParameters &params,
+              unsigned _p20, unsigned _p31) noexcept
+    :p20(_p20), p31(_p31),
+     a(p31 * params.sx), b(p20 * params.sy),
+     sz(params.sz),
+     contrast_factor(params.contrast / 128.f)
+  {
+    const float dd2 = p20 * p31 * float(params.height_slope_factor);
+    c = dd2 * params.sz;
+    dd2_square = dd2 * dd2;
+  }
+
+  /**
+   * @param p22 the horizontal height delta (right minus left)
+   * @param p32 the vertical height delta (above minus below)
+   */
+  int8_t Shade(int p22, int p32) const noexcept {
+    const float dd0 = p22 * p31;
+    const float dd1 = p32 * p20;
+
+    const float num = c + p22 * a + p32 * b;
+    const float square_mag = dd0 * dd0 + dd1 * dd1 + dd2_square;
+    const float mag = std::max(std::sqrt(square_mag), 1.f);
+
+    const int sval = int(num / mag);
+    const int sindex = int((sval - sz) * contrast_factor);
+    return std::clamp(sindex, -MAX_ILLUMINATION, MAX_ILLUMINATION);
+  }
+
+  int8_t Shade(const TerrainHeight *src,
+               const TerrainHeight *above, const TerrainHeight *below,
+               unsigned left, unsigned right) const noexcept {
+    return Shade(ClipHeightDelta(src[right], src[-int(left)]),
+                 ClipHeightDelta(*above, *below));
+  }
+
+  /**
+   * Shade a range of cells with the portable implementation.
+   */
+  void ShadePortable(const TerrainHeight *src,
+                     const TerrainHeight *above,
+                     const TerrainHeight *below,
+                     unsigned step, int8_t *dest,
+                     unsigned n) const noexcept {
+    for (unsigned i = 0; i < n; ++i)
+      dest[i] = Shade(src + i, above + i, below + i, step, step);
+  }
+
+#ifdef __SSE2__
+  static constexpr unsigned SIMD_WIDTH = 8;
+
+private:
+  [[gnu::always_inline]]
+  __m128i Shade4(__m128 p22, __m128 p32) const noexcept {
+    const __m128 dd0 = _mm_mul_ps(p22, _mm_set1_ps(p31));
+    const __m128 dd1 = _mm_mul_ps(p32, _mm_set1_ps(p20));
+
+    const __m128 num = _mm_add_ps(_mm_add_ps(_mm_set1_ps(c),
+                                             _mm_mul_ps(p22, _mm_set1_ps(a))),
+                                  _mm_mul_ps(p32, _mm_set1_ps(b)));
+    const __m128 square_mag = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dd0, dd0),
+                                                    _mm_mul_ps(dd1, dd1)),
+                                         _mm_set1_ps(dd2_square));
+    const __m128 mag = _mm_max_ps(_mm_sqrt_ps(square_mag), _mm_set1_ps(1.f));
+
+    const __m128i sval = _mm_cvttps_epi32(_mm_div_ps(num, mag));
+    const __m128 sindex = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(sval, _mm_set1_epi32(sz))),
+                                     _mm_set1_ps(contrast_factor));
+    return _mm_cvttps_epi32(sindex);
+  }
+
+  /**
+   * Sign-extend the lower four 16 bit integers and convert them to
+   * float.
+   */
+  [[gnu::always_inline]]
+  static __m128 ToFloatLow(__m128i x) noexcept {
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+  }
+
+  [[gnu::always_inline]]
+  static __m128 ToFloatHigh(__m128i x) noexcept {
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+  }
+
+  [[gnu::always_inline]]
+  static __m128i ClipHeightDelta8(const TerrainHeight *a,
+                                 const TerrainHeight *b) noexcept {
+    /* saturating subtraction, which is then clipped further; this
+       is equivalent to the portable ClipHeightDelta() */
+    const __m128i delta = _mm_subs_epi16(_mm_loadu_si128((const __m128i *)a),
+                                         _mm_loadu_si128((const __m128i *)b));
+    return _mm_max_epi16(_mm_min_epi16(delta, _mm_set1_epi16(MAX_HEIGHT_DELTA)),
+                         _mm_set1_epi16(-MAX_HEIGHT_DELTA));
+  }
+
+public:
+  [[gnu::always_inline]]
+  void Shade8(const TerrainHeight *src,
+              const TerrainHeight *above, const TerrainHeight *below,
+              unsigned step, int8_t *dest) const noexcept {
+    const __m128i p22 = ClipHeightDelta8(src + step, src - step);
+    const __m128i p32 = ClipHeightDelta8(above, below);
+
+    const __m128i lo = Shade4(ToFloatLow(p22), ToFloatLow(p32));
+    const __m128i hi = Shade4(ToFloatHigh(p22), ToFloatHigh(p32));
+
+    const __m128i sindex =
+      _mm_max_epi16(_mm_min_epi16(_mm_packs_epi32(lo, hi),
+                                  _mm_set1_epi16(MAX_ILLUMINATION)),
+                    _mm_set1_epi16(-MAX_ILLUMINATION));
+
+    _mm_storel_epi64((__m128i *)dest, _mm_packs_epi16(sindex, sindex));
+  }
+#elif defined(__ARM_NEON__)
+  static constexpr unsigned SIMD_WIDTH = 8;
+
+private:
+  [[gnu::always_inline]]
+  int32x4_t Shade4(float32x4_t p22, float32x4_t p32) const noexcept {
+    const float32x4_t dd0 = vmulq_n_f32(p22, p31);
+    const float32x4_t dd1 = vmulq_n_f32(p32, p20);
+
+    const float32x4_t num = vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(c), p22, a),
+                                        p32, b);
+    float32x4_t square_mag = vmlaq_f32(vmlaq_f32(vdupq_n_f32(dd2_square),
+                                                 dd0, dd0),
+                                       dd1, dd1);
+
+    /* ARMv7 NEON has neither division nor square root; use the
+       reciprocal square root estimate with two Newton-Raphson
+       steps; clamping the square to 1 is the same as clamping the
+       magnitude to 1 */
+    square_mag = vmaxq_f32(square_mag, vdupq_n_f32(1.f));
+    float32x4_t rsqrt = vrsqrteq_f32(square_mag);
+    rsqrt = vmulq_f32(rsqrt, vrsqrtsq_f32(vmulq_f32(square_mag, rsqrt), rsqrt));
+    rsqrt = vmulq_f32(rsqrt, vrsqrtsq_f32(vmulq_f32(square_mag, rsqrt), rsqrt));
+
+    const int32x4_t sval = vcvtq_s32_f32(vmulq_f32(num, rsqrt));
+    const float32x4_t sindex =
+      vmulq_n_f32(vcvtq_f32_s32(vsubq_s32(sval, vdupq_n_s32(sz))),
+                  contrast_factor);
+    return vcvtq_s32_f32(sindex);
+  }
+
+  [[gnu::always_inline]]
+  static int16x8_t ClipHeightDelta8(const TerrainHeight *a,
+                                   const TerrainHeight *b) noexcept {
+    const int16x8_t delta = vqsubq_s16(vld1q_s16((const int16_t *)a),
+                                       vld1q_s16((const int16_t *)b));
+    return vmaxq_s16(vminq_s16(delta, vdupq_n_s16(MAX_HEIGHT_DELTA)),
+                     vdupq_n_s16(-MAX_HEIGHT_DELTA));
+  }
+
+public:
+  [[gnu::always_inline]]
+  void Shade8(const TerrainHeight *src,
+              const TerrainHeight *above, const TerrainHeight *below,
+              unsigned step, int8_t *dest) const noexcept {
+    const int16x8_t p22 = ClipHeightDelta8(src + step, src - step);
+    const int16x8_t p32 = ClipHeightDelta8(above, below);
+
+    const int32x4_t lo =
+      Shade4(vcvtq_f32_s32(vmovl_s16(vget_low_s16(p22))),
+             vcvtq_f32_s32(vmovl_s16(vget_low_s16(p32))));
+    const int32x4_t hi =
+      Shade4(vcvtq_f32_s32(vmovl_s16(vget_high_s16(p22))),
+             vcvtq_f32_s32(vmovl_s16(vget_high_s16(p32))));
+
+    const int16x8_t sindex =
+      vmaxq_s16(vminq_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)),
+                          vdupq_n_s16(MAX_ILLUMINATION)),
+                vdupq_n_s16(-MAX_ILLUMINATION));
+
+    vst1_s8(dest, vmovn_s16(sindex));
+  }
+#endif
+
+  /**
+   * Shade a range of cells which all have the full horizontal step
+   * size.
+   */
+  [[gnu::hot]]
+  void ShadeInterior(const TerrainHeight *gcc_restrict src,
+                     const TerrainHeight *gcc_restrict above,
+                     const TerrainHeight *gcc_restrict below,
+                     unsigned step, int8_t *gcc_restrict dest,
+                     unsigned n) const noexcept {
+    unsigned i = 0;
+
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+      Shade8(src + i, above + i, below + i, step, dest + i);
+#endif
+
+    /* the odd remainder (or everything, without SIMD) */
+    ShadePortable(src + i, above + i, below + i, step, dest + i, n - i);
+  }
+};
+
+} // anonymous namespace
+
+void
+ShadeSlopeRow(const SlopeShadingParameters &params,
+              const TerrainHeight *src, unsigned width,
+              unsigned row_minus, unsigned row_plus, unsigned step,
+              int8_t *dest) noexcept
+{
+  assert(src != nullptr);
+  assert(dest != nullptr);
+  assert(step > 0);
+
+  const unsigned p31 = row_minus + row_plus;
+  const TerrainHeight *above = src - row_minus * width;
+  const TerrainHeight *below = src + row_plus * width;
+
+  /* the cells near the left and right edges have a smaller
+     horizontal step size, which changes the row constants */
+  const auto shade_edge = [&](unsigned x){
+    const unsigned left = std::min(step, x);
+    const unsigned right = std::min(step, width - 1 - x);
+    const SlopeShader shader(params, left + right, p31);
+    dest[x] = shader.Shade(src + x, above + x, below + x, left, right);
+  };
+
+  if (width <= 2 * step) {
+    for (unsigned x = 0; x < width; ++x)
+      shade_edge(x);
+    return;
+  }
+
+  for (unsigned x = 0; x < step; ++x)
+    shade_edge(x);
+
+  const SlopeShader interior(params, 2 * step, p31);
+  interior.ShadeInterior(src + step, above + step, below + step,
+                         step, dest + step, width - 2 * step);
+
+  for (unsigned x = width - step; x < width; ++x)
+    shade_edge(x);
+}
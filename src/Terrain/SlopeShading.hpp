@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Height.hpp"
+
+#include <cstdint>
+
+/**
+ * The light source and contrast for slope shading.
+ */
+struct SlopeShadingParameters {
+  /**
+   * The direction of the light source, scaled to 255.
+   */
+  int sx, sy, sz;
+
+  int contrast;
+
+  /**
+   * The size of one height matrix cell in meters, limited to a range
+   * which avoids overflows.
+   */
+  unsigned height_slope_factor;
+};
+
+/**
+ * Calculate the illumination (-63..63, 0 means no shading) of all
+ * cells in one row of a height matrix, from the slope between the
+ * neighbouring cells.  SSE2 or NEON instructions are used if
+ * available.
+ *
+ * The result for cells which have a "special" neighbour (see
+ * TerrainHeight::IsSpecial()) is undefined; the caller must check
+ * that.
+ *
+ * @param src the first cell of the row
+ * @param width the number of cells per row
+ * @param row_minus the distance (in rows) to the upper neighbour
+ * @param row_plus the distance (in rows) to the lower neighbour
+ * @param step the distance (in columns) to the left and right
+ * neighbours; it is reduced near the left and right edges
+ * @param dest the destination buffer with #width elements
+ */
+void
+ShadeSlopeRow(const SlopeShadingParameters &params,
+              const TerrainHeight *src, unsigned width,
+              unsigned row_minus, unsigned row_plus, unsigned step,
+              int8_t *dest) noexcept;
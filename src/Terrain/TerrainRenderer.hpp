@@ -42,9 +42,7 @@ public:
    * Flush the cache.
    */
   void Flush() {
-#ifdef ENABLE_OPENGL
     raster_renderer.Invalidate();
-#endif
     compare_projection.Clear();
   }
 
@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "TileStore.hpp"
+#include "RasterTile.hpp"
+#include "io/FileMapping.hpp"
+#include "lib/fmt/PathFormatter.hpp"
+#include "lib/fmt/RuntimeError.hxx"
+#include "lib/fmt/SystemError.hxx"
+#include "util/SpanCast.hxx"
+#include "LogFile.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+TerrainTileStore::TerrainTileStore(Path _path, const Key &key,
+                                   unsigned n_tiles)
+  :path(_path)
+{
+  if (!fd.Open(path.c_str(), O_RDWR|O_CREAT))
+    throw FmtErrno("Failed to open {}", path);
+
+  if (!Open(key, n_tiles))
+    Create(key, n_tiles);
+}
+
+TerrainTileStore::~TerrainTileStore() noexcept = default;
+
+inline bool
+TerrainTileStore::Open(const Key &key, unsigned n_tiles)
+{
+  const off_t size = fd.GetSize();
+  if (size < off_t(sizeof(Header) + n_tiles * sizeof(Slot)))
+    return false;
+
+  Header header;
+  if (fd.ReadAt(0, &header, sizeof(header)) != sizeof(header) ||
+      header.magic != Header::MAGIC ||
+      header.version != Header::VERSION ||
+      header.key != key)
+    return false;
+
+  slots.resize(n_tiles);
+  const std::size_t table_size = n_tiles * sizeof(Slot);
+  if (fd.ReadAt(sizeof(header), slots.data(), table_size) != ssize_t(table_size))
+    return false;
+
+  /* verify that all slots point inside the file; discard the file
+     if not, because it was probably truncated */
+  for (const auto &slot : slots)
+    if (slot.IsDefined() &&
+        slot.offset + slot.GetByteSize() > uint64_t(size))
+      return false;
+
+  end_offset = size;
+  return true;
+}
+
+inline void
+TerrainTileStore::Create(const Key &key, unsigned n_tiles)
+{
+  if (ftruncate(fd.Get(), 0) < 0)
+    throw FmtErrno("Failed to truncate {}", path);
+
+  Header header{};
+  header.magic = Header::MAGIC;
+  header.version = Header::VERSION;
+  header.key = key;
+
+  slots.assign(n_tiles, Slot{});
+
+  if (fd.Seek(0) < 0)
+    throw FmtErrno("Failed to seek {}", path);
+
+  fd.FullWrite(ReferenceAsBytes(header));
+  fd.FullWrite(std::as_bytes(std::span{slots}));
+
+  end_offset = sizeof(header) + n_tiles * sizeof(Slot);
+}
+
+std::span<const std::byte>
+TerrainTileStore::Map(uint64_t offset, std::size_t size) const
+{
+  if (mapping == nullptr ||
+      offset + size > std::span<const std::byte>{*mapping}.size()) {
+    /* the tile was appended after the file was mapped; map it
+       again */
+    mapping.reset();
+    mapping = std::make_unique<FileMapping>(path);
+  }
+
+  const std::span<const std::byte> m = *mapping;
+  if (offset + size > m.size())
+    throw FmtRuntimeError("Truncated terrain tile store: {}", path);
+
+  return m.subspan(offset, size);
+}
+
+bool
+TerrainTileStore::Load(unsigned index, RasterTile &tile) const noexcept
+{
+  const std::lock_guard lock{mutex};
+
+  if (index >= slots.size() || !tile.IsDefined())
+    return false;
+
+  const Slot &slot = slots[index];
+  if (!slot.IsDefined() ||
+      slot.width != tile.size.x || slot.height != tile.size.y)
+    return false;
+
+  try {
+    const auto src = Map(slot.offset, slot.GetByteSize());
+
+    tile.buffer.Resize(tile.size);
+    std::copy(src.begin(), src.end(),
+              reinterpret_cast<std::byte *>(tile.buffer.GetData()));
+    return true;
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to load terrain tile");
+    return false;
+  }
+}
+
+void
+TerrainTileStore::Save(unsigned index, const RasterTile &tile) noexcept
+{
+  assert(tile.IsLoaded());
+
+  const std::lock_guard lock{mutex};
+
+  if (index >= slots.size() || slots[index].IsDefined())
+    return;
+
+  Slot slot;
+  slot.width = tile.size.x;
+  slot.height = tile.size.y;
+
+  const std::size_t size = slot.GetByteSize();
+  if (end_offset + size > MAX_FILE_SIZE)
+    return;
+
+  slot.offset = end_offset;
+
+  try {
+    /* write the tile buffer first and then the slot, so an
+       interrupted write never leaves a dangling slot behind */
+    if (fd.Seek(end_offset) < 0)
+      throw FmtErrno("Failed to seek {}", path);
+
+    fd.FullWrite({reinterpret_cast<const std::byte *>(tile.buffer.GetData()), size});
+
+    if (fd.Seek(sizeof(Header) + index * sizeof(Slot)) < 0)
+      throw FmtErrno("Failed to seek {}", path);
+
+    fd.FullWrite(ReferenceAsBytes(slot));
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to save terrain tile");
+    return;
+  }
+
+  slots[index] = slot;
+  end_offset += size;
+}
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "RasterLocation.hpp"
+#include "Height.hpp"
+#include "io/UniqueFileDescriptor.hxx"
+#include "system/Path.hpp"
+#include "thread/Mutex.hxx"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+class FileMapping;
+class RasterTile;
+
+/**
+ * A persistent on-disk store of decoded #RasterTile buffers.  It
+ * allows reactivating a tile by copying it from a memory-mapped file
+ * instead of running the (expensive) JPEG2000 decoder again.
+ *
+ * The file consists of a header, a slot table with one entry per
+ * tile and the raw #TerrainHeight buffers, which are appended as
+ * tiles get decoded.  The header contains the size and modification
+ * time of the map file and the tile geometry; if any of these does
+ * not match, the store is discarded and created again.
+ *
+ * All methods are thread-safe.
+ */
+class TerrainTileStore {
+  /**
+   * Stop appending tiles once the file has reached this size.
+   * Beyond that, tiles are decoded from the map file as usual.
+   */
+  static constexpr uint64_t MAX_FILE_SIZE = 256 * 1024 * 1024;
+
+public:
+  struct Key {
+    /**
+     * The size of the map file.
+     */
+    uint64_t file_size;
+
+    /**
+     * The modification time of the map file.
+     */
+    std::chrono::system_clock::time_point file_mtime;
+
+    /**
+     * The size of the raster in pixels.
+     */
+    RasterLocation size;
+
+    /**
+     * The number of tile columns and rows.
+     */
+    RasterLocation n_tiles;
+
+    bool operator==(const Key &) const noexcept = default;
+  };
+
+private:
+  struct Header {
+    static constexpr uint32_t MAGIC = 0x5854cafe;
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic, version;
+    Key key;
+  };
+
+  struct Slot {
+    /**
+     * The position of the tile buffer within the file; 0 means the
+     * tile has not been stored yet.
+     */
+    uint32_t offset;
+
+    /**
+     * The size of the tile in pixels.
+     */
+    uint16_t width, height;
+
+    constexpr bool IsDefined() const noexcept {
+      return offset != 0;
+    }
+
+    constexpr std::size_t GetByteSize() const noexcept {
+      return std::size_t(width) * height * sizeof(TerrainHeight);
+    }
+  };
+
+  const AllocatedPath path;
+
+  mutable Mutex mutex;
+
+  UniqueFileDescriptor fd;
+
+  /**
+   * A read-only mapping of the file.  It is recreated when a tile
+   * is requested which was appended after the file was mapped.
+   */
+  mutable std::unique_ptr<FileMapping> mapping;
+
+  /**
+   * An in-memory copy of the slot table.
+   */
+  std::vector<Slot> slots;
+
+  /**
+   * The current end of the file, where the next tile will be
+   * appended.
+   */
+  uint64_t end_offset;
+
+public:
+  /**
+   * Open (or create) the store.
+   *
+   * Throws on error.
+   *
+   * @param path the path of the store file
+   * @param key identifies the map file; if it does not match the
+   * key saved in the file, the file is cleared
+   * @param n_tiles the total number of tiles
+   */
+  TerrainTileStore(Path _path, const Key &key, unsigned n_tiles);
+  ~TerrainTileStore() noexcept;
+
+  TerrainTileStore(const TerrainTileStore &) = delete;
+  TerrainTileStore &operator=(const TerrainTileStore &) = delete;
+
+  /**
+   * Load the decoded buffer of the specified tile from the store.
+   * The caller must hold the write lock on the #RasterTileCache.
+   *
+   * @return true if the tile was loaded, false if it is not in the
+   * store (or on I/O error)
+   */
+  bool Load(unsigned index, RasterTile &tile) const noexcept;
+
+  /**
+   * Append the decoded buffer of the specified tile to the store.
+   * Does nothing if the tile has already been stored or if the file
+   * has reached its maximum size.  Errors are logged.
+   */
+  void Save(unsigned index, const RasterTile &tile) noexcept;
+
+private:
+  bool Open(const Key &key, unsigned n_tiles);
+  void Create(const Key &key, unsigned n_tiles);
+
+  /**
+   * Ensure that the mapping covers the given range; the caller
+   * must hold the mutex.
+   *
+   * Throws on error.
+   */
+  std::span<const std::byte> Map(uint64_t offset, std::size_t size) const;
+};
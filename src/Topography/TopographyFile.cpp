@@ -3,6 +3,7 @@
 
 #include "Topography/TopographyFile.hpp"
 #include "Topography/XShape.hpp"
+#include "Topography/TopographyPack.hpp"
 #include "Convert.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "util/ScopeExit.hxx"
@@ -22,7 +23,8 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
                                ResourceId _ultra_icon,
                                unsigned _pen_width)
   :dir(_dir),
-   file(dir, filename),
+   file(std::in_place, dir, filename),
+   pack(nullptr),
    label_field(_label_field),
    icon(_icon), big_icon(_big_icon), ultra_icon(_ultra_icon),
    pen_width(_pen_width),
@@ -30,7 +32,36 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
    label_threshold(_label_threshold),
    important_label_threshold(_important_label_threshold)
 {
-  const std::size_t n_shapes = file.size();
+  Init(file->size(), ImportRect(file->GetBounds()));
+
+  if (dir != nullptr)
+    ++dir->refcount;
+}
+
+TopographyFile::TopographyFile(const TopographyPackLayer &_pack,
+                               double _threshold,
+                               double _label_threshold,
+                               double _important_label_threshold,
+                               const BGRA8Color _color,
+                               int _label_field,
+                               ResourceId _icon, ResourceId _big_icon,
+                               ResourceId _ultra_icon,
+                               unsigned _pen_width)
+  :dir(nullptr),
+   pack(&_pack),
+   label_field(_label_field),
+   icon(_icon), big_icon(_big_icon), ultra_icon(_ultra_icon),
+   pen_width(_pen_width),
+   color(_color), scale_threshold(_threshold),
+   label_threshold(_label_threshold),
+   important_label_threshold(_important_label_threshold)
+{
+  Init(pack->size(), pack->GetBounds());
+}
+
+void
+TopographyFile::Init(std::size_t n_shapes, const GeoBounds &file_bounds)
+{
   constexpr std::size_t MAX_SHAPES = 16 * 1024 * 1024;
   if (n_shapes == 0)
     throw std::runtime_error{"Empty shapefile"};
@@ -38,7 +69,6 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
   if (n_shapes > MAX_SHAPES)
     throw std::runtime_error{"Too many shapes in shapefile"};
 
-  const auto file_bounds = ImportRect(file.GetBounds());
   if (!file_bounds.Check())
     throw std::runtime_error{"Malformed shapefile bounds"};
 
@@ -46,9 +76,6 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
 
   shapes.ResizeDiscard(n_shapes);
 
-  if (dir != nullptr)
-    ++dir->refcount;
-
   ++serial;
 }
 
@@ -69,59 +96,33 @@ TopographyFile::ClearCache() noexcept
   list.clear();
 }
 
-static std::unique_ptr<XShape>
-LoadShape(ShapeFile &file, GeoPoint &center, std::size_t i, int label_field)
+std::unique_ptr<XShape>
+TopographyFile::LoadShape(std::size_t i)
 {
+  if (pack != nullptr)
+    return std::make_unique<XShape>(*pack, i);
+
   shapeObj shape;
   msInitShape(&shape);
   AtScopeExit(&shape) { msFreeShape(&shape); };
-  file.ReadShape(shape, i);
+  file->ReadShape(shape, i);
 
   const char *label = label_field >= 0
-    ? file.ReadLabel(i, label_field)
+    ? file->ReadLabel(i, label_field)
     : nullptr;
 
   return std::make_unique<XShape>(shape, center, label);
 }
 
-bool
-TopographyFile::Update(const WindowProjection &map_projection)
+template<typename F>
+inline void
+TopographyFile::UpdateShapes(F &&is_selected)
 {
-  if (map_projection.GetMapScale() > scale_threshold)
-    /* not visible, don't update cache now */
-    return false;
-
-  const GeoBounds screenRect =
-    map_projection.GetScreenBounds();
-  if (cache_bounds.IsValid() && cache_bounds.IsInside(screenRect))
-    /* the cache is still fresh */
-    return false;
-
-  cache_bounds = screenRect.Scale(2);
-
-  // Test which shapes are inside the given bounds and save the
-  // status to file.status
-  switch (file.WhichShapes(dir, ConvertRect(cache_bounds))) {
-  case MS_FAILURE:
-    ClearCache();
-    throw std::runtime_error{"Failed to update shapefile"};
-
-  case MS_DONE:
-    /* screen is outside of map bounds */
-    return false;
-
-  case MS_SUCCESS:
-    break;
-  }
-
-  const auto status = file.GetStatus();
-  assert(status != nullptr);
-
   // Iterate through the shapefile entries
   auto prev = list.before_begin();
   auto it = shapes.begin();
-  for (std::size_t i = 0; i < file.size(); ++i, ++it) {
-    if (!msGetBit(status, i)) {
+  for (std::size_t i = 0; i < shapes.size(); ++i, ++it) {
+    if (!is_selected(i)) {
       // If the shape is outside the bounds
       // delete the shape from the cache
       if (it->shape != nullptr) {
@@ -144,7 +145,7 @@ TopographyFile::Update(const WindowProjection &map_projection)
         assert(&*std::next(prev) != &*it);
 
         // shape isn't cached yet -> cache the shape
-        it->shape = LoadShape(file, center, i, label_field);
+        it->shape = LoadShape(i);
 
         /* insert into linked list (protected) */
         {
@@ -160,7 +161,52 @@ TopographyFile::Update(const WindowProjection &map_projection)
   }
 
   assert(std::next(prev) == list.end());
+}
+
+bool
+TopographyFile::Update(const WindowProjection &map_projection)
+{
+  if (map_projection.GetMapScale() > scale_threshold)
+    /* not visible, don't update cache now */
+    return false;
+
+  const GeoBounds screenRect =
+    map_projection.GetScreenBounds();
+  if (cache_bounds.IsValid() && cache_bounds.IsInside(screenRect))
+    /* the cache is still fresh */
+    return false;
+
+  cache_bounds = screenRect.Scale(2);
+
+  if (pack != nullptr) {
+    /* look up the shapes in the pack's tile index */
+    if (!pack->SelectShapes(cache_bounds, selected))
+      /* screen is outside of map bounds */
+      return false;
+
+    UpdateShapes([this](std::size_t i){ return selected[i]; });
+    return true;
+  }
+
+  // Test which shapes are inside the given bounds and save the
+  // status to file.status
+  switch (file->WhichShapes(dir, ConvertRect(cache_bounds))) {
+  case MS_FAILURE:
+    ClearCache();
+    throw std::runtime_error{"Failed to update shapefile"};
+
+  case MS_DONE:
+    /* screen is outside of map bounds */
+    return false;
+
+  case MS_SUCCESS:
+    break;
+  }
+
+  const auto status = file->GetStatus();
+  assert(status != nullptr);
 
+  UpdateShapes([status](std::size_t i){ return msGetBit(status, i); });
   return true;
 }
 
@@ -170,11 +216,11 @@ TopographyFile::LoadAll()
   // Iterate through the shapefile entries
   auto prev = list.before_begin();
   auto it = shapes.begin();
-  for (std::size_t i = 0; i < file.size(); ++i, ++it) {
+  for (std::size_t i = 0; i < shapes.size(); ++i, ++it) {
     if (it->shape == nullptr) {
       assert(&*std::next(prev) != &*it);
       // shape isn't cached yet -> cache the shape
-      it->shape = LoadShape(file, center, i, label_field);
+      it->shape = LoadShape(i);
       // update list pointer
       prev = list.insert_after(prev, *it);
     } else {
@@ -216,15 +262,16 @@ TopographyFile::GetThinningLevel(double map_scale) const noexcept
 }
 
 unsigned
-TopographyFile::GetMinimumPointDistance(unsigned level) const noexcept
+TopographyFile::GetMinimumPointDistance(double threshold,
+                                        unsigned level) noexcept
 {
   switch (level) {
     case 1:
-      return (unsigned)(4 * scale_threshold / 30);
+      return (unsigned)(4 * threshold / 30);
     case 2:
-      return (unsigned)(6 * scale_threshold / 30);
+      return (unsigned)(6 * threshold / 30);
     case 3:
-      return (unsigned)(9 * scale_threshold / 30);
+      return (unsigned)(9 * threshold / 30);
   }
   return 1;
 }
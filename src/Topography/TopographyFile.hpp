@@ -18,9 +18,12 @@
 
 #include <cassert>
 #include <memory>
+#include <optional>
+#include <vector>
 
 class WindowProjection;
 class XShape;
+class TopographyPackLayer;
 struct zzip_dir;
 
 class TopographyFile {
@@ -35,7 +38,23 @@ class TopographyFile {
 
   zzip_dir *const dir;
 
-  ShapeFile file;
+  /**
+   * The shapefile; not opened if the shapes are loaded from a
+   * #TopographyPack.
+   */
+  std::optional<ShapeFile> file;
+
+  /**
+   * If not nullptr, then the shapes are loaded from this (memory
+   * mapped) pack instead of the shapefile.
+   */
+  const TopographyPackLayer *const pack;
+
+  /**
+   * The shapes selected by TopographyPackLayer::SelectShapes() (only
+   * used with a #pack).
+   */
+  std::vector<bool> selected;
 
   /**
    * The center of shapefileObj::bounds.
@@ -144,6 +163,23 @@ public:
                  ResourceId ultra_icon=ResourceId::Null(),
                  unsigned pen_width=1);
 
+  /**
+   * Construct an object which loads the shapes from a
+   * #TopographyPack layer instead of a shapefile.  The pack must
+   * outlive this object.
+   *
+   * Throws on error.
+   */
+  TopographyFile(const TopographyPackLayer &pack,
+                 double threshold, double label_threshold,
+                 double important_label_threshold,
+                 const BGRA8Color color,
+                 int label_field=-1,
+                 ResourceId icon=ResourceId::Null(),
+                 ResourceId big_icon=ResourceId::Null(),
+                 ResourceId ultra_icon=ResourceId::Null(),
+                 unsigned pen_width=1);
+
   TopographyFile(const TopographyFile &) = delete;
 
   /**
@@ -241,7 +277,13 @@ public:
    * @return minimum distance between points in ShapePoint coordinates
    */
   [[gnu::pure]]
-  unsigned GetMinimumPointDistance(unsigned level) const noexcept;
+  unsigned GetMinimumPointDistance(unsigned level) const noexcept {
+    return GetMinimumPointDistance(scale_threshold, level);
+  }
+
+  [[gnu::const]]
+  static unsigned GetMinimumPointDistance(double threshold,
+                                          unsigned level) noexcept;
 #endif
 
   /**
@@ -260,4 +302,20 @@ public:
 
 protected:
   void ClearCache() noexcept;
+
+private:
+  void Init(std::size_t n_shapes, const GeoBounds &file_bounds);
+
+  /**
+   * Throws on error.
+   */
+  std::unique_ptr<XShape> LoadShape(std::size_t i);
+
+  /**
+   * Load the selected shapes into the cache and remove all others.
+   *
+   * Throws on error.
+   */
+  template<typename F>
+  void UpdateShapes(F &&is_selected);
 };
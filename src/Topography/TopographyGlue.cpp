@@ -5,25 +5,37 @@
 #include "Topography/TopographyStore.hpp"
 #include "Language/Language.hpp"
 #include "Profile/Profile.hpp"
+#include "Profile/Keys.hpp"
+#include "Components.hpp"
 #include "LogFile.hpp"
-#include "io/MapFile.hpp"
+#include "io/FileCache.hpp"
 #include "io/ZipArchive.hpp"
 #include "io/ZipLineReader.hpp"
 #include "system/Path.hpp"
 
+static constexpr char topography_pack_name[] = "topography.pack";
+
 /**
  * Load topography from the map file (ZIP), load the other files from
- * the same ZIP file.
+ * the same ZIP file.  The shapes are converted to a #TopographyPack
+ * in the file cache on the first run, and subsequent runs map the
+ * pack instead of decoding the shapefiles.
  */
 static bool
 LoadConfiguredTopographyZip(TopographyStore &store)
 try {
-  auto archive = OpenMapFile();
-  if (!archive)
+  const auto path = Profile::GetPath(ProfileKeys::MapFile);
+  if (path == nullptr)
     return false;
 
-  ZipLineReaderA reader(archive->get(), "topology.tpl");
-  store.Load(reader, nullptr, archive->get());
+  ZipArchive archive{path};
+
+  AllocatedPath pack_path;
+  if (file_cache != nullptr)
+    pack_path = file_cache->CreatePath(topography_pack_name);
+
+  ZipLineReaderA reader(archive.get(), "topology.tpl");
+  store.Load(reader, nullptr, archive.get(), pack_path, path);
   return true;
 } catch (...) {
   LogError(std::current_exception(), "No topography in map file");
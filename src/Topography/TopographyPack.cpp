@@ -0,0 +1,500 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "TopographyPack.hpp"
+#include "TopographyFile.hpp"
+#include "ShapeFile.hpp"
+#include "Convert.hpp"
+#include "io/FileMapping.hpp"
+#include "system/FileUtil.hpp"
+#include "system/Path.hpp"
+#include "util/ScopeExit.hxx"
+#include "util/SpanCast.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<GeoBounds>);
+static_assert(std::is_trivially_copyable_v<XShape::Point>);
+
+#ifdef ENABLE_OPENGL
+static_assert(TopographyPackShape::THINNING_LEVELS == XShape::THINNING_LEVELS);
+#endif
+
+namespace {
+
+struct Trailer {
+  static constexpr uint32_t MAGIC = 0x546f706f;
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic, version;
+
+  /**
+   * sizeof() of the records; detects changes of the memory layout.
+   */
+  uint32_t point_size, shape_size, layer_size;
+
+  /**
+   * The number of thinning levels with index buffers; 0 if the pack
+   * was created without OpenGL.
+   */
+  uint32_t thinning_levels;
+
+  uint32_t n_layers, reserved;
+
+  /**
+   * TopographyPackLayerRecord[n_layers]
+   */
+  uint64_t layers;
+
+  /**
+   * The size and modification time of the map file.
+   */
+  uint64_t file_size;
+  int64_t file_mtime;
+};
+
+/**
+ * The alignment of all arrays in the file.
+ */
+static constexpr std::size_t ALIGNMENT = 8;
+
+static_assert(alignof(TopographyPackShape) <= ALIGNMENT);
+static_assert(alignof(TopographyPackLayerRecord) <= ALIGNMENT);
+static_assert(alignof(XShape::Point) <= ALIGNMENT);
+static_assert(sizeof(Trailer) % ALIGNMENT == 0);
+
+/**
+ * Maps locations to the tiles of a #TopographyPackLayer.
+ */
+struct TileGrid {
+  GeoBounds bounds;
+  unsigned columns, rows;
+
+  /**
+   * Choose the grid size for the given number of shapes; about 8
+   * shapes per tile, but not more than 64 x 64 tiles.
+   */
+  static unsigned GetSize(std::size_t n_shapes) noexcept {
+    return std::clamp(unsigned(std::sqrt(n_shapes / 8.)), 1u, 64u);
+  }
+
+  [[gnu::pure]]
+  unsigned GetColumn(Angle longitude) const noexcept {
+    const Angle width = bounds.GetWidth();
+    if (width <= Angle::Zero())
+      return 0;
+
+    const Angle offset = (longitude - bounds.GetWest()).AsBearing();
+    if (offset > width)
+      /* outside: clamp to the nearer edge */
+      return offset - width < Angle::FullCircle() - offset
+        ? columns - 1
+        : 0;
+
+    return std::min(unsigned(offset.Native() / width.Native() * columns),
+                    columns - 1);
+  }
+
+  [[gnu::pure]]
+  unsigned GetRow(Angle latitude) const noexcept {
+    const Angle offset = latitude - bounds.GetSouth();
+    if (offset <= Angle::Zero() || bounds.GetHeight() <= Angle::Zero())
+      return 0;
+
+    return std::min(unsigned(offset.Native() / bounds.GetHeight().Native() * rows),
+                    rows - 1);
+  }
+
+  struct Range {
+    unsigned first_column, last_column, first_row, last_row;
+  };
+
+  [[gnu::pure]]
+  Range GetRange(const GeoBounds &b) const noexcept {
+    Range r{
+      GetColumn(b.GetWest()), GetColumn(b.GetEast()),
+      GetRow(b.GetSouth()), GetRow(b.GetNorth()),
+    };
+
+    if (r.first_column > r.last_column) {
+      /* wraps around the layer */
+      r.first_column = 0;
+      r.last_column = columns - 1;
+    }
+
+    return r;
+  }
+};
+
+} // anonymous namespace
+
+static Trailer
+MakeTrailer(Path original_path, std::size_t n_layers, uint64_t layers)
+{
+  Trailer trailer{};
+  trailer.magic = Trailer::MAGIC;
+  trailer.version = Trailer::VERSION;
+  trailer.point_size = sizeof(XShape::Point);
+  trailer.shape_size = sizeof(TopographyPackShape);
+  trailer.layer_size = sizeof(TopographyPackLayerRecord);
+#ifdef ENABLE_OPENGL
+  trailer.thinning_levels = XShape::THINNING_LEVELS;
+#endif
+  trailer.n_layers = n_layers;
+  trailer.layers = layers;
+  trailer.file_size = File::GetSize(original_path);
+  trailer.file_mtime = File::GetLastModification(original_path)
+    .time_since_epoch().count();
+  return trailer;
+}
+
+/**
+ * Check whether the given array is inside the file and properly
+ * aligned.
+ */
+template<typename T>
+static constexpr bool
+CheckArray(std::size_t file_size, uint64_t offset, uint64_t n) noexcept
+{
+  return offset % alignof(T) == 0 && offset <= file_size &&
+    n <= (file_size - offset) / sizeof(T);
+}
+
+/**
+ * Check the bounds of everything referenced by a shape record,
+ * except for the contents of the points and index buffers.
+ */
+static bool
+CheckShape(std::span<const std::byte> data,
+           const TopographyPackShape &shape) noexcept
+{
+  if (shape.num_lines > XShape::MAX_LINES ||
+      !CheckArray<uint16_t>(data.size(), shape.lines, shape.num_lines) ||
+      !CheckArray<XShape::Point>(data.size(), shape.points, shape.n_points))
+    return false;
+
+  uint64_t n_points = 0;
+  for (const auto n : FromBytesStrict<const uint16_t>(data.subspan(shape.lines,
+                                                                   shape.num_lines * sizeof(uint16_t))))
+    n_points += n;
+
+  if (n_points != shape.n_points)
+    return false;
+
+  if (shape.label != 0 &&
+      (shape.label >= data.size() ||
+       memchr(data.data() + shape.label, 0, data.size() - shape.label) == nullptr))
+    return false;
+
+  for (std::size_t level = 0; level < shape.indices.size(); ++level)
+    if (shape.indices[level] != 0 &&
+        !CheckArray<uint16_t>(data.size(), shape.indices[level],
+                              shape.index_sizes[level]))
+      return false;
+
+  return true;
+}
+
+bool
+TopographyPackLayer::Load(std::span<const std::byte> _data,
+                          const TopographyPackLayerRecord &record) noexcept
+{
+  const uint64_t n_tiles = uint64_t(record.tile_columns) * record.tile_rows;
+  if (record.n_shapes == 0 || n_tiles == 0 ||
+      record.name > _data.size() ||
+      record.name_size > _data.size() - record.name ||
+      !CheckArray<TopographyPackShape>(_data.size(), record.shapes,
+                                       record.n_shapes) ||
+      !CheckArray<uint32_t>(_data.size(), record.tile_offsets, n_tiles + 1) ||
+      !CheckArray<uint32_t>(_data.size(), record.tile_shapes,
+                            record.n_tile_shapes))
+    return false;
+
+  data = _data;
+  name = ToStringView(data.subspan(record.name, record.name_size));
+  bounds = record.bounds;
+  scale_threshold = record.scale_threshold;
+  label_field = record.label_field;
+  shapes = FromBytesStrict<const TopographyPackShape>
+    (data.subspan(record.shapes,
+                  record.n_shapes * sizeof(TopographyPackShape)));
+  tile_columns = record.tile_columns;
+  tile_rows = record.tile_rows;
+  tile_offsets = FromBytesStrict<const uint32_t>
+    (data.subspan(record.tile_offsets, (n_tiles + 1) * sizeof(uint32_t)));
+  tile_shapes = FromBytesStrict<const uint32_t>
+    (data.subspan(record.tile_shapes,
+                  record.n_tile_shapes * sizeof(uint32_t)));
+
+  /* check the tile index and the shapes, because they are used
+     without bounds checks */
+
+  if (tile_offsets.front() != 0 ||
+      tile_offsets.back() != record.n_tile_shapes ||
+      !std::is_sorted(tile_offsets.begin(), tile_offsets.end()))
+    return false;
+
+  for (const uint32_t i : tile_shapes)
+    if (i >= record.n_shapes)
+      return false;
+
+  for (const auto &shape : shapes)
+    if (!CheckShape(data, shape))
+      return false;
+
+  return true;
+}
+
+TopographyPack::TopographyPack(std::unique_ptr<FileMapping> &&_mapping) noexcept
+  :mapping(std::move(_mapping)) {}
+
+TopographyPack::~TopographyPack() noexcept = default;
+
+std::unique_ptr<TopographyPack>
+TopographyPack::Open(Path path, Path original_path)
+{
+  if (!File::Exists(path))
+    return nullptr;
+
+  auto mapping = std::make_unique<FileMapping>(path);
+  const std::span<const std::byte> data = *mapping;
+
+  Trailer trailer;
+  if (data.size() < sizeof(trailer))
+    return nullptr;
+
+  memcpy(&trailer, data.data() + data.size() - sizeof(trailer),
+         sizeof(trailer));
+
+  const Trailer expected = MakeTrailer(original_path, trailer.n_layers,
+                                       trailer.layers);
+  if (memcmp(&trailer, &expected, sizeof(trailer)) != 0)
+    return nullptr;
+
+  const auto records_size = data.size() - sizeof(trailer);
+  if (!CheckArray<TopographyPackLayerRecord>(records_size, trailer.layers,
+                                             trailer.n_layers))
+    return nullptr;
+
+  const auto records = FromBytesStrict<const TopographyPackLayerRecord>
+    (data.subspan(trailer.layers,
+                  trailer.n_layers * sizeof(TopographyPackLayerRecord)));
+
+  std::unique_ptr<TopographyPack> pack(new TopographyPack(std::move(mapping)));
+  pack->layers.reserve(records.size());
+
+  for (const auto &record : records)
+    if (!pack->layers.emplace_back().Load(data, record))
+      return nullptr;
+
+  return pack;
+}
+
+const TopographyPackLayer *
+TopographyPack::FindLayer(std::string_view name, int label_field,
+                          double scale_threshold) const noexcept
+{
+  for (const auto &i : layers)
+    if (i.name == name && i.label_field == label_field &&
+        i.scale_threshold == scale_threshold)
+      return &i;
+
+  return nullptr;
+}
+
+bool
+TopographyPackLayer::SelectShapes(const GeoBounds &_bounds,
+                                  std::vector<bool> &selected) const noexcept
+{
+  if (!bounds.Overlaps(_bounds))
+    return false;
+
+  selected.assign(shapes.size(), false);
+
+  const TileGrid grid{bounds, tile_columns, tile_rows};
+  const auto range = grid.GetRange(_bounds);
+
+  for (unsigned row = range.first_row; row <= range.last_row; ++row) {
+    const unsigned tile = row * tile_columns;
+    const auto begin = tile_shapes.begin() + tile_offsets[tile + range.first_column];
+    const auto end = tile_shapes.begin() + tile_offsets[tile + range.last_column + 1];
+
+    for (auto i = begin; i != end; ++i)
+      if (!selected[*i] && _bounds.Overlaps(shapes[*i].bounds))
+        selected[*i] = true;
+  }
+
+  return true;
+}
+
+TopographyPackWriter::TopographyPackWriter(Path path)
+  :file(path)
+{
+  /* begin with the magic, so no array is at offset 0, which means
+     "none" in the shape records */
+  Append(ReferenceAsBytes(Trailer::MAGIC));
+}
+
+uint64_t
+TopographyPackWriter::Append(std::span<const std::byte> src)
+{
+  static constexpr std::byte padding[ALIGNMENT]{};
+  if (const std::size_t n = (ALIGNMENT - position % ALIGNMENT) % ALIGNMENT;
+      n > 0) {
+    file.Write(std::span{padding, n});
+    position += n;
+  }
+
+  const uint64_t offset = position;
+  file.Write(src);
+  position += src.size();
+  return offset;
+}
+
+void
+TopographyPackWriter::AddLayer(zzip_dir *dir, const char *filename,
+                               std::string_view name,
+                               int label_field, double scale_threshold)
+{
+  ShapeFile shapefile(dir, filename);
+
+  const std::size_t n_shapes = shapefile.size();
+  if (n_shapes == 0)
+    throw std::runtime_error{"Empty shapefile"};
+
+  const auto bounds = ImportRect(shapefile.GetBounds());
+  if (!bounds.Check())
+    throw std::runtime_error{"Malformed shapefile bounds"};
+
+  const GeoPoint center = bounds.GetCenter();
+
+  std::vector<TopographyPackShape> shapes(n_shapes);
+
+  /* the line lengths and labels are collected and written after the
+     points, so TopographyPack::Open() can check them without touching
+     the pages of the points */
+  std::vector<uint16_t> lines;
+  std::string labels;
+
+  for (std::size_t i = 0; i < n_shapes; ++i) {
+    shapeObj src;
+    msInitShape(&src);
+    AtScopeExit(&src) { msFreeShape(&src); };
+    shapefile.ReadShape(src, i);
+
+    const XShape shape(src, center,
+                       label_field >= 0
+                       ? shapefile.ReadLabel(i, label_field)
+                       : nullptr);
+
+    auto &dest = shapes[i];
+    dest = {};
+    dest.bounds = shape.get_bounds();
+    dest.type = shape.get_type();
+
+    const auto shape_lines = shape.GetLines();
+    dest.num_lines = shape_lines.size();
+    dest.lines = lines.size();
+    lines.insert(lines.end(), shape_lines.begin(), shape_lines.end());
+
+    for (const auto n : shape_lines)
+      dest.n_points += n;
+
+    dest.points = Append(std::span{shape.GetPoints(), dest.n_points});
+
+    if (const char *label = shape.GetLabel(); label != nullptr) {
+      dest.label = labels.size();
+      labels.append(label);
+      labels.push_back('\0');
+    } else
+      dest.label = UINT64_MAX;
+
+#ifdef ENABLE_OPENGL
+    if (dest.num_lines > 0 &&
+        (dest.type == MS_SHAPE_LINE || dest.type == MS_SHAPE_POLYGON)) {
+      for (unsigned level = 0; level < XShape::THINNING_LEVELS; ++level) {
+        const auto min_distance =
+          TopographyFile::GetMinimumPointDistance(scale_threshold, level);
+        const auto indices = shape.GetIndices(level, ShapeScalar(min_distance));
+        if (indices.indices == nullptr)
+          continue;
+
+        /* the counts, followed by the indices which are used */
+        std::size_t n = indices.indices - indices.count;
+        if (dest.type == MS_SHAPE_LINE) {
+          for (std::size_t l = 0; l < dest.num_lines; ++l)
+            n += indices.count[l];
+        } else
+          n += *indices.count;
+
+        dest.indices[level] = Append(std::span{indices.count, n});
+        dest.index_sizes[level] = n;
+      }
+    }
+#endif
+  }
+
+  const uint64_t lines_offset = Append(std::span<const uint16_t>{lines});
+  const uint64_t labels_offset = Append(AsBytes(labels));
+  for (auto &i : shapes) {
+    i.lines = lines_offset + i.lines * sizeof(uint16_t);
+    i.label = i.label != UINT64_MAX ? labels_offset + i.label : 0;
+  }
+
+  /* build the tile index */
+
+  const unsigned size = TileGrid::GetSize(n_shapes);
+  const TileGrid grid{bounds, size, size};
+  const std::size_t n_tiles = size * size;
+
+  std::vector<uint32_t> tile_offsets(n_tiles + 1, 0);
+  for (const auto &i : shapes) {
+    const auto range = grid.GetRange(i.bounds);
+    for (unsigned row = range.first_row; row <= range.last_row; ++row)
+      for (unsigned column = range.first_column;
+           column <= range.last_column; ++column)
+        ++tile_offsets[row * size + column + 1];
+  }
+
+  for (std::size_t i = 1; i <= n_tiles; ++i)
+    tile_offsets[i] += tile_offsets[i - 1];
+
+  std::vector<uint32_t> tile_shapes(tile_offsets.back());
+  std::vector<uint32_t> fill(tile_offsets.begin(), tile_offsets.end() - 1);
+  for (std::size_t i = 0; i < n_shapes; ++i) {
+    const auto range = grid.GetRange(shapes[i].bounds);
+    for (unsigned row = range.first_row; row <= range.last_row; ++row)
+      for (unsigned column = range.first_column;
+           column <= range.last_column; ++column)
+        tile_shapes[fill[row * size + column]++] = i;
+  }
+
+  TopographyPackLayerRecord record{};
+  record.bounds = bounds;
+  record.scale_threshold = scale_threshold;
+  record.name = Append(AsBytes(name));
+  record.name_size = name.size();
+  record.label_field = label_field;
+  record.n_shapes = n_shapes;
+  record.tile_columns = record.tile_rows = size;
+  record.n_tile_shapes = tile_shapes.size();
+  record.shapes = Append(std::span<const TopographyPackShape>{shapes});
+  record.tile_offsets = Append(std::span<const uint32_t>{tile_offsets});
+  record.tile_shapes = Append(std::span<const uint32_t>{tile_shapes});
+  layers.push_back(record);
+}
+
+void
+TopographyPackWriter::Commit(Path original_path)
+{
+  const uint64_t offset =
+    Append(std::span<const TopographyPackLayerRecord>{layers});
+  const Trailer trailer = MakeTrailer(original_path, layers.size(), offset);
+  Append(ReferenceAsBytes(trailer));
+  file.Commit();
+}
@@ -0,0 +1,299 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "XShape.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "io/FileOutputStream.hxx"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+class Path;
+class FileMapping;
+struct zzip_dir;
+
+/**
+ * The record of one shape in a #TopographyPack.  All offsets are
+ * relative to the beginning of the file.
+ */
+struct TopographyPackShape {
+  static constexpr std::size_t THINNING_LEVELS = 4;
+
+  GeoBounds bounds;
+
+  uint8_t type;
+  uint8_t num_lines;
+  uint16_t reserved;
+
+  uint32_t n_points;
+
+  /**
+   * The number of points of each line (uint16_t[num_lines]).
+   */
+  uint64_t lines;
+
+  /**
+   * All points of all lines (XShape::Point[n_points]).
+   */
+  uint64_t points;
+
+  /**
+   * The null-terminated label; 0 if there is none.
+   */
+  uint64_t label;
+
+  /**
+   * The index buffers built by XShape::GetIndices() for each
+   * thinning level (the counts followed by the indices); 0 if there
+   * is none.  Only used on OpenGL.
+   */
+  std::array<uint64_t, THINNING_LEVELS> indices;
+
+  /**
+   * The number of uint16_t elements in each of the #indices buffers.
+   */
+  std::array<uint32_t, THINNING_LEVELS> index_sizes;
+};
+
+/**
+ * The record of one layer in a #TopographyPack.
+ */
+struct TopographyPackLayerRecord {
+  GeoBounds bounds;
+
+  double scale_threshold;
+
+  /**
+   * The name of the shapefile without the ".shp" suffix (not
+   * null-terminated).
+   */
+  uint64_t name;
+  uint32_t name_size;
+
+  int32_t label_field;
+
+  uint32_t n_shapes;
+
+  uint32_t tile_columns, tile_rows;
+
+  uint32_t n_tile_shapes;
+
+  /**
+   * TopographyPackShape[n_shapes]
+   */
+  uint64_t shapes;
+
+  /**
+   * uint32_t[tile_columns * tile_rows + 1]
+   */
+  uint64_t tile_offsets;
+
+  /**
+   * uint32_t[n_tile_shapes]
+   */
+  uint64_t tile_shapes;
+};
+
+/**
+ * One layer (i.e. one shapefile) of a #TopographyPack.  This is a
+ * view into the memory-mapped file.
+ */
+class TopographyPackLayer {
+  friend class TopographyPack;
+
+  std::span<const std::byte> data;
+
+  std::string_view name;
+
+  GeoBounds bounds;
+
+  double scale_threshold;
+
+  int label_field;
+
+  std::span<const TopographyPackShape> shapes;
+
+  /**
+   * A grid of tiles which covers #bounds.  #tile_offsets contains
+   * the start of each tile's shape list in #tile_shapes (plus one
+   * element for the end of the last one).  A shape is listed in each
+   * tile it overlaps.
+   */
+  unsigned tile_columns, tile_rows;
+  std::span<const uint32_t> tile_offsets, tile_shapes;
+
+public:
+  std::string_view GetName() const noexcept {
+    return name;
+  }
+
+  const GeoBounds &GetBounds() const noexcept {
+    return bounds;
+  }
+
+  std::size_t size() const noexcept {
+    return shapes.size();
+  }
+
+  const TopographyPackShape &GetShape(std::size_t i) const noexcept {
+    return shapes[i];
+  }
+
+  std::span<const uint16_t> GetLines(const TopographyPackShape &shape) const noexcept {
+    return {
+      reinterpret_cast<const uint16_t *>(data.data() + shape.lines),
+      shape.num_lines,
+    };
+  }
+
+  const XShape::Point *GetPoints(const TopographyPackShape &shape) const noexcept {
+    return reinterpret_cast<const XShape::Point *>(data.data() + shape.points);
+  }
+
+  const char *GetLabel(const TopographyPackShape &shape) const noexcept {
+    return shape.label != 0
+      ? reinterpret_cast<const char *>(data.data() + shape.label)
+      : nullptr;
+  }
+
+  const uint16_t *GetIndices(const TopographyPackShape &shape,
+                             unsigned thinning_level) const noexcept {
+    const uint64_t offset = shape.indices[thinning_level];
+    return offset != 0
+      ? reinterpret_cast<const uint16_t *>(data.data() + offset)
+      : nullptr;
+  }
+
+  /**
+   * Determine which shapes overlap the given bounds, using the tile
+   * index.  This is the equivalent of ShapeFile::WhichShapes().
+   *
+   * @param selected a flag for each shape (resized by this method)
+   * @return false if the bounds do not overlap this layer at all;
+   * #selected is not modified in this case
+   */
+  bool SelectShapes(const GeoBounds &bounds,
+                    std::vector<bool> &selected) const noexcept;
+
+private:
+  /**
+   * Check the record and initialise this object from it.
+   *
+   * @return false if the record is malformed
+   */
+  bool Load(std::span<const std::byte> data,
+            const TopographyPackLayerRecord &record) noexcept;
+};
+
+/**
+ * A memory-mappable copy of all topography layers of a map file.  It
+ * contains the shapes in the form needed by #XShape (i.e. points
+ * projected relative to the layer center on OpenGL), the triangle and
+ * line indices of all thinning levels and a tile index for the
+ * spatial lookup.  Loading shapes from it is pointer arithmetic
+ * instead of decoding the shapefile.
+ *
+ * The file consists of the points and index buffers, the line
+ * lengths and labels of each layer, the shape records, the tile
+ * index, the layer table and a trailer at the end.  The trailer
+ * contains the size and modification time of the map file; if these
+ * do not match, the pack is ignored.  The format depends on the
+ * memory layout of the records and on the type of #XShape::Point,
+ * therefore the pack can only be used on the machine which created
+ * it.
+ */
+class TopographyPack {
+  std::unique_ptr<FileMapping> mapping;
+
+  std::vector<TopographyPackLayer> layers;
+
+  TopographyPack(std::unique_ptr<FileMapping> &&_mapping) noexcept;
+
+public:
+  ~TopographyPack() noexcept;
+
+  TopographyPack(const TopographyPack &) = delete;
+  TopographyPack &operator=(const TopographyPack &) = delete;
+
+  /**
+   * Map the pack file.
+   *
+   * Throws on I/O error.
+   *
+   * @param path the path of the pack file
+   * @param original_path the path of the map file
+   * @return nullptr if the pack file does not exist, is stale or is
+   * malformed
+   */
+  static std::unique_ptr<TopographyPack> Open(Path path, Path original_path);
+
+  /**
+   * Find a layer which was created from the shapefile with the given
+   * name and the same settings.
+   *
+   * @param name the name of the shapefile without the ".shp" suffix
+   */
+  [[gnu::pure]]
+  const TopographyPackLayer *FindLayer(std::string_view name,
+                                       int label_field,
+                                       double scale_threshold) const noexcept;
+};
+
+/**
+ * Converts shapefiles to a #TopographyPack.
+ */
+class TopographyPackWriter {
+  FileOutputStream file;
+
+  uint64_t position = 0;
+
+  std::vector<TopographyPackLayerRecord> layers;
+
+public:
+  /**
+   * Throws on error.
+   */
+  explicit TopographyPackWriter(Path path);
+
+  /**
+   * Load all shapes of a shapefile and append them as a new layer.
+   *
+   * Throws on error; the pack remains usable, but the layer is
+   * missing.
+   *
+   * @param name the name of the layer for TopographyPack::FindLayer()
+   * @param scale_threshold the zoom threshold of the layer, which
+   * determines the point distances of the thinning levels
+   */
+  void AddLayer(zzip_dir *dir, const char *filename, std::string_view name,
+                int label_field, double scale_threshold);
+
+  /**
+   * Write the layer table and replace the pack file.
+   *
+   * Throws on error.
+   *
+   * @param original_path the path of the map file which contains the
+   * shapefiles
+   */
+  void Commit(Path original_path);
+
+private:
+  /**
+   * Append data, aligned for all record types, and return its
+   * offset.
+   */
+  uint64_t Append(std::span<const std::byte> src);
+
+  template<typename T>
+  uint64_t Append(std::span<const T> src) {
+    return Append(std::as_bytes(src));
+  }
+};
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "Topography/TopographyStore.hpp"
+#include "Topography/TopographyPack.hpp"
 #include "Index.hpp"
 #include "util/StringAPI.hxx"
 #include "util/StringCompare.hxx"
@@ -13,6 +14,8 @@
 #include "LogFile.hpp"
 
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #include <windef.h> // for MAX_PATH
 
@@ -65,9 +68,73 @@ TopographyStore::LoadAll() noexcept
     i.LoadAll();
 }
 
+namespace {
+
+struct TopographyLayer {
+  /**
+   * The name of the shapefile without the ".shp" suffix.
+   */
+  std::string name;
+
+  /**
+   * The parsed "topology.tpl" line; its "name" attribute is not
+   * used, because it points into the line buffer.
+   */
+  TopographyIndexEntry entry;
+};
+
+} // anonymous namespace
+
+/**
+ * Build the path of the shapefile in the given buffer.
+ */
+static const char *
+MakeShapeFilename(char *buffer, char *buffer_end, std::string_view name) noexcept
+{
+  memcpy(buffer_end, name.data(), name.size());
+  // Append ".shp" file extension to the shape_filename buffer
+  strcpy(buffer_end + name.size(), ".shp");
+  return buffer;
+}
+
+/**
+ * Open the pack; if it is missing or stale, convert all shapefiles
+ * to a new pack first.
+ */
+static std::unique_ptr<TopographyPack>
+OpenPack(Path pack_path, Path original_path, struct zzip_dir *zdir,
+         const std::vector<TopographyLayer> &layers,
+         char *shape_filename, char *shape_filename_end) noexcept
+try {
+  if (auto pack = TopographyPack::Open(pack_path, original_path))
+    return pack;
+
+  LogFormat("Creating topography pack");
+
+  TopographyPackWriter writer(pack_path);
+  for (const auto &i : layers) {
+    try {
+      writer.AddLayer(zdir,
+                      MakeShapeFilename(shape_filename, shape_filename_end,
+                                        i.name),
+                      i.name, i.entry.shape_field, i.entry.shape_range);
+    } catch (...) {
+      LogError(std::current_exception());
+    }
+  }
+
+  writer.Commit(original_path);
+
+  return TopographyPack::Open(pack_path, original_path);
+} catch (...) {
+  LogError(std::current_exception(), "Failed to load topography pack");
+  return nullptr;
+}
+
 void
 TopographyStore::Load(NLineReader &reader,
-                      Path directory, struct zzip_dir *zdir) noexcept
+                      Path directory, struct zzip_dir *zdir,
+                      Path pack_path, Path original_path) noexcept
 {
   Reset();
 
@@ -85,7 +152,7 @@ TopographyStore::Load(NLineReader &reader,
 
   // Iterate through shape files in the "topology.tpl" file until
   // end or max. file number reached
-  auto i = files.before_begin();
+  std::vector<TopographyLayer> layers;
   while (char *line = reader.ReadLine()) {
     // .tpl Line format: filename,range,icon,field,r,g,b,pen_width,label_range,important_range,alpha
 
@@ -93,22 +160,45 @@ TopographyStore::Load(NLineReader &reader,
     if (!entry)
       continue;
 
-    // Extract filename and append it to the shape_filename buffer
-    memcpy(shape_filename_end, entry->name.data(), entry->name.size());
-    // Append ".shp" file extension to the shape_filename buffer
-    strcpy(shape_filename_end + entry->name.size(), ".shp");
+    layers.push_back({std::string{entry->name}, *entry});
+  }
+
+  if (pack_path != nullptr && original_path != nullptr)
+    pack = OpenPack(pack_path, original_path, zdir, layers,
+                    shape_filename, shape_filename_end);
+
+  auto i = files.before_begin();
+  for (const auto &layer : layers) {
+    const auto &entry = layer.entry;
+    const TopographyPackLayer *pack_layer = pack != nullptr
+      ? pack->FindLayer(layer.name, entry.shape_field, entry.shape_range)
+      : nullptr;
 
     // Create TopographyFile instance from parsed line
     try {
-      i = files.emplace_after(i,
-                              zdir, shape_filename,
-                              entry->shape_range,
-                              entry->label_range,
-                              entry->important_label_range,
-                              entry->color,
-                              entry->shape_field,
-                              entry->icon, entry->big_icon, entry->ultra_icon,
-                              entry->pen_width);
+      if (pack_layer != nullptr)
+        i = files.emplace_after(i,
+                                *pack_layer,
+                                entry.shape_range,
+                                entry.label_range,
+                                entry.important_label_range,
+                                entry.color,
+                                entry.shape_field,
+                                entry.icon, entry.big_icon, entry.ultra_icon,
+                                entry.pen_width);
+      else
+        i = files.emplace_after(i,
+                                zdir,
+                                MakeShapeFilename(shape_filename,
+                                                  shape_filename_end,
+                                                  layer.name),
+                                entry.shape_range,
+                                entry.label_range,
+                                entry.important_label_range,
+                                entry.color,
+                                entry.shape_field,
+                                entry.icon, entry.big_icon, entry.ultra_icon,
+                                entry.pen_width);
     } catch (...) {
       LogError(std::current_exception());
     }
@@ -119,4 +209,5 @@ void
 TopographyStore::Reset() noexcept
 {
   files.clear();
+  pack.reset();
 }
@@ -4,11 +4,13 @@
 #pragma once
 
 #include "TopographyFile.hpp"
+#include "system/Path.hpp"
 #include "util/NonCopyable.hpp"
 
 #include <forward_list>
+#include <memory>
 
-class Path;
+class TopographyPack;
 class WindowProjection;
 class NLineReader;
 struct zzip_dir;
@@ -17,6 +19,12 @@ struct zzip_dir;
  * Class used to manage and render vector topography layers
  */
 class TopographyStore : private NonCopyable {
+  /**
+   * The pack which #files refer to; nullptr if they are loaded from
+   * the shapefiles.
+   */
+  std::unique_ptr<TopographyPack> pack;
+
   std::forward_list<TopographyFile> files;
 
   /**
@@ -64,7 +72,15 @@ public:
    */
   void LoadAll() noexcept;
 
+  /**
+   * @param pack_path the path of a #TopographyPack which is used
+   * instead of the shapefiles; it is created if it does not exist or
+   * is stale; nullptr to load the shapefiles
+   * @param original_path the path of the map file (the ZIP file
+   * #zdir); required if #pack_path is given
+   */
   void Load(NLineReader &reader,
-            Path directory, struct zzip_dir *zdir = nullptr) noexcept;
+            Path directory, struct zzip_dir *zdir = nullptr,
+            Path pack_path = nullptr, Path original_path = nullptr) noexcept;
   void Reset() noexcept;
 };
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "Topography/XShape.hpp"
+#include "Topography/TopographyPack.hpp"
 #include "Convert.hpp"
 #include "util/Compiler.h"
 #include "util/StringAPI.hxx"
@@ -90,8 +91,10 @@ ImportShapePoint(const pointObj &src, [[maybe_unused]] const GeoPoint &file_cent
 
 XShape::XShape(const shapeObj &shape, const GeoPoint &file_center,
                const char *_label)
-  :label(ImportLabel(_label))
+  :owned_label(ImportLabel(_label))
 {
+  label = owned_label.c_str();
+
   bounds = ImportRect(shape.bounds);
   if (!bounds.Check())
     throw std::runtime_error{"Malformed shape bounds"};
@@ -119,8 +122,9 @@ XShape::XShape(const shapeObj &shape, const GeoPoint &file_center,
     ++num_lines;
   }
 
-  points = std::make_unique<Point[]>(num_points);
-  auto *p = points.get();
+  owned_points = std::make_unique<Point[]>(num_points);
+  points = owned_points.get();
+  auto *p = owned_points.get();
   for (std::size_t l = 0; l < num_lines; ++l) {
     const pointObj *src = shape.line[l].point;
     p = std::transform(src, src + lines[l], p,
@@ -130,6 +134,30 @@ XShape::XShape(const shapeObj &shape, const GeoPoint &file_center,
   }
 }
 
+XShape::XShape(const TopographyPackLayer &layer, std::size_t i) noexcept
+{
+  const auto &shape = layer.GetShape(i);
+
+  bounds = shape.bounds;
+  type = shape.type;
+
+  const auto src_lines = layer.GetLines(shape);
+  num_lines = src_lines.size();
+  std::copy(src_lines.begin(), src_lines.end(), lines.begin());
+
+  points = layer.GetPoints(shape);
+  label = layer.GetLabel(shape);
+
+#ifdef ENABLE_OPENGL
+  for (unsigned level = 0; level < THINNING_LEVELS; ++level) {
+    index_count[level] = layer.GetIndices(shape, level);
+    if (index_count[level] != nullptr)
+      indices[level] = index_count[level] +
+        (type == MS_SHAPE_LINE ? num_lines : 1);
+  }
+#endif
+}
+
 XShape::~XShape() noexcept = default;
 
 #ifdef ENABLE_OPENGL
@@ -148,12 +176,12 @@ XShape::BuildIndices(unsigned thinning_level, ShapeScalar min_distance) noexcept
   if (type == MS_SHAPE_LINE) {
     if (num_points <= 2)
       return false;  // line cannot be simplified, so don't create indices
-    index_count[thinning_level] = std::make_unique<GLushort[]>(num_lines + num_points);
-    idx_count = index_count[thinning_level].get();
+    owned_indices[thinning_level] = std::make_unique<GLushort[]>(num_lines + num_points);
+    index_count[thinning_level] = idx_count = owned_indices[thinning_level].get();
     indices[thinning_level] = idx = idx_count + num_lines;
 
     const auto end_l = std::next(lines.begin(), num_lines);
-    const ShapePoint *p = points.get();
+    const ShapePoint *p = points;
     unsigned i = 0;
     for (auto l = lines.begin(); l != end_l; ++l) {
       assert(*l >= 2);
@@ -178,17 +206,17 @@ XShape::BuildIndices(unsigned thinning_level, ShapeScalar min_distance) noexcept
     // TODO: free memory saved by thinning (use malloc/realloc or some class?)
     return true;
   } else if (type == MS_SHAPE_POLYGON) {
-    index_count[thinning_level] = std::make_unique<GLushort[]>(1 + 3 * (num_points - 2) + 2 * (num_lines - 1));
-    idx_count = index_count[thinning_level].get();
+    owned_indices[thinning_level] = std::make_unique<GLushort[]>(1 + 3 * (num_points - 2) + 2 * (num_lines - 1));
+    index_count[thinning_level] = idx_count = owned_indices[thinning_level].get();
     indices[thinning_level] = idx = idx_count + 1;
 
     *idx_count = 0;
-    const ShapePoint *pt = points.get();
+    const ShapePoint *pt = points;
     for (std::size_t i=0; i < num_lines; i++) {
       std::size_t count = PolygonToTriangles(pt, lines[i], idx + *idx_count,
                                              min_distance);
       if (i > 0) {
-        const GLushort offset = pt - points.get();
+        const GLushort offset = pt - points;
         const std::size_t max_idx_count = *idx_count + count;
         for (std::size_t j = *idx_count; j < max_idx_count; j++)
           idx[j] += offset;
@@ -213,7 +241,7 @@ XShape::GetIndices(int thinning_level, ShapeScalar min_distance) const noexcept
       return {};
   }
 
-  return {indices[thinning_level], index_count[thinning_level].get()};
+  return {indices[thinning_level], index_count[thinning_level]};
 }
 
 #endif // ENABLE_OPENGL
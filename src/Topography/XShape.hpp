@@ -18,13 +18,21 @@
 #include <span>
 
 struct GeoPoint;
+class TopographyPackLayer;
 
 class XShape {
+public:
   static constexpr std::size_t MAX_LINES = 32;
+
 #ifdef ENABLE_OPENGL
   static constexpr std::size_t THINNING_LEVELS = 4;
+
+  using Point = ShapePoint;
+#else
+  using Point = GeoPoint;
 #endif
 
+private:
   GeoBounds bounds;
 
   uint8_t type;
@@ -41,22 +49,19 @@ class XShape {
    */
   std::array<uint16_t, MAX_LINES> lines;
 
-#ifdef ENABLE_OPENGL
-  using Point = ShapePoint;
-#else
-  using Point = GeoPoint;
-#endif
-
   /**
-   * All points of all lines.
+   * All points of all lines.  Points to #owned_points or into a
+   * memory-mapped #TopographyPack.
    */
-  std::unique_ptr<Point[]> points;
+  const Point *points = nullptr;
+
+  std::unique_ptr<Point[]> owned_points;
 
 #ifdef ENABLE_OPENGL
   /**
    * Indices of polygon triangles or lines with reduced number of vertices.
    */
-  std::array<uint16_t *, THINNING_LEVELS> indices{};
+  std::array<const uint16_t *, THINNING_LEVELS> indices{};
 
   /**
    * For polygons this will contain the total number of triangle vertices
@@ -64,7 +69,13 @@ class XShape {
    * For lines there will be an array of size num_lines for each thinning
    * level, which contains the number of points for each line.
    */
-  std::array<std::unique_ptr<uint16_t[]>, THINNING_LEVELS> index_count;
+  std::array<const uint16_t *, THINNING_LEVELS> index_count{};
+
+  /**
+   * The buffers allocated by BuildIndices(); #index_count and
+   * #indices point into them.
+   */
+  std::array<std::unique_ptr<uint16_t[]>, THINNING_LEVELS> owned_indices;
 
   /**
    * The start offset in the #GLArrayBuffer (vertex buffer object).
@@ -73,7 +84,12 @@ class XShape {
   mutable unsigned offset;
 #endif
 
-  BasicAllocatedString<char> label;
+  /**
+   * Points to #owned_label or into a memory-mapped #TopographyPack.
+   */
+  const char *label = nullptr;
+
+  BasicAllocatedString<char> owned_label;
 
 public:
   /**
@@ -82,6 +98,13 @@ public:
   XShape(const shapeObj &shape, const GeoPoint &file_center,
          const char *label);
 
+  /**
+   * Construct a shape which refers to the points, labels and
+   * (OpenGL) indices of a #TopographyPack.  Nothing is copied except
+   * for the line lengths; the pack must outlive this object.
+   */
+  XShape(const TopographyPackLayer &layer, std::size_t i) noexcept;
+
   ~XShape() noexcept;
 
   XShape(const XShape &) = delete;
@@ -124,10 +147,10 @@ public:
   }
 
   const Point *GetPoints() const noexcept {
-    return points.get();
+    return points;
   }
 
   const char *GetLabel() const noexcept {
-    return label.c_str();
+    return label;
   }
 };
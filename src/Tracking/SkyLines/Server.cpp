@@ -10,6 +10,15 @@
 #include "net/UniqueSocketDescriptor.hxx"
 #include "util/CRC16CCITT.hpp"
 
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
 static UniqueSocketDescriptor
 CreateBindUDP(SocketAddress address)
 {
@@ -31,22 +40,182 @@ CreateBindUDP(SocketAddress address)
 
 namespace SkyLinesTracking {
 
+/**
+ * The maximum number of datagrams received or sent with one system
+ * call.
+ */
+static constexpr unsigned BATCH_SIZE = 64;
+
+/**
+ * Queued responses are submitted before the end of the received batch
+ * once the oldest one has waited this long, so the responses to the
+ * first datagrams of a batch are not delayed by handling the rest of
+ * it.
+ */
+static constexpr std::chrono::steady_clock::duration MAX_SEND_DELAY =
+  std::chrono::milliseconds{1};
+
+struct Server::ReceiveBatch {
+  struct Datagram {
+    alignas(uint64_t) std::array<std::byte, 4096> data;
+    StaticSocketAddress address;
+    std::size_t length;
+  };
+
+  std::array<Datagram, BATCH_SIZE> datagrams;
+
+#ifdef __linux__
+  std::array<struct iovec, BATCH_SIZE> iov;
+  std::array<struct mmsghdr, BATCH_SIZE> msgs;
+#endif
+
+  /**
+   * Receive as many pending datagrams as possible without blocking.
+   *
+   * Throws on error.
+   *
+   * @return the number of datagrams in #datagrams
+   */
+  unsigned Receive(SocketDescriptor s);
+};
+
+unsigned
+Server::ReceiveBatch::Receive(SocketDescriptor s)
+{
+#ifdef __linux__
+  for (unsigned i = 0; i < BATCH_SIZE; ++i) {
+    auto &d = datagrams[i];
+    iov[i] = {d.data.data(), d.data.size()};
+    msgs[i] = {};
+    msgs[i].msg_hdr.msg_name = d.address;
+    msgs[i].msg_hdr.msg_namelen = d.address.GetCapacity();
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int n = recvmmsg(s.Get(), msgs.data(), BATCH_SIZE, MSG_DONTWAIT, nullptr);
+  if (n < 0) {
+    const auto e = GetSocketError();
+    if (IsSocketErrorReceiveWouldBlock(e))
+      return 0;
+
+    throw MakeSocketError(e, "Failed to receive");
+  }
+
+  for (int i = 0; i < n; ++i) {
+    auto &d = datagrams[i];
+    d.address.SetSize(msgs[i].msg_hdr.msg_namelen);
+    d.length = msgs[i].msg_len;
+  }
+
+  return n;
+#else
+  unsigned n = 0;
+  for (; n < BATCH_SIZE; ++n) {
+    auto &d = datagrams[n];
+    socklen_t address_size = d.address.GetCapacity();
+    ssize_t nbytes = recvfrom(s.Get(), (char *)d.data.data(), d.data.size(),
+                              MSG_DONTWAIT,
+                              d.address, &address_size);
+    if (nbytes < 0) {
+      const auto e = GetSocketError();
+      if (IsSocketErrorReceiveWouldBlock(e))
+        break;
+
+      throw MakeSocketError(e, "Failed to receive");
+    }
+
+    d.address.SetSize(address_size);
+    d.length = nbytes;
+  }
+
+  return n;
+#endif
+}
+
+struct Server::SendQueue {
+  /**
+   * Larger datagrams bypass the queue.  This is enough for all
+   * responses generated by #CloudServer.
+   */
+  static constexpr std::size_t MAX_DATAGRAM_SIZE = 1280;
+
+  struct Datagram {
+    StaticSocketAddress address;
+    std::size_t length;
+    std::array<std::byte, MAX_DATAGRAM_SIZE> data;
+  };
+
+  std::array<Datagram, BATCH_SIZE> datagrams;
+  unsigned n = 0;
+
+  /**
+   * When was the oldest datagram queued?  Only valid if not empty.
+   */
+  std::chrono::steady_clock::time_point since;
+
+#ifdef __linux__
+  std::array<struct iovec, BATCH_SIZE> iov;
+  std::array<struct mmsghdr, BATCH_SIZE> msgs;
+#endif
+
+  bool empty() const noexcept {
+    return n == 0;
+  }
+
+  bool full() const noexcept {
+    return n == BATCH_SIZE;
+  }
+
+  bool IsOverdue() const noexcept {
+    return !empty() &&
+      std::chrono::steady_clock::now() - since >= MAX_SEND_DELAY;
+  }
+
+  void Push(SocketAddress address,
+            std::span<const std::byte> buffer) noexcept {
+    assert(!full());
+    assert(buffer.size() <= MAX_DATAGRAM_SIZE);
+
+    if (n == 0)
+      since = std::chrono::steady_clock::now();
+
+    auto &d = datagrams[n++];
+    d.address = address;
+    d.length = buffer.size();
+    std::memcpy(d.data.data(), buffer.data(), buffer.size());
+  }
+};
+
 Server::Server(EventLoop &event_loop,
                SocketAddress server_address)
   :socket(event_loop, BIND_THIS_METHOD(OnSocketReady),
-          CreateBindUDP(server_address).Release())
+          CreateBindUDP(server_address).Release()),
+   flush_event(event_loop, BIND_THIS_METHOD(FlushSendQueue)),
+   receive_batch(std::make_unique<ReceiveBatch>()),
+   send_queue(std::make_unique<SendQueue>())
+{
+  socket.ScheduleRead();
+}
+
+Server::Server(EventLoop &event_loop, UniqueSocketDescriptor &&_socket)
+  :socket(event_loop, BIND_THIS_METHOD(OnSocketReady), _socket.Release()),
+   flush_event(event_loop, BIND_THIS_METHOD(FlushSendQueue)),
+   receive_batch(std::make_unique<ReceiveBatch>()),
+   send_queue(std::make_unique<SendQueue>())
 {
   socket.ScheduleRead();
 }
 
 Server::~Server()
 {
+  FlushSendQueue();
   socket.Close();
 }
 
 void
-Server::SendBuffer(SocketAddress address,
-                   std::span<const std::byte> buffer) noexcept
+Server::SendNow(SocketAddress address,
+                std::span<const std::byte> buffer) noexcept
 {
   try {
     ssize_t nbytes = socket.GetSocket().WriteNoWait(buffer, address);
@@ -57,6 +226,75 @@ Server::SendBuffer(SocketAddress address,
   }
 }
 
+void
+Server::SendBuffer(SocketAddress address,
+                   std::span<const std::byte> buffer) noexcept
+{
+  if (!socket.IsDefined())
+    return;
+
+  if (buffer.size() > SendQueue::MAX_DATAGRAM_SIZE) {
+    /* too large for the queue; flush it first to preserve the
+       order */
+    FlushSendQueue();
+    SendNow(address, buffer);
+    return;
+  }
+
+  if (send_queue->full())
+    FlushSendQueue();
+
+  send_queue->Push(address, buffer);
+  flush_event.Schedule();
+}
+
+void
+Server::FlushSendQueue() noexcept
+{
+  flush_event.Cancel();
+
+  auto &q = *send_queue;
+  if (q.empty() || !socket.IsDefined()) {
+    q.n = 0;
+    return;
+  }
+
+#ifdef __linux__
+  for (unsigned i = 0; i < q.n; ++i) {
+    auto &d = q.datagrams[i];
+    q.iov[i] = {d.data.data(), d.length};
+    q.msgs[i] = {};
+    q.msgs[i].msg_hdr.msg_name = d.address;
+    q.msgs[i].msg_hdr.msg_namelen = d.address.GetSize();
+    q.msgs[i].msg_hdr.msg_iov = &q.iov[i];
+    q.msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  for (unsigned i = 0; i < q.n;) {
+    int n = sendmmsg(socket.GetSocket().Get(), q.msgs.data() + i, q.n - i,
+                     MSG_DONTWAIT);
+    if (n <= 0) {
+      /* the first datagram has failed; report and skip it */
+      try {
+        throw MakeSocketError("Failed to send");
+      } catch (...) {
+        OnSendError(q.datagrams[i].address, std::current_exception());
+      }
+
+      ++i;
+    } else
+      i += n;
+  }
+#else
+  for (unsigned i = 0; i < q.n; ++i) {
+    const auto &d = q.datagrams[i];
+    SendNow(d.address, {d.data.data(), d.length});
+  }
+#endif
+
+  q.n = 0;
+}
+
 void
 Server::OnPing(const Client &client, unsigned id)
 {
@@ -71,6 +309,11 @@ Server::OnDatagramReceived(Client &&client,
   if (length < sizeof(header))
     return;
 
+  client.key = FromBE64(header.key);
+
+  if (!OnDatagramKey(client, {(const std::byte *)data, length}))
+    return;
+
   const uint16_t received_crc = FromBE16(header.crc);
   header.crc = 0;
 
@@ -78,8 +321,6 @@ Server::OnDatagramReceived(Client &&client,
   if (received_crc != calculated_crc)
     return;
 
-  client.key = FromBE64(header.key);
-
   const auto &ping = *(const PingPacket *)data;
   const auto &fix = *(const FixPacket *)data;
   const auto &traffic = *(const TrafficRequestPacket *)data;
@@ -172,26 +413,36 @@ Server::OnDatagramReceived(Client &&client,
   }
 }
 
+void
+Server::HandleDatagram(SocketAddress address,
+                       std::span<std::byte> datagram) noexcept
+{
+  Client client;
+  client.address = address;
+  OnDatagramReceived(std::move(client), datagram.data(), datagram.size());
+}
+
 void
 Server::OnSocketReady(unsigned) noexcept
 try {
-  // TODO: use recvmmsg() on Linux
+  auto &batch = *receive_batch;
+  const unsigned n = batch.Receive(socket.GetSocket());
 
-  Client client;
-  socklen_t address_size = sizeof(client.address);
-  char buffer[4096];
+  for (unsigned i = 0; i < n; ++i) {
+    auto &d = batch.datagrams[i];
 
-  ssize_t nbytes = recvfrom(socket.GetSocket().Get(), buffer, sizeof(buffer),
-                            MSG_DONTWAIT,
-                            client.address, &address_size);
-  if (nbytes < 0)
-    throw MakeSocketError("Failed to receive");
+    Client client;
+    client.address = d.address;
+    OnDatagramReceived(std::move(client), d.data.data(), d.length);
 
-  client.address.SetSize(address_size);
-  // TODO: set client.key
+    if (send_queue->IsOverdue())
+      FlushSendQueue();
+  }
 
-  OnDatagramReceived(std::move(client), buffer, nbytes);
+  /* send all responses to this batch at once */
+  FlushSendQueue();
 } catch (...) {
+  FlushSendQueue();
   socket.Close();
   OnError(std::current_exception());
 }
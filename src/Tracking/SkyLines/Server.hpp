@@ -4,15 +4,18 @@
 #pragma once
 
 #include "event/SocketEvent.hxx"
+#include "event/DeferEvent.hxx"
 #include "net/StaticSocketAddress.hxx"
 #include "util/SpanCast.hxx"
 
 #include <chrono>
 #include <cstdint>
 #include <exception>
+#include <memory>
 #include <span>
 
 struct GeoPoint;
+class UniqueSocketDescriptor;
 
 namespace SkyLinesTracking {
 
@@ -21,10 +24,29 @@ namespace SkyLinesTracking {
  *
  * To use this class, derive your class from it and implement the
  * virtual methods.
+ *
+ * Datagrams are received and sent in batches: on Linux, with one
+ * recvmmsg() / sendmmsg() call per batch; elsewhere, with a loop of
+ * recvfrom() / sendto() calls.  Responses are queued and submitted
+ * after all received datagrams have been handled (or earlier if the
+ * batch takes long to handle), or at the end of the current
+ * #EventLoop iteration if they were generated elsewhere (e.g. by a
+ * timer).
  */
 class Server {
   SocketEvent socket;
 
+  /**
+   * Submits the #send_queue.
+   */
+  DeferEvent flush_event;
+
+  struct ReceiveBatch;
+  const std::unique_ptr<ReceiveBatch> receive_batch;
+
+  struct SendQueue;
+  const std::unique_ptr<SendQueue> send_queue;
+
 public:
   struct Client {
     StaticSocketAddress address;
@@ -34,6 +56,12 @@ public:
 public:
   Server(EventLoop &event_loop, SocketAddress server_address);
 
+  /**
+   * Construct with a socket which is already bound (e.g. one of
+   * several sharing a port with SO_REUSEPORT).
+   */
+  Server(EventLoop &event_loop, UniqueSocketDescriptor &&_socket);
+
   ~Server();
 
   constexpr
@@ -50,19 +78,52 @@ public:
     return socket.GetEventLoop();
   }
 
+  /**
+   * Queue a datagram.  It is sent when the current batch is
+   * submitted; errors are reported to OnSendError().
+   */
   void SendBuffer(SocketAddress address,
                   std::span<const std::byte> buffer) noexcept;
 
+  /**
+   * Send all queued datagrams now.
+   */
+  void FlushSendQueue() noexcept;
+
   template<typename P>
   void SendPacket(SocketAddress address, const P &packet) noexcept {
     SendBuffer(address, ReferenceAsBytes(packet));
   }
 
+  /**
+   * Handle a datagram which was received elsewhere, e.g. by another
+   * #Server instance which has redirected it from
+   * OnDatagramKey().  The buffer gets modified.
+   */
+  void HandleDatagram(SocketAddress address,
+                      std::span<std::byte> datagram) noexcept;
+
 private:
+  void SendNow(SocketAddress address,
+               std::span<const std::byte> buffer) noexcept;
+
   void OnDatagramReceived(Client &&client, void *data, size_t length);
   void OnSocketReady(unsigned events) noexcept;
 
 protected:
+  /**
+   * A datagram with a valid header has been received; its checksum
+   * has not been verified yet.  This can be used to redirect
+   * datagrams to another #Server instance (see HandleDatagram()).
+   *
+   * @param datagram the unmodified datagram
+   * @return false if this instance shall ignore the datagram
+   */
+  virtual bool OnDatagramKey([[maybe_unused]] const Client &client,
+                             [[maybe_unused]] std::span<const std::byte> datagram) noexcept {
+    return true;
+  }
+
   virtual void OnPing(const Client &client, unsigned id);
 
   virtual void OnFix([[maybe_unused]] const Client &client,
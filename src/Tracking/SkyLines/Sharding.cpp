@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Sharding.hpp"
+#include "Protocol.hpp"
+#include "net/SocketAddress.hxx"
+#include "net/SocketError.hxx"
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <linux/filter.h>
+#include <sys/socket.h>
+#endif
+
+namespace SkyLinesTracking {
+
+std::vector<UniqueSocketDescriptor>
+CreateShardedSockets(SocketAddress address, unsigned n)
+{
+#ifndef __linux__
+  if (n > 1)
+    throw std::runtime_error("Multiple shards require SO_REUSEPORT");
+#endif
+
+  std::vector<UniqueSocketDescriptor> sockets;
+  sockets.reserve(n);
+
+  for (unsigned i = 0; i < n; ++i) {
+    UniqueSocketDescriptor s;
+    if (!s.Create(address.GetFamily(), SOCK_DGRAM, 0))
+      throw MakeSocketError("Failed to create socket");
+
+    /* Linux dual-stack: receive IPv4 and IPv6 on one socket. */
+#ifndef _WIN32
+    if (address.GetFamily() == AF_INET6)
+      s.SetV6Only(false);
+#endif
+
+#ifdef __linux__
+    if (n > 1 && !s.SetReusePort())
+      throw MakeSocketError("Failed to set SO_REUSEPORT");
+#endif
+
+    if (!s.Bind(address))
+      throw MakeSocketError("Failed to bind socket");
+
+    sockets.emplace_back(std::move(s));
+  }
+
+  return sockets;
+}
+
+bool
+SteerByKey([[maybe_unused]] SocketDescriptor s,
+           [[maybe_unused]] unsigned n) noexcept
+{
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+  /* the program sees the UDP payload; load the least significant
+     32 bits of the big-endian key */
+  static_assert(sizeof(Header::key) == 8);
+
+  struct sock_filter code[] = {
+    BPF_STMT(BPF_LD|BPF_W|BPF_ABS, KEY_LOW_OFFSET),
+    BPF_STMT(BPF_ALU|BPF_MOD|BPF_K, n),
+    BPF_STMT(BPF_RET|BPF_A, 0),
+  };
+
+  /* datagrams which are too short make the load fail; the program
+     then returns 0, i.e. the first socket, which discards them */
+
+  const struct sock_fprog program = {
+    (unsigned short)std::size(code),
+    code,
+  };
+
+  return s.SetOption(SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+                     &program, sizeof(program));
+#else
+  return false;
+#endif
+}
+
+} /* namespace SkyLinesTracking */
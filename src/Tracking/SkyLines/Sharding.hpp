@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Protocol.hpp"
+#include "net/UniqueSocketDescriptor.hxx"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SocketAddress;
+
+/*
+ * Helpers for a server which distributes its clients over several
+ * threads ("shards"), each one with its own UDP socket on the same
+ * port.
+ */
+
+namespace SkyLinesTracking {
+
+/**
+ * The offset of the least significant 32 bits of the big-endian
+ * #Header::key in a datagram.  This is the word which the program
+ * installed by SteerByKey() loads.
+ */
+constexpr std::size_t KEY_LOW_OFFSET = offsetof(Header, key) + 4;
+
+/**
+ * Determine which of @p n shards owns the client with the given
+ * key.  This must match the program installed by SteerByKey(),
+ * i.e. use the 32 bits at #KEY_LOW_OFFSET.
+ */
+constexpr unsigned
+GetShardOfKey(uint64_t key, unsigned n) noexcept
+{
+  return uint32_t(key) % n;
+}
+
+/**
+ * Create @p n UDP sockets bound to the same address.  If there is
+ * more than one, they share the port with SO_REUSEPORT (Linux only).
+ *
+ * Throws on error.
+ */
+std::vector<UniqueSocketDescriptor>
+CreateShardedSockets(SocketAddress address, unsigned n);
+
+/**
+ * Install a BPF program in the SO_REUSEPORT group of the given
+ * socket which delivers each datagram to the socket with the index
+ * GetShardOfKey(key, n), according to the #Header::key.  Without
+ * it, the kernel distributes by the sender's address, and the
+ * receiving shard has to redirect datagrams to the owner.
+ *
+ * @return false if this is not supported
+ */
+bool
+SteerByKey(SocketDescriptor s, unsigned n) noexcept;
+
+} /* namespace SkyLinesTracking */
@@ -178,7 +178,7 @@ SettingsLeave(const UISettings &old_ui_settings)
     airspace_database.Clear();
     ReadAirspace(airspace_database,
                  CommonInterface::GetComputerSettings().pressure,
-                 operation);
+                 operation, file_cache);
 
     if (data_components->terrain)
       SetAirspaceGroundLevels(airspace_database, *data_components->terrain);
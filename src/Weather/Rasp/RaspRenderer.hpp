@@ -101,9 +101,8 @@ public:
    * Flush the cache.
    */
   void Flush() {
-#ifdef ENABLE_OPENGL
     raster_renderer.Invalidate();
-#else
+#ifndef ENABLE_OPENGL
     compare_projection.Clear();
 #endif
     last_map = nullptr;
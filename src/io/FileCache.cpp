@@ -82,6 +82,13 @@ FileCache::Flush(const char *name)
   File::Delete(MakeCachePath(name));
 }
 
+AllocatedPath
+FileCache::CreatePath(const char *name)
+{
+  Directory::Create(cache_path);
+  return MakeCachePath(name);
+}
+
 std::unique_ptr<Reader>
 FileCache::Load(const char *name, Path original_path) noexcept
 {
@@ -25,6 +25,13 @@ protected:
 public:
   void Flush(const char *name);
 
+  /**
+   * Returns the path of a cache file whose contents are managed by
+   * the caller (e.g. because it needs random access).  The cache
+   * directory is created if it does not exist yet.
+   */
+  AllocatedPath CreatePath(const char *name);
+
   /**
    * Returns nullptr on error.
    */
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "thread/ThreadPool.hpp"
+#include "thread/Thread.hpp"
+
+#include <cassert>
+#include <thread>
+#include <utility>
+
+class ThreadPool::Worker final : public Thread {
+  ThreadPool &pool;
+
+public:
+  Worker(ThreadPool &_pool) noexcept
+    :Thread(_pool.name), pool(_pool) {}
+
+protected:
+  void Run() noexcept override {
+    if (pool.idle_priority)
+      SetIdlePriority();
+
+    pool.RunWorker();
+  }
+};
+
+ThreadPool::ThreadPool(const char *_name, unsigned n_threads,
+                       bool _idle_priority)
+  :name(_name), idle_priority(_idle_priority)
+{
+  workers.reserve(n_threads);
+
+  try {
+    for (unsigned i = 0; i < n_threads; ++i) {
+      auto &worker = workers.emplace_back(std::make_unique<Worker>(*this));
+      worker->Start();
+    }
+  } catch (...) {
+    StopWorkers();
+    throw;
+  }
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+  StopWorkers();
+}
+
+void
+ThreadPool::StopWorkers() noexcept
+{
+  {
+    const std::lock_guard lock{mutex};
+    assert(queue.empty());
+    stop = true;
+    cond.notify_all();
+  }
+
+  /* Join() ignores threads which failed to start */
+  for (auto &worker : workers)
+    worker->Join();
+
+  workers.clear();
+}
+
+unsigned
+ThreadPool::GetHardwareConcurrency() noexcept
+{
+  const unsigned n = std::thread::hardware_concurrency();
+  return n > 0 ? n : 1;
+}
+
+void
+ThreadPool::Submit(Group &group, std::function<void()> &&function)
+{
+  const std::lock_guard lock{mutex};
+  queue.push_back({&group, std::move(function)});
+  ++group.pending;
+  cond.notify_all();
+}
+
+inline void
+ThreadPool::Execute(std::unique_lock<Mutex> &lock, Task &&task) noexcept
+{
+  Group &group = *task.group;
+
+  std::exception_ptr error;
+
+  {
+    const ScopeUnlock unlock{mutex};
+
+    try {
+      task.function();
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    /* destruct the function (and its captures) outside of the
+       lock */
+    task.function = {};
+  }
+
+  assert(lock.owns_lock());
+  (void)lock;
+
+  if (error && !group.error)
+    group.error = std::move(error);
+
+  assert(group.pending > 0);
+  if (--group.pending == 0)
+    cond.notify_all();
+}
+
+void
+ThreadPool::RunWorker() noexcept
+{
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    if (queue.empty()) {
+      if (stop)
+        break;
+
+      cond.wait(lock);
+      continue;
+    }
+
+    Task task = std::move(queue.front());
+    queue.pop_front();
+    Execute(lock, std::move(task));
+  }
+}
+
+void
+ThreadPool::Wait(Group &group)
+{
+  std::unique_lock lock{mutex};
+
+  while (group.pending > 0) {
+    if (queue.empty()) {
+      cond.wait(lock);
+      continue;
+    }
+
+    /* help with the queued tasks; these may belong to other
+       groups, which is fine, because their waiters will be woken
+       up when they're done */
+    Task task = std::move(queue.front());
+    queue.pop_front();
+    Execute(lock, std::move(task));
+  }
+
+  if (group.error)
+    std::rethrow_exception(std::exchange(group.error, {}));
+}
+
+void
+ThreadPool::ForEach(unsigned n, const std::function<void(unsigned)> &f)
+{
+  Group group;
+
+  try {
+    for (unsigned i = 0; i < n; ++i)
+      Submit(group, [&f, i]{ f(i); });
+  } catch (...) {
+    /* the queued tasks refer to this stack frame; let them finish
+       before propagating the exception */
+    try {
+      Wait(group);
+    } catch (...) {
+    }
+
+    throw;
+  }
+
+  Wait(group);
+}
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * A fixed-size set of worker threads which execute CPU-bound tasks
+ * in parallel.  Tasks are grouped in a #Group; the thread which waits
+ * for a #Group helps executing queued tasks, therefore tasks may
+ * submit and wait for nested groups without deadlocking.
+ *
+ * A pool with zero threads is valid: all tasks are then executed by
+ * the thread which calls Wait().
+ */
+class ThreadPool {
+  class Worker;
+
+public:
+  /**
+   * A set of tasks which can be waited for.  It must not be
+   * destroyed while tasks are still pending.
+   */
+  class Group {
+    friend class ThreadPool;
+
+    unsigned pending = 0;
+
+    /**
+     * The first exception thrown by a task of this group.
+     */
+    std::exception_ptr error;
+
+  public:
+    Group() noexcept = default;
+
+    Group(const Group &) = delete;
+    Group &operator=(const Group &) = delete;
+  };
+
+private:
+  struct Task {
+    Group *group;
+    std::function<void()> function;
+  };
+
+  const char *const name;
+
+  const bool idle_priority;
+
+  Mutex mutex;
+
+  /**
+   * Signalled when a task is queued, a group is finished, or the
+   * pool is stopped.
+   */
+  Cond cond;
+
+  std::deque<Task> queue;
+
+  std::vector<std::unique_ptr<Worker>> workers;
+
+  bool stop = false;
+
+public:
+  /**
+   * Throws on error.
+   *
+   * @param name the name of the worker threads (must be a string
+   * literal)
+   * @param n_threads the number of worker threads; the thread
+   * calling Wait() participates, too
+   * @param _idle_priority run the worker threads with idle
+   * priority; this does not affect the thread calling Wait()
+   */
+  ThreadPool(const char *_name, unsigned n_threads,
+             bool _idle_priority=false);
+
+  ~ThreadPool() noexcept;
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * Returns the number of online processors, but at least 1.
+   */
+  [[gnu::const]]
+  static unsigned GetHardwareConcurrency() noexcept;
+
+  /**
+   * Returns the number of threads which may execute tasks
+   * concurrently, including the one calling Wait().
+   */
+  unsigned GetConcurrency() const noexcept {
+    return workers.size() + 1;
+  }
+
+  /**
+   * Queue a task.  It may be executed by any worker thread or by
+   * a thread calling Wait().
+   *
+   * Throws std::bad_alloc; the task is not queued in this case.
+   */
+  void Submit(Group &group, std::function<void()> &&function);
+
+  /**
+   * Wait until all tasks of the given group have finished, and
+   * execute queued tasks meanwhile.
+   *
+   * Throws the first exception thrown by a task of the group.
+   */
+  void Wait(Group &group);
+
+  /**
+   * Call the given function for all indices from 0 to n-1 in
+   * parallel and wait for completion.
+   *
+   * Throws the first exception thrown by the function.
+   */
+  void ForEach(unsigned n, const std::function<void(unsigned)> &f);
+
+private:
+  void StopWorkers() noexcept;
+  void Execute(std::unique_lock<Mutex> &lock, Task &&task) noexcept;
+  void RunWorker() noexcept;
+};
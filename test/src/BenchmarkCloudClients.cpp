@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Replay a synthetic fleet of cloud clients which send one fix per
+ * second each, the way xcsoar-cloud-server handles it: update the
+ * client's location in the spatial index, then query the clients in
+ * traffic range.  For comparison, the same is done with the
+ * boost::geometry rtree which CloudClientContainer used to have.
+ */
+
+#include "Cloud/Client.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+#include "Geo/FAISphere.hpp"
+#include "net/IPv4Address.hxx"
+#include "system/Args.hpp"
+#include "util/PrintException.hxx"
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/algorithms/distance.hpp>
+#include <boost/geometry/algorithms/intersection.hpp>
+#include <boost/geometry/strategies/strategies.hpp>
+
+#include <chrono>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr double TRAFFIC_RANGE = 50000;
+
+/**
+ * The distance travelled between two fixes [m].
+ */
+static constexpr double STEP = 30;
+
+struct SimulatedClient {
+  uint64_t key;
+  GeoPoint location;
+  Angle track;
+
+  void Move() noexcept {
+    const Angle distance = FAISphere::EarthDistanceToAngle(STEP);
+    location.latitude += distance * track.cos();
+    location.longitude += distance * track.sin()
+      / location.latitude.cos();
+  }
+};
+
+/**
+ * Place the fleet randomly in central Europe (about 1.6 million
+ * square kilometres), flying in random directions.
+ */
+static std::vector<SimulatedClient>
+MakeFleet(unsigned n)
+{
+  std::mt19937 rng;
+  std::uniform_real_distribution<double> latitude(40, 55), longitude(-5, 25);
+  std::uniform_real_distribution<double> track(0, 360);
+
+  std::vector<SimulatedClient> fleet;
+  fleet.reserve(n);
+  for (unsigned i = 0; i < n; ++i)
+    fleet.push_back({
+      0x1000 + i,
+      GeoPoint(Angle::Degrees(longitude(rng)), Angle::Degrees(latitude(rng))),
+      Angle::Degrees(track(rng)),
+    });
+
+  return fleet;
+}
+
+struct Result {
+  Clock::duration update{}, query{};
+  unsigned long n_fixes = 0, n_neighbours = 0;
+};
+
+static void
+PrintResult(const char *name, const Result &r) noexcept
+{
+  const auto ns = [&r](Clock::duration d){
+    return std::chrono::duration<double, std::nano>(d).count() / r.n_fixes;
+  };
+
+  printf("%-6s update %7.0f ns/fix  query %8.0f ns/fix  (%.1f neighbours/fix)\n",
+         name, ns(r.update), ns(r.query),
+         double(r.n_neighbours) / r.n_fixes);
+}
+
+static Result
+ReplayContainer(std::vector<SimulatedClient> fleet, unsigned n_rounds)
+{
+  const IPv4Address address(127, 0, 0, 1, 5597);
+
+  CloudClientContainer clients;
+  for (const auto &i : fleet)
+    clients.Make(address, i.key, i.location, 1000, 0, false);
+
+  Result r;
+  for (unsigned round = 0; round < n_rounds; ++round) {
+    for (auto &i : fleet) {
+      i.Move();
+
+      const auto t0 = Clock::now();
+      auto &client = *clients.Find(i.key);
+      clients.Refresh(client, address, i.location, 1000, 0, false);
+      const auto t1 = Clock::now();
+
+      for ([[maybe_unused]] const auto &j :
+             clients.QueryWithinRange(i.location, TRAFFIC_RANGE))
+        ++r.n_neighbours;
+      const auto t2 = Clock::now();
+
+      r.update += t1 - t0;
+      r.query += t2 - t1;
+      ++r.n_fixes;
+    }
+  }
+
+  return r;
+}
+
+static Result
+ReplayRTree(std::vector<SimulatedClient> fleet, unsigned n_rounds)
+{
+  using Value = std::pair<GeoPoint, const SimulatedClient *>;
+  boost::geometry::index::rtree<Value, boost::geometry::index::rstar<16>> rtree;
+
+  for (const auto &i : fleet)
+    rtree.insert({i.location, &i});
+
+  Result r;
+  for (unsigned round = 0; round < n_rounds; ++round) {
+    for (auto &i : fleet) {
+      const auto old_location = i.location;
+      i.Move();
+
+      const auto t0 = Clock::now();
+      rtree.remove(Value{old_location, &i});
+      rtree.insert({i.location, &i});
+      const auto t1 = Clock::now();
+
+      const auto q = boost::geometry::index::intersects(BoostRangeBox(i.location,
+                                                                      TRAFFIC_RANGE));
+      for (auto j = rtree.qbegin(q); j != rtree.qend(); ++j)
+        ++r.n_neighbours;
+      const auto t2 = Clock::now();
+
+      r.update += t1 - t0;
+      r.query += t2 - t1;
+      ++r.n_fixes;
+    }
+  }
+
+  return r;
+}
+
+int
+main(int argc, char **argv)
+try {
+  Args args(argc, argv, "[CLIENTS] [ROUNDS]");
+  const unsigned n_clients = args.IsEmpty()
+    ? 10000
+    : strtoul(args.GetNext(), nullptr, 10);
+  const unsigned n_rounds = args.IsEmpty()
+    ? 10
+    : strtoul(args.GetNext(), nullptr, 10);
+  args.ExpectEnd();
+
+  if (n_clients == 0 || n_rounds == 0)
+    args.UsageError();
+
+  const auto fleet = MakeFleet(n_clients);
+  printf("clients=%u rounds=%u\n", n_clients, n_rounds);
+
+  PrintResult("grid", ReplayContainer(fleet, n_rounds));
+  PrintResult("rtree", ReplayRTree(fleet, n_rounds));
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Feed a recorded NMEA file through NMEAParser::ParseLine() many
+ * times and print the throughput.
+ */
+
+#include "Device/Parser.hpp"
+#include "NMEA/Info.hpp"
+#include "system/Args.hpp"
+#include "io/FileLineReader.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int
+main(int argc, char **argv)
+try {
+  Args args(argc, argv, "FILE.nmea [ITERATIONS]");
+  const auto path = args.ExpectNextPath();
+  const unsigned iterations = args.IsEmpty()
+    ? 100
+    : strtoul(args.GetNext(), nullptr, 10);
+  args.ExpectEnd();
+
+  std::vector<std::string> lines;
+
+  {
+    FileLineReaderA file(path);
+    char *line;
+    while ((line = file.ReadLine()) != nullptr)
+      lines.emplace_back(line);
+  }
+
+  if (lines.empty()) {
+    fprintf(stderr, "No lines in file\n");
+    return EXIT_FAILURE;
+  }
+
+  unsigned n_parsed = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (unsigned i = 0; i < iterations; ++i) {
+    NMEAParser parser;
+    NMEAInfo info;
+    info.Reset();
+    info.clock = TimeStamp{FloatDuration{1}};
+
+    for (const auto &line : lines)
+      if (parser.ParseLine(line.c_str(), info))
+        ++n_parsed;
+  }
+
+  const std::chrono::duration<double> duration =
+    std::chrono::steady_clock::now() - start;
+
+  const double n_lines = double(lines.size()) * iterations;
+  printf("%.0f lines (%u parsed) in %.3f s: %.0f lines/s, %.1f ns/line\n",
+         n_lines, n_parsed, duration.count(),
+         n_lines / duration.count(),
+         duration.count() * 1e9 / n_lines);
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Terrain/HeightMatrix.hpp"
+#include "Terrain/SlopeShading.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+
+int main()
+{
+  /* a WVGA screen at full resolution */
+  HeightMatrix matrix;
+  matrix.FillGradient({800, 480}, 200, 2500);
+
+  const auto size = matrix.GetSize();
+  constexpr unsigned step = 2;
+
+  const SlopeShadingParameters params{-120, -120, 201, 128, 100};
+
+  const auto illumination = std::make_unique<int8_t[]>(size.x);
+
+  long sum = 0;
+  for (unsigned i = 1024; i-- > 0;) {
+    for (unsigned y = 0; y < size.y; ++y) {
+      const unsigned row_minus = std::min(step, y);
+      const unsigned row_plus = std::min(step, size.y - 1 - y);
+
+      ShadeSlopeRow(params, matrix.GetRow(y), size.x,
+                    row_minus, row_plus, step, illumination.get());
+
+      /* prevent gcc from optimizing this loop away */
+      sum += illumination[y];
+    }
+  }
+
+  return sum == LONG_MIN;
+}
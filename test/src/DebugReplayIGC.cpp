@@ -2,17 +2,17 @@
 // Copyright The XCSoar Project
 
 #include "DebugReplayIGC.hpp"
-#include "io/FileLineReader.hpp"
 #include "IGC/IGCParser.hpp"
 #include "IGC/IGCFix.hpp"
 #include "Units/System.hpp"
 #include "system/Path.hpp"
 
+#include <string>
+
 DebugReplay*
 DebugReplayIGC::Create(Path input_file)
 {
-  FileLineReaderA *reader = new FileLineReaderA(input_file);
-  return new DebugReplayIGC(reader);
+  return new DebugReplayIGC(input_file);
 }
 
 bool
@@ -20,25 +20,25 @@ DebugReplayIGC::Next()
 {
   last_basic = computed_basic;
 
-  const char *line;
-  while ((line = reader->ReadLine()) != NULL) {
-    if (line[0] == 'B') {
+  while (const auto line = reader.ReadLine()) {
+    if (line->starts_with('B')) {
       IGCFix fix;
-      if (IGCParseFix(line, extensions, fix)) {
+      if (IGCParseFix(*line, extensions, fix)) {
         CopyFromFix(fix);
 
         Compute();
         return true;
       }
-    } else if (line[0] == 'H') {
+    } else if (line->starts_with("HFDTE")) {
+      /* the header parser needs a null-terminated copy */
+      const std::string header{*line};
       BrokenDate date;
-      if (memcmp(line, "HFDTE", 5) == 0 &&
-          IGCParseDateRecord(line, date)) {
+      if (IGCParseDateRecord(header.c_str(), date)) {
         (BrokenDate &)raw_basic.date_time_utc = date;
         raw_basic.time_available.Clear();
       }
-    } else if (line[0] == 'I') {
-      IGCParseExtensions(line, extensions);
+    } else if (line->starts_with('I')) {
+      IGCParseExtensions(*line, extensions);
     }
   }
 
@@ -3,18 +3,21 @@
 
 #pragma once
 
-#include "DebugReplayFile.hpp"
+#include "DebugReplay.hpp"
 #include "IGC/IGCExtensions.hpp"
-#include "io/FileLineReader.hpp"
+#include "IGC/IGCReader.hpp"
 
 struct IGCFix;
+class Path;
+
+class DebugReplayIGC : public DebugReplay {
+  IGCReader reader;
 
-class DebugReplayIGC : public DebugReplayFile {
   IGCExtensions extensions;
 
 private:
-  DebugReplayIGC(FileLineReaderA *_reader)
-    : DebugReplayFile(_reader) {
+  explicit DebugReplayIGC(Path input_file)
+    :reader(input_file) {
     extensions.clear();
   }
 
@@ -16,9 +16,7 @@ int main(int argc, char **argv)
   FlarmNetDatabase database;
   FlarmNetReader::LoadFile(path, database);
 
-  for (auto i = database.begin(), end = database.end(); i != end; ++i) {
-    const FlarmNetRecord &record = i->second;
-
+  for (const FlarmNetRecord &record : database) {
     char id_buf[16];
     printf("%s\t%s\t%s\t%s\n",
              record.id.Format(id_buf), record.pilot.c_str(),
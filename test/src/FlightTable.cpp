@@ -4,8 +4,8 @@
 #include "IGC/IGCParser.hpp"
 #include "IGC/IGCFix.hpp"
 #include "IGC/IGCExtensions.hpp"
+#include "IGC/IGCReader.hpp"
 #include "Repository/FileType.hpp"
-#include "io/FileLineReader.hpp"
 #include "system/FileUtil.hpp"
 #include "time/FloatDuration.hxx"
 #include "util/StaticString.hxx"
@@ -13,6 +13,7 @@
 
 #include <cstdio>
 #include <cstring>
+#include <string>
 #include <stdlib.h>
 
 class FlightCheck {
@@ -112,20 +113,21 @@ class IGCFileVisitor : public File::Visitor {
 void
 IGCFileVisitor::Visit(Path path, Path filename)
 {
-  FileLineReaderA reader(path);
+  IGCReader reader(path);
 
   IGCExtensions extensions;
   extensions.clear();
 
   FlightCheck flight(filename.c_str());
-  char *line;
-  while ((line = reader.ReadLine()) != NULL) {
+  while (const auto line = reader.ReadLine()) {
     unsigned day, month, year;
 
     IGCFix fix;
-    if (IGCParseFix(line, extensions, fix))
+    if (IGCParseFix(*line, extensions, fix))
       flight.fix(fix);
-    else if (sscanf(line, "HFDTE%02u%02u%02u", &day, &month, &year)) {
+    else if (line->starts_with("HFDTE") &&
+             sscanf(std::string{*line}.c_str(), "HFDTE%02u%02u%02u",
+                    &day, &month, &year) == 3) {
       /* damn you, Y2K bug! */
       if (year > 80)
         year += 1900;
@@ -6,8 +6,12 @@
 #include "Printing.hpp"
 #include "system/Args.hpp"
 #include "DebugReplay.hpp"
+#include "thread/ThreadPool.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <ctime>
 #include <stdio.h>
 
 using namespace std::chrono;
@@ -48,8 +52,39 @@ static ContestManager weglide_free(Contest::WEGLIDE_FREE,
 static ContestManager charron(Contest::CHARRON,
                               full_trace, triangle_trace, sprint_trace);
 
+static const std::array all_managers{
+  &olc_classic, &olc_fai, &olc_sprint, &olc_league, &olc_plus, &dmst,
+  &xcontest, &sis_at, &olc_netcoupe, &weglide_free, &charron,
+};
+
+/**
+ * Solve all contests exhaustively (in parallel) and print the
+ * wall-clock and the CPU time this took.
+ */
+static void
+SolveExhaustive(ThreadPool &pool)
+{
+  for (auto *manager : all_managers)
+    manager->SetThreadPool(&pool);
+
+  const auto wall_start = steady_clock::now();
+  const std::clock_t cpu_start = std::clock();
+
+  /* olc_sprint is solved incrementally only */
+  pool.ForEach(all_managers.size(), [](unsigned i){
+    if (all_managers[i] != &olc_sprint)
+      all_managers[i]->SolveExhaustive();
+  });
+
+  const duration<double> wall = steady_clock::now() - wall_start;
+  const double cpu = double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+  printf("\nsolved with %u threads: wall %.3f s, cpu %.3f s\n",
+         pool.GetConcurrency(), wall.count(), cpu);
+}
+
 static int
-TestContest(DebugReplay &replay)
+TestContest(DebugReplay &replay, ThreadPool &pool)
 {
   bool released = false;
 
@@ -81,18 +116,7 @@ TestContest(DebugReplay &replay)
     olc_league.UpdateIdle();
   }
 
-  olc_classic.SolveExhaustive();
-  olc_fai.SolveExhaustive();
-  olc_league.SolveExhaustive();
-  olc_plus.SolveExhaustive();
-  dmst.SolveExhaustive();
-  xcontest.SolveExhaustive();
-  sis_at.SolveExhaustive();
-  olc_netcoupe.SolveExhaustive();
-  weglide_free.SolveExhaustive();
-  charron.SolveExhaustive();
-
-  putchar('\n');
+  SolveExhaustive(pool);
 
   std::cout << "classic\n";
   PrintHelper::print(olc_classic.GetStats().GetResult());
@@ -167,14 +191,20 @@ TestContest(DebugReplay &replay)
 
 int main(int argc, char **argv)
 {
-  Args args(argc, argv, "DRIVER FILE");
+  Args args(argc, argv, "DRIVER FILE [THREADS]");
   DebugReplay *replay = CreateDebugReplay(args);
   if (replay == NULL)
     return EXIT_FAILURE;
 
+  const unsigned n_threads = args.IsEmpty()
+    ? ThreadPool::GetHardwareConcurrency()
+    : std::max(atoi(args.GetNext()), 1);
   args.ExpectEnd();
 
-  int result = TestContest(*replay);
+  /* the main thread participates in solving */
+  ThreadPool pool("Contest", n_threads - 1);
+
+  int result = TestContest(*replay, pool);
   delete replay;
   return result;
 }
@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * A load generator for the SkyLines tracking server (e.g.
+ * xcsoar-cloud-server).  It simulates many clients which send one
+ * FIX per second each, followed by a PING.  The time until the
+ * matching ACK arrives is the response latency; it includes the time
+ * the server needs to handle the FIX (and to send its traffic
+ * responses).
+ */
+
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Tracking/SkyLines/Assemble.hpp"
+#include "Tracking/SkyLines/Server.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "net/Resolver.hxx"
+#include "net/AddressInfo.hxx"
+#include "net/SocketError.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
+#include "system/Args.hpp"
+#include "util/ByteOrder.hxx"
+#include "util/PrintException.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace SL = SkyLinesTracking;
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * All keys used by this program start with this value.
+ */
+static constexpr uint64_t KEY_BASE = 0x4c4f414400000000;
+
+/**
+ * The distance between two simulated clients [degrees].  Clients
+ * are placed on a grid, so each one has a few others within the
+ * server's traffic range.
+ */
+static constexpr double GRID_SPACING = 0.2;
+
+struct SimulatedClient {
+  GeoPoint location;
+  Clock::time_point ping_time;
+  uint16_t ping_id = 0;
+  bool ping_pending = false;
+};
+
+struct Statistics {
+  unsigned fixes = 0, acks = 0, traffic_responses = 0, other = 0;
+  std::vector<Clock::duration> latencies;
+};
+
+static double
+ToMilliseconds(Clock::duration d) noexcept
+{
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+static void
+Send(SocketDescriptor s, std::span<const std::byte> packet)
+{
+  if (s.Send(packet) < 0) {
+    const auto e = GetSocketError();
+    if (!IsSocketErrorSendWouldBlock(e))
+      throw MakeSocketError(e, "Failed to send");
+  }
+}
+
+static void
+SendFix(SocketDescriptor s, unsigned i, SimulatedClient &client,
+        Statistics &stats)
+{
+  const uint64_t key = KEY_BASE + i + 1;
+  const auto now = Clock::now();
+
+  /* drift slowly to the east */
+  client.location.longitude += Angle::Degrees(0.0005);
+
+  Send(s, ReferenceAsBytes(SL::MakeFix(key,
+                                       SL::FixPacket::FLAG_LOCATION |
+                                       SL::FixPacket::FLAG_ALTITUDE,
+                                       0, client.location, Angle::Zero(),
+                                       0, 0, 1500 + (i % 7) * 100, 0, 0)));
+  ++stats.fixes;
+
+  ++client.ping_id;
+  client.ping_time = now;
+  client.ping_pending = true;
+  Send(s, ReferenceAsBytes(SL::MakePing(key, client.ping_id)));
+}
+
+static void
+ReceiveAll(SocketDescriptor s, std::vector<SimulatedClient> &clients,
+           Statistics &stats)
+{
+  alignas(uint64_t) std::byte buffer[4096];
+
+  while (true) {
+    const ssize_t nbytes = s.ReadNoWait(buffer);
+    if (nbytes < 0) {
+      const auto e = GetSocketError();
+      if (IsSocketErrorReceiveWouldBlock(e))
+        return;
+
+      throw MakeSocketError(e, "Failed to receive");
+    }
+
+    const auto &header = *(const SL::Header *)buffer;
+    if ((size_t)nbytes < sizeof(header) ||
+        FromBE32(header.magic) != SL::MAGIC)
+      continue;
+
+    const uint64_t key = FromBE64(header.key);
+    if (key <= KEY_BASE || key > KEY_BASE + clients.size())
+      continue;
+
+    auto &client = clients[key - KEY_BASE - 1];
+
+    switch ((SL::Type)FromBE16(header.type)) {
+    case SL::ACK:
+      if ((size_t)nbytes >= sizeof(SL::ACKPacket) && client.ping_pending &&
+          FromBE16(((const SL::ACKPacket *)buffer)->id) == client.ping_id) {
+        client.ping_pending = false;
+        stats.latencies.push_back(Clock::now() - client.ping_time);
+        ++stats.acks;
+      }
+
+      break;
+
+    case SL::TRAFFIC_RESPONSE:
+      ++stats.traffic_responses;
+      break;
+
+    default:
+      ++stats.other;
+      break;
+    }
+  }
+}
+
+static void
+PrintStatistics(Statistics &stats, unsigned n_clients,
+                Clock::duration duration) noexcept
+{
+  const double seconds = std::chrono::duration<double>(duration).count();
+
+  printf("clients=%u duration=%.1fs\n", n_clients, seconds);
+  printf("fixes=%u (%.0f/s)\n", stats.fixes, stats.fixes / seconds);
+  printf("acks=%u lost=%u\n", stats.acks, stats.fixes - stats.acks);
+  printf("traffic_responses=%u (%.0f/s)\n",
+         stats.traffic_responses, stats.traffic_responses / seconds);
+
+  auto &l = stats.latencies;
+  if (l.empty())
+    return;
+
+  std::sort(l.begin(), l.end());
+  printf("latency p50=%.2fms p99=%.2fms max=%.2fms\n",
+         ToMilliseconds(l[l.size() / 2]),
+         ToMilliseconds(l[l.size() * 99 / 100]),
+         ToMilliseconds(l.back()));
+}
+
+int
+main(int argc, char **argv)
+try {
+  Args args(argc, argv, "HOST[:PORT] CLIENTS SECONDS");
+  const char *host = args.ExpectNext();
+  const int n_clients = args.ExpectNextInt();
+  const int n_seconds = args.ExpectNextInt();
+  args.ExpectEnd();
+
+  if (n_clients <= 0 || n_seconds <= 0)
+    args.UsageError();
+
+  const auto ai = Resolve(host, SL::Server::GetDefaultPort(), 0, SOCK_DGRAM);
+  const auto &address = ai.front();
+
+  UniqueSocketDescriptor s;
+  if (!s.CreateNonBlock(address.GetFamily(), SOCK_DGRAM, 0))
+    throw MakeSocketError("Failed to create socket");
+
+  s.SetIntOption(SOL_SOCKET, SO_RCVBUF, 4 * 1024 * 1024);
+  s.SetIntOption(SOL_SOCKET, SO_SNDBUF, 4 * 1024 * 1024);
+
+  if (!s.Connect(address))
+    throw MakeSocketError("Failed to connect");
+
+  std::vector<SimulatedClient> clients(n_clients);
+  const unsigned columns = (unsigned)std::ceil(std::sqrt(n_clients));
+  for (unsigned i = 0; i < clients.size(); ++i)
+    clients[i].location =
+      GeoPoint(Angle::Degrees(5 + (i % columns) * GRID_SPACING * 1.4),
+               Angle::Degrees(45 + (i / columns) * GRID_SPACING));
+
+  Statistics stats;
+  stats.latencies.reserve(n_clients * n_seconds);
+
+  /* each client sends once per second; spread them evenly */
+  const Clock::duration interval =
+    Clock::duration(std::chrono::seconds(1)) / n_clients;
+  const auto start = Clock::now();
+  const auto end = start + std::chrono::seconds(n_seconds);
+  auto next_send = start;
+  unsigned next_client = 0;
+
+  while (true) {
+    auto now = Clock::now();
+    while (next_send <= now && next_send < end) {
+      SendFix(s, next_client, clients[next_client], stats);
+      next_client = (next_client + 1) % clients.size();
+      next_send += interval;
+    }
+
+    ReceiveAll(s, clients, stats);
+
+    /* wait one more second for late responses */
+    if (now >= end + std::chrono::seconds(1))
+      break;
+
+    const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>
+      ((next_send < end ? next_send : end + std::chrono::seconds(1)) - now);
+    (void)s.WaitReadable(std::max<int>(timeout.count(), 0));
+  }
+
+  PrintStatistics(stats, n_clients, end - start);
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
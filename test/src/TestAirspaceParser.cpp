@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 // Copyright The XCSoar Project
 
+#include "Airspace/AirspaceCache.hpp"
 #include "Airspace/AirspaceParser.hpp"
 #include "Engine/Airspace/AbstractAirspace.hpp"
 #include "Engine/Airspace/AirspaceCircle.hpp"
@@ -11,6 +12,10 @@
 #include "util/StringAPI.hxx"
 #include "util/PrintException.hxx"
 #include "io/FileLineReader.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "io/MemoryReader.hxx"
+#include "io/StringOutputStream.hxx"
+#include "util/SpanCast.hxx"
 #include "Operation/Operation.hpp"
 #include "TestUtil.hpp"
 
@@ -289,14 +294,136 @@ TestOpenAirExtended()
   }
 }
 
+static std::string
+SaveCache(const Airspaces &airspaces, std::size_t first_pending=0)
+{
+  StringOutputStream sos;
+  BufferedOutputStream bos{sos};
+  SaveAirspaceCache(bos, airspaces, first_pending);
+  bos.Flush();
+  return std::move(sos).GetValue();
+}
+
+static void
+LoadCache(std::string_view data, Airspaces &airspaces)
+{
+  MemoryReader memory_reader{AsBytes(data)};
+  BufferedReader buffered_reader{memory_reader};
+  LoadAirspaceCache(buffered_reader, airspaces);
+}
+
+static bool
+Equals(const AirspaceAltitude &a, const AirspaceAltitude &b)
+{
+  return a.reference == b.reference && a.altitude == b.altitude &&
+    a.flight_level == b.flight_level &&
+    a.altitude_above_terrain == b.altitude_above_terrain;
+}
+
+static bool
+Equals(TransponderCode a, TransponderCode b)
+{
+  if (!a.IsDefined() || !b.IsDefined())
+    return a.IsDefined() == b.IsDefined();
+
+  return a.GetCode() == b.GetCode();
+}
+
+static bool
+Equals(const AbstractAirspace &a, const AbstractAirspace &b)
+{
+  if (a.GetShape() != b.GetShape() ||
+      !StringIsEqual(a.GetName(), b.GetName()) ||
+      !StringIsEqual(a.GetStationName(), b.GetStationName()) ||
+      a.GetClass() != b.GetClass() || a.GetType() != b.GetType() ||
+      !(a.GetRadioFrequency() == b.GetRadioFrequency()) ||
+      !Equals(a.GetTransponderCode(), b.GetTransponderCode()) ||
+      !a.GetDays().equals(b.GetDays()) ||
+      !Equals(a.GetBase(), b.GetBase()) || !Equals(a.GetTop(), b.GetTop()))
+    return false;
+
+  if (a.GetShape() == AbstractAirspace::Shape::CIRCLE) {
+    const auto &ca = (const AirspaceCircle &)a;
+    const auto &cb = (const AirspaceCircle &)b;
+    return ca.GetCenter() == cb.GetCenter() &&
+      ca.GetRadius() == cb.GetRadius();
+  }
+
+  const auto &pa = a.GetPoints(), &pb = b.GetPoints();
+  if (pa.size() != pb.size())
+    return false;
+
+  for (std::size_t i = 0; i < pa.size(); ++i)
+    if (pa[i].GetLocation() != pb[i].GetLocation())
+      return false;
+
+  return true;
+}
+
+static void
+TestCache(Path path)
+{
+  Airspaces parsed;
+  FileReader file_reader{path};
+  BufferedReader buffered_reader{file_reader};
+  ParseAirspaceFile(parsed, buffered_reader);
+
+  const std::string data = SaveCache(parsed);
+
+  Airspaces loaded;
+  LoadCache(data, loaded);
+
+  const auto &a = parsed.GetPending(), &b = loaded.GetPending();
+  if (ok1(a.size() == b.size())) {
+    bool equal = true;
+    for (std::size_t i = 0; i < a.size(); ++i)
+      equal = equal && Equals(*a[i], *b[i]);
+    ok1(equal);
+  } else
+    skip(1, 0, "Wrong number of airspaces");
+
+  /* the loaded airspaces produce the same cache */
+  ok1(SaveCache(loaded) == data);
+
+  /* a truncated cache is rejected as a whole */
+  Airspaces truncated;
+  try {
+    LoadCache(std::string_view{data}.substr(0, data.size() / 2), truncated);
+    ok1(false);
+  } catch (...) {
+    ok1(truncated.IsEmpty());
+  }
+}
+
+static void
+TestCachePartial()
+{
+  Airspaces airspaces;
+  FileReader file_reader{Path("test/data/airspace/tnp.sua")};
+  BufferedReader buffered_reader{file_reader};
+  ParseAirspaceFile(airspaces, buffered_reader);
+
+  /* only the airspaces starting at the given index are saved */
+  const std::size_t n = airspaces.GetPending().size();
+  Airspaces loaded;
+  LoadCache(SaveCache(airspaces, n - 2), loaded);
+  ok1(loaded.GetPending().size() == 2 &&
+      Equals(*loaded.GetPending().front(), *airspaces.GetPending()[n - 2]));
+}
+
 int main()
 try {
-  plan_tests(115);
+  plan_tests(115 + 3 * 4 + 1);
 
   TestOpenAir();
   TestTNP();
   TestOpenAirExtended();
 
+  TestCache(Path("test/data/airspace/openair.txt"));
+  TestCache(Path("test/data/airspace/tnp.sua"));
+  TestCache(Path("test/data/airspace/openair_2.txt"));
+  TestCachePartial();
+
   return exit_status();
 } catch (const std::runtime_error &e) {
   PrintException(e);
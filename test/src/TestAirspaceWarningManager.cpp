@@ -3,12 +3,23 @@
 
 #include "Airspace/Airspaces.hpp"
 #include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
 #include "Engine/Airspace/AirspaceWarningManager.hpp"
+#include "Engine/Airspace/AirspaceIntersectionVisitor.hpp"
+#include "Engine/Airspace/AirspaceInterceptSolution.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Task/Stats/TaskStats.hpp"
+#include "Geo/GeoVector.hpp"
 #include "TransponderCode.hpp"
 #include "TestUtil.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
+#include <vector>
+
+#include <stdio.h>
 
 static AirspacePtr
 MakeAirspace(AirspaceClass cls,
@@ -128,14 +139,301 @@ TestNotamAckDayClearSiblings()
   ok1(second_warning != nullptr && !second_warning->GetAckDay());
 }
 
+static AirspacePtr
+MakeSector(const GeoPoint &south_west, Angle width, Angle height,
+           AirspaceClass cls, double base_altitude, double top_altitude,
+           std::string &&name, bool convex=false)
+{
+  /* subdivide each edge like the arcs of a real TMA sector */
+  static constexpr unsigned STEPS = 8;
+  std::vector<GeoPoint> points;
+  const GeoPoint corners[] = {
+    south_west,
+    {south_west.longitude + width, south_west.latitude},
+    {south_west.longitude + width, south_west.latitude + height},
+    {south_west.longitude, south_west.latitude + height},
+  };
+
+  for (unsigned i = 0; i < 4; ++i) {
+    const GeoPoint &a = corners[i], &b = corners[(i + 1) % 4];
+    for (unsigned j = 0; j < STEPS; ++j)
+      points.push_back(a.Interpolate(b, double(j) / STEPS));
+  }
+
+  auto airspace = std::make_shared<AirspacePolygon>(points);
+  if (convex)
+    /* leaves only the corners, and the outline is no longer closed
+       (like the random polygons of harness_airspace) */
+    airspace->MakeConvex();
+
+  AirspaceAltitude base{};
+  base.reference = AltitudeReference::MSL;
+  base.altitude = base_altitude;
+
+  AirspaceAltitude top{};
+  top.reference = AltitudeReference::MSL;
+  top.altitude = top_altitude;
+
+  airspace->SetProperties(std::move(name), std::string{},
+                          TransponderCode::Null(),
+                          cls, cls, base, top);
+  return airspace;
+}
+
+/**
+ * The intersection visitor used by the per-prediction algorithm of
+ * AirspaceWarningManager before all predictions were checked in one
+ * sweep.
+ */
+class ReferenceWarningVisitor final : public AirspaceIntersectionVisitor {
+  const AircraftState &state;
+  const AirspaceAircraftPerformance &perf;
+  AirspaceWarningManager &warning_manager;
+  const AirspaceWarning::State warning_state;
+  const FloatDuration max_time;
+  const double max_alt;
+  bool mode_inside = false;
+
+public:
+  ReferenceWarningVisitor(const AircraftState &_state,
+                          const AirspaceAircraftPerformance &_perf,
+                          AirspaceWarningManager &_warning_manager,
+                          AirspaceWarning::State _warning_state,
+                          FloatDuration _max_time, double _max_alt)
+    :state(_state), perf(_perf), warning_manager(_warning_manager),
+     warning_state(_warning_state), max_time(_max_time), max_alt(_max_alt) {}
+
+  void SetMode(bool m) {
+    mode_inside = m;
+  }
+
+  void Visit(ConstAirspacePtr airspace_ptr) noexcept override {
+    const auto &airspace = *airspace_ptr;
+    const auto &config = warning_manager.GetConfig();
+    if (!airspace.IsActive() ||
+        !(config.IsClassEnabled(airspace.GetClassOrType()) ||
+          config.IsClassEnabled(airspace.GetTypeOrClass())) ||
+        (max_alt > 0 && airspace.GetBaseAltitude(state) > max_alt))
+      return;
+
+    AirspaceWarning *warning = warning_manager.GetWarningPtr(airspace);
+    if (warning != nullptr && !warning->IsStateAccepted(warning_state))
+      return;
+
+    const AirspaceInterceptSolution solution = mode_inside
+      ? airspace.Intercept(state, perf, state.location, state.location)
+      : Intercept(airspace, state, perf);
+    if (!solution.IsValid() || solution.elapsed_time > max_time)
+      return;
+
+    if (warning == nullptr)
+      warning = warning_manager.GetNewWarningPtr(std::move(airspace_ptr));
+
+    warning->UpdateSolution(warning_state, solution);
+  }
+};
+
+class AirspaceWarningManagerTest {
+public:
+  /**
+   * The algorithm of AirspaceWarningManager::Update() before all
+   * predictions were checked in one sweep: the airspaces are queried
+   * separately for the aircraft location and for each prediction.
+   */
+  static void UpdatePerPrediction(AirspaceWarningManager &manager,
+                                  const AircraftState &state,
+                                  const GlidePolar &glide_polar,
+                                  const TaskStats &task_stats,
+                                  bool circling,
+                                  std::chrono::duration<unsigned> dt) {
+    for (auto &w : manager.warnings)
+      w.SaveState();
+
+    const auto &config = manager.config;
+    const auto &airspaces = manager.airspaces;
+
+    if (glide_polar.IsValid()) {
+      for (const auto &i : airspaces.QueryInside(state.location)) {
+        const auto &airspace = i.GetAirspace();
+        if (airspace.IsActive() &&
+            (config.IsClassEnabled(airspace.GetClassOrType()) ||
+             config.IsClassEnabled(airspace.GetTypeOrClass())) &&
+            airspace.Inside((const AltitudeState &)state))
+          manager.UpdateInside(state, glide_polar, i.GetAirspacePtr());
+      }
+    }
+
+    AirspaceWarningManager::PredictionList predictions;
+    manager.PredictGlide(state, glide_polar, predictions);
+    manager.PredictFilter(state, circling, predictions);
+    manager.PredictTask(state, glide_polar, task_stats, predictions);
+
+    const auto ceiling = state.altitude
+      + std::max((unsigned)1000, config.altitude_warning_margin);
+
+    for (const auto &prediction : predictions) {
+      ReferenceWarningVisitor visitor(state, prediction.perf, manager,
+                                      prediction.warning_state,
+                                      prediction.max_time, ceiling);
+      airspaces.VisitIntersecting(state.location, prediction.location,
+                                  visitor);
+
+      visitor.SetMode(true);
+      for (const auto &i : airspaces.QueryInside(state.location))
+        visitor.Visit(i.GetAirspacePtr());
+    }
+
+    for (auto it = manager.warnings.begin(); it != manager.warnings.end();) {
+      if (it->WarningLive(config.acknowledgement_time, dt))
+        ++it;
+      else
+        it = manager.warnings.erase(it);
+    }
+
+    manager.warnings.sort();
+  }
+};
+
+/**
+ * Do both managers have the same warnings (airspace, kind and
+ * solution) in the same order?
+ */
+static bool
+SameWarnings(const AirspaceWarningManager &a,
+             const AirspaceWarningManager &b) noexcept
+{
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const AirspaceWarning &x, const AirspaceWarning &y){
+                      return &x.GetAirspace() == &y.GetAirspace() &&
+                        x.GetWarningState() == y.GetWarningState() &&
+                        x.GetSolution().elapsed_time == y.GetSolution().elapsed_time &&
+                        x.GetSolution().distance == y.GetSolution().distance;
+                    });
+}
+
+/**
+ * Fly through a dense TMA made of many small stacked sectors and
+ * print the time spent in AirspaceWarningManager::Update().
+ */
+static void
+TestDense()
+{
+  using namespace std::chrono;
+
+  static constexpr unsigned GRID = 30;
+  static constexpr struct {
+    AirspaceClass cls;
+    double base, top;
+    bool convex;
+  } layers[] = {
+    { CLASSD, 0, 500, false },
+    { CLASSC, 500, 1000, false },
+    { CLASSD, 1000, 1400, true },
+    { CLASSC, 1400, 2000, true },
+    { CLASSD, 2000, 2500, false },
+    { CLASSC, 2500, 4000, false },
+    /* above the warning ceiling while flying at 1500m */
+    { CLASSA, 4000, 6000, false },
+    { CLASSA, 6000, 8000, false },
+  };
+
+  const GeoPoint origin{Angle::Degrees(8), Angle::Degrees(50)};
+  const Angle width = Angle::Degrees(0.01), height = Angle::Degrees(0.007);
+
+  Airspaces airspaces;
+  for (unsigned layer = 0; layer < std::size(layers); ++layer)
+    for (unsigned x = 0; x < GRID; ++x)
+      for (unsigned y = 0; y < GRID; ++y)
+        airspaces.Add(MakeSector({origin.longitude + width * x,
+                                  origin.latitude + height * y},
+                                 width, height, layers[layer].cls,
+                                 layers[layer].base, layers[layer].top,
+                                 std::to_string(layer) + "/" +
+                                 std::to_string(x) + "/" +
+                                 std::to_string(y),
+                                 layers[layer].convex));
+  airspaces.Optimise();
+
+  AirspaceWarningConfig config;
+  config.SetDefaults();
+
+  AirspaceWarningManager manager(config, airspaces);
+
+  /* the same scene checked with the per-prediction algorithm */
+  AirspaceWarningManager reference(config, airspaces);
+
+  const GlidePolar glide_polar(1);
+  const TaskStats task_stats{};
+
+  const GeoPoint start{origin.longitude + width / 2,
+                       origin.latitude + height * (GRID / 2) + height / 2};
+
+  AircraftState state;
+  state.Reset();
+  state.flying = true;
+  state.altitude = 1500;
+  state.track = Angle::Degrees(90);
+  state.ground_speed = state.true_airspeed = 30;
+  state.time = TimeStamp{FloatDuration{0}};
+  state.location = start;
+  manager.Reset(state);
+  reference.Reset(state);
+
+  static constexpr unsigned N_UPDATES = 400;
+
+  duration<double, std::milli> update_time{};
+  unsigned max_warnings = 0;
+  bool above_ceiling = false;
+  unsigned mismatches = 0;
+  for (unsigned i = 1; i <= N_UPDATES; ++i) {
+    state.time = TimeStamp{FloatDuration{i}};
+    state.location = GeoVector(30. * i, state.track).EndPoint(start);
+
+    const auto start_time = steady_clock::now();
+    manager.Update(state, glide_polar, task_stats, false, seconds{1});
+    update_time += steady_clock::now() - start_time;
+
+    AirspaceWarningManagerTest::UpdatePerPrediction(reference, state,
+                                                    glide_polar, task_stats,
+                                                    false, seconds{1});
+    if (!SameWarnings(manager, reference))
+      ++mismatches;
+
+    max_warnings = std::max(max_warnings, unsigned(manager.size()));
+    for (const auto &w : manager)
+      if (w.GetAirspace().GetClass() == CLASSA)
+        above_ceiling = true;
+  }
+
+  printf("# %u updates with %u airspaces: %.1f ms, up to %u warnings\n",
+         N_UPDATES, unsigned(std::size(layers) * GRID * GRID),
+         update_time.count(), max_warnings);
+
+  ok1(max_warnings > 0);
+
+  /* the sweep finds the same warnings as the per-prediction queries */
+  ok1(mismatches == 0);
+
+  /* sectors whose base is far above the aircraft are never warned
+     about */
+  ok1(!above_ceiling);
+
+  /* the most severe warning is the sector the aircraft is in */
+  ok1(!manager.empty() &&
+      manager.begin()->GetWarningState() == AirspaceWarning::WARNING_INSIDE &&
+      manager.begin()->GetAirspace().GetClass() == CLASSC &&
+      manager.begin()->GetAirspace().Inside(state.location));
+}
+
 int
 main()
 {
-  plan_tests(31);
+  plan_tests(31 + 4);
 
   TestNonNotamAckDayClear();
   TestNotamAckDayClearAfterRefresh();
   TestNotamAckDayClearSiblings();
+  TestDense();
 
   return exit_status();
 }
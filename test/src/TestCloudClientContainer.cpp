@@ -0,0 +1,409 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Cloud/Client.hpp"
+#include "Cloud/Serialiser.hpp"
+#include "Cloud/TrafficCache.hpp"
+#include "Tracking/SkyLines/Sharding.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+#include "net/IPv4Address.hxx"
+#include "io/MemoryReader.hxx"
+#include "io/StringOutputStream.hxx"
+#include "util/ByteOrder.hxx"
+#include "util/SpanCast.hxx"
+
+#include "TestUtil.hpp"
+
+#include <boost/geometry/algorithms/intersects.hpp>
+#include <boost/geometry/strategies/strategies.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+static constexpr double RANGE = 50000;
+
+/**
+ * Areas where the random clients are placed; they include the
+ * antimeridian and a pole.
+ */
+static constexpr struct {
+  double south, north, west, east;
+} areas[] = {
+  { 45, 50, 5, 15 },
+  { -40, -38, 179, 181 },
+  { 88, 90, -180, 180 },
+  { -1, 1, -1, 1 },
+};
+
+static std::mt19937 rng;
+
+static GeoPoint
+RandomLocation()
+{
+  const auto &a = areas[rng() % std::size(areas)];
+  std::uniform_real_distribution<double> latitude(a.south, a.north);
+  std::uniform_real_distribution<double> longitude(a.west, a.east);
+  return GeoPoint(Angle::Degrees(longitude(rng)),
+                  Angle::Degrees(latitude(rng)));
+}
+
+/**
+ * Move the location by up to 0.05 degrees (about one minute of
+ * flight).
+ */
+static GeoPoint
+Move(GeoPoint location)
+{
+  std::uniform_real_distribution<double> delta(-0.05, 0.05);
+  location.longitude = (location.longitude + Angle::Degrees(delta(rng))).AsDelta();
+  location.latitude = std::clamp(location.latitude + Angle::Degrees(delta(rng)),
+                                 -Angle::QuarterCircle(),
+                                 Angle::QuarterCircle());
+  return location;
+}
+
+/**
+ * Like boost::geometry::intersects(), but split boxes which cross
+ * the antimeridian (boost::geometry considers them empty).
+ */
+static bool
+IsInside(GeoPoint location, const boost::geometry::model::box<GeoPoint> &box)
+{
+  auto west = box.min_corner(), east = box.max_corner();
+  if (west.longitude <= east.longitude)
+    return boost::geometry::intersects(location, box);
+
+  location.longitude = location.longitude.AsDelta();
+
+  const GeoPoint antimeridian_east(Angle::HalfCircle(), east.latitude);
+  const GeoPoint antimeridian_west(-Angle::HalfCircle(), west.latitude);
+  return boost::geometry::intersects(location,
+                                     boost::geometry::model::box<GeoPoint>{west, antimeridian_east}) ||
+    boost::geometry::intersects(location,
+                                boost::geometry::model::box<GeoPoint>{antimeridian_west, east});
+}
+
+/**
+ * Compare QueryWithinRange() with a linear search.
+ */
+static bool
+CheckQuery(const CloudClientContainer &clients, GeoPoint location)
+{
+  const auto box = BoostRangeBox(location, RANGE);
+
+  std::vector<uint64_t> expected;
+  for (const auto &i : clients)
+    if (IsInside(i.location, box))
+      expected.push_back(i.key);
+
+  std::vector<uint64_t> actual;
+  for (const auto &i : clients.QueryWithinRange(location, RANGE))
+    actual.push_back(i.key);
+
+  std::sort(expected.begin(), expected.end());
+  std::sort(actual.begin(), actual.end());
+  return actual == expected;
+}
+
+static bool
+CheckQueries(const CloudClientContainer &clients)
+{
+  /* at the clients' locations */
+  unsigned n = 0;
+  for (const auto &i : clients) {
+    if (!CheckQuery(clients, i.location))
+      return false;
+
+    if (++n >= 200)
+      break;
+  }
+
+  /* at random locations */
+  for (unsigned i = 0; i < 200; ++i)
+    if (!CheckQuery(clients, RandomLocation()))
+      return false;
+
+  return true;
+}
+
+/**
+ * Check that the #NearTrafficCache query of the grid cell containing
+ * the given location finds all clients found by a query around the
+ * location itself.
+ */
+static bool
+CheckCellQuery(const CloudClientContainer &clients, GeoPoint location)
+{
+  const auto [center, range] =
+    NearTrafficCache::GetCellQuery(CloudClientContainer::GetGridCell(location),
+                                   RANGE);
+
+  std::set<uint64_t> cell;
+  for (const auto &i : clients.QueryWithinRange(center, range))
+    cell.insert(i.key);
+
+  for (const auto &i : clients.QueryWithinRange(location, RANGE))
+    if (!cell.contains(i.key))
+      return false;
+
+  return true;
+}
+
+static bool
+CheckCellQueries(const CloudClientContainer &clients)
+{
+  unsigned n = 0;
+  for (const auto &i : clients) {
+    if (!CheckCellQuery(clients, i.location))
+      return false;
+
+    if (++n >= 200)
+      break;
+  }
+
+  for (unsigned i = 0; i < 200; ++i)
+    if (!CheckCellQuery(clients, RandomLocation()))
+      return false;
+
+  return true;
+}
+
+static void
+TestNearTrafficCache()
+{
+  using namespace std::chrono_literals;
+
+  const std::chrono::steady_clock::time_point now{};
+
+  NearTrafficCache cache;
+  ok1(cache.Get(1, now) == nullptr);
+
+  auto &cell = cache.Make(1, now + 100ms);
+  cell.items.emplace_back();
+  ok1(cache.Get(1, now) == &cell);
+  ok1(cache.Get(1, now + 99ms) == &cell);
+  ok1(cache.Get(2, now) == nullptr);
+
+  /* the TTL is exclusive */
+  ok1(cache.Get(1, now + 100ms) == nullptr);
+
+  /* Make() reuses the cell with a new expiry, but clears it */
+  ok1(&cache.Make(1, now + 200ms) == &cell);
+  ok1(cell.items.empty() && cache.Get(1, now + 150ms) == &cell);
+
+  cache.Make(2, now + 300ms);
+  cache.Expire(now + 200ms);
+  ok1(cache.Get(1, now) == nullptr);
+  ok1(cache.Get(2, now + 250ms) != nullptr);
+
+  cache.Expire(now + 300ms);
+  ok1(cache.Get(2, now) == nullptr);
+}
+
+static std::map<uint64_t, unsigned>
+GetIds(const CloudClientContainer &clients)
+{
+  std::map<uint64_t, unsigned> ids;
+  for (const auto &i : clients)
+    ids.emplace(i.key, i.id);
+  return ids;
+}
+
+/**
+ * Distribute clients over several containers like the sharded
+ * server does, let each container assign new ids, and save all of
+ * them into one file.
+ */
+static void
+TestShards()
+{
+  static constexpr unsigned N_SHARDS = 3;
+
+  const IPv4Address address(127, 0, 0, 1, 5597);
+
+  CloudClientContainer db;
+  for (unsigned i = 0; i < 100; ++i)
+    db.Make(address, 0x2000 + i, RandomLocation(), 1000, 0, false);
+
+  const auto old_ids = GetIds(db);
+  const unsigned db_next_id = db.GetNextId();
+
+  /* MoveIf() preserves the ids */
+  CloudClientContainer shards[N_SHARDS];
+  for (unsigned i = 0; i < N_SHARDS; ++i) {
+    db.MoveIf(shards[i], [i](const CloudClient &c){
+      return SkyLinesTracking::GetShardOfKey(c.key, N_SHARDS) == i;
+    });
+    shards[i].SetIdSequence(db_next_id + i, N_SHARDS);
+  }
+
+  ok1(db.empty());
+
+  std::map<uint64_t, unsigned> moved_ids;
+  for (const auto &shard : shards)
+    moved_ids.merge(GetIds(shard));
+
+  ok1(moved_ids == old_ids);
+
+  /* the strided id sequences do not collide */
+  for (unsigned i = 0; i < 300; ++i) {
+    auto &shard = shards[rng() % N_SHARDS];
+    shard.Make(address, 0x3000 + i, RandomLocation(), 1000, 0, false);
+  }
+
+  std::set<unsigned> ids;
+  unsigned max_id = 0;
+  bool unique = true;
+  for (const auto &shard : shards) {
+    for (const auto &i : shard) {
+      unique = unique && ids.insert(i.id).second;
+      max_id = std::max(max_id, i.id);
+    }
+  }
+
+  ok1(unique);
+  ok1(ids.size() == 400);
+
+  /* save all containers into one file with a stale "next_id" */
+  StringOutputStream os;
+  {
+    Serialiser s(os);
+    CloudClientContainer::SaveBegin(s, db_next_id);
+    for (const auto &shard : shards)
+      shard.SaveClients(s);
+    CloudClientContainer::SaveEnd(s);
+    s.Flush();
+  }
+
+  MemoryReader reader(AsBytes(os.GetValue()));
+  Deserialiser s(reader);
+  CloudClientContainer loaded;
+  loaded.Load(s);
+
+  std::map<uint64_t, unsigned> saved_ids;
+  for (const auto &shard : shards)
+    saved_ids.merge(GetIds(shard));
+
+  ok1(GetIds(loaded) == saved_ids);
+
+  /* Load() repairs "next_id" */
+  ok1(loaded.GetNextId() > max_id);
+  const auto &client = loaded.Make(address, 0x4000, RandomLocation(),
+                                   1000, 0, false);
+  ok1(!ids.contains(client.id));
+}
+
+/**
+ * Emulate the program installed by SkyLinesTracking::SteerByKey():
+ * load the big-endian 32 bit word at KEY_LOW_OFFSET and take it
+ * modulo the number of shards.
+ */
+static unsigned
+SteerDatagram(std::span<const std::byte> datagram, unsigned n)
+{
+  const auto *p = datagram.data() + SkyLinesTracking::KEY_LOW_OFFSET;
+  const uint32_t word = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+    (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+  return word % n;
+}
+
+static void
+TestShardOfKey()
+{
+  std::uniform_int_distribution<uint64_t> random_key;
+
+  bool same = true;
+  for (unsigned i = 0; i < 1000; ++i) {
+    const uint64_t key = random_key(rng);
+
+    SkyLinesTracking::Header header{};
+    header.key = ToBE64(key);
+
+    for (unsigned n = 1; n <= 8; ++n)
+      same = same && SkyLinesTracking::GetShardOfKey(key, n) ==
+        SteerDatagram(ReferenceAsBytes(header), n);
+  }
+
+  ok1(same);
+}
+
+int
+main()
+{
+  plan_tests(18 + 10 + 1);
+
+  const IPv4Address address(127, 0, 0, 1, 5597);
+
+  CloudClientContainer clients;
+  ok1(clients.QueryWithinRange(GeoPoint(Angle::Degrees(7),
+                                        Angle::Degrees(51)),
+                               RANGE).empty());
+
+  std::vector<uint64_t> keys;
+  for (unsigned i = 0; i < 2000; ++i) {
+    const uint64_t key = 0x1000 + i;
+    clients.Make(address, key, RandomLocation(), 1000, 0, false);
+    keys.push_back(key);
+  }
+
+  ok1(CheckQueries(clients));
+
+  /* small moves, which usually stay inside the grid cell */
+  for (unsigned round = 0; round < 10; ++round)
+    for (const auto key : keys) {
+      auto &client = *clients.Find(key);
+      clients.Refresh(client, address, Move(client.location), 1000, 0, false);
+    }
+
+  ok1(CheckQueries(clients));
+
+  /* jumps; Make() refreshes existing clients */
+  const auto *first = clients.Find(keys.front());
+  for (const auto key : keys)
+    clients.Make(address, key, RandomLocation(), 1000, 0, false);
+
+  ok1(first == clients.Find(keys.front()));
+  ok1(CheckQueries(clients));
+
+  /* remove every other client */
+  for (unsigned i = 0; i < keys.size(); i += 2)
+    clients.Remove(*clients.Find(keys[i]));
+
+  ok1(CheckQueries(clients));
+
+  /* a client exactly on the antimeridian */
+  const GeoPoint antimeridian(Angle::Degrees(180), Angle::Degrees(-30));
+  clients.Make(address, 1, antimeridian, 1000, 0, false);
+  ok1(CheckQuery(clients, antimeridian));
+  ok1(CheckQuery(clients, GeoPoint(Angle::Degrees(-179.9),
+                                   Angle::Degrees(-30))));
+
+  /* each location is inside the bounds of its grid cell */
+  bool inside = true;
+  for (unsigned i = 0; i < 1000; ++i) {
+    const auto location = RandomLocation();
+    const auto bounds =
+      CloudClientContainer::GetGridCellBounds(CloudClientContainer::GetGridCell(location));
+    inside = inside && bounds.IsInside(location.longitude.AsDelta(),
+                                       location.latitude);
+  }
+
+  ok1(inside);
+
+  /* the #NearTrafficCache query of a grid cell covers the queries
+     of all locations inside it */
+  ok1(CheckCellQueries(clients));
+
+  clients.clear();
+  ok1(clients.empty());
+
+  TestShards();
+  TestNearTrafficCache();
+  TestShardOfKey();
+
+  return exit_status();
+}
@@ -2,19 +2,165 @@
 // Copyright The XCSoar Project
 
 #include "FLARM/FlarmNetDatabase.hpp"
+#include "FLARM/FlarmNetCache.hpp"
 #include "FLARM/FlarmNetReader.hpp"
 #include "FLARM/FlarmNetRecord.hpp"
 #include "FLARM/Id.hpp"
+#include "system/FileUtil.hpp"
 #include "system/Path.hpp"
 #include "TestUtil.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+static const Path fln_path{"test/data/flarmnet/data.fln"};
+static const Path cache_path{"output/TestFlarmNet.bin"};
+
+static bool
+RecordsEqual(const FlarmNetRecord &a, const FlarmNetRecord &b) noexcept
+{
+  return a.id == b.id &&
+    StringIsEqual(a.pilot, b.pilot) &&
+    StringIsEqual(a.airfield, b.airfield) &&
+    StringIsEqual(a.plane_type, b.plane_type) &&
+    StringIsEqual(a.registration, b.registration) &&
+    StringIsEqual(a.callsign, b.callsign) &&
+    a.frequency == b.frequency;
+}
+
+/**
+ * Do both databases return the same results for all ids and
+ * callsigns in #a?
+ */
+static bool
+LookupsEqual(const FlarmNetDatabase &a, const FlarmNetDatabase &b) noexcept
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (const FlarmNetRecord &record : a) {
+    const FlarmNetRecord *other = b.FindRecordById(record.id);
+    if (other == nullptr || !RecordsEqual(record, *other))
+      return false;
+
+    const FlarmNetRecord *array_a[16], *array_b[16];
+    const unsigned n_a = a.FindRecordsByCallSign(record.callsign, array_a, 16);
+    const unsigned n_b = b.FindRecordsByCallSign(record.callsign, array_b, 16);
+    if (n_a != n_b)
+      return false;
+
+    for (unsigned i = 0; i < n_a; ++i)
+      if (!RecordsEqual(*array_a[i], *array_b[i]))
+        return false;
+
+    FlarmId ids_a[16], ids_b[16];
+    if (a.FindIdsByCallSign(record.callsign, ids_a, 16) != n_a ||
+        b.FindIdsByCallSign(record.callsign, ids_b, 16) != n_a ||
+        !std::equal(ids_a, ids_a + n_a, ids_b))
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Compare the sorted database with a linear search over the inserted
+ * records, including duplicate ids and shared callsigns.
+ */
+static void
+TestCommit()
+{
+  std::vector<FlarmNetRecord> inserted;
+  FlarmNetDatabase db;
+
+  for (unsigned i = 0; i < 1000; ++i) {
+    FlarmNetRecord record;
+    /* the ids wrap around after 993 records, so a few are used
+       twice */
+    record.id = FlarmId::FromValue(1 + (i * 7919) % 993);
+    record.callsign.Format("C%u", i % 37);
+    record.registration.Format("D-%04u", i);
+    inserted.push_back(record);
+    db.Insert(record);
+  }
+
+  db.Commit();
+
+  bool ids_ok = true, callsigns_ok = true;
+  unsigned n_distinct = 0;
+
+  for (unsigned i = 0; i < inserted.size(); ++i) {
+    const FlarmNetRecord &record = inserted[i];
+    const auto first = std::find_if(inserted.begin(), inserted.end(),
+                                    [&](const FlarmNetRecord &r){
+                                      return r.id == record.id;
+                                    });
+    if (first != inserted.begin() + i)
+      continue;
+
+    ++n_distinct;
+
+    /* the first of several records with the same id wins */
+    const FlarmNetRecord *found = db.FindRecordById(record.id);
+    if (found == nullptr || !RecordsEqual(*found, record))
+      ids_ok = false;
+  }
+
+  ok1(ids_ok);
+  ok1(db.size() == n_distinct);
+  ok1(db.FindRecordById(FlarmId::FromValue(5000)) == nullptr);
+
+  for (unsigned c = 0; c < 37; ++c) {
+    char callsign[8];
+    snprintf(callsign, sizeof(callsign), "C%u", c);
+
+    std::vector<FlarmId> expected;
+    for (const FlarmNetRecord &record : db)
+      if (StringIsEqual(record.callsign, callsign))
+        expected.push_back(record.id);
+
+    FlarmId ids[64];
+    const unsigned n = db.FindIdsByCallSign(callsign, ids, 64);
+    if (n != expected.size() ||
+        !std::equal(ids, ids + n, expected.begin()) ||
+        db.FindFirstRecordByCallSign(callsign)->id != expected.front() ||
+        /* the array size must be respected */
+        db.FindIdsByCallSign(callsign, ids, 2) != 2)
+      callsigns_ok = false;
+  }
+
+  ok1(callsigns_ok);
+  ok1(db.FindFirstRecordByCallSign("XX") == nullptr);
+}
+
+static void
+TestCache(const FlarmNetDatabase &text_db)
+{
+  File::Delete(cache_path);
+
+  FlarmNetDatabase db;
+  ok1(!FlarmNetCache::Load(cache_path, fln_path, db));
+
+  FlarmNetCache::Save(cache_path, fln_path, text_db);
+  ok1(FlarmNetCache::Load(cache_path, fln_path, db));
+  ok1(LookupsEqual(text_db, db));
+  ok1(LookupsEqual(db, text_db));
+
+  /* a cache created for another file must be ignored */
+  FlarmNetDatabase db2;
+  ok1(!FlarmNetCache::Load(cache_path, Path("test/data/flarmnet"), db2));
+  ok1(db2.IsEmpty());
+
+  File::Delete(cache_path);
+}
+
 int main()
 {
-  plan_tests(16);
+  plan_tests(16 + 5 + 6);
 
   FlarmNetDatabase db;
-  int count = FlarmNetReader::LoadFile(Path("test/data/flarmnet/data.fln"),
-                                       db);
+  int count = FlarmNetReader::LoadFile(fln_path, db);
   ok1(count == 6);
 
   FlarmId id = FlarmId::Parse("DDA85C", NULL);
@@ -60,5 +206,8 @@ int main()
   ok1(foundDDA85C);
   ok1(foundDDA896);
 
+  TestCommit();
+  TestCache(db);
+
   return exit_status();
 }
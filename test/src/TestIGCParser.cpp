@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "IGC/IGCParser.hpp"
+#include "IGC/IGCReader.hpp"
 #include "IGC/IGCExtensions.hpp"
 #include "IGC/IGCFix.hpp"
 #include "IGC/IGCHeader.hpp"
@@ -12,6 +13,8 @@
 
 #include <string.h>
 
+using std::string_view_literals::operator""sv;
+
 static void
 TestHeader()
 {
@@ -58,6 +61,15 @@ TestExtensions()
   ok1(extensions[3].start == 47);
   ok1(extensions[3].finish == 49);
   ok1(strcmp(extensions[3].code, "TRT") == 0);
+
+  ok1(extensions[0].type == IGCExtension::Type::UNKNOWN);
+  ok1(extensions[1].type == IGCExtension::Type::ENL);
+  ok1(extensions[2].type == IGCExtension::Type::GSP);
+  ok1(extensions[3].type == IGCExtension::Type::TRT);
+
+  /* truncated record: the complete extensions are kept */
+  ok1(!IGCParseExtensions("I043638FXA3941ENL4246GSP47", extensions));
+  ok1(extensions.size() == 3);
 }
 
 static void
@@ -171,6 +183,79 @@ TestFix()
   ok1(fix.gps_altitude == 7);
 }
 
+static void
+TestFixExtensions()
+{
+  IGCExtensions extensions;
+  ok1(IGCParseExtensions("I043638FXA3941ENL4246GSP4749TRT", extensions));
+
+  IGCFix fix;
+  ok1(IGCParseFix("B1122385103117N00742367EA-00120048700001201234180",
+                  extensions, fix));
+  ok1(fix.pressure_altitude == -12);
+  ok1(fix.gps_altitude == 487);
+  ok1(fix.enl == 12);
+  ok1(fix.gsp == 12);
+  ok1(fix.trt == 180);
+  ok1(fix.ias < 0);
+
+  /* a column beyond the end of the line is ignored */
+  ok1(IGCParseFix("B1122385103117N00742367EA004900048700001201234",
+                  extensions, fix));
+  ok1(fix.enl == 12);
+  ok1(fix.gsp == 12);
+  ok1(fix.trt < 0);
+
+  /* the std::string_view overload does not need null-termination */
+  static constexpr char buffer[] =
+    "B1122385103117N00742367EA004900048700001201234180"
+    "B1122395103117N00742367EA004910048800009901234";
+  ok1(IGCParseFix(std::string_view{buffer, 47}, extensions, fix));
+  ok1(fix.time == BrokenTime(11, 22, 38));
+  ok1(fix.enl == 12);
+  ok1(fix.trt < 0);
+
+  ok1(!IGCParseFix(std::string_view{buffer, 34}, extensions, fix));
+  ok1(!IGCParseFix("B1122385103117N00742367EA00490004 7", extensions, fix));
+}
+
+static void
+TestReader()
+{
+  IGCReader reader("AXCSfoo\r\n"
+                   "I013638FXA\r\n"
+                   "\r\n"
+                   "B1122385103117N00742367EA0049000487000\n"
+                   "B1122395103117N00742367EA0049100488"sv);
+
+  auto line = reader.ReadLine();
+  ok1(line && *line == "AXCSfoo"sv);
+
+  IGCExtensions extensions;
+  line = reader.ReadLine();
+  ok1(line && IGCParseExtensions(*line, extensions));
+  ok1(extensions.size() == 1);
+
+  line = reader.ReadLine();
+  ok1(line && line->empty());
+
+  IGCFix fix;
+  line = reader.ReadLine();
+  ok1(line && IGCParseFix(*line, extensions, fix));
+  ok1(fix.time == BrokenTime(11, 22, 38));
+
+  line = reader.ReadLine();
+  ok1(line && IGCParseFix(*line, extensions, fix));
+  ok1(fix.time == BrokenTime(11, 22, 39));
+  ok1(fix.gps_altitude == 488);
+
+  ok1(!reader.ReadLine());
+
+  reader.Rewind();
+  line = reader.ReadLine();
+  ok1(line && *line == "AXCSfoo"sv);
+}
+
 static void
 TestFixTime()
 {
@@ -192,6 +277,27 @@ TestFixTime()
 
   ok1(IGCParseTime("0123375103117N00742367EV0049000487", time));
   ok1(time == BrokenTime(01, 23, 37));
+
+  bool gps_valid;
+  ok1(!IGCParseFixTime("", time, gps_valid));
+  ok1(!IGCParseFixTime("B1122385103117N00742367", time, gps_valid));
+  ok1(!IGCParseFixTime("B1122385103117N00742367EX0049000487", time, gps_valid));
+  ok1(!IGCParseFixTime("B2522385103117N00742367EA0049000487", time, gps_valid));
+  ok1(!IGCParseFixTime("L1122385103117N00742367EA0049000487", time, gps_valid));
+
+  ok1(IGCParseFixTime("B1122385103117N00742367EA0049000487", time, gps_valid));
+  ok1(time == BrokenTime(11, 22, 38));
+  ok1(gps_valid);
+
+  /* short record */
+  ok1(IGCParseFixTime("B1122395103117N00742367EV", time, gps_valid));
+  ok1(time == BrokenTime(11, 22, 39));
+  ok1(!gps_valid);
+
+  /* bad location */
+  ok1(IGCParseFixTime("B112240XXXXXXXXXXXXXXXXXA0049000487", time, gps_valid));
+  ok1(time == BrokenTime(11, 22, 40));
+  ok1(gps_valid);
 }
 
 static void
@@ -251,13 +357,15 @@ TestDeclarationTurnpoint()
 
 int main()
 {
-  plan_tests(148);
+  plan_tests(197);
 
   TestHeader();
   TestDate();
   TestLocation();
   TestExtensions();
   TestFix();
+  TestFixExtensions();
+  TestReader();
   TestFixTime();
   TestDeclarationHeader();
   TestDeclarationTurnpoint();
@@ -0,0 +1,308 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "IGC/IgcMetaIndex.hpp"
+#include "IGC/IgcMetaCache.hpp"
+#include "ui/event/Notify.hpp"
+#include "io/FileMapping.hpp"
+#include "io/FileOutputStream.hxx"
+#include "system/FileUtil.hpp"
+#include "system/Path.hpp"
+#include "util/SpanCast.hxx"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static const Path index_path{"output/TestIgcMetaIndex.bin"};
+static const Path igc_path{"output/TestIgcMetaIndex-1.igc"};
+static const Path igc2_path{"output/TestIgcMetaIndex-2.igc"};
+static const Path deleted_path{"output/TestIgcMetaIndex-3.igc"};
+
+/* IgcMetaCache::StartBackgroundFill() is not used here */
+void
+UI::Notify::SendNotification() noexcept
+{
+}
+
+static bool
+MetaEqual(const IgcFileMeta &a, const IgcFileMeta &b) noexcept
+{
+  return a.has_start == b.has_start && a.has_end == b.has_end &&
+    (!a.has_start || a.start == b.start) &&
+    (!a.has_end || a.end == b.end);
+}
+
+static bool
+RecordsEqual(std::span<const IgcMetaIndex::Record> a,
+             std::span<const IgcMetaIndex::Record> b) noexcept
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (std::size_t i = 0; i < a.size(); ++i)
+    if (a[i].path != b[i].path || a[i].file_size != b[i].file_size ||
+        a[i].file_mtime != b[i].file_mtime ||
+        !MetaEqual(a[i].meta, b[i].meta))
+      return false;
+
+  return true;
+}
+
+static std::vector<IgcMetaIndex::Record>
+MakeRecords()
+{
+  std::vector<IgcMetaIndex::Record> records;
+
+  for (unsigned i = 0; i < 1000; ++i) {
+    auto &r = records.emplace_back();
+    r.path = "/flights/2020-05-" + std::to_string(i) + "-XCS-AAA-01.igc";
+    r.file_size = 100000 + i;
+    r.file_mtime = 1589700000000000000 + i;
+    r.meta.has_start = i % 3 != 2;
+    r.meta.has_end = r.meta.has_start;
+    r.meta.start = BrokenTime(i % 24, i % 60, 0);
+    r.meta.end = BrokenTime((i + 5) % 24, 0, i % 60);
+  }
+
+  return records;
+}
+
+static void
+WriteFile(Path path, std::string_view data)
+{
+  FileOutputStream file(path);
+  file.Write(AsBytes(data));
+  file.Commit();
+}
+
+static std::string
+ReadFile(Path path)
+{
+  const FileMapping mapping(path);
+  return std::string{ToStringView(std::span<const std::byte>{mapping})};
+}
+
+static void
+TestSaveLoad()
+{
+  const auto records = MakeRecords();
+  IgcMetaIndex::Save(index_path, records);
+
+  const auto loaded = IgcMetaIndex::Load(index_path);
+  ok1(RecordsEqual(loaded, records));
+
+  /* an empty index */
+  IgcMetaIndex::Save(index_path, {});
+  ok1(IgcMetaIndex::Load(index_path).empty());
+
+  File::Delete(index_path);
+}
+
+static void
+TestMalformed()
+{
+  IgcMetaIndex::Save(index_path, MakeRecords());
+  const std::string data = ReadFile(index_path);
+  ok1(data.size() > 1000);
+
+  /* truncated */
+  WriteFile(index_path, std::string_view{data}.substr(0, data.size() - 1));
+  ok1(IgcMetaIndex::Load(index_path).empty());
+
+  /* trailing garbage */
+  WriteFile(index_path, data + "x");
+  ok1(IgcMetaIndex::Load(index_path).empty());
+
+  /* wrong version */
+  std::string copy = data;
+  copy[4] ^= 0x7f;
+  WriteFile(index_path, copy);
+  ok1(IgcMetaIndex::Load(index_path).empty());
+
+  /* implausible time in the first record (header 16 bytes, then
+     sizes, path length and flags) */
+  copy = data;
+  copy[16 + 19] = 99;
+  WriteFile(index_path, copy);
+  ok1(IgcMetaIndex::Load(index_path).empty());
+
+  File::Delete(index_path);
+}
+
+static void
+TestFileKey()
+{
+  uint64_t size1, size2;
+  int64_t mtime1, mtime2;
+
+  IgcMetaIndex::GetFileKey(Path("test/data/01lz1hq1.igc"), size1, mtime1);
+  ok1(size1 > 0);
+  ok1(mtime1 != 0);
+
+  WriteFile(index_path, "B1122385103117N00742367EA0049000487\n");
+  IgcMetaIndex::GetFileKey(index_path, size2, mtime2);
+  ok1(size2 == 36);
+
+  WriteFile(index_path, "B1122385103117N00742367EA0049000487\n"
+            "B1122395103117N00742367EA0049000487\n");
+  IgcMetaIndex::GetFileKey(index_path, size1, mtime1);
+  ok1(size1 == 72);
+
+  File::Delete(index_path);
+  IgcMetaIndex::GetFileKey(index_path, size1, mtime1);
+  ok1(size1 == 0);
+}
+
+/**
+ * Write an index file with a fake entry for the given file, which
+ * claims a flight from 01:00 to 02:00.
+ */
+static void
+SaveFakeIndex(Path path, uint64_t size, int64_t mtime)
+{
+  IgcMetaIndex::Record r;
+  r.path = path.c_str();
+  r.file_size = size;
+  r.file_mtime = mtime;
+  r.meta.has_start = r.meta.has_end = true;
+  r.meta.start = BrokenTime(1, 0, 0);
+  r.meta.end = BrokenTime(2, 0, 0);
+  IgcMetaIndex::Save(index_path, {&r, 1});
+}
+
+static void
+TestCacheParse()
+{
+  /* short records and records with a bad location count, invalid
+     fixes don't */
+  WriteFile(igc_path,
+            "AXCSfoo\n"
+            "B1000005103117N00742367EV0049000487\n"
+            "B1122385103117N00742367EA0049000487\n"
+            "B1200005103117N00742367EA\n"
+            "B123000XXXXXXXXXXXXXXXXXA0049000487\n"
+            "B1300005103117N00742367EV0049000487\n");
+
+  IgcMetaCache cache;
+  ok1(cache.GetCompactInfo(igc_path).starts_with("11:22 - 12:30"));
+
+  /* a file without valid fixes */
+  WriteFile(igc2_path, "AXCSfoo\n");
+  ok1(cache.GetCompactInfo(igc2_path).empty());
+}
+
+static void
+TestCacheIndex()
+{
+  WriteFile(igc_path, "B1122385103117N00742367EA0049000487\n"
+            "B1230005103117N00742367EA0049000487\n");
+
+  uint64_t size;
+  int64_t mtime;
+  IgcMetaIndex::GetFileKey(igc_path, size, mtime);
+
+  /* an unmodified file: the index entry is used without parsing */
+  SaveFakeIndex(igc_path, size, mtime);
+  {
+    IgcMetaCache cache;
+    cache.LoadIndex(AllocatedPath(index_path));
+    ok1(cache.GetCompactInfo(igc_path).starts_with("01:00 - 02:00"));
+  }
+
+  /* a different size or modification time: parsed again */
+  SaveFakeIndex(igc_path, size + 1, mtime);
+  {
+    IgcMetaCache cache;
+    cache.LoadIndex(AllocatedPath(index_path));
+    ok1(cache.GetCompactInfo(igc_path).starts_with("11:22 - 12:30"));
+  }
+
+  SaveFakeIndex(igc_path, size, mtime - 1);
+  {
+    IgcMetaCache cache;
+    cache.LoadIndex(AllocatedPath(index_path));
+    ok1(cache.GetCompactInfo(igc_path).starts_with("11:22 - 12:30"));
+  }
+
+  /* loaded entries remain unverified until they are looked up: a
+     modification after LoadIndex() is detected */
+  SaveFakeIndex(igc_path, size, mtime);
+  {
+    IgcMetaCache cache;
+    cache.LoadIndex(AllocatedPath(index_path));
+
+    WriteFile(igc_path, "B1122385103117N00742367EA0049000487\n"
+              "B1230005103117N00742367EA0049000487\n"
+              "B1300005103117N00742367EA0049000487\n");
+    ok1(cache.GetCompactInfo(igc_path).starts_with("11:22 - 13:00"));
+
+    /* once verified, the entry is not checked again */
+    WriteFile(igc_path, "B1122385103117N00742367EA0049000487\n");
+    ok1(cache.GetCompactInfo(igc_path).starts_with("11:22 - 13:00"));
+  }
+
+  /* the parsed entry was saved by the destructor */
+  const auto records = IgcMetaIndex::Load(index_path);
+  ok1(records.size() == 1 && records.front().meta.end == BrokenTime(13, 0, 0));
+}
+
+static void
+TestCacheDeleted()
+{
+  WriteFile(igc_path, "B1122385103117N00742367EA0049000487\n");
+  WriteFile(igc2_path, "B1230005103117N00742367EA0049000487\n");
+  File::Delete(deleted_path);
+
+  uint64_t size;
+  int64_t mtime;
+  IgcMetaIndex::GetFileKey(igc_path, size, mtime);
+
+  std::vector<IgcMetaIndex::Record> records(2);
+  records[0].path = igc_path.c_str();
+  records[0].file_size = size;
+  records[0].file_mtime = mtime;
+  records[1].path = deleted_path.c_str();
+  records[1].file_size = 1234;
+  records[1].file_mtime = mtime;
+  IgcMetaIndex::Save(index_path, records);
+
+  {
+    IgcMetaCache cache;
+    cache.LoadIndex(AllocatedPath(index_path));
+
+    /* parse a new file, so the index gets written */
+    ok1(cache.GetCompactInfo(igc2_path).starts_with("12:30 - 12:30"));
+    cache.SaveIndex();
+  }
+
+  /* the entry of the deleted file is gone, the one which has not
+     been looked up is kept */
+  const auto loaded = IgcMetaIndex::Load(index_path);
+  ok1(loaded.size() == 2);
+  ok1(std::none_of(loaded.begin(), loaded.end(), [](const auto &r){
+    return r.path == deleted_path.c_str();
+  }));
+  ok1(std::any_of(loaded.begin(), loaded.end(), [](const auto &r){
+    return r.path == igc_path.c_str();
+  }));
+
+  File::Delete(index_path);
+  File::Delete(igc_path);
+  File::Delete(igc2_path);
+}
+
+int main()
+{
+  plan_tests(2 + 5 + 5 + 2 + 6 + 4);
+
+  TestSaveLoad();
+  TestMalformed();
+  TestFileKey();
+  TestCacheParse();
+  TestCacheIndex();
+  TestCacheDeleted();
+
+  return exit_status();
+}
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "NMEA/SentenceTable.hpp"
+#include "TestUtil.hpp"
+
+using std::string_view_literals::operator""sv;
+
+enum class Sentence {
+  UNKNOWN,
+  GPRMC,
+  GPGGA,
+  PFLAU,
+  PFLAA,
+  LK8EX1,
+  PLXVF,
+};
+
+static constexpr auto table = MakeNMEASentenceTable<Sentence>({
+  {"$GPRMC"sv, Sentence::GPRMC},
+  {"$GPGGA"sv, Sentence::GPGGA},
+  {"$PFLAU"sv, Sentence::PFLAU},
+  {"$PFLAA"sv, Sentence::PFLAA},
+  {"$LK8EX1"sv, Sentence::LK8EX1},
+  {"$PLXVF"sv, Sentence::PLXVF},
+});
+
+/* lookups work at compile time, too */
+static_assert(table.Get("$PFLAU"sv, Sentence::UNKNOWN) == Sentence::PFLAU);
+static_assert(table.Find("$PFLAX"sv) == nullptr);
+
+int main()
+{
+  plan_tests(16);
+
+  ok1(PackNMEASentenceType(""sv) == 0);
+  ok1(PackNMEASentenceType("$PFLAU,3"sv) != 0);
+  ok1(PackNMEASentenceType("$PFLAU,3,"sv) == 0);
+  ok1(PackNMEASentenceType("$PFLAU"sv) != PackNMEASentenceType("$PFLAA"sv));
+
+  ok1(table.Get("$GPRMC"sv, Sentence::UNKNOWN) == Sentence::GPRMC);
+  ok1(table.Get("$GPGGA"sv, Sentence::UNKNOWN) == Sentence::GPGGA);
+  ok1(table.Get("$PFLAU"sv, Sentence::UNKNOWN) == Sentence::PFLAU);
+  ok1(table.Get("$PFLAA"sv, Sentence::UNKNOWN) == Sentence::PFLAA);
+  ok1(table.Get("$LK8EX1"sv, Sentence::UNKNOWN) == Sentence::LK8EX1);
+  ok1(table.Get("$PLXVF"sv, Sentence::UNKNOWN) == Sentence::PLXVF);
+
+  /* unknown sentences, prefixes and extensions of known ones */
+  ok1(table.Find(""sv) == nullptr);
+  ok1(table.Find("$"sv) == nullptr);
+  ok1(table.Find("$GPRM"sv) == nullptr);
+  ok1(table.Find("$GPRMCX"sv) == nullptr);
+  ok1(table.Find("$GPGSA"sv) == nullptr);
+  ok1(table.Find("$LK8EX1LK8EX1"sv) == nullptr);
+
+  return exit_status();
+}
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Geo/PolygonEdges.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "Geo/Flat/FlatRay.hpp"
+#include "TestUtil.hpp"
+
+#include <chrono>
+#include <vector>
+
+#include <stdio.h>
+
+static unsigned seed = 1;
+
+static double
+Random(double min, double max)
+{
+  seed = seed * 1103515245 + 12345;
+  return min + (max - min) * ((seed >> 8) & 0xffff) / 0xffff;
+}
+
+static GeoPoint
+RandomPoint(const GeoPoint &center, double radius)
+{
+  return {center.longitude + Angle::Degrees(Random(-radius, radius)),
+          center.latitude + Angle::Degrees(Random(-radius, radius))};
+}
+
+/**
+ * Generate a closed, star-shaped (i.e. usually not convex) polygon.
+ */
+static SearchPointVector
+MakePolygon(const GeoPoint &center, unsigned n)
+{
+  SearchPointVector v;
+  for (unsigned i = 0; i < n; ++i) {
+    const Angle a = Angle::FullCircle() * i / n;
+    const double r = Random(0.02, 0.1);
+    v.emplace_back(GeoPoint(center.longitude + Angle::Degrees(r * a.cos()),
+                            center.latitude + Angle::Degrees(r * a.sin())));
+  }
+
+  v.push_back(v.front());
+  return v;
+}
+
+static std::vector<double>
+LinearIntersections(const SearchPointVector &border, const FlatRay &ray)
+{
+  std::vector<double> result;
+  for (auto i = border.begin(); std::next(i) != border.end(); ++i) {
+    const FlatRay edge(i->GetFlatLocation(), std::next(i)->GetFlatLocation());
+    const double t = ray.DistinctIntersection(edge);
+    if (t >= 0)
+      result.push_back(t);
+  }
+
+  return result;
+}
+
+static std::vector<double>
+EdgeIntersections(const PolygonEdges &edges, const FlatRay &ray)
+{
+  std::vector<double> result;
+  edges.VisitIntersections(ray, [&result](double t){
+    result.push_back(t);
+  });
+  return result;
+}
+
+/**
+ * Compare the results with the ones of #SearchPointVector and print
+ * the time spent by both.
+ */
+static void
+TestRandom(unsigned n_vertices)
+{
+  using namespace std::chrono;
+
+  const GeoPoint center(Angle::Degrees(7), Angle::Degrees(51));
+  const FlatProjection projection(center);
+
+  SearchPointVector border = MakePolygon(center, n_vertices);
+  border.Project(projection);
+
+  PolygonEdges edges;
+  edges.Update(border);
+
+  std::vector<GeoPoint> points;
+  std::vector<FlatRay> rays;
+  for (unsigned i = 0; i < 2000; ++i) {
+    points.push_back(RandomPoint(center, 0.12));
+    rays.emplace_back(projection.ProjectInteger(RandomPoint(center, 0.12)),
+                      projection.ProjectInteger(RandomPoint(center, 0.12)));
+  }
+
+  auto start_time = steady_clock::now();
+  std::vector<bool> expected_inside;
+  for (const auto &p : points)
+    expected_inside.push_back(border.IsInside(p));
+  std::vector<std::vector<double>> expected_intersections;
+  for (const auto &ray : rays)
+    expected_intersections.push_back(LinearIntersections(border, ray));
+  const duration<double, std::milli> linear_time =
+    steady_clock::now() - start_time;
+
+  start_time = steady_clock::now();
+  std::vector<bool> actual_inside;
+  for (const auto &p : points)
+    actual_inside.push_back(edges.IsInside(p));
+  std::vector<std::vector<double>> actual_intersections;
+  for (const auto &ray : rays)
+    actual_intersections.push_back(EdgeIntersections(edges, ray));
+  const duration<double, std::milli> edges_time =
+    steady_clock::now() - start_time;
+
+  printf("# %u vertices: SearchPointVector %.1f ms, PolygonEdges %.1f ms\n",
+         n_vertices, linear_time.count(), edges_time.count());
+
+  ok1(actual_inside == expected_inside);
+  ok1(actual_intersections == expected_intersections);
+}
+
+static void
+TestDegenerate()
+{
+  PolygonEdges edges;
+  ok1(edges.empty());
+  ok1(!edges.IsInside(GeoPoint(Angle::Degrees(7), Angle::Degrees(51))));
+
+  const FlatRay ray({0, 0}, {100, 100});
+  ok1(EdgeIntersections(edges, ray).empty());
+
+  SearchPointVector line;
+  line.emplace_back(GeoPoint(Angle::Degrees(7), Angle::Degrees(51)));
+  line.emplace_back(GeoPoint(Angle::Degrees(8), Angle::Degrees(52)));
+  line.Project(FlatProjection(line.front().GetLocation()));
+  edges.Update(line);
+  ok1(!edges.IsInside(GeoPoint(Angle::Degrees(7.5), Angle::Degrees(51.5))));
+}
+
+int main()
+{
+  plan_tests(4 + 2 * 4);
+
+  TestDegenerate();
+  TestRandom(5);
+  TestRandom(32);
+  TestRandom(100);
+  TestRandom(1000);
+
+  return exit_status();
+}
@@ -0,0 +1,418 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Engine/Route/ReachFan.hpp"
+#include "Engine/Route/ReachResult.hpp"
+#include "Engine/Route/RoutePolars.hpp"
+#include "Engine/Route/FlatTriangleFanVisitor.hpp"
+#include "Terrain/RasterMap.hpp"
+#include "GlideSolvers/GlideSettings.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "thread/ThreadPool.hpp"
+#include "TestUtil.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include <stdio.h>
+
+/*
+ * An analytic terrain model: a few hills on a plain, so the reach
+ * fan gets sub-fans around the obstacles without needing a terrain
+ * file.
+ */
+
+struct Hill {
+  double longitude, latitude;
+  double height, radius;
+};
+
+static constexpr Hill hills[] = {
+  { 10.15, 46.05, 1800, 0.05 },
+  { 9.85, 46.10, 1500, 0.08 },
+  { 10.05, 45.80, 2000, 0.06 },
+  { 9.80, 45.90, 1200, 0.04 },
+  { 10.30, 45.95, 1600, 0.07 },
+};
+
+static constexpr GeoPoint center(Angle::Degrees(10), Angle::Degrees(46));
+
+static double
+CalcTerrainHeight(const GeoPoint &p) noexcept
+{
+  double h = 200;
+  for (const auto &hill : hills) {
+    const double dx = (p.longitude.Degrees() - hill.longitude) / hill.radius;
+    const double dy = (p.latitude.Degrees() - hill.latitude) / hill.radius;
+    h += hill.height * std::exp(-(dx * dx + dy * dy));
+  }
+
+  return h;
+}
+
+void
+RasterTileCache::Reset() noexcept
+{
+  bounds = GeoBounds(GeoPoint(center.longitude - Angle::Degrees(2),
+                              center.latitude + Angle::Degrees(2)),
+                     GeoPoint(center.longitude + Angle::Degrees(2),
+                              center.latitude - Angle::Degrees(2)));
+}
+
+TerrainHeight
+RasterMap::GetHeight(const GeoPoint &location) const noexcept
+{
+  return TerrainHeight(int16_t(CalcTerrainHeight(location)));
+}
+
+GeoPoint
+RasterMap::GroundIntersection(const GeoPoint &origin,
+                              const int h_origin, const int h_glide,
+                              const GeoPoint &destination,
+                              const int height_floor) const noexcept
+{
+  static constexpr unsigned STEPS = 256;
+
+  GeoPoint last_clear = origin;
+  for (unsigned i = 1; i <= STEPS; ++i) {
+    const double t = double(i) / STEPS;
+    const GeoPoint p = origin.Interpolate(destination, t);
+    const double h = h_origin - t * h_glide;
+    if (h < std::max(CalcTerrainHeight(p), double(height_floor)))
+      return last_clear;
+
+    if (h <= 0)
+      break;
+
+    last_clear = p;
+  }
+
+  return GeoPoint::Invalid();
+}
+
+RasterMap::Intersection
+RasterMap::FirstIntersection([[maybe_unused]] const GeoPoint &origin,
+                             [[maybe_unused]] const int h_origin,
+                             [[maybe_unused]] const GeoPoint &destination,
+                             [[maybe_unused]] const int h_destination,
+                             [[maybe_unused]] const int h_virt,
+                             [[maybe_unused]] const int h_ceiling,
+                             [[maybe_unused]] const int h_safety) const noexcept
+{
+  return Intersection::Invalid();
+}
+
+static RoutePolars
+MakeRoutePolars(double wind_speed)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+
+  RoutePlannerConfig config;
+  config.SetDefaults();
+  config.mode = RoutePlannerConfig::Mode::TERRAIN;
+  config.reach_calc_mode = RoutePlannerConfig::ReachMode::TURNING;
+
+  const GlidePolar polar(0);
+  const SpeedVector wind(Angle::Degrees(270), wind_speed);
+
+  RoutePolars rpolars;
+  rpolars.SetConfig(config);
+  rpolars.Initialise(settings, polar, wind);
+  return rpolars;
+}
+
+/**
+ * Compare the reach of two solutions on a grid of destinations.
+ *
+ * @return the number of destinations where the terrain
+ * reachability differs or the arrival height differs by more than
+ * the given tolerance
+ */
+static unsigned
+CompareReach(const ReachFan &a, const ReachFan &b,
+             const RoutePolars &rpolars, int tolerance)
+{
+  unsigned n_different = 0;
+
+  for (int i = -20; i <= 20; ++i) {
+    for (int j = -20; j <= 20; ++j) {
+      const GeoPoint p(center.longitude + Angle::Degrees(i * 0.02),
+                       center.latitude + Angle::Degrees(j * 0.02));
+      const AGeoPoint dest(p, CalcTerrainHeight(p));
+
+      const auto ra = a.FindPositiveArrival(dest, rpolars);
+      const auto rb = b.FindPositiveArrival(dest, rpolars);
+      if (!ra || !rb) {
+        if (ra.has_value() != rb.has_value())
+          ++n_different;
+        continue;
+      }
+
+      if (ra->IsReachableTerrain() != rb->IsReachableTerrain() ||
+          (ra->IsReachableTerrain() &&
+           std::abs(ra->terrain - rb->terrain) > tolerance))
+        ++n_different;
+    }
+  }
+
+  return n_different;
+}
+
+/**
+ * Count the destinations on a grid which are reachable with a
+ * higher arrival altitude in #b than in #a.
+ */
+static unsigned
+CountGrown(const ReachFan &a, const ReachFan &b, const RoutePolars &rpolars)
+{
+  unsigned n_grown = 0;
+
+  for (int i = -20; i <= 20; ++i) {
+    for (int j = -20; j <= 20; ++j) {
+      const GeoPoint p(center.longitude + Angle::Degrees(i * 0.02),
+                       center.latitude + Angle::Degrees(j * 0.02));
+      const AGeoPoint dest(p, CalcTerrainHeight(p));
+
+      const auto rb = b.FindPositiveArrival(dest, rpolars);
+      if (!rb || !rb->IsReachableTerrain())
+        continue;
+
+      const auto ra = a.FindPositiveArrival(dest, rpolars);
+      if (!ra || !ra->IsReachableTerrain() || rb->terrain > ra->terrain)
+        ++n_grown;
+    }
+  }
+
+  return n_grown;
+}
+
+static void
+TestReuse(const RasterMap &map)
+{
+  const RoutePolars rpolars = MakeRoutePolars(5);
+
+  AGeoPoint origin(center, 1500);
+
+  ReachFan reach;
+  ok1(reach.Solve(origin, rpolars, &map));
+  ok1(reach.GetReusedFans() == 0);
+
+  /* a fresh solution from the same origin is identical */
+  {
+    ReachFan fresh;
+    ok1(fresh.Solve(origin, rpolars, &map));
+    ok1(CompareReach(reach, fresh, rpolars, 0) == 0);
+  }
+
+  /* no movement: the whole tree is reused */
+  ok1(reach.Solve(origin, rpolars, &map));
+  ok1(reach.GetReusedFans() > 1);
+  const int terrain_base = reach.GetTerrainBase();
+
+  /* one second of flight in rising air: the root fan is solved
+     again, but sub-fans are taken over */
+  const ReachFan previous = reach;
+  origin.longitude += Angle::Degrees(0.0004);
+  origin.altitude += 1;
+  ok1(reach.Solve(origin, rpolars, &map));
+  ok1(reach.GetReusedFans() > 0);
+  ok1(std::abs(reach.GetTerrainBase() - terrain_base) < 20);
+
+  /* the result does not differ from a fresh solution more than the
+     previous solution does */
+  {
+    ReachFan fresh;
+    ok1(fresh.Solve(origin, rpolars, &map));
+
+    const int tolerance = FlatTriangleFanTree::REUSE_HEIGHT * 2;
+    ok1(CompareReach(reach, fresh, rpolars, tolerance) <=
+        CompareReach(previous, fresh, rpolars, tolerance));
+  }
+
+  /* after sinking, nothing is reused and the reach does not grow
+     beyond a fresh solution from the lower altitude */
+  {
+    ReachFan sinking;
+    ok1(sinking.Solve(origin, rpolars, &map));
+
+    AGeoPoint lower = origin;
+    lower.altitude -= 5;
+    ok1(sinking.Solve(lower, rpolars, &map));
+    ok1(sinking.GetReusedFans() == 0);
+
+    ReachFan fresh;
+    fresh.Solve(lower, rpolars, &map);
+    ok1(CountGrown(fresh, sinking, rpolars) == 0);
+
+    /* climbing back reuses the lower solution */
+    ok1(sinking.Solve(origin, rpolars, &map));
+    ok1(sinking.GetReusedFans() > 0);
+  }
+
+  /* a different wind invalidates everything */
+  const RoutePolars windy = MakeRoutePolars(15);
+  ok1(reach.Solve(origin, windy, &map));
+  ok1(reach.GetReusedFans() == 0);
+
+  /* moving far away from the projection center invalidates
+     everything */
+  ok1(reach.Solve(origin, windy, &map));
+  ok1(reach.GetReusedFans() > 0);
+  origin.latitude += Angle::Degrees(0.1);
+  ok1(reach.Solve(origin, windy, &map));
+  ok1(reach.GetReusedFans() == 0);
+
+  /* below the terrain, there is nothing to reuse */
+  ok1(!reach.Solve(AGeoPoint(center, 100), windy, &map));
+  ok1(reach.GetReusedFans() == 0);
+  ok1(reach.Solve(origin, windy, &map));
+  ok1(reach.GetReusedFans() == 0);
+}
+
+/**
+ * Simulate a glide in rising air at fix rate and compare the time
+ * spent with solving from scratch each time.
+ */
+static void
+TestGlide(const RasterMap &map)
+{
+  const RoutePolars rpolars = MakeRoutePolars(5);
+  static constexpr unsigned N = 30;
+
+  using Clock = std::chrono::steady_clock;
+
+  AGeoPoint origin(center, 2000);
+  ReachFan reach;
+  unsigned n_reused = 0;
+
+  const auto t0 = Clock::now();
+  for (unsigned i = 0; i < N; ++i) {
+    reach.Solve(origin, rpolars, &map);
+    n_reused += reach.GetReusedFans();
+
+    origin.longitude += Angle::Degrees(0.0004);
+    origin.altitude += 1;
+  }
+  const auto t1 = Clock::now();
+
+  origin = AGeoPoint(center, 2000);
+  for (unsigned i = 0; i < N; ++i) {
+    ReachFan fresh;
+    fresh.Solve(origin, rpolars, &map);
+
+    origin.longitude += Angle::Degrees(0.0004);
+    origin.altitude += 1;
+  }
+  const auto t2 = Clock::now();
+
+  ok1(n_reused > 0);
+
+  printf("# %u updates: incremental %ld ms, from scratch %ld ms, %u fans reused\n",
+         N,
+         (long)std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count(),
+         (long)std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count(),
+         n_reused);
+}
+
+/**
+ * Collects all fans of a solution.
+ */
+class FanCollector final : public FlatTriangleFanVisitor {
+public:
+  std::vector<FlatGeoPoint> points;
+  std::vector<std::size_t> sizes;
+
+  void VisitFan([[maybe_unused]] FlatGeoPoint origin,
+                std::span<const FlatGeoPoint> fan) noexcept override {
+    points.insert(points.end(), fan.begin(), fan.end());
+    sizes.push_back(fan.size());
+  }
+};
+
+static bool
+operator==(const FanCollector &a, const FanCollector &b) noexcept
+{
+  return a.sizes == b.sizes && a.points == b.points;
+}
+
+static FanCollector
+CollectFans(const ReachFan &reach)
+{
+  const GeoBounds bounds(GeoPoint(center.longitude - Angle::Degrees(2),
+                                  center.latitude + Angle::Degrees(2)),
+                         GeoPoint(center.longitude + Angle::Degrees(2),
+                                  center.latitude - Angle::Degrees(2)));
+
+  FanCollector collector;
+  reach.AcceptInRange(bounds, collector);
+  return collector;
+}
+
+/**
+ * Solving on a #ThreadPool must give exactly the same tree as
+ * solving on one thread.
+ */
+static void
+TestParallel(const RasterMap &map)
+{
+  ThreadPool pool("TestReachFan", 3);
+  const RoutePolars rpolars = MakeRoutePolars(5);
+  static constexpr unsigned N = 10;
+
+  using Clock = std::chrono::steady_clock;
+  Clock::duration serial_time{}, parallel_time{};
+
+  AGeoPoint origin(center, 2000);
+  ReachFan serial, parallel;
+  bool same = true, reused = false;
+
+  for (unsigned i = 0; i < N; ++i) {
+    const auto t0 = Clock::now();
+    serial.Solve(origin, rpolars, &map);
+    const auto t1 = Clock::now();
+    parallel.Solve(origin, rpolars, &map, true, &pool);
+    const auto t2 = Clock::now();
+
+    serial_time += t1 - t0;
+    parallel_time += t2 - t1;
+
+    if (CollectFans(serial).sizes.size() < 2 ||
+        !(CollectFans(serial) == CollectFans(parallel)) ||
+        serial.GetReusedFans() != parallel.GetReusedFans() ||
+        serial.GetTerrainBase() != parallel.GetTerrainBase())
+      same = false;
+
+    if (parallel.GetReusedFans() > 0)
+      reused = true;
+
+    /* every other step is too large for reusing sub-fans */
+    origin.longitude += Angle::Degrees(i % 2 ? 0.0004 : 0.004);
+    origin.altitude += 3;
+  }
+
+  ok1(same);
+  ok1(reused);
+
+  printf("# %u updates: serial %ld ms, %u threads %ld ms\n",
+         N,
+         (long)std::chrono::duration_cast<std::chrono::milliseconds>(serial_time).count(),
+         pool.GetConcurrency(),
+         (long)std::chrono::duration_cast<std::chrono::milliseconds>(parallel_time).count());
+}
+
+int
+main()
+{
+  plan_tests(30);
+
+  RasterMap map;
+  TestReuse(map);
+  TestGlide(map);
+  TestParallel(map);
+
+  return exit_status();
+}
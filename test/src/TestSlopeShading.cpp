@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Terrain/SlopeShading.hpp"
+#include "Terrain/HeightMatrix.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+/**
+ * The single precision kernel (and the reciprocal square root
+ * estimate on NEON) may truncate the dot product to a different
+ * integer than the double formula (off by one), which is then scaled
+ * by contrast/128; therefore the results may differ by up to 2 with
+ * the maximum contrast 255.
+ */
+static constexpr int TOLERANCE = 2;
+
+static constexpr SlopeShadingParameters parameters[] = {
+  /* the default settings (brightness 128, sun from the south-west) */
+  { -120, -120, 201, 128, 100 },
+  /* maximum contrast, high sun */
+  { 30, -40, 250, 255, 30 },
+  /* low contrast, low sun from the east, large cells */
+  { 250, 10, 44, 64, 8192 },
+};
+
+static unsigned
+SafeMinusStep(unsigned pos, unsigned step) noexcept
+{
+  return std::min(step, pos);
+}
+
+static unsigned
+SafePlusStep(unsigned pos, unsigned size, unsigned step) noexcept
+{
+  if (size <= 1 || pos >= size - 1)
+    return 0;
+
+  return std::min(step, size - 1 - pos);
+}
+
+static int
+ClipHeightDelta(TerrainHeight a, TerrainHeight b) noexcept
+{
+  return std::clamp(a.GetValue() - b.GetValue(), -512, 512);
+}
+
+/**
+ * The scalar formula which was used by
+ * RasterRenderer::GenerateSlopeImage() before ShadeSlopeRow() was
+ * introduced.
+ */
+static int
+ReferenceShade(const SlopeShadingParameters &params,
+               const TerrainHeight *data, unsigned width, unsigned height,
+               unsigned x, unsigned y, unsigned step) noexcept
+{
+  const unsigned row_plus_index = SafePlusStep(y, height, step);
+  const unsigned row_minus_index = SafeMinusStep(y, step);
+  const unsigned column_plus_index = SafePlusStep(x, width, step);
+  const unsigned column_minus_index = SafeMinusStep(x, step);
+
+  const TerrainHeight *src = data + y * width + x;
+  const auto h_above = src[-int(row_minus_index * width)];
+  const auto h_below = src[row_plus_index * width];
+  const auto h_left = src[-int(column_minus_index)];
+  const auto h_right = src[column_plus_index];
+
+  const unsigned p31 = row_plus_index + row_minus_index;
+  const int p32 = ClipHeightDelta(h_above, h_below);
+  const int p22 = ClipHeightDelta(h_right, h_left);
+  const unsigned p20 = column_plus_index + column_minus_index;
+
+  const int dd0 = p22 * int(p31);
+  const int dd1 = int(p20) * p32;
+  const double dd2 = double(p20) * double(p31) *
+    double(params.height_slope_factor);
+  const double num =
+    dd2 * double(params.sz) + double(dd0) * double(params.sx) +
+    double(dd1) * double(params.sy);
+  const double square_mag =
+    double(dd0) * double(dd0) +
+    double(dd1) * double(dd1) +
+    dd2 * dd2;
+  const double mag = sqrt(square_mag);
+  const int sval = int(num / std::max(mag, 1.0));
+  const int sindex = (sval - params.sz) * params.contrast / 128;
+  return std::clamp(sindex, -63, 63);
+}
+
+/**
+ * Shade all rows with ShadeSlopeRow() and compare each cell with
+ * ReferenceShade().
+ */
+static bool
+CheckShading(const SlopeShadingParameters &params,
+             const TerrainHeight *data, unsigned width, unsigned height,
+             unsigned step)
+{
+  std::vector<int8_t> row(width);
+
+  for (unsigned y = 0; y < height; ++y) {
+    ShadeSlopeRow(params, data + y * width, width,
+                  SafeMinusStep(y, step), SafePlusStep(y, height, step),
+                  step, row.data());
+
+    for (unsigned x = 0; x < width; ++x) {
+      const int expected = ReferenceShade(params, data, width, height,
+                                          x, y, step);
+      if (std::abs(row[x] - expected) > TOLERANCE) {
+        printf("# step=%u x=%u y=%u: %d, expected %d\n",
+               step, x, y, row[x], expected);
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool
+CheckShading(const HeightMatrix &matrix, unsigned step)
+{
+  const auto size = matrix.GetSize();
+  for (const auto &params : parameters)
+    if (!CheckShading(params, matrix.GetData(), size.x, size.y, step))
+      return false;
+
+  return true;
+}
+
+/**
+ * Gradients in both directions, some of them steep enough to be
+ * clipped by ClipHeightDelta().  The widths include matrices
+ * narrower than two steps (edge cells only) and widths which leave
+ * a remainder after the SIMD lanes.
+ */
+static void
+TestGradient(bool vertical)
+{
+  static constexpr struct {
+    unsigned width, height;
+    int16_t min_h, max_h;
+  } matrices[] = {
+    { 1, 1, 100, 100 },
+    { 3, 2, 0, 500 },
+    { 7, 5, 2000, -100 },
+    { 17, 9, 0, 9000 },
+    { 61, 11, -50, 1500 },
+    { 800, 4, 200, 2500 },
+  };
+
+  HeightMatrix matrix;
+
+  for (const auto &m : matrices) {
+    matrix.FillGradient({m.width, m.height}, m.min_h, m.max_h, vertical);
+
+    bool success = true;
+    for (unsigned step : {1u, 2u, 4u})
+      if (!CheckShading(matrix, step))
+        success = false;
+
+    ok(success, "%s gradient %ux%u",
+       vertical ? "vertical" : "horizontal", m.width, m.height);
+  }
+}
+
+/**
+ * A simple deterministic pseudo random number generator.
+ */
+static uint32_t
+NextRandom(uint32_t &state) noexcept
+{
+  state = state * 1664525 + 1013904223;
+  return state >> 8;
+}
+
+/**
+ * Rough terrain (no special values), which exercises all slopes
+ * including clipped ones and negative heights.
+ */
+static void
+TestRandom(unsigned width, unsigned height)
+{
+  uint32_t state = width * 31 + height;
+
+  std::vector<TerrainHeight> data;
+  data.reserve(width * height);
+  for (unsigned i = 0; i < width * height; ++i)
+    data.emplace_back(int16_t(int(NextRandom(state) % 3000) - 500));
+
+  bool success = true;
+  for (const auto &params : parameters)
+    for (unsigned step : {1u, 2u, 3u, 8u})
+      if (!CheckShading(params, data.data(), width, height, step))
+        success = false;
+
+  ok(success, "random %ux%u", width, height);
+}
+
+int
+main()
+{
+  plan_tests(6 + 6 + 4);
+
+  TestGradient(false);
+  TestGradient(true);
+
+  TestRandom(9, 7);
+  TestRandom(23, 13);
+  TestRandom(64, 3);
+  TestRandom(101, 20);
+
+  return exit_status();
+}
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "StartupJobs.hpp"
+#include "Operation/Operation.hpp"
+#include "thread/ThreadPool.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Records the calls forwarded by StartupJobs::Run().
+ */
+class RecordingOperationEnvironment final : public NullOperationEnvironment {
+public:
+  unsigned range = 0, position = 0;
+  bool position_decreased = false;
+  std::vector<std::string> errors;
+
+  void SetErrorMessage(const char *text) noexcept override {
+    errors.emplace_back(text);
+  }
+
+  void SetProgressRange(unsigned _range) noexcept override {
+    range = _range;
+  }
+
+  void SetProgressPosition(unsigned _position) noexcept override {
+    if (_position < position)
+      position_decreased = true;
+    position = _position;
+  }
+};
+
+static void
+TestJobs(unsigned n_threads)
+{
+  ThreadPool pool("Test", n_threads);
+  StartupJobs jobs;
+
+  std::atomic_uint sequence{0};
+  unsigned a_done = 0, b_done = 0, c_start = 0, d_start = 0;
+
+  const unsigned a = jobs.Add(1, [&](OperationEnvironment &env){
+    env.SetProgressRange(10);
+    for (unsigned i = 1; i <= 10; ++i) {
+      env.Sleep(std::chrono::milliseconds(10));
+      env.SetProgressPosition(i);
+    }
+    a_done = ++sequence;
+  });
+
+  const unsigned b = jobs.Add(2, [&](OperationEnvironment &env){
+    env.SetErrorMessage("b failed partially");
+    b_done = ++sequence;
+  });
+
+  jobs.Add(1, [&](OperationEnvironment &){
+    c_start = ++sequence;
+    throw std::runtime_error("c failed");
+  }, {a, b});
+
+  jobs.Add(0, [&](OperationEnvironment &){
+    d_start = ++sequence;
+  }, {a});
+
+  RecordingOperationEnvironment env;
+  jobs.Run(pool, env);
+
+  ok1(sequence == 4);
+
+  /* jobs run only after their dependencies have finished */
+  ok1(c_start > a_done && c_start > b_done);
+  ok1(d_start > a_done);
+
+  ok1(env.range == 4 * 256);
+  ok1(env.position == env.range);
+  ok1(!env.position_decreased);
+
+  ok1(env.errors.size() == 2);
+  ok1(std::find(env.errors.begin(), env.errors.end(),
+                "b failed partially") != env.errors.end());
+  ok1(std::find(env.errors.begin(), env.errors.end(),
+                "c failed") != env.errors.end());
+}
+
+int main()
+{
+  plan_tests(2 * 9);
+
+  TestJobs(1);
+  TestJobs(3);
+
+  return exit_status();
+}
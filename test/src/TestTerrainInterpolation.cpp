@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Terrain/Interpolation.hpp"
+#include "TestUtil.hpp"
+
+#include <array>
+#include <cstdint>
+
+/**
+ * A simple deterministic pseudo random number generator.
+ */
+static uint32_t
+NextRandom(uint32_t &state) noexcept
+{
+  state = state * 1664525 + 1013904223;
+  return state >> 8;
+}
+
+static TerrainHeight
+RandomHeight(uint32_t &state) noexcept
+{
+  switch (NextRandom(state) % 16) {
+  case 0:
+    return TerrainHeight::Invalid();
+
+  case 1:
+    /* water */
+    return TerrainHeight(-30000);
+
+  case 2:
+    return TerrainHeight(32767);
+
+  case 3:
+    return TerrainHeight(-29999);
+
+  default:
+    return TerrainHeight(int16_t(NextRandom(state) % 9000) - 500);
+  }
+}
+
+static unsigned
+RandomSubpixel(uint32_t &state) noexcept
+{
+  switch (NextRandom(state) % 8) {
+  case 0:
+    return 0;
+
+  case 1:
+    return 0xff;
+
+  default:
+    return NextRandom(state) % 0x100;
+  }
+}
+
+/**
+ * Compare the (possibly vectorised) #InterpolationBatch with the
+ * scalar InterpolateBilinear().
+ */
+static void
+TestBatch(unsigned n)
+{
+  uint32_t state = n;
+
+  /* each sample gets its own 2x2 pixel block */
+  std::array<std::array<TerrainHeight, 4>, InterpolationBatch::CAPACITY> pixels;
+  std::array<unsigned, InterpolationBatch::CAPACITY> ix, iy;
+
+  InterpolationBatch batch;
+  for (unsigned i = 0; i < n; ++i) {
+    for (auto &p : pixels[i])
+      p = RandomHeight(state);
+
+    ix[i] = RandomSubpixel(state);
+    iy[i] = RandomSubpixel(state);
+
+    batch.Append(pixels[i].data(), 1, 2, ix[i], iy[i]);
+  }
+
+  std::array<TerrainHeight, InterpolationBatch::CAPACITY> result;
+  ok1(batch.Flush(result.data()) == result.data() + n);
+
+  bool equal = true;
+  for (unsigned i = 0; i < n; ++i) {
+    const auto &p = pixels[i];
+    const auto expected = InterpolateBilinear(p[0], p[1], p[2], p[3],
+                                              ix[i], iy[i]);
+    equal &= result[i].GetValue() == expected.GetValue();
+  }
+
+  ok1(equal);
+}
+
+static void
+TestPassThrough()
+{
+  InterpolationBatch batch;
+  batch.Append(TerrainHeight(1234));
+  batch.Append(TerrainHeight::Invalid());
+  batch.Append(TerrainHeight(-30000));
+
+  TerrainHeight result[3];
+  batch.Flush(result);
+
+  ok1(result[0].GetValue() == 1234);
+  ok1(result[1].IsInvalid());
+  ok1(result[2].IsWater());
+}
+
+int main()
+{
+  plan_tests(3 + 3 + 2 * 3);
+
+  /* the exact result of a few known inputs */
+  ok1(InterpolateBilinear(TerrainHeight(100), TerrainHeight(200),
+                          TerrainHeight(300), TerrainHeight(400),
+                          0x80, 0x80).GetValue() == 250);
+  ok1(InterpolateBilinear(TerrainHeight(100), TerrainHeight::Invalid(),
+                          TerrainHeight(300), TerrainHeight(400),
+                          0x80, 0x80).GetValue() == 100);
+  ok1(InterpolateBilinear(TerrainHeight(-100), TerrainHeight(-100),
+                          TerrainHeight(-100), TerrainHeight(-100),
+                          0x12, 0x34).GetValue() == -100);
+
+  TestPassThrough();
+
+  /* full batches and odd remainders */
+  TestBatch(InterpolationBatch::CAPACITY);
+  TestBatch(1);
+  TestBatch(13);
+
+  return exit_status();
+}
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "thread/ThreadPool.hpp"
+#include "TestUtil.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+static void
+TestForEach(ThreadPool &pool)
+{
+  std::vector<unsigned> results(1000);
+  pool.ForEach(results.size(), [&results](unsigned i){
+    results[i] = i * i;
+  });
+
+  bool all = true;
+  for (unsigned i = 0; i < results.size(); ++i)
+    all &= results[i] == i * i;
+  ok1(all);
+}
+
+static void
+TestException(ThreadPool &pool)
+{
+  std::atomic_uint count{0};
+
+  bool caught = false;
+  try {
+    pool.ForEach(100, [&count](unsigned i){
+      ++count;
+      if (i == 42)
+        throw std::runtime_error("42");
+    });
+  } catch (const std::runtime_error &) {
+    caught = true;
+  }
+
+  ok1(caught);
+
+  /* all other tasks must have run nonetheless */
+  ok1(count == 100);
+}
+
+static void
+TestNested(ThreadPool &pool)
+{
+  std::atomic_uint count{0};
+
+  /* tasks waiting for nested groups must not deadlock, even if
+     there are more of them than worker threads */
+  pool.ForEach(16, [&pool, &count](unsigned){
+    pool.ForEach(16, [&count](unsigned){
+      ++count;
+    });
+  });
+
+  ok1(count == 256);
+}
+
+static void
+TestPool(unsigned n_threads)
+{
+  ThreadPool pool("Test", n_threads);
+  ok1(pool.GetConcurrency() == n_threads + 1);
+
+  TestForEach(pool);
+  TestException(pool);
+  TestNested(pool);
+}
+
+#if defined(__linux__) && defined(SCHED_IDLE)
+
+/**
+ * Only the worker threads of an idle pool run with idle priority;
+ * the thread calling Wait() keeps its priority, even though it
+ * executes tasks, too.
+ */
+static void
+TestIdlePriority()
+{
+  const int policy = sched_getscheduler(0);
+  const auto caller = std::this_thread::get_id();
+  std::atomic_bool worker_not_idle{false}, caller_idle{false};
+
+  ThreadPool pool("Test", 2, true);
+  pool.ForEach(64, [&](unsigned){
+    const bool idle = sched_getscheduler(0) == SCHED_IDLE;
+    if (std::this_thread::get_id() != caller)
+      worker_not_idle = worker_not_idle || !idle;
+    else if (idle)
+      caller_idle = true;
+  });
+
+  ok1(!worker_not_idle);
+  ok1(!caller_idle);
+  ok1(sched_getscheduler(0) == policy);
+}
+
+#endif
+
+int main()
+{
+#if defined(__linux__) && defined(SCHED_IDLE)
+  plan_tests(3 * 5 + 1 + 3);
+#else
+  plan_tests(3 * 5 + 1);
+#endif
+
+  ok1(ThreadPool::GetHardwareConcurrency() >= 1);
+
+  TestPool(0);
+  TestPool(1);
+  TestPool(3);
+
+#if defined(__linux__) && defined(SCHED_IDLE)
+  TestIdlePriority();
+#endif
+
+  return exit_status();
+}
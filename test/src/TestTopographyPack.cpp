@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Topography/TopographyPack.hpp"
+#include "Topography/TopographyFile.hpp"
+#include "Topography/XShape.hpp"
+#include "io/ZipArchive.hpp"
+#include "system/FileUtil.hpp"
+#include "system/Path.hpp"
+#include "util/StringAPI.hxx"
+
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static const Path map_path{"test/data/benalla9.xcm"};
+static const Path pack_path{"output/TestTopographyPack.bin"};
+
+/**
+ * The layers of benalla9.xcm (see its topology.tpl).
+ */
+static constexpr struct {
+  const char *name;
+  double range;
+  int label_field;
+} layers[] = {
+  { "inwaterahydro_area", 100000, -1 },
+  { "watrcrslhydro_line", 7000, -1 },
+  { "builtupapop_area", 15000, 0 },
+  { "roadltrans_line", 15000, -1 },
+  { "railrdltrans_line", 10000, -1 },
+  { "mispopppop_point", 5000, 0 },
+};
+
+static bool
+BoundsEqual(const GeoBounds &a, const GeoBounds &b) noexcept
+{
+  return a.GetWest() == b.GetWest() && a.GetEast() == b.GetEast() &&
+    a.GetSouth() == b.GetSouth() && a.GetNorth() == b.GetNorth();
+}
+
+#ifdef ENABLE_OPENGL
+
+static bool
+IndicesEqual(const XShape &a, const XShape &b, double range)
+{
+  if (a.get_type() != MS_SHAPE_LINE && a.get_type() != MS_SHAPE_POLYGON)
+    return true;
+
+  for (unsigned level = 0; level < XShape::THINNING_LEVELS; ++level) {
+    const ShapeScalar min_distance(TopographyFile::GetMinimumPointDistance(range,
+                                                                          level));
+    const auto ia = a.GetIndices(level, min_distance);
+    const auto ib = b.GetIndices(level, min_distance);
+    if ((ia.indices == nullptr) != (ib.indices == nullptr))
+      return false;
+
+    if (ia.indices == nullptr)
+      continue;
+
+    if (ia.indices - ia.count != ib.indices - ib.count)
+      return false;
+
+    std::size_t n = 0;
+    if (a.get_type() == MS_SHAPE_LINE) {
+      const std::size_t num_lines = a.GetLines().size();
+      if (!std::equal(ia.count, ia.count + num_lines, ib.count))
+        return false;
+
+      for (std::size_t l = 0; l < num_lines; ++l)
+        n += ia.count[l];
+    } else {
+      if (*ia.count != *ib.count)
+        return false;
+
+      n = *ia.count;
+    }
+
+    if (!std::equal(ia.indices, ia.indices + n, ib.indices))
+      return false;
+  }
+
+  return true;
+}
+
+#endif
+
+static bool
+ShapesEqual(const XShape &a, const XShape &b, [[maybe_unused]] double range)
+{
+  if (!BoundsEqual(a.get_bounds(), b.get_bounds()) ||
+      a.get_type() != b.get_type())
+    return false;
+
+  const auto lines = a.GetLines();
+  if (!std::equal(lines.begin(), lines.end(),
+                  b.GetLines().begin(), b.GetLines().end()))
+    return false;
+
+  std::size_t n_points = 0;
+  for (const auto n : lines)
+    n_points += n;
+
+  if (n_points > 0 &&
+      memcmp(a.GetPoints(), b.GetPoints(), n_points * sizeof(XShape::Point)) != 0)
+    return false;
+
+  if ((a.GetLabel() == nullptr) != (b.GetLabel() == nullptr) ||
+      (a.GetLabel() != nullptr && !StringIsEqual(a.GetLabel(), b.GetLabel())))
+    return false;
+
+#ifdef ENABLE_OPENGL
+  if (!IndicesEqual(a, b, range))
+    return false;
+#endif
+
+  return true;
+}
+
+/**
+ * Compare all shapes loaded from the pack with the ones loaded from
+ * the shapefile.
+ */
+static bool
+FilesEqual(const TopographyFile &a, const TopographyFile &b, double range)
+{
+  auto i = a.begin(), j = b.begin();
+  for (; i != a.end() && j != b.end(); ++i, ++j)
+    if (!ShapesEqual(*i, *j, range))
+      return false;
+
+  return i == a.end() && j == b.end();
+}
+
+/**
+ * Compare TopographyPackLayer::SelectShapes() with a linear search.
+ */
+static bool
+CheckSelect(const TopographyPackLayer &layer)
+{
+  static std::mt19937 rng;
+
+  const auto &bounds = layer.GetBounds();
+  std::uniform_real_distribution<double>
+    longitude(bounds.GetWest().Degrees() - 0.1, bounds.GetEast().Degrees() + 0.1),
+    latitude(bounds.GetSouth().Degrees() - 0.1, bounds.GetNorth().Degrees() + 0.1),
+    size(0.001, 0.5);
+
+  std::vector<bool> selected;
+
+  for (unsigned n = 0; n < 200; ++n) {
+    const Angle west = Angle::Degrees(longitude(rng));
+    const Angle south = Angle::Degrees(latitude(rng));
+    const GeoBounds query(GeoPoint(west, south + Angle::Degrees(size(rng))),
+                          GeoPoint(west + Angle::Degrees(size(rng)), south));
+
+    if (!layer.SelectShapes(query, selected)) {
+      if (bounds.Overlaps(query))
+        return false;
+      continue;
+    }
+
+    for (std::size_t i = 0; i < layer.size(); ++i)
+      if (selected[i] != query.Overlaps(layer.GetShape(i).bounds))
+        return false;
+  }
+
+  return true;
+}
+
+static void
+TestLayer(const TopographyPack &pack, ZipArchive &archive,
+          const char *name, double range, int label_field)
+{
+  const auto *layer = pack.FindLayer(name, label_field, range);
+  ok1(layer != nullptr);
+  if (layer == nullptr) {
+    skip(2, 0, "layer not found");
+    return;
+  }
+
+  const std::string filename = std::string{name} + ".shp";
+  TopographyFile shapefile(archive.get(), filename.c_str(),
+                           range, range, range,
+                           BGRA8Color(0, 0, 0), label_field);
+  shapefile.LoadAll();
+
+  TopographyFile packed(*layer, range, range, range,
+                        BGRA8Color(0, 0, 0), label_field);
+  packed.LoadAll();
+
+  ok1(FilesEqual(shapefile, packed, range));
+  ok1(CheckSelect(*layer));
+}
+
+int
+main()
+{
+  plan_tests(5 + std::size(layers) * 3);
+
+  File::Delete(pack_path);
+  ok1(TopographyPack::Open(pack_path, map_path) == nullptr);
+
+  ZipArchive archive(map_path);
+
+  {
+    TopographyPackWriter writer(pack_path);
+    for (const auto &i : layers) {
+      const std::string filename = std::string{i.name} + ".shp";
+      writer.AddLayer(archive.get(), filename.c_str(), i.name,
+                      i.label_field, i.range);
+    }
+
+    writer.Commit(map_path);
+  }
+
+  const auto pack = TopographyPack::Open(pack_path, map_path);
+  ok1(pack != nullptr);
+  if (pack == nullptr)
+    return exit_status();
+
+  for (const auto &i : layers)
+    TestLayer(*pack, archive, i.name, i.range, i.label_field);
+
+  /* layers created with other settings must not be found */
+  ok1(pack->FindLayer(layers[0].name, 3, layers[0].range) == nullptr);
+  ok1(pack->FindLayer(layers[0].name, layers[0].label_field, 1) == nullptr);
+
+  /* a pack created for another map file must be ignored */
+  ok1(TopographyPack::Open(pack_path, Path("test/data/01lz1hq1.igc")) == nullptr);
+
+  File::Delete(pack_path);
+
+  return exit_status();
+}
@@ -14,6 +14,7 @@
 
 #include <windef.h>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
 
 using namespace std::chrono;
@@ -46,6 +47,8 @@ TestTrace(Path filename, unsigned ntrace, bool output=false)
   IGCExtensions extensions;
   extensions.clear();
 
+  const auto start_time = steady_clock::now();
+
   char *line;
   int i = 0;
   for (; (line = reader.ReadLine()) != NULL; i++) {
@@ -65,6 +68,8 @@ TestTrace(Path filename, unsigned ntrace, bool output=false)
   }
   putchar('\n');
   printf("# samples %d\n", i);
+  printf("# time %.1f ms\n",
+         duration<double, std::milli>(steady_clock::now() - start_time).count());
   return true;
 }
 
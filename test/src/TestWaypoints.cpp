@@ -4,9 +4,12 @@
 #include "Waypoint/Waypoints.hpp"
 #include "Geo/GeoVector.hpp"
 #include "test_debug.hpp"
+#include "harness_waypoints.hpp"
 #include "util/Macros.hpp"
 
+#include <algorithm>
 #include <functional>
+#include <vector>
 
 #include <stdio.h>
 extern "C" {
@@ -485,13 +488,66 @@ TestNameSubstringShortname()
   ok1(dual_matched && dual_matched->name == "ALPHA FIELD");
 }
 
+/**
+ * Collect the sorted ids of all waypoints matching the substring.
+ */
+static std::vector<unsigned>
+CollectNameSubstring(const Waypoints &waypoints, const char *substring)
+{
+  std::vector<unsigned> result;
+  waypoints.VisitNameSubstring(substring, [&](const auto &wp){
+    result.push_back(wp->id);
+  });
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+/**
+ * Compare the results of the linear scan (before Optimise()) with the
+ * ones of the name index (after Optimise()) on a large set of
+ * waypoints.  Optimise() reorders the waypoints, so only the sets of
+ * matches are compared.
+ */
+static bool
+TestNameSubstringIndex()
+{
+  static constexpr const char *needles[] = {
+    "", "E", "WA", "berg", "HAUSEN", "OBERWALD", "LS", "EDDF12", "XYZ",
+  };
+
+  Waypoints waypoints;
+  SetupNameWaypoints(waypoints, 30000);
+
+  std::vector<std::vector<unsigned>> expected;
+  for (const char *needle : needles)
+    expected.push_back(CollectNameSubstring(waypoints, needle));
+
+  waypoints.Optimise();
+
+  bool success = true;
+  for (unsigned i = 0; i < ARRAY_SIZE(needles); ++i)
+    if (CollectNameSubstring(waypoints, needles[i]) != expected[i])
+      success = false;
+
+  /* modifications invalidate the index; the result must still be
+     correct */
+  Waypoint extra{GeoPoint(Angle::Degrees(7), Angle::Degrees(46))};
+  extra.name = "OBERWALDEXTRA";
+  waypoints.Append(std::move(extra));
+  success = success &&
+    CollectNameSubstring(waypoints, "OBERWALD").size() ==
+    expected[5].size() + 1;
+
+  return success;
+}
+
 int
 main(int argc, char** argv)
 {
   if (!ParseArgs(argc, argv))
     return 0;
 
-  plan_tests(52 + 9 + 6 + 17);
+  plan_tests(52 + 9 + 6 + 17 + 1);
 
   Waypoints waypoints;
   GeoPoint center(Angle::Degrees(51.4), Angle::Degrees(7.85));
@@ -508,6 +564,9 @@ main(int argc, char** argv)
   TestNameSubstringVisitor(waypoints);
   TestNameSubstringShortname();
   TestSuggestNameSubstring();
+  ok(TestNameSubstringIndex(), "name substring index", 0);
+  if (verbose)
+    BenchmarkNameSubstring(30000);
   TestRangeVisitor(waypoints, center);
   TestGetNearest(waypoints, center);
   TestIterator(waypoints);
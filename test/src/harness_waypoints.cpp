@@ -6,10 +6,14 @@
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "system/FileUtil.hpp"
 #include "test_debug.hpp"
+#include "util/Macros.hpp"
 
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+
+#include <stdio.h>
 
 /** 
  * Initialises waypoints with random and non-random waypoints
@@ -88,3 +92,75 @@ bool SetupWaypoints(Waypoints &waypoints, const unsigned n)
   return true;
 }
 
+
+void
+SetupNameWaypoints(Waypoints &waypoints, unsigned n)
+{
+  static constexpr const char *syllables[] = {
+    "AL", "BERG", "DORF", "EN", "FELD", "HAUSEN", "IN", "KIRCH",
+    "LING", "MOOS", "OBER", "RIED", "SANKT", "TAL", "UNTER", "WALD",
+  };
+
+  unsigned seed = 1;
+  for (unsigned i = 0; i < n; ++i) {
+    Waypoint wp{GeoPoint(Angle::Degrees(5 + (i % 200) * 0.05),
+                         Angle::Degrees(45 + (i / 200) * 0.05))};
+
+    const unsigned n_syllables = 2 + i % 3;
+    for (unsigned j = 0; j < n_syllables; ++j) {
+      seed = seed * 1103515245 + 12345;
+      wp.name += syllables[(seed >> 16) % ARRAY_SIZE(syllables)];
+    }
+
+    if (i % 4 == 0) {
+      char shortname[16];
+      snprintf(shortname, sizeof(shortname), "%s%u",
+               i % 8 == 0 ? "LS" : "ED", i % 10000);
+      wp.shortname = shortname;
+    }
+
+    waypoints.Append(std::move(wp));
+  }
+}
+
+static unsigned
+CountNameSubstring(const Waypoints &waypoints, const char *substring)
+{
+  unsigned n = 0;
+  waypoints.VisitNameSubstring(substring, [&n](const auto &){ ++n; });
+  return n;
+}
+
+void
+BenchmarkNameSubstring(unsigned n)
+{
+  using namespace std::chrono;
+
+  static constexpr const char *needles[] = {
+    "", "E", "WA", "berg", "HAUSEN", "OBERWALD", "LS", "EDDF12", "XYZ",
+  };
+
+  Waypoints waypoints;
+  SetupNameWaypoints(waypoints, n);
+
+  auto start_time = steady_clock::now();
+  for (const char *needle : needles)
+    CountNameSubstring(waypoints, needle);
+  const duration<double, std::milli> linear_time =
+    steady_clock::now() - start_time;
+
+  start_time = steady_clock::now();
+  waypoints.Optimise();
+  const duration<double, std::milli> build_time =
+    steady_clock::now() - start_time;
+
+  start_time = steady_clock::now();
+  for (const char *needle : needles)
+    printf("# '%s': %u matches\n", needle,
+           CountNameSubstring(waypoints, needle));
+  const duration<double, std::milli> index_time =
+    steady_clock::now() - start_time;
+
+  printf("# %u waypoints: linear %.1f ms, optimise %.1f ms, index %.1f ms\n",
+         n, linear_time.count(), build_time.count(), index_time.count());
+}
@@ -8,3 +8,17 @@ class Waypoints;
 
 const Waypoint* lookup_waypoint(const Waypoints& waypoints, unsigned id);
 bool SetupWaypoints(Waypoints &waypoints, const unsigned n=150);
+
+/**
+ * Append waypoints with pseudo-random names made of common syllables
+ * (and a short name for every fourth one), for testing the name
+ * search.  The result is reproducible.
+ */
+void SetupNameWaypoints(Waypoints &waypoints, unsigned n);
+
+/**
+ * Print the time spent by Waypoints::VisitNameSubstring() with a
+ * linear scan, by Waypoints::Optimise() and with the name index, on
+ * waypoints created by SetupNameWaypoints().
+ */
+void BenchmarkNameSubstring(unsigned n);
@@ -12,7 +12,9 @@
 #include "test_debug.hpp"
 #include "util/PrintException.hxx"
 
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 
 extern "C" {
 #include "tap.h"
@@ -204,13 +206,94 @@ test_replay(const Contest olc_type,
 }
 
 
+/**
+ * Replay the flight into a small #Trace (which gets thinned often) and
+ * let the incremental solver find the OLC-Classic result every
+ * #SOLVE_INTERVAL fixes, as ContestComputer does in flight.  Prints the
+ * cost of each of these updates and compares the final result with a
+ * non-incremental search on the same trace.
+ */
+static bool
+benchmark_incremental(Path path)
+{
+  static constexpr unsigned TRACE_SIZE = 512;
+  static constexpr unsigned SOLVE_INTERVAL = 30;
+  static constexpr unsigned HANDICAP = 100;
+
+  ReplayLoggerSim sim(std::make_unique<FileLineReaderA>(path));
+
+  Trace trace(minutes{2}, Trace::null_time, TRACE_SIZE);
+
+  ContestManager contest_manager(Contest::OLC_CLASSIC, trace, trace, trace);
+  contest_manager.SetHandicap(HANDICAP);
+  contest_manager.SetIncremental(true);
+
+  MoreData basic;
+  basic.Reset();
+
+  unsigned n_fixes = 0, n_updates = 0;
+  steady_clock::duration first_duration{}, total_duration{},
+    max_duration{};
+
+  while (sim.Update(basic)) {
+    if (!basic.time_available || !basic.location_available ||
+        !basic.NavAltitudeAvailable())
+      continue;
+
+    trace.push_back(TracePoint(basic));
+
+    if (++n_fixes % SOLVE_INTERVAL != 0)
+      continue;
+
+    const auto start_time = steady_clock::now();
+    contest_manager.UpdateIdle(true);
+    const auto elapsed = steady_clock::now() - start_time;
+
+    if (n_updates++ == 0)
+      first_duration = elapsed;
+    else {
+      total_duration += elapsed;
+      max_duration = std::max(max_duration, elapsed);
+    }
+  }
+
+  contest_manager.UpdateIdle(true);
+
+  if (n_updates < 2)
+    return false;
+
+  diag("%s: %u fixes, %u updates; first update %.1f ms, "
+       "then average %.2f ms, maximum %.2f ms",
+       path.c_str(), n_fixes, n_updates,
+       duration<double, std::milli>(first_duration).count(),
+       duration<double, std::milli>(total_duration).count() / (n_updates - 1),
+       duration<double, std::milli>(max_duration).count());
+
+  const ContestResult incremental_result =
+    contest_manager.GetStats().GetResult(0);
+
+  ContestManager reference(Contest::OLC_CLASSIC, trace, trace, trace);
+  reference.SetHandicap(HANDICAP);
+  reference.SolveExhaustive();
+
+  return compare_scores(reference.GetStats().GetResult(0),
+                        incremental_result);
+}
+
 int main(int argc, char** argv) 
 try {
   if (!ParseArgs(argc,argv)) {
     return 0;
   }
 
-  plan_tests(5);
+  static constexpr const char *incremental_files[] = {
+    "test/data/0asljd01.igc",
+    "test/data/01lz1hq1.igc",
+    "test/data/9crx3101.igc",
+    "test/data/apf-bug554.igc",
+  };
+
+  plan_tests(5 + std::size(incremental_files));
 
   ok(test_replay(Contest::OLC_LEAGUE, official_score_sprint),
      "replay league", 0);
@@ -223,6 +306,11 @@ try {
   ok(test_replay(Contest::OLC_PLUS, official_score_plus),
      "replay plus", 0);
 
+  /* the incremental solver (which keeps its graph across trace
+     thinning) must find the same result as a full search */
+  for (const char *i : incremental_files)
+    ok(benchmark_incremental(Path(i)), "incremental classic %s", i);
+
   return exit_status();
 } catch (const std::runtime_error &e) {
   PrintException(e);